@@ -0,0 +1,121 @@
+// 重连风暴基准：大量客户端并发地反复建立并立即断开连接，比较单接受线程与
+// 每个I/O线程一个SO_REUSEPORT监听套接字时服务器每秒接受的连接数
+//
+// 用法: bench_accept_storm [clients] [seconds] [io_threads]
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "server/TcpServer.h"
+#include "util/Logger.h"
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct StormResult {
+    long connects = 0;
+    long failures = 0;
+    long accepted = 0;
+    double seconds = 0.0;
+};
+
+// 建立连接后立即以RST关闭，避免客户端端口堆积在TIME_WAIT
+bool connectAndReset(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    bool ok = connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    struct linger lingerOption = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lingerOption, sizeof(lingerOption));
+    close(fd);
+    return ok;
+}
+
+StormResult runStorm(bool reusePort, int clients, int seconds, size_t ioThreads) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(ioThreads);
+    server.setReusePort(reusePort);
+
+    std::atomic<long> accepted{0};
+    server.setConnectionCallback([&accepted](const TcpConnectionPtr&) { ++accepted; });
+    if (!server.start()) {
+        std::fprintf(stderr, "failed to start server\n");
+        std::exit(1);
+    }
+
+    std::atomic<long> connects{0};
+    std::atomic<long> failures{0};
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::seconds(seconds);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < clients; ++i) {
+        threads.emplace_back([&] {
+            long ok = 0;
+            long failed = 0;
+            while (Clock::now() < deadline) {
+                if (connectAndReset(server.getPort())) {
+                    ++ok;
+                } else {
+                    ++failed;
+                }
+            }
+            connects += ok;
+            failures += failed;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // 等待积压在监听队列中的连接被接受
+    long last = -1;
+    while (accepted != last) {
+        last = accepted;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    StormResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.connects = connects;
+    result.failures = failures;
+    result.accepted = accepted;
+    server.stop();
+    return result;
+}
+
+void printResult(const char* name, const StormResult& result) {
+    std::printf("%-14s connects=%-9ld failures=%-6ld accepted=%-9ld accepted/s=%.0f\n", name, result.connects,
+                result.failures, result.accepted, result.accepted / result.seconds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int clients = argc > 1 ? std::atoi(argv[1]) : 8;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+    size_t ioThreads = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 4;
+
+    // 对端复位会产生大量接收错误日志，基准只关心接受速率
+    Logger::getInstance().setLogLevel(LogLevel::FATAL);
+
+    std::printf("clients=%d seconds=%d io_threads=%zu\n", clients, seconds, ioThreads);
+    printResult("accept thread", runStorm(false, clients, seconds, ioThreads));
+    printResult("reuse port", runStorm(true, clients, seconds, ioThreads));
+    return 0;
+}
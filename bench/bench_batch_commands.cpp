@@ -0,0 +1,150 @@
+// 批量命令基准：比较逐个发送create_player/join_matchmaking/leave_matchmaking与
+// create_players/join_matchmaking_batch/leave_matchmaking_batch处理同样数量玩家的单核耗时和线上字节数
+//
+// 用法: bench_batch_commands [players] [batch_size]
+// 请求在计时前生成，计时部分与MatchServer的工作线程相同：JsonRequestHandler解析请求、访问真实的
+// MatchManager并把响应写入复用的缓冲区。每个房间的人数远大于玩家数，测量期间不会成房。
+// 每种方式重复测量5次（每次重新初始化MatchManager）取每个阶段最快的一次。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "core/MatchManager.h"
+#include "server/RequestHandler.h"
+#include "util/Logger.h"
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// 重复REPEATS次取最快的一次，减少其他进程干扰
+constexpr int REPEATS = 5;
+constexpr int PHASES = 3;
+const char* PHASE_NAMES[PHASES] = {"create", "join", "leave"};
+
+struct PhaseResult {
+    double seconds = 0;
+    size_t requests = 0;
+    size_t requestBytes = 0;
+    size_t responseBytes = 0;
+};
+
+std::string createRequest(size_t first, size_t count, bool batch) {
+    if (!batch) {
+        return "{\"cmd\":\"create_player\",\"data\":{\"name\":\"player_" + std::to_string(first) +
+               "\",\"rating\":" + std::to_string(1000 + first % 1000) + "}}";
+    }
+    std::string request = "{\"cmd\":\"create_players\",\"data\":{\"players\":[";
+    for (size_t i = first; i < first + count; ++i) {
+        if (i > first) {
+            request += ",";
+        }
+        request += "{\"name\":\"player_" + std::to_string(i) + "\",\"rating\":" + std::to_string(1000 + i % 1000) + "}";
+    }
+    return request + "]}}";
+}
+
+std::string queueRequest(bool join, const std::vector<Player::PlayerId>& ids, size_t first, size_t count, bool batch) {
+    if (!batch) {
+        return std::string("{\"cmd\":\"") + (join ? "join_matchmaking" : "leave_matchmaking") +
+               "\",\"data\":{\"player_id\":" + std::to_string(ids[first]) + "}}";
+    }
+    std::string request = std::string("{\"cmd\":\"") + (join ? "join_matchmaking_batch" : "leave_matchmaking_batch") +
+                          "\",\"data\":{\"player_ids\":[";
+    for (size_t i = first; i < first + count; ++i) {
+        if (i > first) {
+            request += ",";
+        }
+        request += std::to_string(ids[i]);
+    }
+    return request + "]}}";
+}
+
+// 处理一组请求，请求和响应各按一行计算线上字节数
+PhaseResult runPhase(JsonRequestHandler& handler, const std::vector<std::string>& requests, std::string& response) {
+    PhaseResult result;
+    auto start = Clock::now();
+    for (const auto& request : requests) {
+        response.clear();
+        handler.handleRequest(request, 1, response);
+        result.requestBytes += request.size() + 1;
+        result.responseBytes += response.size() + 1;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.requests = requests.size();
+    return result;
+}
+
+void run(const char* label, size_t players, size_t batchSize) {
+    bool batch = batchSize > 1;
+    size_t step = batch ? batchSize : 1;
+    PhaseResult best[PHASES];
+    std::string response;
+    auto& manager = MatchManager::getInstance();
+
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        manager.shutdown();
+        manager.init(static_cast<int>(players) + 1, 1);
+        manager.setForceMatchOnTimeout(false);
+        JsonRequestHandler handler;
+        std::vector<Player::PlayerId> ids;
+        handler.setPlayerCreatedCallback([&ids](TcpConnection::ConnectionId, Player::PlayerId playerId) {
+            ids.push_back(playerId);
+        });
+
+        PhaseResult results[PHASES];
+        std::vector<std::string> requests;
+        for (size_t i = 0; i < players; i += step) {
+            requests.push_back(createRequest(i, std::min(step, players - i), batch));
+        }
+        results[0] = runPhase(handler, requests, response);
+
+        for (int phase = 1; phase < PHASES; ++phase) {
+            requests.clear();
+            for (size_t i = 0; i < ids.size(); i += step) {
+                requests.push_back(queueRequest(phase == 1, ids, i, std::min(step, ids.size() - i), batch));
+            }
+            results[phase] = runPhase(handler, requests, response);
+        }
+        if (manager.getPlayerCount() != players || manager.getQueueSize() != 0) {
+            std::fprintf(stderr, "Unexpected state: players=%zu queue=%zu\n", manager.getPlayerCount(),
+                         manager.getQueueSize());
+            std::exit(1);
+        }
+
+        for (int phase = 0; phase < PHASES; ++phase) {
+            if (repeat == 0 || results[phase].seconds < best[phase].seconds) {
+                best[phase] = results[phase];
+            }
+        }
+    }
+
+    for (int phase = 0; phase < PHASES; ++phase) {
+        const PhaseResult& result = best[phase];
+        std::printf("%-6s %-6s requests=%-7zu best=%7.2fms ns/player=%6.1f bytes/player: request=%5.1f response=%5.1f\n",
+                    label, PHASE_NAMES[phase], result.requests, result.seconds * 1000,
+                    result.seconds * 1e9 / players, static_cast<double>(result.requestBytes) / players,
+                    static_cast<double>(result.responseBytes) / players);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t players = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t batchSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+    if (players == 0 || batchSize < 2 || batchSize > JsonRequestHandler::MAX_BATCH_SIZE) {
+        std::fprintf(stderr, "Usage: %s [players] [batch_size(2-%zu)]\n", argv[0], JsonRequestHandler::MAX_BATCH_SIZE);
+        return 1;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::WARNING);
+    run("single", players, 1);
+    run("batch", players, batchSize);
+    MatchManager::getInstance().shutdown();
+    return 0;
+}
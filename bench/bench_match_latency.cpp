@@ -0,0 +1,121 @@
+// 匹配延迟基准：比较固定间隔轮询与事件驱动唤醒下玩家从入队到成房的耗时分布
+//
+// 用法: bench_match_latency [players] [mean_arrival_us] [interval_ms] [coalesce_ms]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "core/MatchMaker.h"
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct LatencyResult {
+    std::vector<double> latenciesMs;
+    double elapsedMs = 0.0;
+};
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+LatencyResult runOnce(bool eventDriven, int players, int meanArrivalUs, uint32_t intervalMs, uint32_t coalesceMs) {
+    MatchMaker matchMaker(2);
+    matchMaker.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+    matchMaker.setMatchInterval(intervalMs);
+    matchMaker.setEventDriven(eventDriven);
+    matchMaker.setCoalesceWindow(coalesceMs);
+
+    std::vector<Clock::time_point> enqueueTimes(players + 1);
+    LatencyResult result;
+    std::mutex resultMutex;
+    std::atomic<int> matched{0};
+
+    matchMaker.setMatchNotifyCallback([&](const RoomPtr& room) {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(resultMutex);
+        for (const auto& player : room->getPlayers()) {
+            auto waited = std::chrono::duration<double, std::milli>(now - enqueueTimes[player->getId()]);
+            result.latenciesMs.push_back(waited.count());
+        }
+        matched += room->getPlayerCount();
+    });
+
+    matchMaker.start();
+
+    std::mt19937 rng(42);
+    std::exponential_distribution<double> arrival(1.0 / std::max(meanArrivalUs, 1));
+    std::uniform_int_distribution<int> rating(1400, 1600);
+
+    auto start = Clock::now();
+    for (int i = 1; i <= players; ++i) {
+        auto player = std::make_shared<Player>(i, "BenchPlayer", rating(rng));
+        enqueueTimes[i] = Clock::now();
+        matchMaker.addPlayer(player);
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(arrival(rng))));
+    }
+
+    // 等待所有玩家匹配完成（人数为奇数时最后一人留在队列中）
+    auto deadline = Clock::now() + std::chrono::seconds(10);
+    while (matched < players - (players % 2) && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    result.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    matchMaker.stop();
+    return result;
+}
+
+void report(const char* name, LatencyResult result) {
+    double sum = 0.0;
+    for (double v : result.latenciesMs) {
+        sum += v;
+    }
+    size_t count = result.latenciesMs.size();
+    double mean = count ? sum / count : 0.0;
+    double p50 = percentile(result.latenciesMs, 0.50);
+    double p99 = percentile(result.latenciesMs, 0.99);
+
+    std::printf("%-8s matched=%-6zu mean=%8.2fms p50=%8.2fms p99=%8.2fms elapsed=%8.1fms\n",
+                name, count, mean, p50, p99, result.elapsedMs);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int players = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int meanArrivalUs = argc > 2 ? std::atoi(argv[2]) : 1000;
+    uint32_t intervalMs = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 100;
+    uint32_t coalesceMs = argc > 4 ? static_cast<uint32_t>(std::atoi(argv[4])) : 10;
+
+    std::printf("players=%d mean_arrival=%dus interval=%ums coalesce=%ums\n",
+                players, meanArrivalUs, intervalMs, coalesceMs);
+
+    // 屏蔽MatchMaker逐房间的标准输出日志
+    std::ostringstream sink;
+    auto* original = std::cout.rdbuf(sink.rdbuf());
+
+    auto polling = runOnce(false, players, meanArrivalUs, intervalMs, coalesceMs);
+    auto eventDriven = runOnce(true, players, meanArrivalUs, intervalMs, coalesceMs);
+
+    std::cout.rdbuf(original);
+
+    report("polling", polling);
+    report("event", eventDriven);
+    return 0;
+}
@@ -0,0 +1,119 @@
+// 匹配质量对比：在相同的到达序列上比较贪心锚点匹配与排序窗口匹配的每轮成房数、房间评分跨度和单轮耗时
+//
+// 用法: bench_match_quality [ticks] [arrivals_per_tick] [max_rating_diff] [players_per_room] [backlog]
+// 除逐轮模拟外，另对backlog名同时排队的玩家各执行一轮匹配，比较单轮能组出的房间数
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "core/MatchQueue.h"
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct QualityResult {
+    size_t rooms = 0;
+    int64_t totalSpread = 0;
+    uint64_t totalWaitTicks = 0;
+    size_t matchedPlayers = 0;
+    double totalTickUs = 0.0;
+    size_t leftover = 0;
+};
+
+QualityResult run(MatchAlgorithm algorithm, int ticks, int arrivalsPerTick, int maxRatingDiff, int playersPerRoom) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(maxRatingDiff));
+    queue.setMatchAlgorithm(algorithm);
+
+    // 两种算法使用相同的随机种子，到达序列完全一致
+    std::mt19937 rng(2024);
+    std::poisson_distribution<int> arrivals(arrivalsPerTick);
+    std::normal_distribution<double> rating(1500.0, 350.0);
+
+    std::unordered_map<Player::PlayerId, int> enqueueTick;
+    Player::PlayerId nextId = 1;
+    QualityResult result;
+    std::vector<std::vector<PlayerPtr>> rooms;
+
+    for (int tick = 0; tick < ticks; ++tick) {
+        int count = arrivals(rng);
+        for (int i = 0; i < count; ++i) {
+            auto player = std::make_shared<Player>(nextId, "BenchPlayer", static_cast<int>(rating(rng)));
+            enqueueTick[nextId] = tick;
+            ++nextId;
+            queue.addPlayer(player);
+        }
+
+        rooms.clear();
+        auto start = Clock::now();
+        queue.matchAll(rooms, playersPerRoom);
+        result.totalTickUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        for (const auto& room : rooms) {
+            auto bounds = std::minmax_element(room.begin(), room.end(),
+                [](const PlayerPtr& a, const PlayerPtr& b) { return a->getRating() < b->getRating(); });
+            result.totalSpread += (*bounds.second)->getRating() - (*bounds.first)->getRating();
+            for (const auto& player : room) {
+                result.totalWaitTicks += tick - enqueueTick[player->getId()];
+            }
+            result.matchedPlayers += room.size();
+        }
+        result.rooms += rooms.size();
+    }
+
+    result.leftover = queue.size();
+    return result;
+}
+
+// 单轮匹配：backlog名玩家同时在队列中，返回本轮组出的房间数
+size_t snapshot(MatchAlgorithm algorithm, int backlog, int maxRatingDiff, int playersPerRoom) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(maxRatingDiff));
+    queue.setMatchAlgorithm(algorithm);
+
+    std::mt19937 rng(7);
+    std::normal_distribution<double> rating(1500.0, 350.0);
+    for (int i = 1; i <= backlog; ++i) {
+        queue.addPlayer(std::make_shared<Player>(i, "BenchPlayer", static_cast<int>(rating(rng))));
+    }
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    return queue.matchAll(rooms, playersPerRoom);
+}
+
+void report(const char* name, int ticks, const QualityResult& result) {
+    double roomsPerTick = static_cast<double>(result.rooms) / ticks;
+    double avgSpread = result.rooms ? static_cast<double>(result.totalSpread) / result.rooms : 0.0;
+    double avgWait = result.matchedPlayers ? static_cast<double>(result.totalWaitTicks) / result.matchedPlayers : 0.0;
+    std::printf("%-14s rooms/tick=%8.2f avg_spread=%7.1f avg_wait=%6.2f ticks tick=%8.1fus leftover=%zu\n",
+                name, roomsPerTick, avgSpread, avgWait, result.totalTickUs / ticks, result.leftover);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int ticks = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int arrivalsPerTick = argc > 2 ? std::atoi(argv[2]) : 200;
+    int maxRatingDiff = argc > 3 ? std::atoi(argv[3]) : 100;
+    int playersPerRoom = argc > 4 ? std::atoi(argv[4]) : 2;
+    int backlog = argc > 5 ? std::atoi(argv[5]) : 1000;
+
+    std::printf("ticks=%d arrivals/tick=%d max_rating_diff=%d players_per_room=%d backlog=%d\n",
+                ticks, arrivalsPerTick, maxRatingDiff, playersPerRoom, backlog);
+
+    for (auto algorithm : {MatchAlgorithm::ANCHOR_GREEDY, MatchAlgorithm::SORTED_WINDOW}) {
+        report(matchAlgorithmName(algorithm), ticks,
+               run(algorithm, ticks, arrivalsPerTick, maxRatingDiff, playersPerRoom));
+    }
+    for (auto algorithm : {MatchAlgorithm::ANCHOR_GREEDY, MatchAlgorithm::SORTED_WINDOW}) {
+        std::printf("%-14s backlog rooms=%zu\n", matchAlgorithmName(algorithm),
+                    snapshot(algorithm, backlog, maxRatingDiff, playersPerRoom));
+    }
+    return 0;
+}
@@ -0,0 +1,292 @@
+// 队列扫描基准：比较按列存放的MatchQueue与旧的按玩家指针存放布局在一轮批量匹配中的缓存未命中数
+//
+// 用法: bench_queue_scan [max_rating_diff] [players...]
+// 默认分别在1万和10万名排队玩家上各执行一轮matchAll。
+// 缓存计数来自perf_event_open，内核禁止访问性能计数器时（perf_event_paranoid或容器限制）只输出耗时。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "core/MatchQueue.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum class CacheEvent {
+    LastLevelMiss,
+    L1DataReadMiss
+};
+
+// 单个硬件计数器，仅统计本线程用户态事件
+class PerfCounter {
+public:
+    explicit PerfCounter(CacheEvent event) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (event == CacheEvent::LastLevelMiss) {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        } else {
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~PerfCounter() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    bool available() const { return fd_ >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t value = 0;
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &value, sizeof(value)) != sizeof(value)) {
+                value = 0;
+            }
+        }
+#endif
+        return value;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+// 旧布局的参考实现：每个桶元素持有PlayerPtr，候选判断逐对调用isMatch并解引用Player
+class AosReferenceQueue {
+public:
+    explicit AosReferenceQueue(std::shared_ptr<MatchStrategy> strategy)
+        : strategy_(std::move(strategy)) {
+    }
+
+    void addPlayer(const PlayerPtr& player) {
+        uint64_t seq = nextSeq_++;
+        int bucket = bucketOf(player->getRating());
+        auto& entries = buckets_[bucket];
+        slots_[player->getId()] = Slot{bucket, entries.size()};
+        entries.push_back(Entry{seq, player->getRating(), player});
+        fifo_.push_back(player->getId());
+    }
+
+    size_t matchAll(int requiredPlayers) {
+        size_t formed = 0;
+        std::vector<PlayerPtr> matched;
+        std::vector<const Entry*> candidates;
+        for (auto playerId : fifo_) {
+            auto slot = slots_.find(playerId);
+            if (slot == slots_.end()) {
+                continue;
+            }
+            const Entry& anchorEntry = buckets_[slot->second.bucket][slot->second.index];
+            const PlayerPtr anchor = anchorEntry.player;
+
+            candidates.clear();
+            int minRating = 0, maxRating = 0;
+            strategy_->getRatingWindow(anchor, anchorEntry.rating, minRating, maxRating);
+            auto end = buckets_.upper_bound(bucketOf(maxRating));
+            for (auto it = buckets_.lower_bound(bucketOf(minRating)); it != end; ++it) {
+                for (const auto& entry : it->second) {
+                    if (entry.rating >= minRating && entry.rating <= maxRating && entry.player != anchor) {
+                        candidates.push_back(&entry);
+                    }
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(),
+                [](const Entry* a, const Entry* b) { return a->seq < b->seq; });
+
+            matched.clear();
+            matched.push_back(anchor);
+            for (size_t i = 0; i < candidates.size() && matched.size() < static_cast<size_t>(requiredPlayers); ++i) {
+                bool canMatch = true;
+                for (const auto& player : matched) {
+                    if (!strategy_->isMatch(player, candidates[i]->player)) {
+                        canMatch = false;
+                        break;
+                    }
+                }
+                if (canMatch) {
+                    matched.push_back(candidates[i]->player);
+                }
+            }
+
+            if (matched.size() == static_cast<size_t>(requiredPlayers)) {
+                for (const auto& player : matched) {
+                    erase(player->getId());
+                }
+                ++formed;
+            }
+        }
+        return formed;
+    }
+
+private:
+    struct Entry {
+        uint64_t seq;
+        int rating;
+        PlayerPtr player;
+    };
+
+    struct Slot {
+        int bucket;
+        size_t index;
+    };
+
+    static int bucketOf(int rating) {
+        int bucket = rating / MatchQueue::RATING_BUCKET_WIDTH;
+        if (rating < 0 && rating % MatchQueue::RATING_BUCKET_WIDTH != 0) {
+            --bucket;
+        }
+        return bucket;
+    }
+
+    void erase(Player::PlayerId playerId) {
+        auto it = slots_.find(playerId);
+        Slot slot = it->second;
+        slots_.erase(it);
+        auto& entries = buckets_[slot.bucket];
+        if (slot.index + 1 != entries.size()) {
+            entries[slot.index] = std::move(entries.back());
+            slots_[entries[slot.index].player->getId()].index = slot.index;
+        }
+        entries.pop_back();
+    }
+
+    std::shared_ptr<MatchStrategy> strategy_;
+    std::map<int, std::vector<Entry>> buckets_;
+    std::unordered_map<Player::PlayerId, Slot> slots_;
+    std::vector<Player::PlayerId> fifo_;
+    uint64_t nextSeq_ = 0;
+};
+
+struct PassResult {
+    size_t rooms = 0;
+    double elapsedMs = 0.0;
+    uint64_t llcMisses = 0;
+    uint64_t l1dMisses = 0;
+};
+
+std::vector<PlayerPtr> makePlayers(int count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> rating(0, 2999);
+    std::vector<PlayerPtr> players;
+    players.reserve(count);
+    for (int i = 1; i <= count; ++i) {
+        // 名字超过短字符串优化长度，模拟真实玩家对象的堆分布
+        auto player = std::make_shared<Player>(i, "BenchPlayer_" + std::to_string(i) + "_with_a_long_name", rating(rng));
+        player->updateActivity(1);
+        players.push_back(player);
+    }
+    return players;
+}
+
+template <typename Pass>
+PassResult measure(Pass&& pass) {
+    PerfCounter llc(CacheEvent::LastLevelMiss);
+    PerfCounter l1d(CacheEvent::L1DataReadMiss);
+
+    PassResult result;
+    auto start = Clock::now();
+    llc.start();
+    l1d.start();
+    result.rooms = pass();
+    result.l1dMisses = l1d.stop();
+    result.llcMisses = llc.stop();
+    result.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if (!llc.available()) {
+        result.llcMisses = UINT64_MAX;
+    }
+    if (!l1d.available()) {
+        result.l1dMisses = UINT64_MAX;
+    }
+    return result;
+}
+
+void report(const char* name, int players, const PassResult& result) {
+    char llc[32] = "n/a";
+    char l1d[32] = "n/a";
+    if (result.llcMisses != UINT64_MAX) {
+        std::snprintf(llc, sizeof(llc), "%llu", static_cast<unsigned long long>(result.llcMisses));
+    }
+    if (result.l1dMisses != UINT64_MAX) {
+        std::snprintf(l1d, sizeof(l1d), "%llu", static_cast<unsigned long long>(result.l1dMisses));
+    }
+    std::printf("%-5s players=%-7d rooms=%-7zu time=%9.1fms llc_misses=%-12s l1d_misses=%s\n",
+                name, players, result.rooms, result.elapsedMs, llc, l1d);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int maxRatingDiff = argc > 1 ? std::atoi(argv[1]) : 10;
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; ++i) {
+        sizes.push_back(std::atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {10000, 100000};
+    }
+
+    std::printf("max_rating_diff=%d\n", maxRatingDiff);
+    auto strategy = std::make_shared<RatingBasedStrategy>(maxRatingDiff);
+
+    for (int count : sizes) {
+        auto players = makePlayers(count);
+
+        AosReferenceQueue aos(strategy);
+        for (const auto& player : players) {
+            aos.addPlayer(player);
+        }
+        report("aos", count, measure([&] { return aos.matchAll(2); }));
+
+        MatchQueue soa;
+        soa.setMatchStrategy(strategy);
+        for (const auto& player : players) {
+            soa.addPlayer(player);
+        }
+        std::vector<std::vector<PlayerPtr>> rooms;
+        report("soa", count, measure([&] { return soa.matchAll(rooms, 2); }));
+    }
+    return 0;
+}
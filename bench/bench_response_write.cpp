@@ -0,0 +1,256 @@
+// 响应生成基准：比较旧的ostringstream拼接与JsonWriter写入复用缓冲区生成JSON响应的单核耗时和堆分配次数
+//
+// 用法: bench_response_write [responses] [rounds]
+// 两种实现生成逐字节相同的get_player_info、get_queue_status和match_notify响应（房间平均分除外，
+// 旧实现按6位有效数字输出，新实现输出最短的精确表示，因此组合中不含get_rooms）。
+// 每种实现重复测量5次取最快的一次，同时统计每个响应的堆分配次数（替换全局operator new计数）。
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "util/JsonReader.h"
+#include "util/JsonWriter.h"
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct PlayerInfo {
+    uint64_t id;
+    std::string name;
+    int rating;
+    bool inQueue;
+    int team;
+};
+
+enum class Kind {
+    PLAYER_INFO,
+    QUEUE_STATUS,
+    MATCH_NOTIFY
+};
+
+struct Response {
+    Kind kind;
+    // PLAYER_INFO使用第一个玩家，MATCH_NOTIFY使用全部玩家
+    std::vector<PlayerInfo> players;
+    uint64_t value;
+};
+
+// 旧实现：data先用ostringstream拼好，再由createJsonResponse拼进外层
+namespace legacy {
+
+std::string createJsonResponse(const std::string& command, bool success, const std::string& message,
+                               const std::string& data) {
+    std::ostringstream oss;
+    oss << "{\"cmd\":\"" << command << "\",\"success\":" << (success ? "true" : "false")
+        << ",\"message\":\"" << message << "\"";
+    if (!data.empty()) {
+        oss << ",\"data\":" << data;
+    }
+    oss << "}";
+    return oss.str();
+}
+
+std::string write(const Response& response) {
+    switch (response.kind) {
+        case Kind::PLAYER_INFO: {
+            const PlayerInfo& player = response.players.front();
+            std::ostringstream oss;
+            oss << "{\"player_id\":" << player.id
+                << ",\"name\":\"" << escapeJsonString(player.name)
+                << "\",\"rating\":" << player.rating
+                << ",\"in_queue\":" << (player.inQueue ? "true" : "false")
+                << "}";
+            return createJsonResponse("get_player_info", true, "Player info retrieved successfully", oss.str());
+        }
+        case Kind::QUEUE_STATUS: {
+            std::ostringstream oss;
+            oss << "{\"queue_size\":" << response.value << "}";
+            return createJsonResponse("get_queue_status", true, "Queue status retrieved successfully", oss.str());
+        }
+        case Kind::MATCH_NOTIFY:
+        default: {
+            std::ostringstream oss;
+            oss << "{\"room_id\":" << response.value << ",\"teams\":2,\"players\":[";
+            for (size_t i = 0; i < response.players.size(); ++i) {
+                const PlayerInfo& player = response.players[i];
+                if (i > 0) {
+                    oss << ",";
+                }
+                oss << "{\"player_id\":" << player.id
+                    << ",\"name\":\"" << escapeJsonString(player.name)
+                    << "\",\"rating\":" << player.rating
+                    << ",\"team\":" << player.team
+                    << "}";
+            }
+            oss << "]}";
+            return "{\"cmd\":\"match_notify\",\"success\":true,\"message\":\"Match found\",\"data\":" + oss.str() + "}";
+        }
+    }
+}
+
+} // namespace legacy
+
+// 新实现：与RequestHandler和MatchServer相同，直接写入调用方复用的缓冲区
+void writeResponse(const Response& response, std::string& out) {
+    JsonWriter writer(out);
+    const char* command = response.kind == Kind::PLAYER_INFO    ? "get_player_info"
+                          : response.kind == Kind::QUEUE_STATUS ? "get_queue_status"
+                                                                : "match_notify";
+    const char* message = response.kind == Kind::PLAYER_INFO    ? "Player info retrieved successfully"
+                          : response.kind == Kind::QUEUE_STATUS ? "Queue status retrieved successfully"
+                                                                : "Match found";
+    writer.beginObject()
+        .key("cmd").escapedString(command)
+        .key("success").boolean(true)
+        .key("message").string(message)
+        .key("data").beginObject();
+    switch (response.kind) {
+        case Kind::PLAYER_INFO: {
+            const PlayerInfo& player = response.players.front();
+            writer.key("player_id").integer(player.id)
+                .key("name").string(player.name)
+                .key("rating").integer(player.rating)
+                .key("in_queue").boolean(player.inQueue);
+            break;
+        }
+        case Kind::QUEUE_STATUS:
+            writer.key("queue_size").integer(response.value);
+            break;
+        case Kind::MATCH_NOTIFY:
+        default:
+            writer.key("room_id").integer(response.value).key("teams").integer(2).key("players").beginArray();
+            for (const PlayerInfo& player : response.players) {
+                writer.beginObject()
+                    .key("player_id").integer(player.id)
+                    .key("name").string(player.name)
+                    .key("rating").integer(player.rating)
+                    .key("team").integer(player.team)
+                    .endObject();
+            }
+            writer.endArray();
+            break;
+    }
+    writer.endObject().endObject();
+}
+
+// 以查询为主，每10个响应中有一个10人房间的成房通知
+std::vector<Response> makeResponses(size_t count) {
+    std::vector<Response> responses;
+    responses.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Response response;
+        uint64_t id = 100000 + i;
+        if (i % 10 == 9) {
+            response.kind = Kind::MATCH_NOTIFY;
+            response.value = i;
+            for (int p = 0; p < 10; ++p) {
+                response.players.push_back({id + p, "player_" + std::to_string(id + p), 1000 + p * 7, false, p % 2});
+            }
+        } else if (i % 3 == 0) {
+            response.kind = Kind::QUEUE_STATUS;
+            response.value = i % 5000;
+        } else {
+            response.kind = Kind::PLAYER_INFO;
+            response.players.push_back({id, "player_" + std::to_string(id), 1000 + static_cast<int>(i % 1000),
+                                        i % 2 == 0, -1});
+        }
+        responses.push_back(std::move(response));
+    }
+    return responses;
+}
+
+// 重复REPEATS次取最快的一次，减少其他进程干扰
+constexpr int REPEATS = 5;
+
+template <typename Writer>
+void run(const char* label, const std::vector<Response>& responses, int rounds, Writer writer) {
+    uint64_t checksum = 0;
+    for (const auto& response : responses) {
+        checksum += writer(response);
+    }
+
+    double best = 0;
+    uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        auto start = Clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto& response : responses) {
+                checksum += writer(response);
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (repeat == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    double total = static_cast<double>(responses.size()) * rounds;
+    std::printf("%-13s responses=%-9.0f best=%8.1fms ns/resp=%6.1f allocs/resp=%.3f checksum=%llu\n",
+                label, total, best * 1000, best * 1e9 / total, allocations / (total * REPEATS),
+                static_cast<unsigned long long>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 50;
+    if (count == 0 || rounds <= 0) {
+        std::fprintf(stderr, "Usage: %s [responses] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    auto responses = makeResponses(count);
+
+    // 两种实现的输出必须一致
+    std::string buffer;
+    for (const auto& response : responses) {
+        buffer.clear();
+        writeResponse(response, buffer);
+        if (buffer != legacy::write(response)) {
+            std::fprintf(stderr, "Output mismatch: %s\n", buffer.c_str());
+            return 1;
+        }
+    }
+
+    run("ostringstream", responses, rounds, [](const Response& response) {
+        return legacy::write(response).size();
+    });
+    // 与工作线程相同：每个响应前清空缓冲区，容量保留
+    run("JsonWriter", responses, rounds, [&buffer](const Response& response) {
+        buffer.clear();
+        writeResponse(response, buffer);
+        return buffer.size();
+    });
+    return 0;
+}
@@ -0,0 +1,141 @@
+// 本机传输延迟基准：同一个服务器同时监听TCP回环地址和Unix域套接字，
+// 客户端逐个发送请求并等待回显，比较两种传输方式的请求往返延迟
+//
+// 用法: bench_transport_latency [round_trips] [clients] [io_threads]
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "server/TcpServer.h"
+#include "util/Logger.h"
+#include "util/SocketAddress.h"
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// 与真实请求大小相近的负载
+const std::string REQUEST = "{\"cmd\":\"join_matchmaking\",\"data\":{\"player_id\":\"a1b2c3d4e5f60718\"}}\n";
+
+struct LatencyResult {
+    std::vector<double> samplesUs;
+    double seconds = 0.0;
+};
+
+int connectTo(const SocketAddress& address) {
+    int fd = socket(address.getFamily(), SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, address.get(), address.length) < 0) {
+        std::perror("connect");
+        std::exit(1);
+    }
+    return fd;
+}
+
+// 每个客户端发送一个请求后读完整个回显再发下一个
+void runClient(const SocketAddress& address, int roundTrips, std::vector<double>& samplesUs) {
+    int fd = connectTo(address);
+    std::vector<char> buffer(REQUEST.size());
+    samplesUs.reserve(roundTrips);
+    for (int i = 0; i < roundTrips; ++i) {
+        auto start = Clock::now();
+        if (send(fd, REQUEST.data(), REQUEST.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(REQUEST.size())) {
+            std::perror("send");
+            std::exit(1);
+        }
+        size_t received = 0;
+        while (received < REQUEST.size()) {
+            ssize_t n = recv(fd, buffer.data() + received, buffer.size() - received, 0);
+            if (n <= 0) {
+                std::perror("recv");
+                std::exit(1);
+            }
+            received += n;
+        }
+        samplesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    close(fd);
+}
+
+LatencyResult runTransport(const SocketAddress& address, int roundTrips, int clients) {
+    std::vector<std::vector<double>> perClient(clients);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int i = 0; i < clients; ++i) {
+        threads.emplace_back([&, i] { runClient(address, roundTrips, perClient[i]); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    LatencyResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& samples : perClient) {
+        result.samplesUs.insert(result.samplesUs.end(), samples.begin(), samples.end());
+    }
+    std::sort(result.samplesUs.begin(), result.samplesUs.end());
+    return result;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    return sorted[index];
+}
+
+void printResult(const char* name, const LatencyResult& result) {
+    double total = 0.0;
+    for (double sample : result.samplesUs) {
+        total += sample;
+    }
+    std::printf("%-6s round_trips=%-8zu avg=%7.1f us  p50=%7.1f us  p99=%7.1f us  max=%8.1f us  req/s=%.0f\n", name,
+                result.samplesUs.size(), total / result.samplesUs.size(), percentile(result.samplesUs, 0.50),
+                percentile(result.samplesUs, 0.99), result.samplesUs.back(), result.samplesUs.size() / result.seconds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int roundTrips = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int clients = argc > 2 ? std::atoi(argv[2]) : 1;
+    size_t ioThreads = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 2;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARNING);
+
+    std::string unixPath = "/tmp/bench_transport_" + std::to_string(getpid()) + ".sock";
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(ioThreads);
+    server.addListenAddress("unix:" + unixPath);
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view message) {
+        conn->send(message);
+    });
+    if (!server.start()) {
+        std::fprintf(stderr, "failed to start server\n");
+        return 1;
+    }
+
+    SocketAddress tcpAddress;
+    SocketAddress unixAddress;
+    parseSocketAddress("127.0.0.1", server.getPort(), tcpAddress);
+    parseSocketAddress("unix:" + unixPath, 0, unixAddress);
+
+    std::printf("round_trips=%d clients=%d io_threads=%zu request=%zu bytes\n", roundTrips, clients, ioThreads,
+                REQUEST.size());
+    // 先各跑一轮预热，避免首次连接和缓冲区分配计入结果
+    runTransport(tcpAddress, roundTrips / 10 + 1, clients);
+    runTransport(unixAddress, roundTrips / 10 + 1, clients);
+    printResult("tcp", runTransport(tcpAddress, roundTrips, clients));
+    printResult("unix", runTransport(unixAddress, roundTrips, clients));
+
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,290 @@
+// 协议编码基准：比较JSON协议与紧凑二进制协议每个请求的线上字节数和单核CPU耗时
+//
+// 用法: bench_wire_protocol [requests] [rounds]
+// 每个请求走完一次往返中除网络以外的全部步骤：客户端编码请求帧，服务器取出帧并交给对应的
+// RequestHandler处理(访问真实的MatchManager)，编码响应帧，客户端解码响应中的字段。
+// 请求组合以查询和入队/离队为主，离队紧跟在同一玩家的入队之后，队列大小保持不变，不会成房。
+// 服务器和MatchServer的工作线程一样把响应写入复用的缓冲区。每种协议重复测量5次取最快的一次，
+// 同时统计每个请求的堆分配次数（替换全局operator new计数），其中包括连接发送队列中每帧的一次分配。
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/MatchManager.h"
+#include "server/BinaryRequestHandler.h"
+#include "util/FrameCodec.h"
+#include "util/JsonReader.h"
+#include "util/Logger.h"
+
+using namespace gmatch;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+enum class Command {
+    JOIN,
+    LEAVE,
+    PLAYER_INFO,
+    QUEUE_STATUS
+};
+
+struct Request {
+    Command command;
+    Player::PlayerId playerId;
+};
+
+const char* jsonCommandName(Command command) {
+    switch (command) {
+        case Command::JOIN:
+            return "join_matchmaking";
+        case Command::LEAVE:
+            return "leave_matchmaking";
+        case Command::PLAYER_INFO:
+            return "get_player_info";
+        case Command::QUEUE_STATUS:
+        default:
+            return "get_queue_status";
+    }
+}
+
+BinaryOpcode binaryOpcode(Command command) {
+    switch (command) {
+        case Command::JOIN:
+            return BinaryOpcode::JOIN_MATCHMAKING;
+        case Command::LEAVE:
+            return BinaryOpcode::LEAVE_MATCHMAKING;
+        case Command::PLAYER_INFO:
+            return BinaryOpcode::GET_PLAYER_INFO;
+        case Command::QUEUE_STATUS:
+        default:
+            return BinaryOpcode::GET_QUEUE_STATUS;
+    }
+}
+
+// 每5个请求：2个查询玩家信息，1个查询队列，1对入队/离队
+std::vector<Request> makeRequests(const std::vector<Player::PlayerId>& players, size_t count) {
+    std::vector<Request> requests;
+    requests.reserve(count + 1);
+    for (size_t i = 0; requests.size() < count; ++i) {
+        Player::PlayerId playerId = players[i % players.size()];
+        switch (i % 4) {
+            case 0:
+            case 1:
+                requests.push_back({Command::PLAYER_INFO, playerId});
+                break;
+            case 2:
+                requests.push_back({Command::QUEUE_STATUS, 0});
+                break;
+            default:
+                requests.push_back({Command::JOIN, playerId});
+                requests.push_back({Command::LEAVE, playerId});
+                break;
+        }
+    }
+    return requests;
+}
+
+// 一次往返的结果，两种协议取出同样的内容
+struct RoundTrip {
+    size_t requestBytes = 0;
+    size_t responseBytes = 0;
+    uint64_t checksum = 0;
+};
+
+class JsonCodec {
+public:
+    void roundTrip(const Request& request, RoundTrip& result) {
+        // 客户端编码请求，与MatchClient相同
+        std::string payload = std::string("{\"cmd\":\"") + jsonCommandName(request.command) + "\",\"data\":";
+        if (request.command == Command::QUEUE_STATUS) {
+            payload += "{}";
+        } else {
+            payload += "{\"player_id\":" + std::to_string(request.playerId) + "}";
+        }
+        payload += "}";
+        requestFrame_.clear();
+        appendFrame(FramingMode::LINE, payload, requestFrame_);
+
+        // 服务器分帧、处理并编码响应，发送队列中的每帧是一个新分配的字符串
+        serverDecoder_.append(requestFrame_.data(), requestFrame_.size());
+        std::string_view frame;
+        serverDecoder_.nextFrame(frame);
+        response_.clear();
+        handler_.handleRequest(frame, 1, response_);
+        responseFrame_ = encodeFrame(FramingMode::LINE, response_);
+
+        // 客户端分帧并解码响应
+        clientDecoder_.append(responseFrame_.data(), responseFrame_.size());
+        clientDecoder_.nextFrame(frame);
+        JsonFields fields, data;
+        if (parseJsonObject(frame, fields, "data", &data)) {
+            const JsonValue* success = fields.find("success");
+            bool ok = false;
+            if (success && success->getBool(ok) && ok) {
+                ++result.checksum;
+            }
+            uint64_t value = 0;
+            const JsonValue* field = data.find(request.command == Command::QUEUE_STATUS ? "queue_size" : "player_id");
+            if (field && field->getInteger(value)) {
+                result.checksum += value;
+            }
+            int rating = 0;
+            if ((field = data.find("rating")) && field->getInteger(rating)) {
+                result.checksum += rating;
+            }
+        }
+
+        result.requestBytes += requestFrame_.size();
+        result.responseBytes += responseFrame_.size();
+    }
+
+private:
+    JsonRequestHandler handler_;
+    FrameDecoder serverDecoder_{FramingMode::LINE};
+    FrameDecoder clientDecoder_{FramingMode::LINE};
+    std::string requestFrame_;
+    std::string response_;
+    std::string responseFrame_;
+};
+
+class BinaryCodec {
+public:
+    void roundTrip(const Request& request, RoundTrip& result) {
+        // 客户端编码请求，与MatchClient相同
+        std::string payload;
+        BinaryWriter writer(payload);
+        writer.header(binaryOpcode(request.command), BinaryStatus::OK, ++requestId_);
+        if (request.command != Command::QUEUE_STATUS) {
+            writer.u64(request.playerId);
+        }
+        requestFrame_.clear();
+        appendFrame(FramingMode::BINARY, payload, requestFrame_);
+
+        serverDecoder_.append(requestFrame_.data(), requestFrame_.size());
+        std::string_view frame;
+        serverDecoder_.nextFrame(frame);
+        response_.clear();
+        handler_.handleRequest(frame, 1, response_);
+        responseFrame_ = encodeFrame(FramingMode::BINARY, response_);
+
+        clientDecoder_.append(responseFrame_.data(), responseFrame_.size());
+        clientDecoder_.nextFrame(frame);
+        BinaryReader reader(frame);
+        BinaryHeader header;
+        if (reader.header(header) && header.status == BinaryStatus::OK) {
+            ++result.checksum;
+            uint64_t value = 0;
+            int32_t rating = 0;
+            if (request.command == Command::QUEUE_STATUS || request.command == Command::PLAYER_INFO) {
+                reader.u64(value);
+                result.checksum += value;
+            }
+            if (request.command == Command::PLAYER_INFO && reader.i32(rating)) {
+                result.checksum += rating;
+            }
+        }
+
+        result.requestBytes += requestFrame_.size();
+        result.responseBytes += responseFrame_.size();
+    }
+
+private:
+    BinaryRequestHandler handler_;
+    FrameDecoder serverDecoder_{FramingMode::BINARY};
+    FrameDecoder clientDecoder_{FramingMode::BINARY};
+    std::string requestFrame_;
+    std::string response_;
+    std::string responseFrame_;
+    uint32_t requestId_ = 0;
+};
+
+// 重复REPEATS次取最快的一次，减少其他进程干扰
+constexpr int REPEATS = 5;
+
+template <typename Codec>
+void run(const char* label, const std::vector<Request>& requests, int rounds) {
+    Codec codec;
+    RoundTrip warmup;
+    for (const auto& request : requests) {
+        codec.roundTrip(request, warmup);
+    }
+
+    double best = 0;
+    RoundTrip result;
+    uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        result = RoundTrip();
+        auto start = Clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto& request : requests) {
+                codec.roundTrip(request, result);
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (repeat == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    double total = static_cast<double>(requests.size()) * rounds;
+    std::printf("%-7s requests=%-9.0f best=%8.1fms ns/req=%7.1f allocs/req=%5.2f bytes/req: request=%5.1f response=%6.1f checksum=%llu\n",
+                label, total, best * 1000, best * 1e9 / total, allocations / (total * REPEATS),
+                result.requestBytes / total, result.responseBytes / total, static_cast<unsigned long long>(result.checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (count == 0 || rounds <= 0) {
+        std::fprintf(stderr, "Usage: %s [requests] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::WARNING);
+    // 每个房间的人数远大于同时在队列中的人数，测量期间不会成房
+    auto& manager = MatchManager::getInstance();
+    manager.init(1000, 1);
+    manager.setForceMatchOnTimeout(false);
+    std::vector<Player::PlayerId> players;
+    for (int i = 0; i < 1000; ++i) {
+        players.push_back(manager.createPlayer("player_" + std::to_string(100000 + i), 1000 + i)->getId());
+    }
+
+    auto requests = makeRequests(players, count);
+    run<JsonCodec>("json", requests, rounds);
+    run<BinaryCodec>("binary", requests, rounds);
+
+    manager.shutdown();
+    return 0;
+}
@@ -5,10 +5,154 @@
 #include <unistd.h>
 #include <cstring>
 #include <iostream>
-#include <sstream>
+#include "../util/SocketAddress.h"
+#include "../util/JsonReader.h"
+#include "../util/JsonWriter.h"
 
 namespace gmatch {
 
+namespace {
+
+// {"player_id":id}
+std::string playerIdData(Player::PlayerId playerId) {
+    std::string data;
+    JsonWriter(data).beginObject().key("player_id").integer(playerId).endObject();
+    return data;
+}
+
+// 二进制协议成功响应对应的JSON协议响应消息
+const char* binarySuccessMessage(BinaryOpcode opcode) {
+    switch (opcode) {
+        case BinaryOpcode::CREATE_PLAYER:
+            return "Player created successfully";
+        case BinaryOpcode::JOIN_MATCHMAKING:
+            return "Joined matchmaking queue";
+        case BinaryOpcode::LEAVE_MATCHMAKING:
+            return "Left matchmaking queue";
+        case BinaryOpcode::GET_ROOMS:
+            return "Rooms retrieved successfully";
+        case BinaryOpcode::GET_PLAYER_INFO:
+            return "Player info retrieved successfully";
+        case BinaryOpcode::GET_QUEUE_STATUS:
+            return "Queue status retrieved successfully";
+        case BinaryOpcode::MATCH_NOTIFY:
+            return "Match found";
+        default:
+            return "";
+    }
+}
+
+// 把二进制成功响应的消息体转换为JSON协议响应中的data，消息体不完整时返回false
+bool renderBinaryData(BinaryOpcode opcode, BinaryReader& body, std::string& data) {
+    JsonWriter writer(data);
+    switch (opcode) {
+        case BinaryOpcode::CREATE_PLAYER: {
+            uint64_t playerId;
+            int32_t rating;
+            std::string_view name;
+            if (!body.u64(playerId) || !body.i32(rating) || !body.str(name)) {
+                return false;
+            }
+            writer.beginObject()
+                .key("player_id").integer(playerId)
+                .key("name").string(name)
+                .key("rating").integer(rating)
+                .endObject();
+            return true;
+        }
+        case BinaryOpcode::GET_ROOMS: {
+            uint32_t count;
+            if (!body.u32(count)) {
+                return false;
+            }
+            writer.beginArray();
+            for (uint32_t i = 0; i < count; ++i) {
+                uint64_t roomId;
+                uint8_t status;
+                uint16_t playerCount, capacity;
+                double avgRating;
+                if (!body.u64(roomId) || !body.u8(status) || !body.u16(playerCount) || !body.u16(capacity) ||
+                    !body.f64(avgRating)) {
+                    return false;
+                }
+                writer.beginObject()
+                    .key("room_id").integer(roomId)
+                    .key("status").integer(status)
+                    .key("player_count").integer(playerCount)
+                    .key("capacity").integer(capacity)
+                    .key("avg_rating").number(avgRating)
+                    .endObject();
+            }
+            writer.endArray();
+            return true;
+        }
+        case BinaryOpcode::GET_PLAYER_INFO: {
+            uint64_t playerId;
+            int32_t rating;
+            uint8_t inQueue;
+            std::string_view name;
+            if (!body.u64(playerId) || !body.i32(rating) || !body.u8(inQueue) || !body.str(name)) {
+                return false;
+            }
+            writer.beginObject()
+                .key("player_id").integer(playerId)
+                .key("name").string(name)
+                .key("rating").integer(rating)
+                .key("in_queue").boolean(inQueue != 0)
+                .endObject();
+            return true;
+        }
+        case BinaryOpcode::GET_QUEUE_STATUS: {
+            uint64_t queueSize;
+            if (!body.u64(queueSize)) {
+                return false;
+            }
+            writer.beginObject().key("queue_size").integer(queueSize).endObject();
+            return true;
+        }
+        case BinaryOpcode::MATCH_NOTIFY: {
+            uint64_t roomId;
+            uint16_t teams, count;
+            if (!body.u64(roomId) || !body.u16(teams) || !body.u16(count)) {
+                return false;
+            }
+            writer.beginObject()
+                .key("room_id").integer(roomId)
+                .key("teams").integer(teams)
+                .key("players").beginArray();
+            for (uint16_t i = 0; i < count; ++i) {
+                uint64_t playerId;
+                int32_t rating;
+                int16_t team;
+                std::string_view name;
+                if (!body.u64(playerId) || !body.i32(rating) || !body.i16(team) || !body.str(name)) {
+                    return false;
+                }
+                writer.beginObject()
+                    .key("player_id").integer(playerId)
+                    .key("name").string(name)
+                    .key("rating").integer(rating)
+                    .key("team").integer(team)
+                    .endObject();
+            }
+            writer.endArray().endObject();
+            return true;
+        }
+        default:
+            // 加入、离开队列的响应没有消息体
+            return true;
+    }
+}
+
+// 创建玩家和成房通知的消息体以u64 player_id / room_id开头
+uint64_t leadingId(std::string_view message) {
+    uint64_t id = 0;
+    BinaryReader(message.substr(BINARY_HEADER_SIZE)).u64(id);
+    return id;
+}
+
+} // namespace
+
 MatchClient::MatchClient() {
 }
 
@@ -21,28 +165,22 @@ bool MatchClient::connect(const std::string& address, uint16_t port) {
         return true;
     }
     
-    // 创建socket
-    socketFd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (socketFd_ < 0) {
-        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+    // 设置地址，支持IPv4、IPv6和"unix:/path"形式的Unix域套接字
+    SocketAddress serverAddr;
+    if (!parseSocketAddress(address, port, serverAddr)) {
+        std::cerr << "Invalid address: " << address << std::endl;
         return false;
     }
     
-    // 设置地址
-    struct sockaddr_in serverAddr;
-    std::memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(port);
-    
-    if (inet_pton(AF_INET, address.c_str(), &serverAddr.sin_addr) <= 0) {
-        std::cerr << "Invalid address: " << address << std::endl;
-        close(socketFd_);
-        socketFd_ = -1;
+    // 创建socket
+    socketFd_ = socket(serverAddr.getFamily(), SOCK_STREAM, 0);
+    if (socketFd_ < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
         return false;
     }
     
     // 连接服务器
-    if (::connect(socketFd_, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+    if (::connect(socketFd_, serverAddr.get(), serverAddr.length) < 0) {
         std::cerr << "Failed to connect: " << strerror(errno) << std::endl;
         close(socketFd_);
         socketFd_ = -1;
@@ -52,17 +190,36 @@ bool MatchClient::connect(const std::string& address, uint16_t port) {
     connected_ = true;
     running_ = true;
     
+    // 二进制协议先发送魔数，服务器据此切换该连接的协议
+    bool binary = protocol_ == WireProtocol::BINARY;
+    if (binary && !sendFrame(std::string(BINARY_PROTOCOL_MAGIC))) {
+        std::cerr << "Failed to negotiate binary protocol: " << strerror(errno) << std::endl;
+        connected_ = false;
+        running_ = false;
+        close(socketFd_);
+        socketFd_ = -1;
+        return false;
+    }
+    
     // 启动接收线程
-    receiveThread_ = std::thread([this]() {
-        const size_t bufferSize = 4096;
-        char buffer[bufferSize];
+    receiveThread_ = std::thread([this, binary]() {
+        const size_t chunkSize = 4096;
+        FrameDecoder decoder(binary ? FramingMode::BINARY : framingMode_);
         
         while (running_) {
-            std::memset(buffer, 0, bufferSize);
-            ssize_t bytesRead = recv(socketFd_, buffer, bufferSize - 1, 0);
+            char* buffer = decoder.beginWrite(chunkSize);
+            ssize_t bytesRead = recv(socketFd_, buffer, decoder.writableBytes(), 0);
             
             if (bytesRead > 0) {
-                messageReceived(std::string(buffer, bytesRead));
+                // 一次读取可能包含多条响应或通知，逐帧处理
+                decoder.commitWrite(bytesRead);
+                std::string_view frame;
+                while (decoder.nextFrame(frame)) {
+                    messageReceived(std::string(frame));
+                }
+                if (decoder.hasError()) {
+                    break;
+                }
             } else if (bytesRead == 0) {
                 // 服务器关闭连接
                 break;
@@ -75,6 +232,7 @@ bool MatchClient::connect(const std::string& address, uint16_t port) {
         }
         
         connected_ = false;
+        failPendingRequests("Disconnected from server");
         
         // 通知断开连接
         ClientEvent event;
@@ -102,16 +260,16 @@ bool MatchClient::connect(const std::string& address, uint16_t port) {
 }
 
 void MatchClient::disconnect() {
-    if (!connected_) {
+    // 服务器先关闭连接时connected_已被接收线程清除，线程仍需回收
+    if (!receiveThread_.joinable() && !eventProcessThread_.joinable()) {
         return;
     }
     
     running_ = false;
     
-    // 关闭socket
+    // 先shutdown唤醒阻塞在recv中的接收线程，再关闭socket
     if (socketFd_ >= 0) {
-        close(socketFd_);
-        socketFd_ = -1;
+        shutdown(socketFd_, SHUT_RDWR);
     }
     
     // 等待线程结束
@@ -119,55 +277,127 @@ void MatchClient::disconnect() {
         receiveThread_.join();
     }
     
+    {
+        std::lock_guard<std::mutex> lock(eventQueueMutex_);
+    }
+    eventQueueCv_.notify_all();
     if (eventProcessThread_.joinable()) {
         eventProcessThread_.join();
     }
     
+    if (socketFd_ >= 0) {
+        close(socketFd_);
+        socketFd_ = -1;
+    }
     connected_ = false;
 }
 
-bool MatchClient::createPlayer(const std::string& name, int rating) {
-    std::stringstream ss;
-    ss << "{\"name\":\"" << name << "\",\"rating\":" << rating << "}";
-    return sendRequest("create_player", ss.str());
+bool MatchClient::createPlayer(const std::string& name, int rating, ResponseCallback callback) {
+    if (protocol_ == WireProtocol::BINARY) {
+        std::string body;
+        BinaryWriter writer(body);
+        writer.i32(rating);
+        writer.str(name);
+        return sendBinaryRequest(BinaryOpcode::CREATE_PLAYER, body, std::move(callback));
+    }
+    
+    std::string data;
+    JsonWriter(data).beginObject().key("name").string(name).key("rating").integer(rating).endObject();
+    return sendRequest("create_player", data, std::move(callback));
 }
 
-bool MatchClient::joinMatchmaking() {
+bool MatchClient::joinMatchmaking(ResponseCallback callback) {
     if (playerId_ == 0) {
         return false;
     }
     
-    std::stringstream ss;
-    ss << "{\"player_id\":" << playerId_ << "}";
-    return sendRequest("join_matchmaking", ss.str());
+    if (protocol_ == WireProtocol::BINARY) {
+        std::string body;
+        BinaryWriter(body).u64(playerId_);
+        return sendBinaryRequest(BinaryOpcode::JOIN_MATCHMAKING, body, std::move(callback));
+    }
+    
+    return sendRequest("join_matchmaking", playerIdData(playerId_), std::move(callback));
 }
 
-bool MatchClient::leaveMatchmaking() {
+bool MatchClient::leaveMatchmaking(ResponseCallback callback) {
     if (playerId_ == 0) {
         return false;
     }
     
-    std::stringstream ss;
-    ss << "{\"player_id\":" << playerId_ << "}";
-    return sendRequest("leave_matchmaking", ss.str());
+    if (protocol_ == WireProtocol::BINARY) {
+        std::string body;
+        BinaryWriter(body).u64(playerId_);
+        return sendBinaryRequest(BinaryOpcode::LEAVE_MATCHMAKING, body, std::move(callback));
+    }
+    
+    return sendRequest("leave_matchmaking", playerIdData(playerId_), std::move(callback));
 }
 
-bool MatchClient::getRooms() {
-    return sendRequest("get_rooms", "{}");
+bool MatchClient::getRooms(ResponseCallback callback) {
+    if (protocol_ == WireProtocol::BINARY) {
+        return sendBinaryRequest(BinaryOpcode::GET_ROOMS, "", std::move(callback));
+    }
+    return sendRequest("get_rooms", "{}", std::move(callback));
 }
 
-bool MatchClient::getPlayerInfo() {
+bool MatchClient::getPlayerInfo(ResponseCallback callback) {
     if (playerId_ == 0) {
         return false;
     }
     
-    std::stringstream ss;
-    ss << "{\"player_id\":" << playerId_ << "}";
-    return sendRequest("get_player_info", ss.str());
+    if (protocol_ == WireProtocol::BINARY) {
+        std::string body;
+        BinaryWriter(body).u64(playerId_);
+        return sendBinaryRequest(BinaryOpcode::GET_PLAYER_INFO, body, std::move(callback));
+    }
+    
+    return sendRequest("get_player_info", playerIdData(playerId_), std::move(callback));
+}
+
+bool MatchClient::getQueueStatus(ResponseCallback callback) {
+    if (protocol_ == WireProtocol::BINARY) {
+        return sendBinaryRequest(BinaryOpcode::GET_QUEUE_STATUS, "", std::move(callback));
+    }
+    return sendRequest("get_queue_status", "{}", std::move(callback));
+}
+
+std::future<ClientResponse> MatchClient::createPlayerAsync(const std::string& name, int rating) {
+    return toFuture([this, &name, rating](ResponseCallback callback) {
+        return createPlayer(name, rating, std::move(callback));
+    });
+}
+
+std::future<ClientResponse> MatchClient::joinMatchmakingAsync() {
+    return toFuture([this](ResponseCallback callback) { return joinMatchmaking(std::move(callback)); });
+}
+
+std::future<ClientResponse> MatchClient::leaveMatchmakingAsync() {
+    return toFuture([this](ResponseCallback callback) { return leaveMatchmaking(std::move(callback)); });
+}
+
+std::future<ClientResponse> MatchClient::getRoomsAsync() {
+    return toFuture([this](ResponseCallback callback) { return getRooms(std::move(callback)); });
 }
 
-bool MatchClient::getQueueStatus() {
-    return sendRequest("get_queue_status", "{}");
+std::future<ClientResponse> MatchClient::getPlayerInfoAsync() {
+    return toFuture([this](ResponseCallback callback) { return getPlayerInfo(std::move(callback)); });
+}
+
+std::future<ClientResponse> MatchClient::getQueueStatusAsync() {
+    return toFuture([this](ResponseCallback callback) { return getQueueStatus(std::move(callback)); });
+}
+
+std::future<ClientResponse> MatchClient::toFuture(const std::function<bool(ResponseCallback)>& send) {
+    auto promise = std::make_shared<std::promise<ClientResponse>>();
+    auto future = promise->get_future();
+    // 请求方法返回false时不会调用回调
+    if (!send([promise](const ClientResponse& response) { promise->set_value(response); })) {
+        ClientResponse failed;
+        failed.message = "Request not sent";
+        promise->set_value(failed);
+    }
+    return future;
 }
 
 void MatchClient::setEventCallback(EventCallback callback) {
@@ -212,82 +442,55 @@ void MatchClient::processEvents() {
 }
 
 void MatchClient::messageReceived(const std::string& message) {
-    processResponse(message);
+    if (protocol_ == WireProtocol::BINARY) {
+        processBinaryResponse(message);
+    } else {
+        processResponse(message);
+    }
 }
 
 void MatchClient::processResponse(const std::string& response) {
-    // 解析响应
-    // 格式: {"cmd":"命令","success":true/false,"message":"消息","data":{...}}
-    
-    size_t cmdStart = response.find("\"cmd\"");
-    size_t successStart = response.find("\"success\"");
-    size_t messageStart = response.find("\"message\"");
-    size_t dataStart = response.find("\"data\"");
+    // 格式: {"id":请求ID,"cmd":"命令","success":true/false,"message":"消息","data":{...}}，
+    // 请求带id时响应才有id，服务器推送的消息没有id
+    JsonFields fields, data;
+    if (!parseJsonObject(response, fields, "data", &data)) {
+        return;
+    }
+    std::string_view cmd;
+    const JsonValue* value = fields.find("cmd");
+    if (!value || !value->getStringView(cmd)) {
+        return;
+    }
     
-    if (cmdStart == std::string::npos || successStart == std::string::npos || messageStart == std::string::npos) {
+    if (cmd == "heartbeat") {
+        // 回复空帧保持连接，服务器不会分发空帧
+        sendFrame(encodeFrame(framingMode_, ""));
         return;
     }
     
-    // 解析命令
-    cmdStart = response.find(':', cmdStart) + 1;
-    size_t cmdEnd = response.find(',', cmdStart);
-    std::string cmd = response.substr(cmdStart, cmdEnd - cmdStart);
-    cmd.erase(std::remove_if(cmd.begin(), cmd.end(), [](char c) { return c == '\"' || c == ' '; }), cmd.end());
-    
-    // 解析成功状态
-    successStart = response.find(':', successStart) + 1;
-    size_t successEnd = response.find(',', successStart);
-    std::string successStr = response.substr(successStart, successEnd - successStart);
-    successStr.erase(std::remove_if(successStr.begin(), successStr.end(), 
-                                   [](char c) { return c == ' '; }), 
-                    successStr.end());
-    bool success = (successStr == "true");
-    
-    // 解析消息
-    messageStart = response.find(':', messageStart) + 1;
-    size_t messageEnd = response.find(',', messageStart);
-    if (messageEnd == std::string::npos || dataStart == std::string::npos) {
-        messageEnd = response.find('}', messageStart);
-    }
-    std::string message = response.substr(messageStart, messageEnd - messageStart);
-    message.erase(std::remove_if(message.begin(), message.end(), 
-                                [](char c) { return c == '\"'; }), 
-                 message.end());
-    
-    // 解析数据
-    std::string data;
-    if (dataStart != std::string::npos) {
-        dataStart = response.find(':', dataStart) + 1;
-        size_t dataEnd = response.rfind('}');
-        data = response.substr(dataStart, dataEnd - dataStart + 1);
+    ClientResponse result;
+    if ((value = fields.find("success"))) {
+        value->getBool(result.success);
+    }
+    if ((value = fields.find("message"))) {
+        value->getString(result.message);
+    }
+    if ((value = fields.find("data"))) {
+        result.data = std::string(value->text);
     }
     
     ClientEvent event;
-    event.message = message;
-    event.data = data;
+    event.message = result.message;
+    event.data = result.data;
     
-    if (!success) {
+    // 其他响应不产生特定事件
+    bool notify = true;
+    if (!result.success) {
         event.type = ClientEventType::ERROR;
     } else if (cmd == "create_player") {
         event.type = ClientEventType::PLAYER_CREATED;
-        
-        // 提取玩家ID
-        if (!data.empty()) {
-            size_t playerIdPos = data.find("\"player_id\"");
-            if (playerIdPos != std::string::npos) {
-                playerIdPos = data.find(':', playerIdPos) + 1;
-                size_t playerIdEnd = data.find(',', playerIdPos);
-                if (playerIdEnd == std::string::npos) {
-                    playerIdEnd = data.find('}', playerIdPos);
-                }
-                
-                std::string playerIdStr = data.substr(playerIdPos, playerIdEnd - playerIdPos);
-                try {
-                    playerId_ = std::stoull(playerIdStr);
-                } catch (...) {
-                    // 忽略解析错误
-                }
-            }
+        if ((value = data.find("player_id"))) {
+            value->getInteger(playerId_);
         }
     } else if (cmd == "join_matchmaking") {
         event.type = ClientEventType::JOINED_QUEUE;
@@ -295,45 +498,203 @@ void MatchClient::processResponse(const std::string& response) {
         event.type = ClientEventType::LEFT_QUEUE;
     } else if (cmd == "match_notify") {
         event.type = ClientEventType::MATCH_FOUND;
-        
-        // 提取房间ID
-        if (!data.empty()) {
-            size_t roomIdPos = data.find("\"room_id\"");
-            if (roomIdPos != std::string::npos) {
-                roomIdPos = data.find(':', roomIdPos) + 1;
-                size_t roomIdEnd = data.find(',', roomIdPos);
-                if (roomIdEnd == std::string::npos) {
-                    roomIdEnd = data.find('}', roomIdPos);
-                }
-                
-                std::string roomIdStr = data.substr(roomIdPos, roomIdEnd - roomIdPos);
-                try {
-                    roomId_ = std::stoull(roomIdStr);
-                } catch (...) {
-                    // 忽略解析错误
-                }
-            }
+        if ((value = data.find("room_id"))) {
+            value->getInteger(roomId_);
         }
     } else {
-        // 其他响应，不产生特定事件
+        notify = false;
+    }
+    
+    // 先更新玩家ID和房间ID再完成请求，回调中可以直接使用
+    uint32_t requestId = 0;
+    if ((value = fields.find("id")) && value->getInteger(requestId)) {
+        completeRequest(requestId, result);
+    }
+    if (notify) {
+        pushEvent(event);
+    }
+}
+
+void MatchClient::processBinaryResponse(const std::string& response) {
+    // 格式见BinaryProtocol.h，响应的message和data与JSON协议的响应一致
+    BinaryHeader header;
+    BinaryReader body(response);
+    if (!body.header(header)) {
+        return;
+    }
+    
+    if (header.opcode == BinaryOpcode::HEARTBEAT) {
+        // 回复空帧保持连接，服务器不会分发空帧
+        sendFrame(encodeFrame(FramingMode::BINARY, ""));
         return;
     }
     
+    ClientResponse result;
+    ClientEvent event;
+    bool notify = true;
+    if (header.status != BinaryStatus::OK) {
+        std::string_view message;
+        body.str(message);
+        result.message = std::string(message);
+        event.type = ClientEventType::ERROR;
+    } else if (!renderBinaryData(header.opcode, body, result.data)) {
+        result.data.clear();
+        result.message = "Malformed response";
+        event.type = ClientEventType::ERROR;
+    } else {
+        result.success = true;
+        result.message = binarySuccessMessage(header.opcode);
+        switch (header.opcode) {
+            case BinaryOpcode::CREATE_PLAYER:
+                playerId_ = leadingId(response);
+                event.type = ClientEventType::PLAYER_CREATED;
+                break;
+            case BinaryOpcode::JOIN_MATCHMAKING:
+                event.type = ClientEventType::JOINED_QUEUE;
+                break;
+            case BinaryOpcode::LEAVE_MATCHMAKING:
+                event.type = ClientEventType::LEFT_QUEUE;
+                break;
+            case BinaryOpcode::MATCH_NOTIFY:
+                roomId_ = leadingId(response);
+                event.type = ClientEventType::MATCH_FOUND;
+                break;
+            case BinaryOpcode::GET_ROOMS:
+            case BinaryOpcode::GET_PLAYER_INFO:
+            case BinaryOpcode::GET_QUEUE_STATUS:
+                notify = false;
+                break;
+            default:
+                // 其他推送(如状态变化)不产生特定事件
+                return;
+        }
+    }
+    event.message = result.message;
+    event.data = result.data;
+    
+    // 服务器推送的消息request_id为0
+    if (header.requestId != 0) {
+        completeRequest(header.requestId, result);
+    }
+    if (notify) {
+        pushEvent(event);
+    }
+}
+
+void MatchClient::pushEvent(const ClientEvent& event) {
     // 添加到事件队列
     std::lock_guard<std::mutex> lock(eventQueueMutex_);
     eventQueue_.push_back(event);
     eventQueueCv_.notify_one();
 }
 
-bool MatchClient::sendRequest(const std::string& cmd, const std::string& data) {
+uint32_t MatchClient::addPendingRequest(ResponseCallback callback) {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    // 接收线程先清除connected_再在锁内清理等待中的请求，这里看到已连接时登记的请求一定会被完成
+    if (!connected_) {
+        return 0;
+    }
+    uint32_t requestId = nextRequestId_++;
+    // 0表示服务器推送的消息
+    if (requestId == 0) {
+        requestId = nextRequestId_++;
+    }
+    pendingRequests_[requestId] = std::move(callback);
+    return requestId;
+}
+
+bool MatchClient::removePendingRequest(uint32_t requestId) {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    return pendingRequests_.erase(requestId) > 0;
+}
+
+void MatchClient::completeRequest(uint32_t requestId, const ClientResponse& response) {
+    ResponseCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        auto it = pendingRequests_.find(requestId);
+        if (it == pendingRequests_.end()) {
+            return;
+        }
+        callback = std::move(it->second);
+        pendingRequests_.erase(it);
+    }
+    callback(response);
+}
+
+void MatchClient::failPendingRequests(const std::string& message) {
+    std::unordered_map<uint32_t, ResponseCallback> pending;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pending.swap(pendingRequests_);
+    }
+    ClientResponse failed;
+    failed.message = message;
+    for (auto& entry : pending) {
+        entry.second(failed);
+    }
+}
+
+bool MatchClient::sendRequest(const std::string& cmd, const std::string& data, ResponseCallback callback) {
     if (!connected_) {
         return false;
     }
     
-    std::stringstream ss;
-    ss << "{\"cmd\":\"" << cmd << "\",\"data\":" << data << "}";
-    std::string request = ss.str();
+    // 先登记再发送，响应可能在发送返回之前到达
+    uint32_t requestId = 0;
+    if (callback) {
+        requestId = addPendingRequest(std::move(callback));
+        if (requestId == 0) {
+            return false;
+        }
+    }
+    
+    std::string message;
+    JsonWriter writer(message);
+    writer.beginObject();
+    if (requestId != 0) {
+        writer.key("id").integer(requestId);
+    }
+    writer.key("cmd").string(cmd).key("data").raw(data).endObject();
+    if (sendFrame(encodeFrame(framingMode_, message))) {
+        return true;
+    }
+    // 发送失败时撤销登记；已被断开连接的清理完成时回调已经调用过，按已发出处理
+    return requestId != 0 && !removePendingRequest(requestId);
+}
+
+bool MatchClient::sendBinaryRequest(BinaryOpcode opcode, const std::string& body, ResponseCallback callback) {
+    if (!connected_) {
+        return false;
+    }
+    
+    bool pending = static_cast<bool>(callback);
+    uint32_t requestId;
+    if (pending) {
+        requestId = addPendingRequest(std::move(callback));
+        if (requestId == 0) {
+            return false;
+        }
+    } else {
+        requestId = nextRequestId_++;
+    }
+    
+    std::string message;
+    message.reserve(BINARY_HEADER_SIZE + body.size());
+    BinaryWriter(message).header(opcode, BinaryStatus::OK, requestId);
+    message += body;
+    if (sendFrame(encodeFrame(FramingMode::BINARY, message))) {
+        return true;
+    }
+    return pending && !removePendingRequest(requestId);
+}
+
+bool MatchClient::sendFrame(const std::string& request) {
+    if (!connected_) {
+        return false;
+    }
     
+    std::lock_guard<std::mutex> lock(sendMutex_);
     size_t totalSent = 0;
     size_t requestSize = request.size();
     const char* buffer = request.c_str();
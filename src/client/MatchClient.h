@@ -6,9 +6,13 @@
 #include <atomic>
 #include <mutex>
 #include <deque>
+#include <future>
+#include <unordered_map>
 #include <condition_variable>
 #include "../core/Player.h"
 #include "../core/Room.h"
+#include "../util/FrameCodec.h"
+#include "../util/BinaryProtocol.h"
 
 namespace gmatch {
 
@@ -30,37 +34,66 @@ struct ClientEvent {
     std::string data;
 };
 
+// 请求的响应，data与JSON协议响应中的data相同(JSON文本)，没有时为空
+struct ClientResponse {
+    bool success = false;
+    std::string message;
+    std::string data;
+};
+
 // 匹配客户端
 class MatchClient {
 public:
     using EventCallback = std::function<void(const ClientEvent&)>;
+    // 在接收线程中调用，不能阻塞；连接断开时尚未收到响应的请求以success为false完成
+    using ResponseCallback = std::function<void(const ClientResponse&)>;
     
     MatchClient();
     ~MatchClient();
     
-    // 连接服务器
+    // 连接服务器，address可以是IPv4、IPv6或"unix:/path"，Unix域套接字忽略port
     bool connect(const std::string& address, uint16_t port);
     
     // 断开连接
     void disconnect();
     
+    // 设置与服务器一致的分帧方式，需在connect()之前调用，默认按行分帧
+    void setFramingMode(FramingMode mode) { framingMode_ = mode; }
+    
+    // 设置使用的协议，需在connect()之前调用，默认JSON。二进制协议不受分帧方式影响，
+    // 事件中的data仍转换为与JSON协议相同的JSON文本
+    void setProtocol(WireProtocol protocol) { protocol_ = protocol; }
+    
+    // 请求方法在请求发出后立即返回，响应仍以事件通知。传入callback时请求带上id，
+    // 收到对应id的响应后调用callback；带id的请求可以同时发出多个，服务器可能不按发送顺序完成，
+    // 需要先后顺序的请求(如加入后离开)应等前一个完成再发送
+    
     // 创建玩家
-    bool createPlayer(const std::string& name, int rating = 1500);
+    bool createPlayer(const std::string& name, int rating = 1500, ResponseCallback callback = nullptr);
     
     // 加入匹配队列
-    bool joinMatchmaking();
+    bool joinMatchmaking(ResponseCallback callback = nullptr);
     
     // 离开匹配队列
-    bool leaveMatchmaking();
+    bool leaveMatchmaking(ResponseCallback callback = nullptr);
     
     // 获取房间列表
-    bool getRooms();
+    bool getRooms(ResponseCallback callback = nullptr);
     
     // 获取玩家信息
-    bool getPlayerInfo();
+    bool getPlayerInfo(ResponseCallback callback = nullptr);
     
     // 获取队列状态
-    bool getQueueStatus();
+    bool getQueueStatus(ResponseCallback callback = nullptr);
+    
+    // 以上请求的future形式，请求未能发出时future立即就绪且success为false。
+    // 不要在回调中等待future，响应由接收线程处理
+    std::future<ClientResponse> createPlayerAsync(const std::string& name, int rating = 1500);
+    std::future<ClientResponse> joinMatchmakingAsync();
+    std::future<ClientResponse> leaveMatchmakingAsync();
+    std::future<ClientResponse> getRoomsAsync();
+    std::future<ClientResponse> getPlayerInfoAsync();
+    std::future<ClientResponse> getQueueStatusAsync();
     
     // 设置事件回调
     void setEventCallback(EventCallback callback);
@@ -78,11 +111,35 @@ private:
     void processEvents();
     void messageReceived(const std::string& message);
     void processResponse(const std::string& response);
-    bool sendRequest(const std::string& cmd, const std::string& data);
+    void processBinaryResponse(const std::string& response);
+    void pushEvent(const ClientEvent& event);
+    // callback不为空时请求带上id，响应到达后由completeRequest调用
+    bool sendRequest(const std::string& cmd, const std::string& data, ResponseCallback callback);
+    // body为消息头之后的消息体
+    bool sendBinaryRequest(BinaryOpcode opcode, const std::string& body, ResponseCallback callback);
+    // 登记等待响应的请求，返回请求ID，未连接时返回0
+    uint32_t addPendingRequest(ResponseCallback callback);
+    // 撤销未能发出的请求，请求已经完成(回调已调用)时返回false
+    bool removePendingRequest(uint32_t requestId);
+    void completeRequest(uint32_t requestId, const ClientResponse& response);
+    // 连接断开时以失败完成所有等待中的请求
+    void failPendingRequests(const std::string& message);
+    // 把回调形式的请求方法转换为future
+    std::future<ClientResponse> toFuture(const std::function<bool(ResponseCallback)>& send);
+    // 发送已编码的帧，接收线程回复心跳时也会调用
+    bool sendFrame(const std::string& frame);
     
     int socketFd_ = -1;
+    std::mutex sendMutex_;
     std::atomic<bool> connected_{false};
     std::atomic<bool> running_{false};
+    FramingMode framingMode_ = FramingMode::LINE;
+    WireProtocol protocol_ = WireProtocol::JSON;
+    std::atomic<uint32_t> nextRequestId_{1};
+    
+    // 等待响应的请求，按请求ID索引
+    std::unordered_map<uint32_t, ResponseCallback> pendingRequests_;
+    std::mutex pendingMutex_;
     
     std::thread receiveThread_;
     
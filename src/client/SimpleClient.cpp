@@ -77,9 +77,20 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // 分帧方式需与服务器的framing配置一致；"binary"表示使用二进制协议，不受服务器分帧方式影响
+    FramingMode framing = FramingMode::LINE;
+    WireProtocol protocol = WireProtocol::JSON;
+    if (argc >= 4 && !parseFramingMode(argv[3], framing) &&
+        !(parseWireProtocol(argv[3], protocol) && protocol == WireProtocol::BINARY)) {
+        std::cerr << "Invalid framing mode (line, length or binary)" << std::endl;
+        return 1;
+    }
+    
     std::cout << "Connecting to " << address << ":" << port << std::endl;
     
     MatchClient client;
+    client.setFramingMode(framing);
+    client.setProtocol(protocol);
     client.setEventCallback(handleEvent);
     
     if (!client.connect(address, port)) {
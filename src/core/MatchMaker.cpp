@@ -4,12 +4,21 @@
 #include <thread>
 #include <chrono>
 #include <iostream>
+#include <limits>
 
 namespace gmatch {
 
 // MatchMaker 实现
-MatchMaker::MatchMaker(int playersPerRoom)
+MatchMaker::MatchMaker(int playersPerRoom, size_t workerCount)
     : playersPerRoom_(playersPerRoom) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    for (size_t i = 0; i < workerCount; ++i) {
+        shards_.push_back(std::make_unique<MatchShard>());
+    }
+    setShardRatingRange(DEFAULT_SHARD_MIN_RATING, DEFAULT_SHARD_MAX_RATING);
 }
 
 MatchMaker::~MatchMaker() {
@@ -19,30 +28,165 @@ MatchMaker::~MatchMaker() {
 void MatchMaker::start() {
     if (!running_) {
         running_ = true;
-        matchThread_ = std::thread(&MatchMaker::matchLoop, this);
+        // 启动后各线程立即匹配一轮
+        for (auto& shard : shards_) {
+            shard->matchedVersion = UNMATCHED_VERSION;
+        }
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            shards_[i]->worker = std::thread(&MatchMaker::matchLoop, this, i);
+        }
     }
 }
 
 void MatchMaker::stop() {
+    suspend();
+    for (auto& shard : shards_) {
+        shard->queue.clear();
+    }
+    
+    std::lock_guard<std::mutex> lock(playerShardsMutex_);
+    playerShards_.clear();
+}
+
+void MatchMaker::suspend() {
     if (running_) {
         running_ = false;
-        if (matchThread_.joinable()) {
-            matchThread_.join();
+        for (auto& shard : shards_) {
+            shard->queue.interrupt();
         }
-        queue_.clear();
+        {
+            std::lock_guard<std::mutex> lock(passMutex_);
+            passDone_.notify_all();
+        }
+        for (auto& shard : shards_) {
+            if (shard->worker.joinable()) {
+                shard->worker.join();
+            }
+        }
+    }
+}
+
+void MatchMaker::setShardRatingRange(int minRating, int maxRating) {
+    shardBounds_.clear();
+    int64_t span = std::max<int64_t>(static_cast<int64_t>(maxRating) - minRating, 1);
+    for (size_t i = 1; i < shards_.size(); ++i) {
+        shardBounds_.push_back(static_cast<int>(minRating + span * static_cast<int64_t>(i) / shards_.size()));
     }
 }
 
+size_t MatchMaker::shardOf(int rating) const {
+    return std::upper_bound(shardBounds_.begin(), shardBounds_.end(), rating) - shardBounds_.begin();
+}
+
+size_t MatchMaker::lowestCoveringShard(int rating, int maxDiff) const {
+    if (maxDiff < 0) {
+        return 0;
+    }
+    int64_t lowest = static_cast<int64_t>(rating) - maxDiff;
+    return shardOf(static_cast<int>(std::max<int64_t>(lowest, std::numeric_limits<int>::min())));
+}
+
 void MatchMaker::addPlayer(const PlayerPtr& player) {
-    queue_.addPlayer(player);
+    size_t shardIndex = shardOf(player->getRating());
+    {
+        std::lock_guard<std::mutex> lock(playerShardsMutex_);
+        playerShards_[player->getId()] = shardIndex;
+    }
+    shards_[shardIndex]->queue.addPlayer(player);
+    
+    // 玩家落在下级分片的评分窗口内时，唤醒这些分片
+    int maxDiff = getMatchStrategy()->getMaxRatingDiff();
+    for (size_t i = lowestCoveringShard(player->getRating(), maxDiff); i < shardIndex; ++i) {
+        shards_[i]->queue.interrupt();
+    }
 }
 
 void MatchMaker::removePlayer(Player::PlayerId playerId) {
-    queue_.removePlayer(playerId);
+    size_t shardIndex = shards_.size();
+    {
+        std::lock_guard<std::mutex> lock(playerShardsMutex_);
+        auto it = playerShards_.find(playerId);
+        if (it != playerShards_.end()) {
+            shardIndex = it->second;
+            playerShards_.erase(it);
+        }
+    }
+    
+    if (shardIndex < shards_.size()) {
+        shards_[shardIndex]->queue.removePlayer(playerId);
+    } else {
+        // 路由记录可能已在匹配成功后被清理，逐个分片尝试移除
+        for (auto& shard : shards_) {
+            shard->queue.removePlayer(playerId);
+        }
+    }
+}
+
+void MatchMaker::addPlayers(const std::vector<PlayerPtr>& players) {
+    if (players.empty()) {
+        return;
+    }
+    std::vector<std::vector<PlayerPtr>> byShard(shards_.size());
+    {
+        std::lock_guard<std::mutex> lock(playerShardsMutex_);
+        for (const auto& player : players) {
+            size_t shardIndex = shardOf(player->getRating());
+            playerShards_[player->getId()] = shardIndex;
+            byShard[shardIndex].push_back(player);
+        }
+    }
+    
+    int maxDiff = getMatchStrategy()->getMaxRatingDiff();
+    std::vector<bool> wakeLower(shards_.size(), false);
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        if (byShard[i].empty()) {
+            continue;
+        }
+        shards_[i]->queue.addPlayers(byShard[i]);
+        size_t lowest = i;
+        for (const auto& player : byShard[i]) {
+            lowest = std::min(lowest, lowestCoveringShard(player->getRating(), maxDiff));
+        }
+        for (size_t j = lowest; j < i; ++j) {
+            wakeLower[j] = true;
+        }
+    }
+    
+    // 与addPlayer相同，唤醒评分窗口覆盖新玩家的下级分片，每个分片只唤醒一次
+    for (size_t i = 0; i < wakeLower.size(); ++i) {
+        if (wakeLower[i]) {
+            shards_[i]->queue.interrupt();
+        }
+    }
+}
+
+void MatchMaker::removePlayers(const std::vector<Player::PlayerId>& playerIds) {
+    if (playerIds.empty()) {
+        return;
+    }
+    std::vector<std::vector<Player::PlayerId>> byShard(shards_.size());
+    std::vector<Player::PlayerId> unrouted;
+    {
+        std::lock_guard<std::mutex> lock(playerShardsMutex_);
+        for (auto playerId : playerIds) {
+            auto it = playerShards_.find(playerId);
+            if (it != playerShards_.end()) {
+                byShard[it->second].push_back(playerId);
+                playerShards_.erase(it);
+            } else {
+                unrouted.push_back(playerId);
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        // 路由记录可能已在匹配成功后被清理，这些玩家在每个分片中都尝试移除
+        byShard[i].insert(byShard[i].end(), unrouted.begin(), unrouted.end());
+        shards_[i]->queue.removePlayers(byShard[i]);
+    }
 }
 
 RoomPtr MatchMaker::createRoom(const std::vector<PlayerPtr>& players) {
-    std::lock_guard<std::mutex> lock(roomsMutex_);
     auto roomId = nextRoomId_++;
     auto room = std::make_shared<Room>(roomId, players.size());
     
@@ -50,6 +194,16 @@ RoomPtr MatchMaker::createRoom(const std::vector<PlayerPtr>& players) {
         room->addPlayer(player);
     }
     
+    // 分队在加锁前完成，不阻塞其他分片创建房间
+    TeamBalancer balancer(teamCount_, teamBalanceBudgetUs_);
+    if (balancer.getTeamCount() > 1 && players.size() >= static_cast<size_t>(balancer.getTeamCount())) {
+        auto teams = balancer.assignTeams(players);
+        for (size_t i = 0; i < players.size(); ++i) {
+            room->setTeam(players[i]->getId(), teams[i]);
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(roomsMutex_);
     rooms_[roomId] = room;
     return room;
 }
@@ -67,46 +221,201 @@ std::vector<RoomPtr> MatchMaker::getRooms() const {
 }
 
 void MatchMaker::setMatchStrategy(std::shared_ptr<MatchStrategy> strategy) {
-    queue_.setMatchStrategy(strategy);
+    for (auto& shard : shards_) {
+        shard->queue.setMatchStrategy(strategy);
+    }
+}
+
+void MatchMaker::setMatchAlgorithm(MatchAlgorithm algorithm) {
+    for (auto& shard : shards_) {
+        shard->queue.setMatchAlgorithm(algorithm);
+    }
 }
 
 size_t MatchMaker::getQueueSize() const {
-    return queue_.size();
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->queue.size();
+    }
+    return total;
 }
 
-void MatchMaker::matchLoop() {
-    while (running_) {
-        std::vector<PlayerPtr> matchedPlayers;
-        
-        if (queue_.tryMatchPlayers(matchedPlayers, playersPerRoom_, forceMatchOnTimeout_, matchTimeoutThreshold_)) {
-            auto room = createRoom(matchedPlayers);
-            
-            // 记录匹配成功的信息
-            std::string playerNames;
-            for (size_t i = 0; i < matchedPlayers.size(); ++i) {
-                if (i > 0) playerNames += ", ";
-                playerNames += matchedPlayers[i]->getName() + "(" + 
-                               std::to_string(matchedPlayers[i]->getRating()) + ")";
+std::vector<RoomPtr> MatchMaker::matchTick() {
+    std::vector<RoomPtr> rooms;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        auto shardRooms = matchShard(i);
+        rooms.insert(rooms.end(), shardRooms.begin(), shardRooms.end());
+    }
+    return rooms;
+}
+
+std::vector<RoomPtr> MatchMaker::matchShard(size_t shardIndex) {
+    std::vector<std::vector<PlayerPtr>> matchedRooms;
+    
+    // 本分片的全部玩家与上级分片中评分低于本分片上界+maxDiff的玩家在同一轮中按入队顺序匹配，
+    // 边界两侧的玩家不会因为各分片先各自匹配剩下奇数而落单；评分段较窄时窗口可能覆盖多个上级分片
+    std::vector<MatchQueue*> queues{&shards_[shardIndex]->queue};
+    int maxRating = std::numeric_limits<int>::max();
+    if (shardIndex + 1 < shards_.size()) {
+        size_t last = shards_.size() - 1;
+        int maxDiff = getMatchStrategy()->getMaxRatingDiff();
+        if (maxDiff >= 0) {
+            int64_t limit = static_cast<int64_t>(shardBounds_[shardIndex]) + maxDiff - 1;
+            maxRating = static_cast<int>(std::min<int64_t>(limit, std::numeric_limits<int>::max()));
+            last = shardOf(maxRating);
+        }
+        for (size_t i = shardIndex + 1; i <= last; ++i) {
+            queues.push_back(&shards_[i]->queue);
+        }
+    }
+    
+    if (queues.size() == 1) {
+        queues.front()->matchAll(matchedRooms, playersPerRoom_, forceMatchOnTimeout_, matchTimeoutThreshold_);
+    } else {
+        MatchQueue::matchAcross(queues, std::numeric_limits<int>::min(), maxRating, matchedRooms,
+                                playersPerRoom_, forceMatchOnTimeout_, matchTimeoutThreshold_);
+    }
+    
+    // 本分片仍有等待超时的玩家时，与其他分片中最早入队的玩家强制成组
+    uint64_t oldestActivity = 0;
+    if (forceMatchOnTimeout_ && shards_.size() > 1 &&
+        shards_[shardIndex]->queue.getOldestActivityTime(oldestActivity)) {
+        uint64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        if (nowMs > oldestActivity && nowMs - oldestActivity > matchTimeoutThreshold_) {
+            std::vector<MatchQueue*> allQueues;
+            for (auto& shard : shards_) {
+                allQueues.push_back(&shard->queue);
             }
-            
-            std::cout << "Match found! Room " << room->getId() 
-                      << " with players: " << playerNames << std::endl;
-            
-            // 触发回调
-            if (matchNotifyCallback_) {
-                try {
-                    matchNotifyCallback_(room);
-                } catch (const std::exception& e) {
-                    std::cerr << "Exception in match notify callback: " << e.what() << std::endl;
-                } catch (...) {
-                    std::cerr << "Unknown exception in match notify callback" << std::endl;
-                }
+            MatchQueue::forceMatchAcross(allQueues, matchedRooms, playersPerRoom_, matchTimeoutThreshold_);
+        }
+    }
+    
+    return publishRooms(matchedRooms);
+}
+
+std::vector<RoomPtr> MatchMaker::publishRooms(const std::vector<std::vector<PlayerPtr>>& matchedRooms) {
+    std::vector<RoomPtr> rooms;
+    if (matchedRooms.empty()) {
+        return rooms;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(playerShardsMutex_);
+        for (const auto& matchedPlayers : matchedRooms) {
+            for (const auto& player : matchedPlayers) {
+                playerShards_.erase(player->getId());
+            }
+        }
+    }
+    
+    rooms.reserve(matchedRooms.size());
+    for (const auto& matchedPlayers : matchedRooms) {
+        auto room = createRoom(matchedPlayers);
+        rooms.push_back(room);
+        
+        // 记录匹配成功的信息
+        std::string playerNames;
+        for (size_t i = 0; i < matchedPlayers.size(); ++i) {
+            if (i > 0) playerNames += ", ";
+            playerNames += matchedPlayers[i]->getName() + "(" + 
+                           std::to_string(matchedPlayers[i]->getRating()) + ")";
+        }
+        
+        std::cout << "Match found! Room " << room->getId() 
+                  << " with players: " << playerNames << std::endl;
+    }
+    
+    // 触发回调
+    if (matchNotifyCallback_) {
+        for (const auto& room : rooms) {
+            try {
+                matchNotifyCallback_(room);
+            } catch (const std::exception& e) {
+                std::cerr << "Exception in match notify callback: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown exception in match notify callback" << std::endl;
             }
         }
+    }
+    
+    return rooms;
+}
+
+void MatchMaker::matchLoop(size_t shardIndex) {
+    MatchShard& shard = *shards_[shardIndex];
+    while (running_) {
+        uint64_t version = shard.queue.getVersion();
+        waitForLowerShards(shardIndex);
+        matchShard(shardIndex);
+        finishPass(shard, version);
         
-        // 避免CPU过度使用
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (eventDriven_) {
+            waitForNextTick(shard.queue, version);
+        } else {
+            // 避免CPU过度使用
+            std::this_thread::sleep_for(std::chrono::milliseconds(matchIntervalMs_.load()));
+        }
+    }
+}
+
+void MatchMaker::waitForLowerShards(size_t shardIndex) {
+    int maxDiff = getMatchStrategy()->getMaxRatingDiff();
+    uint32_t waitMs = std::min(coalesceWindowMs_.load(), matchIntervalMs_.load());
+    if (shardIndex == 0 || maxDiff == 0 || waitMs == 0) {
+        return;
+    }
+    
+    // 下级分片的匹配范围覆盖本分片下边界附近的玩家，由它们先匹配，剩余的玩家再由本分片向上配对。
+    // 只等待开始等待时已有的变化，最多等待一个合并窗口，持续入队时不会一直等下去
+    size_t lowest = lowestCoveringShard(shardBounds_[shardIndex - 1], maxDiff);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs);
+    std::unique_lock<std::mutex> lock(passMutex_);
+    for (size_t i = shardIndex; i-- > lowest;) {
+        const MatchShard& lower = *shards_[i];
+        uint64_t target = lower.queue.getVersion();
+        passDone_.wait_until(lock, deadline, [this, &lower, target] {
+            uint64_t matched = lower.matchedVersion.load();
+            return !running_ || (matched != UNMATCHED_VERSION && matched >= target);
+        });
+    }
+}
+
+void MatchMaker::finishPass(MatchShard& shard, uint64_t version) {
+    {
+        std::lock_guard<std::mutex> lock(passMutex_);
+        shard.matchedVersion = version;
+        ++shard.passes;
+    }
+    passDone_.notify_all();
+}
+
+void MatchMaker::waitForNextTick(MatchQueue& queue, uint64_t knownVersion) {
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::milliseconds(matchIntervalMs_.load());
+    
+    // 队列中的玩家足够组成房间时最多等待一个匹配间隔，否则一直休眠到有玩家入队
+    bool timed = queue.size() >= static_cast<size_t>(playersPerRoom_);
+    auto deadline = now + interval;
+    
+    // 超时匹配在最早玩家到达阈值时醒来；有多个分片时人数不足一个房间也要醒来，与其他分片的玩家强制成组。
+    // 已经超时但没能成组（所有分片的人数合起来仍然不足）时按匹配间隔重试
+    uint64_t oldestActivity = 0;
+    if (forceMatchOnTimeout_ && (timed || shards_.size() > 1) && queue.getOldestActivityTime(oldestActivity)) {
+        uint64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        uint64_t forceAt = oldestActivity + matchTimeoutThreshold_ + 1;
+        auto forceDeadline = forceAt > nowMs ? now + std::chrono::milliseconds(forceAt - nowMs) : now + interval;
+        deadline = timed ? std::min(deadline, forceDeadline) : forceDeadline;
+        timed = true;
+    }
+    
+    uint64_t version = timed ? queue.waitForChange(knownVersion, deadline) : queue.waitForChange(knownVersion);
+    
+    // 由入队唤醒时，等待合并窗口结束再匹配
+    if (running_ && version != knownVersion && coalesceWindowMs_ > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(coalesceWindowMs_.load()));
     }
 }
 
-} // namespace gmatch 
\ No newline at end of file
+} // namespace gmatch
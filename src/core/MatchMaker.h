@@ -12,30 +12,66 @@
 #include "Room.h"
 #include "MatchQueue.h"
 #include "MatchStrategy.h"
+#include "TeamBalancer.h"
 
 namespace gmatch {
 
 // 匹配器
+// 评分空间被划分为若干评分段，每段有独立的匹配队列和工作线程；
+// 每个分片的线程把本分片与上界以上最大评分差以内的上级分片玩家放在同一轮中匹配，
+// 评分段比最大评分差窄时覆盖其后的多个分片。相邻分片的匹配范围重叠，
+// 线程在下级分片有尚未匹配的变化时先等它完成一轮，边界两侧按评分从低到高依次匹配。
 class MatchMaker {
 public:
     // 匹配通知回调类型
     using MatchNotifyCallback = std::function<void(const RoomPtr&)>;
     
-    explicit MatchMaker(int playersPerRoom = 2);
+    // 默认评分分段范围，范围外的评分归入首尾分片
+    static constexpr int DEFAULT_SHARD_MIN_RATING = 0;
+    static constexpr int DEFAULT_SHARD_MAX_RATING = 3000;
+    
+    // workerCount为0时使用硬件并发数
+    explicit MatchMaker(int playersPerRoom = 2, size_t workerCount = 0);
     ~MatchMaker();
     
     void start();
+    // 停止匹配线程并清空队列
     void stop();
+    // 只停止匹配线程，队列和玩家状态保持不变，之后可以再次start()
+    void suspend();
     
     void addPlayer(const PlayerPtr& player);
     void removePlayer(Player::PlayerId playerId);
+    // 批量入队/出队：路由表只加一次锁，玩家按分片分组后每个分片提交一次
+    void addPlayers(const std::vector<PlayerPtr>& players);
+    void removePlayers(const std::vector<Player::PlayerId>& playerIds);
     
+    // 创建房间，队伍数大于1时按评分为玩家分配队伍
     RoomPtr createRoom(const std::vector<PlayerPtr>& players);
     std::vector<RoomPtr> getRooms() const;
     
+    // 执行一轮批量匹配：依次对每个分片及其评分窗口覆盖的上级分片组出所有可能的房间，
+    // 为每个房间触发匹配通知回调，并返回本轮创建的房间
+    std::vector<RoomPtr> matchTick();
+    
+    // 获取分片（工作线程）数量
+    size_t getWorkerCount() const {
+        return shards_.size();
+    }
+    
+    // 设置评分分段范围，应在start()之前调用
+    void setShardRatingRange(int minRating, int maxRating);
+    
     // 设置匹配策略
     void setMatchStrategy(std::shared_ptr<MatchStrategy> strategy);
     
+    // 设置批量匹配算法
+    void setMatchAlgorithm(MatchAlgorithm algorithm);
+    
+    MatchAlgorithm getMatchAlgorithm() const {
+        return shards_.front()->queue.getMatchAlgorithm();
+    }
+    
     // 设置匹配通知回调
     void setMatchNotifyCallback(MatchNotifyCallback callback) {
         matchNotifyCallback_ = callback;
@@ -54,6 +90,53 @@ public:
         matchTimeoutThreshold_ = ms;
     }
     
+    // 设置匹配轮询间隔(毫秒)
+    // 事件驱动模式下为队列非空时两轮匹配之间的最长等待时间
+    void setMatchInterval(uint32_t ms) {
+        matchIntervalMs_ = ms;
+    }
+    
+    // 设置是否由队列变化唤醒匹配线程，关闭时按固定间隔轮询
+    void setEventDriven(bool enable) {
+        eventDriven_ = enable;
+    }
+    
+    bool isEventDriven() const {
+        return eventDriven_;
+    }
+    
+    // 设置合并窗口(毫秒)：被唤醒后再等待一段时间，把同一时段内的入队合并到一轮匹配
+    void setCoalesceWindow(uint32_t ms) {
+        coalesceWindowMs_ = ms;
+    }
+    
+    uint32_t getCoalesceWindow() const {
+        return coalesceWindowMs_;
+    }
+    
+    // 设置每个房间的队伍数，不大于1时不分队
+    void setTeamCount(int teamCount) {
+        teamCount_ = teamCount;
+    }
+    
+    int getTeamCount() const {
+        return teamCount_;
+    }
+    
+    // 设置每个房间分队时局部交换的时间预算(微秒)
+    void setTeamBalanceBudget(uint32_t us) {
+        teamBalanceBudgetUs_ = us;
+    }
+    
+    uint32_t getTeamBalanceBudget() const {
+        return teamBalanceBudgetUs_;
+    }
+    
+    // 获取匹配轮询间隔
+    uint32_t getMatchInterval() const {
+        return matchIntervalMs_;
+    }
+    
     // 获取超时强制匹配状态
     bool getForceMatchOnTimeout() const {
         return forceMatchOnTimeout_;
@@ -66,19 +149,47 @@ public:
     
     // 获取当前使用的匹配策略
     std::shared_ptr<MatchStrategy> getMatchStrategy() const {
-        return queue_.getMatchStrategy();
+        return shards_.front()->queue.getMatchStrategy();
     }
     
     // 声明友元
     friend class MatchManager;
     
 private:
-    void matchLoop();
+    // 启动后尚未完成过匹配的分片的matchedVersion
+    static constexpr uint64_t UNMATCHED_VERSION = UINT64_MAX;
+    
+    // 评分分片：一段评分区间的队列及其工作线程
+    struct MatchShard {
+        MatchQueue queue;
+        std::thread worker;
+        // 最近完成的一轮匹配开始时的队列版本号，不小于某一版本号表示该版本之前的变化都已匹配过
+        std::atomic<uint64_t> matchedVersion{UNMATCHED_VERSION};
+        // 已完成的匹配轮数
+        std::atomic<uint64_t> passes{0};
+    };
+    
+    size_t shardOf(int rating) const;
+    // 评分窗口覆盖rating的最低分片，该分片到rating所在分片之间的分片都会与rating所在分片一起匹配
+    size_t lowestCoveringShard(int rating, int maxDiff) const;
+    void matchLoop(size_t shardIndex);
+    std::vector<RoomPtr> matchShard(size_t shardIndex);
+    std::vector<RoomPtr> publishRooms(const std::vector<std::vector<PlayerPtr>>& matchedRooms);
+    void waitForNextTick(MatchQueue& queue, uint64_t knownVersion);
+    // 等待匹配范围覆盖本分片的下级分片处理完尚未匹配的变化，最多等待一个合并窗口
+    void waitForLowerShards(size_t shardIndex);
+    void finishPass(MatchShard& shard, uint64_t version);
     
     std::unordered_map<Room::RoomId, RoomPtr> rooms_;
-    MatchQueue queue_;
+    std::vector<std::unique_ptr<MatchShard>> shards_;
+    // shardBounds_[i]为第i+1个分片的评分下界
+    std::vector<int> shardBounds_;
+    // 玩家所在分片，用于按ID出队
+    std::unordered_map<Player::PlayerId, size_t> playerShards_;
+    std::mutex playerShardsMutex_;
     std::atomic<bool> running_{false};
-    std::thread matchThread_;
+    std::mutex passMutex_;
+    std::condition_variable passDone_;
     mutable std::mutex roomsMutex_;
     
     int playersPerRoom_;
@@ -88,6 +199,15 @@ private:
     // 超时匹配控制
     std::atomic<bool> forceMatchOnTimeout_{false};
     std::atomic<uint64_t> matchTimeoutThreshold_{5000}; // 默认5秒
+    
+    // 匹配轮询间隔
+    std::atomic<uint32_t> matchIntervalMs_{100};
+    std::atomic<bool> eventDriven_{true};
+    std::atomic<uint32_t> coalesceWindowMs_{10};
+    
+    // 分队控制
+    std::atomic<int> teamCount_{2};
+    std::atomic<uint32_t> teamBalanceBudgetUs_{50};
 };
 
 } // namespace gmatch 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "MatchManager.h"
+#include <algorithm>
 #include <chrono>
 #include <stdexcept>
 #include "../util/Logger.h"
@@ -17,9 +18,9 @@ MatchManager& MatchManager::getInstance() {
     return instance;
 }
 
-void MatchManager::init(int playersPerRoom) {
+void MatchManager::init(int playersPerRoom, size_t workerCount) {
     if (!initialized_) {
-        matchMaker_ = std::make_shared<MatchMaker>(playersPerRoom);
+        matchMaker_ = std::make_shared<MatchMaker>(playersPerRoom, workerCount);
         
         // 设置默认策略
         auto strategy = std::make_shared<RatingBasedStrategy>(300);
@@ -57,6 +58,65 @@ void MatchManager::shutdown() {
     }
 }
 
+void MatchManager::stopMatching() {
+    if (initialized_ && matchMaker_) {
+        matchMaker_->suspend();
+    }
+}
+
+void MatchManager::resumeMatching() {
+    if (initialized_ && matchMaker_) {
+        matchMaker_->start();
+    }
+}
+
+std::vector<PlayerSnapshot> MatchManager::exportPlayers(Player::PlayerId& nextPlayerId) const {
+    std::vector<PlayerSnapshot> snapshots;
+    std::lock_guard<std::mutex> lock(playersMutex_);
+    snapshots.reserve(players_.size());
+    for (const auto& pair : players_) {
+        const auto& player = pair.second;
+        PlayerSnapshot snapshot;
+        snapshot.id = player->getId();
+        snapshot.name = player->getName();
+        snapshot.rating = player->getRating();
+        snapshot.inQueue = player->isInQueue();
+        snapshot.lastActivityTime = player->getLastActivityTime();
+        snapshots.push_back(std::move(snapshot));
+    }
+    nextPlayerId = nextPlayerId_;
+    return snapshots;
+}
+
+void MatchManager::importPlayers(const std::vector<PlayerSnapshot>& players, Player::PlayerId nextPlayerId) {
+    std::vector<PlayerPtr> queued;
+    {
+        std::lock_guard<std::mutex> lock(playersMutex_);
+        for (const auto& snapshot : players) {
+            auto player = std::make_shared<Player>(snapshot.id, snapshot.name, snapshot.rating);
+            player->updateActivity(snapshot.lastActivityTime);
+            players_[snapshot.id] = player;
+            if (snapshot.inQueue) {
+                queued.push_back(player);
+            }
+            nextPlayerId = std::max(nextPlayerId, snapshot.id + 1);
+        }
+        if (nextPlayerId > nextPlayerId_) {
+            nextPlayerId_ = nextPlayerId;
+        }
+    }
+    
+    // 保留原来的活动时间直接入队，不触发状态回调
+    if (matchMaker_) {
+        for (const auto& player : queued) {
+            player->setStatus(true);
+            matchMaker_->addPlayer(player);
+        }
+    }
+    LOG_INFO("Imported %zu players (%zu queued), next player id %llu", players.size(), queued.size(),
+             static_cast<unsigned long long>(nextPlayerId_.load()));
+}
+
 PlayerPtr MatchManager::createPlayer(const std::string& name, int rating) {
     std::lock_guard<std::mutex> lock(playersMutex_);
     auto playerId = nextPlayerId_++;
@@ -71,6 +131,35 @@ PlayerPtr MatchManager::createPlayer(const std::string& name, int rating) {
     return player;
 }
 
+std::vector<PlayerPtr> MatchManager::createPlayers(const std::vector<NewPlayer>& players) {
+    std::vector<PlayerPtr> created;
+    created.reserve(players.size());
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    std::lock_guard<std::mutex> lock(playersMutex_);
+    players_.reserve(players_.size() + players.size());
+    for (const auto& newPlayer : players) {
+        auto playerId = nextPlayerId_++;
+        auto player = std::make_shared<Player>(playerId, newPlayer.name, newPlayer.rating);
+        player->updateActivity(now);
+        players_[playerId] = player;
+        created.push_back(std::move(player));
+    }
+    return created;
+}
+
+std::vector<PlayerPtr> MatchManager::findPlayers(const std::vector<Player::PlayerId>& playerIds) const {
+    std::vector<PlayerPtr> found;
+    found.reserve(playerIds.size());
+    std::lock_guard<std::mutex> lock(playersMutex_);
+    for (auto playerId : playerIds) {
+        auto it = players_.find(playerId);
+        found.push_back(it != players_.end() ? it->second : nullptr);
+    }
+    return found;
+}
+
 PlayerPtr MatchManager::getPlayer(Player::PlayerId playerId) {
     std::lock_guard<std::mutex> lock(playersMutex_);
     auto it = players_.find(playerId);
@@ -190,16 +279,7 @@ bool MatchManager::joinMatchmaking(Player::PlayerId playerId) {
     }
     
     // 触发回调
-    if (playerStatusCallback_) {
-        try {
-            LOG_DEBUG("Triggering player status callback for %llu", playerId);
-            playerStatusCallback_(playerId, true);
-        } catch (const std::exception& e) {
-            LOG_ERROR("Exception in player status callback: %s", e.what());
-        } catch (...) {
-            LOG_ERROR("Unknown exception in player status callback");
-        }
-    }
+    notifyPlayerStatus(playerId, true);
     
     return true;
 }
@@ -232,18 +312,118 @@ bool MatchManager::leaveMatchmaking(Player::PlayerId playerId) {
     LOG_DEBUG("Player %llu status updated to not in queue", playerId);
     
     // 触发回调
-    if (playerStatusCallback_) {
-        try {
-            LOG_DEBUG("Triggering player status callback for %llu", playerId);
-            playerStatusCallback_(playerId, false);
-        } catch (const std::exception& e) {
-            LOG_ERROR("Exception in player status callback: %s", e.what());
-        } catch (...) {
-            LOG_ERROR("Unknown exception in player status callback");
+    notifyPlayerStatus(playerId, false);
+    
+    return true;
+}
+
+std::vector<MatchmakingResult> MatchManager::joinMatchmakingBatch(const std::vector<Player::PlayerId>& playerIds) {
+    std::vector<MatchmakingResult> results(playerIds.size(), MatchmakingResult::PLAYER_NOT_FOUND);
+    if (!matchMaker_) {
+        LOG_WARNING("Matchmaker not initialized, rejecting batch of %zu players", playerIds.size());
+        std::fill(results.begin(), results.end(), MatchmakingResult::FAILED);
+        return results;
+    }
+    
+    auto players = findPlayers(playerIds);
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    // 先更新状态再提交，同一批中重复的玩家ID看到的已经是在队列中
+    std::vector<PlayerPtr> joining;
+    std::vector<size_t> joiningIndexes;
+    for (size_t i = 0; i < players.size(); ++i) {
+        const auto& player = players[i];
+        if (!player) {
+            continue;
+        }
+        if (player->isInQueue()) {
+            results[i] = MatchmakingResult::ALREADY_IN_QUEUE;
+            continue;
         }
+        player->updateActivity(now);
+        player->setStatus(true);
+        joining.push_back(player);
+        joiningIndexes.push_back(i);
     }
     
-    return true;
+    MatchmakingResult joined = MatchmakingResult::OK;
+    try {
+        matchMaker_->addPlayers(joining);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Exception adding %zu players to queue: %s", joining.size(), e.what());
+        joined = MatchmakingResult::FAILED;
+    } catch (...) {
+        LOG_ERROR("Unknown exception adding %zu players to queue", joining.size());
+        joined = MatchmakingResult::FAILED;
+    }
+    for (size_t i = 0; i < joining.size(); ++i) {
+        results[joiningIndexes[i]] = joined;
+        if (joined != MatchmakingResult::OK) {
+            joining[i]->setStatus(false);  // 如果添加失败，恢复状态
+        }
+    }
+    
+    if (joined == MatchmakingResult::OK) {
+        LOG_DEBUG("Added %zu of %zu players to queue", joining.size(), playerIds.size());
+        for (const auto& player : joining) {
+            notifyPlayerStatus(player->getId(), true);
+        }
+    }
+    return results;
+}
+
+std::vector<MatchmakingResult> MatchManager::leaveMatchmakingBatch(const std::vector<Player::PlayerId>& playerIds) {
+    std::vector<MatchmakingResult> results(playerIds.size(), MatchmakingResult::PLAYER_NOT_FOUND);
+    if (!matchMaker_) {
+        LOG_WARNING("Matchmaker not initialized, rejecting batch of %zu players", playerIds.size());
+        std::fill(results.begin(), results.end(), MatchmakingResult::FAILED);
+        return results;
+    }
+    
+    auto players = findPlayers(playerIds);
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    // 出队请求只是提交给匹配线程，先更新状态不会让匹配线程看到中间状态；
+    // 同一批中重复的玩家ID看到的已经是不在队列中
+    std::vector<Player::PlayerId> leaving;
+    for (size_t i = 0; i < players.size(); ++i) {
+        const auto& player = players[i];
+        if (!player) {
+            continue;
+        }
+        if (!player->isInQueue()) {
+            results[i] = MatchmakingResult::NOT_IN_QUEUE;
+            continue;
+        }
+        player->updateActivity(now);
+        player->setStatus(false);
+        leaving.push_back(playerIds[i]);
+        results[i] = MatchmakingResult::OK;
+    }
+    
+    matchMaker_->removePlayers(leaving);
+    LOG_DEBUG("Removed %zu of %zu players from queue", leaving.size(), playerIds.size());
+    
+    for (auto playerId : leaving) {
+        notifyPlayerStatus(playerId, false);
+    }
+    return results;
+}
+
+void MatchManager::notifyPlayerStatus(Player::PlayerId playerId, bool inQueue) {
+    if (!playerStatusCallback_) {
+        return;
+    }
+    try {
+        LOG_DEBUG("Triggering player status callback for %llu", playerId);
+        playerStatusCallback_(playerId, inQueue);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Exception in player status callback: %s", e.what());
+    } catch (...) {
+        LOG_ERROR("Unknown exception in player status callback");
+    }
 }
 
 RoomPtr MatchManager::getRoom(Room::RoomId roomId) {
@@ -284,6 +464,12 @@ void MatchManager::setMaxRatingDifference(int maxDiff) {
     }
 }
 
+void MatchManager::setMatchStrategy(std::shared_ptr<MatchStrategy> strategy) {
+    if (matchMaker_ && strategy) {
+        matchMaker_->setMatchStrategy(strategy);
+    }
+}
+
 size_t MatchManager::getQueueSize() const {
     if (!matchMaker_) {
         return 0;
@@ -317,6 +503,42 @@ void MatchManager::setMatchTimeoutThreshold(uint64_t ms) {
     }
 }
 
+void MatchManager::setMatchInterval(uint32_t ms) {
+    if (matchMaker_) {
+        matchMaker_->setMatchInterval(ms);
+    }
+}
+
+void MatchManager::setEventDrivenMatching(bool enable) {
+    if (matchMaker_) {
+        matchMaker_->setEventDriven(enable);
+    }
+}
+
+void MatchManager::setMatchCoalesceWindow(uint32_t ms) {
+    if (matchMaker_) {
+        matchMaker_->setCoalesceWindow(ms);
+    }
+}
+
+void MatchManager::setMatchAlgorithm(MatchAlgorithm algorithm) {
+    if (matchMaker_) {
+        matchMaker_->setMatchAlgorithm(algorithm);
+    }
+}
+
+void MatchManager::setTeamCount(int teamCount) {
+    if (matchMaker_) {
+        matchMaker_->setTeamCount(teamCount);
+    }
+}
+
+void MatchManager::setTeamBalanceBudget(uint32_t us) {
+    if (matchMaker_) {
+        matchMaker_->setTeamBalanceBudget(us);
+    }
+}
+
 bool MatchManager::getForceMatchOnTimeout() const {
     if (matchMaker_) {
         return matchMaker_->getForceMatchOnTimeout();
@@ -396,9 +618,21 @@ void MatchManager::printMatchmakingStatus(std::ostream& out) const {
             
             out << "  " << roomIdStr << " | ";
             
-            for (size_t i = 0; i < players.size(); ++i) {
-                if (i > 0) out << ", ";
-                out << players[i]->getName() << " (" << players[i]->getRating() << ")";
+            if (room->getTeamCount() > 1) {
+                // 按队伍分组输出
+                for (int team = 0; team < room->getTeamCount(); ++team) {
+                    if (team > 0) out << " vs ";
+                    auto teamPlayers = room->getTeamPlayers(team);
+                    for (size_t i = 0; i < teamPlayers.size(); ++i) {
+                        if (i > 0) out << ", ";
+                        out << teamPlayers[i]->getName() << " (" << teamPlayers[i]->getRating() << ")";
+                    }
+                }
+            } else {
+                for (size_t i = 0; i < players.size(); ++i) {
+                    if (i > 0) out << ", ";
+                    out << players[i]->getName() << " (" << players[i]->getRating() << ")";
+                }
             }
             out << "\n";
         }
@@ -406,14 +640,26 @@ void MatchManager::printMatchmakingStatus(std::ostream& out) const {
     
     // 匹配配置信息
     auto matchStrategy = matchMaker_->getMatchStrategy();
-    auto strategy = dynamic_cast<RatingBasedStrategy*>(matchStrategy.get());
-    int maxRatingDiff = strategy ? strategy->getMaxRatingDiff() : 0;
+    int maxRatingDiff = matchStrategy ? matchStrategy->getMaxRatingDiff() : 0;
+    auto expanding = dynamic_cast<WaitTimeExpandingStrategy*>(matchStrategy.get());
     
     out << "\nMatchmaking Config:\n";
     out << "  Players per Room: " << matchMaker_->playersPerRoom_ << "\n";
-    out << "  Max Rating Diff: " << maxRatingDiff << "\n";
+    out << "  Match Workers: " << matchMaker_->getWorkerCount() << "\n";
+    out << "  Match Algorithm: " << matchAlgorithmName(matchMaker_->getMatchAlgorithm()) << "\n";
+    if (expanding) {
+        out << "  Rating Diff: " << expanding->getBaseRatingDiff() << " + "
+            << expanding->getExpandPerSecond() << "/s (max " << maxRatingDiff << ")\n";
+    } else {
+        out << "  Max Rating Diff: " << maxRatingDiff << "\n";
+    }
     out << "  Force Match on Timeout: " << (matchMaker_->getForceMatchOnTimeout() ? "Yes" : "No") << "\n";
     out << "  Match Timeout Threshold: " << matchMaker_->getMatchTimeoutThreshold() << "ms\n";
+    out << "  Match Interval: " << matchMaker_->getMatchInterval() << "ms\n";
+    out << "  Event Driven: " << (matchMaker_->isEventDriven() ? "Yes" : "No")
+        << " (coalesce " << matchMaker_->getCoalesceWindow() << "ms)\n";
+    out << "  Teams per Room: " << matchMaker_->getTeamCount()
+        << " (balance budget " << matchMaker_->getTeamBalanceBudget() << "us)\n";
     
     out << "============================\n" << std::endl;
 }
@@ -15,6 +15,30 @@ namespace gmatch {
 using MatchNotifyCallback = std::function<void(const RoomPtr&)>;
 using PlayerStatusCallback = std::function<void(Player::PlayerId, bool)>;
 
+// 玩家状态快照，进程交接时由旧进程导出、新进程导入
+struct PlayerSnapshot {
+    Player::PlayerId id = 0;
+    std::string name;
+    int rating = 0;
+    bool inQueue = false;
+    uint64_t lastActivityTime = 0;  // 在队列中的玩家即入队时间，导入后等待时间接着计算
+};
+
+// 批量创建玩家的参数
+struct NewPlayer {
+    std::string name;
+    int rating = 1500;
+};
+
+// 批量入队/出队中每个玩家的结果
+enum class MatchmakingResult {
+    OK,
+    PLAYER_NOT_FOUND,
+    ALREADY_IN_QUEUE,
+    NOT_IN_QUEUE,
+    FAILED
+};
+
 // 匹配管理器（单例）
 class MatchManager {
 public:
@@ -27,17 +51,32 @@ public:
     MatchManager& operator=(MatchManager&&) = delete;
     
     // 初始化和关闭
-    void init(int playersPerRoom = 2);
+    // workerCount为匹配工作线程（评分分片）数量，0表示使用硬件并发数
+    void init(int playersPerRoom = 2, size_t workerCount = 0);
     void shutdown();
     
+    // 进程交接：stopMatching()停止匹配线程但保留玩家和队列，之后导出的快照不会再被匹配改变，
+    // 交接失败时resumeMatching()重启匹配线程；
+    // importPlayers()恢复玩家并把快照中在队列里的玩家重新入队，玩家ID从nextPlayerId之后继续分配
+    void stopMatching();
+    void resumeMatching();
+    std::vector<PlayerSnapshot> exportPlayers(Player::PlayerId& nextPlayerId) const;
+    void importPlayers(const std::vector<PlayerSnapshot>& players, Player::PlayerId nextPlayerId);
+    
     // 玩家管理
     PlayerPtr createPlayer(const std::string& name, int rating = 1500);
+    // 在一次加锁内创建全部玩家，结果与参数一一对应
+    std::vector<PlayerPtr> createPlayers(const std::vector<NewPlayer>& players);
     PlayerPtr getPlayer(Player::PlayerId playerId);
     void removePlayer(Player::PlayerId playerId);
     
     // 匹配控制
     bool joinMatchmaking(Player::PlayerId playerId);
     bool leaveMatchmaking(Player::PlayerId playerId);
+    // 批量入队/出队：玩家表和分片路由表各只加一次锁，结果与参数一一对应；
+    // 同一批中重复的玩家ID只有第一个生效。状态回调在全部提交后逐个触发
+    std::vector<MatchmakingResult> joinMatchmakingBatch(const std::vector<Player::PlayerId>& playerIds);
+    std::vector<MatchmakingResult> leaveMatchmakingBatch(const std::vector<Player::PlayerId>& playerIds);
     
     // 房间管理
     RoomPtr getRoom(Room::RoomId roomId);
@@ -49,6 +88,8 @@ public:
     
     // 匹配策略设置
     void setMaxRatingDifference(int maxDiff);
+    void setMatchStrategy(std::shared_ptr<MatchStrategy> strategy);
+    void setMatchAlgorithm(MatchAlgorithm algorithm);
     
     // 设置是否启用超时强制匹配
     void setForceMatchOnTimeout(bool enable);
@@ -59,6 +100,19 @@ public:
     // 获取超时强制匹配状态
     bool getForceMatchOnTimeout() const;
     
+    // 设置匹配轮询间隔(毫秒)
+    void setMatchInterval(uint32_t ms);
+    
+    // 设置是否由队列变化唤醒匹配线程
+    void setEventDrivenMatching(bool enable);
+    
+    // 设置匹配合并窗口(毫秒)
+    void setMatchCoalesceWindow(uint32_t ms);
+    
+    // 设置每个房间的队伍数和分队时间预算(微秒)
+    void setTeamCount(int teamCount);
+    void setTeamBalanceBudget(uint32_t us);
+    
     // 高级功能
     size_t getQueueSize() const;
     size_t getPlayerCount() const;
@@ -71,6 +125,10 @@ private:
     MatchManager();
     ~MatchManager();
     
+    // 在一次加锁内查找全部玩家，不存在的为nullptr
+    std::vector<PlayerPtr> findPlayers(const std::vector<Player::PlayerId>& playerIds) const;
+    void notifyPlayerStatus(Player::PlayerId playerId, bool inQueue);
+    
     std::shared_ptr<MatchMaker> matchMaker_;
     std::unordered_map<Player::PlayerId, PlayerPtr> players_;
     std::atomic<Player::PlayerId> nextPlayerId_{1};
@@ -3,121 +3,817 @@
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <limits>
+#include <thread>
 
 namespace gmatch {
 
-MatchQueue::MatchQueue()
+const char* matchAlgorithmName(MatchAlgorithm algorithm) {
+    switch (algorithm) {
+        case MatchAlgorithm::SORTED_WINDOW:
+            return "sorted_window";
+        case MatchAlgorithm::ANCHOR_GREEDY:
+        default:
+            return "greedy";
+    }
+}
+
+bool parseMatchAlgorithm(const std::string& name, MatchAlgorithm& algorithm) {
+    if (name == "greedy") {
+        algorithm = MatchAlgorithm::ANCHOR_GREEDY;
+        return true;
+    }
+    if (name == "sorted_window") {
+        algorithm = MatchAlgorithm::SORTED_WINDOW;
+        return true;
+    }
+    return false;
+}
+
+MatchQueue::MatchQueue(size_t ingressCapacity)
     : matchStrategy_(std::make_shared<RatingBasedStrategy>()) {
+    if (ingressCapacity > 0) {
+        ingress_.reset(new MpscRing<PendingCommand>(ingressCapacity));
+    }
+}
+
+int MatchQueue::bucketOf(int rating) {
+    // 向下取整，保证负评分也落在正确的桶中
+    int bucket = rating / RATING_BUCKET_WIDTH;
+    if (rating < 0 && rating % RATING_BUCKET_WIDTH != 0) {
+        --bucket;
+    }
+    return bucket;
 }
 
 void MatchQueue::addPlayer(const PlayerPtr& player) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    // 不修改玩家状态，只添加到队列
-    queue_.push_back(player);
+    // 不修改玩家状态，只提交入队请求
+    PendingCommand command;
+    command.join = true;
+    command.playerId = player->getId();
+    command.player = player;
+    command.rating = player->getRating();
+    command.enqueueTime = player->getLastActivityTime();
+    submit(&command, 1);
 }
 
 void MatchQueue::removePlayer(Player::PlayerId playerId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = std::find_if(queue_.begin(), queue_.end(),
-        [playerId](const PlayerPtr& player) {
-            return player->getId() == playerId;
-        });
+    // 不修改玩家状态，只提交出队请求
+    PendingCommand command;
+    command.playerId = playerId;
+    submit(&command, 1);
+}
+
+void MatchQueue::addPlayers(const std::vector<PlayerPtr>& players) {
+    if (players.empty()) {
+        return;
+    }
+    std::vector<PendingCommand> commands(players.size());
+    for (size_t i = 0; i < players.size(); ++i) {
+        commands[i].join = true;
+        commands[i].playerId = players[i]->getId();
+        commands[i].player = players[i];
+        commands[i].rating = players[i]->getRating();
+        commands[i].enqueueTime = players[i]->getLastActivityTime();
+    }
+    submit(commands.data(), commands.size());
+}
+
+void MatchQueue::removePlayers(const std::vector<Player::PlayerId>& playerIds) {
+    if (playerIds.empty()) {
+        return;
+    }
+    std::vector<PendingCommand> commands(playerIds.size());
+    for (size_t i = 0; i < playerIds.size(); ++i) {
+        commands[i].playerId = playerIds[i];
+    }
+    submit(commands.data(), commands.size());
+}
+
+void MatchQueue::submit(PendingCommand* commands, size_t count) {
+    size_t pushed = 0;
+    while (ingress_ && pushed < count && ingress_->tryPush(std::move(commands[pushed]))) {
+        ++pushed;
+    }
+    if (pushed < count) {
+        // 缓冲区已满：先应用之前提交的请求，再直接修改队列，保持提交顺序
+        std::lock_guard<std::mutex> lock(mutex_);
+        drainPending(true);
+        for (size_t i = pushed; i < count; ++i) {
+            applyCommand(commands[i]);
+        }
+    }
+    publishChange();
+}
+
+void MatchQueue::publishChange() {
+    version_.fetch_add(1);
+    // waiters_在等待线程持锁检查版本号之前递增，这里读到0时等待线程必然能看到新版本号
+    if (waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        changed_.notify_all();
+    }
+}
+
+void MatchQueue::drainPending(bool waitForClaimed) {
+    if (!ingress_) {
+        return;
+    }
     
-    if (it != queue_.end()) {
-        // 不修改玩家状态，只从队列中移除
-        queue_.erase(it);
+    // 缓冲区满时回退路径需要等到此前领取的槽位全部写完，否则自己的请求会越过它们先生效
+    size_t target = waitForClaimed ? ingress_->claimed() : 0;
+    PendingCommand command;
+    while (true) {
+        if (ingress_->tryPop(command)) {
+            applyCommand(command);
+        } else if (ingress_->consumed() < target) {
+            std::this_thread::yield();
+        } else {
+            break;
+        }
+    }
+}
+
+void MatchQueue::applyCommand(PendingCommand& command) {
+    if (command.join) {
+        if (slots_.count(command.playerId) == 0) {
+            insertEntry(command.player, command.rating, command.enqueueTime);
+        }
+    } else {
+        eraseEntry(command.playerId);
+    }
+    command.player.reset();
+}
+
+bool MatchQueue::isLive(uint64_t seq, Player::PlayerId playerId) const {
+    auto it = slots_.find(playerId);
+    return it != slots_.end() && it->second.seq == seq;
+}
+
+const MatchQueue::RatingBucket* MatchQueue::locate(Player::PlayerId playerId, size_t& index) const {
+    auto it = slots_.find(playerId);
+    if (it == slots_.end()) {
+        return nullptr;
+    }
+    index = it->second.index;
+    return &buckets_.at(it->second.bucket);
+}
+
+bool MatchQueue::oldestEntry(Player::PlayerId& playerId) {
+    // 跳过已经移除的玩家
+    while (!fifo_.empty()) {
+        if (isLive(fifo_.front().first, fifo_.front().second)) {
+            playerId = fifo_.front().second;
+            return true;
+        }
+        fifo_.pop_front();
+    }
+    return false;
+}
+
+void MatchQueue::insertEntry(const PlayerPtr& player, int rating, uint64_t enqueueTime) {
+    uint64_t seq = nextSeq_++;
+    int bucketKey = bucketOf(rating);
+    auto& bucket = buckets_[bucketKey];
+    slots_[player->getId()] = Slot{bucketKey, bucket.size(), seq};
+    bucket.seqs.push_back(seq);
+    bucket.ids.push_back(player->getId());
+    bucket.ratings.push_back(rating);
+    bucket.enqueueTimes.push_back(enqueueTime);
+    bucket.players.push_back(player);
+    fifo_.emplace_back(seq, player->getId());
+}
+
+void MatchQueue::eraseEntry(Player::PlayerId playerId) {
+    auto it = slots_.find(playerId);
+    if (it == slots_.end()) {
+        return;
+    }
+
+    // 与桶尾元素交换后删除，O(1)
+    Slot slot = it->second;
+    slots_.erase(it);
+
+    auto& bucket = buckets_[slot.bucket];
+    size_t last = bucket.size() - 1;
+    if (slot.index != last) {
+        bucket.seqs[slot.index] = bucket.seqs[last];
+        bucket.ids[slot.index] = bucket.ids[last];
+        bucket.ratings[slot.index] = bucket.ratings[last];
+        bucket.enqueueTimes[slot.index] = bucket.enqueueTimes[last];
+        bucket.players[slot.index] = std::move(bucket.players[last]);
+        slots_[bucket.ids[slot.index]].index = slot.index;
+    }
+    bucket.seqs.pop_back();
+    bucket.ids.pop_back();
+    bucket.ratings.pop_back();
+    bucket.enqueueTimes.pop_back();
+    bucket.players.pop_back();
+
+    // FIFO序列中的失效记录过多时压缩一次，避免长期不出队的锚点导致序列膨胀
+    if (fifo_.size() > slots_.size() * 2 + 64) {
+        std::deque<std::pair<uint64_t, Player::PlayerId>> live;
+        for (const auto& item : fifo_) {
+            if (isLive(item.first, item.second)) {
+                live.push_back(item);
+            }
+        }
+        fifo_.swap(live);
+    }
+}
+
+void MatchQueue::pruneEmptyBuckets() {
+    for (auto it = buckets_.begin(); it != buckets_.end();) {
+        if (it->second.size() == 0) {
+            it = buckets_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MatchQueue::collectRange(int minRating, int maxRating, std::vector<CandidateRef>& entries) const {
+    if (minRating > maxRating) {
+        return;
+    }
+    auto end = buckets_.upper_bound(bucketOf(maxRating));
+    for (auto it = buckets_.lower_bound(bucketOf(minRating)); it != end; ++it) {
+        const RatingBucket& bucket = it->second;
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            if (bucket.ratings[i] >= minRating && bucket.ratings[i] <= maxRating) {
+                entries.push_back(CandidateRef{bucket.seqs[i], &bucket, i});
+            }
+        }
+    }
+}
+
+void MatchQueue::scoreSegments(const PlayerPtr& player, int rating, uint64_t enqueueTime,
+                               const CandidateBuffer& buffer, uint64_t* mask) const {
+    for (const auto& segment : buffer.segments) {
+        const RatingBucket& bucket = *segment.first;
+        MatchCandidates batch;
+        batch.ratings = bucket.ratings.data();
+        batch.enqueueTimes = bucket.enqueueTimes.data();
+        batch.players = bucket.players.data();
+        batch.count = bucket.size();
+        matchStrategy_->matchBatch(player, rating, enqueueTime, batch, mask + segment.second);
+    }
+}
+
+bool MatchQueue::matchAnchor(Player::PlayerId anchorId, int requiredPlayers, std::vector<PlayerPtr>& matchedPlayers,
+                             CandidateBuffer& buffer) {
+    matchedPlayers.clear();
+
+    size_t anchorIndex = 0;
+    const RatingBucket* anchorBucket = locate(anchorId, anchorIndex);
+    if (!anchorBucket) {
+        return false;
+    }
+    const PlayerPtr& anchor = anchorBucket->players[anchorIndex];
+
+    // 只判断评分窗口覆盖的桶，策略不限制评分区间时判断所有桶
+    int minRating = std::numeric_limits<int>::min();
+    int maxRating = std::numeric_limits<int>::max();
+    auto first = buckets_.begin();
+    auto last = buckets_.end();
+    if (matchStrategy_->getRatingWindow(anchor, anchorBucket->ratings[anchorIndex], minRating, maxRating)) {
+        // 区间为空时lower_bound已经越过upper_bound，不能再向后遍历
+        if (minRating > maxRating) {
+            return false;
+        }
+        first = buckets_.lower_bound(bucketOf(minRating));
+        last = buckets_.upper_bound(bucketOf(maxRating));
+    }
+
+    buffer.segments.clear();
+    size_t words = 0;
+    for (auto it = first; it != last; ++it) {
+        if (it->second.size() > 0) {
+            buffer.segments.emplace_back(&it->second, words);
+            words += MatchStrategy::maskWords(it->second.size());
+        }
+    }
+    buffer.mask.resize(words);
+    buffer.pairMask.resize(words);
+    scoreSegments(anchor, anchorBucket->ratings[anchorIndex], anchorBucket->enqueueTimes[anchorIndex], buffer,
+                  buffer.mask.data());
+
+    buffer.picked.clear();
+    size_t needed = static_cast<size_t>(requiredPlayers) - 1;
+    while (buffer.picked.size() < needed) {
+        // mask中保留的候选与所有已选中的玩家都能匹配，从中选择最早入队的
+        const RatingBucket* bestBucket = nullptr;
+        size_t bestIndex = 0;
+        size_t bestWord = 0;
+        uint64_t bestSeq = UINT64_MAX;
+        for (const auto& segment : buffer.segments) {
+            const RatingBucket& bucket = *segment.first;
+            size_t segmentWords = MatchStrategy::maskWords(bucket.size());
+            for (size_t w = 0; w < segmentWords; ++w) {
+                uint64_t bits = buffer.mask[segment.second + w];
+                while (bits != 0) {
+                    size_t i = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+                    bits &= bits - 1;
+                    if (bucket.seqs[i] < bestSeq && bucket.ids[i] != anchorId &&
+                        bucket.ratings[i] >= minRating && bucket.ratings[i] <= maxRating) {
+                        bestBucket = &bucket;
+                        bestIndex = i;
+                        bestWord = segment.second + w;
+                        bestSeq = bucket.seqs[i];
+                    }
+                }
+            }
+        }
+
+        if (!bestBucket) {
+            return false;
+        }
+        buffer.picked.emplace_back(bestBucket, bestIndex);
+        buffer.mask[bestWord] &= ~(uint64_t(1) << (bestIndex % 64));
+
+        // 还需要更多玩家时，剩余候选也必须与新选中的玩家匹配
+        if (buffer.picked.size() < needed) {
+            scoreSegments(bestBucket->players[bestIndex], bestBucket->ratings[bestIndex],
+                          bestBucket->enqueueTimes[bestIndex], buffer, buffer.pairMask.data());
+            for (size_t w = 0; w < words; ++w) {
+                buffer.mask[w] &= buffer.pairMask[w];
+            }
+        }
+    }
+
+    // 组成房间时才复制玩家对象
+    matchedPlayers.push_back(anchor);
+    for (const auto& pick : buffer.picked) {
+        matchedPlayers.push_back(pick.first->players[pick.second]);
+    }
+    return true;
+}
+
+bool MatchQueue::forceMatchOldest(int requiredPlayers, uint64_t timeoutThreshold, std::vector<PlayerPtr>& matchedPlayers) {
+    size_t required = static_cast<size_t>(requiredPlayers);
+    Player::PlayerId oldestId = 0;
+    if (!oldestEntry(oldestId) || slots_.size() < required) {
+        return false;
+    }
+
+    // 获取当前时间
+    auto now = std::chrono::system_clock::now();
+    auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count();
+
+    // 检查第一个玩家的等待时间是否超过阈值
+    size_t index = 0;
+    uint64_t enqueueTime = locate(oldestId, index)->enqueueTimes[index];
+    if (nowMs - enqueueTime <= timeoutThreshold) {
+        return false;
+    }
+
+    std::cout << "Force matching due to timeout: " <<
+                 (nowMs - enqueueTime) << "ms > " <<
+                 timeoutThreshold << "ms" << std::endl;
+
+    // 使用贪婪算法按入队顺序取人
+    matchedPlayers.clear();
+    for (const auto& item : fifo_) {
+        if (matchedPlayers.size() >= required) {
+            break;
+        }
+        const RatingBucket* bucket = locate(item.second, index);
+        if (bucket && bucket->seqs[index] == item.first) {
+            matchedPlayers.push_back(bucket->players[index]);
+        }
+    }
+    return true;
+}
+
+void MatchQueue::removeMatched(const std::vector<PlayerPtr>& matchedPlayers) {
+    for (const auto& player : matchedPlayers) {
+        player->setStatus(false);
+        eraseEntry(player->getId());
     }
 }
 
 bool MatchQueue::tryMatchPlayers(std::vector<PlayerPtr>& matchedPlayers, int requiredPlayers, bool forceMatchOnTimeout, uint64_t timeoutThreshold) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (queue_.size() < requiredPlayers) {
+    drainPending();
+
+    if (slots_.size() < static_cast<size_t>(requiredPlayers)) {
         return false;
     }
-    
-    // 找到第一个玩家
+
+    // 以最早入队的玩家为锚点
+    Player::PlayerId oldestId = 0;
+    oldestEntry(oldestId);
+    CandidateBuffer buffer;
+    bool matched = matchAnchor(oldestId, requiredPlayers, matchedPlayers, buffer);
+
+    // 如果找不到足够匹配的玩家，且启用了超时匹配
+    if (!matched && forceMatchOnTimeout) {
+        matched = forceMatchOldest(requiredPlayers, timeoutThreshold, matchedPlayers);
+    }
+
+    // 如果匹配成功，从队列中移除这些玩家
+    if (matched) {
+        removeMatched(matchedPlayers);
+        pruneEmptyBuckets();
+        return true;
+    }
+
     matchedPlayers.clear();
-    matchedPlayers.push_back(queue_[0]);
-    
-    // 尝试匹配剩下的玩家
-    for (size_t i = 1; i < queue_.size() && matchedPlayers.size() < requiredPlayers; ++i) {
-        bool canMatch = true;
-        
-        // 检查与所有已匹配玩家的匹配度
-        for (const auto& matchedPlayer : matchedPlayers) {
-            if (!matchStrategy_->isMatch(matchedPlayer, queue_[i])) {
-                canMatch = false;
+    return false;
+}
+
+size_t MatchQueue::matchAll(std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                            bool forceMatchOnTimeout, uint64_t timeoutThreshold) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drainPending();
+    return matchLocked(matchedRooms, requiredPlayers, forceMatchOnTimeout, timeoutThreshold);
+}
+
+size_t MatchQueue::matchLocked(std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                               bool forceMatchOnTimeout, uint64_t timeoutThreshold) {
+    size_t formed = 0;
+    size_t required = static_cast<size_t>(requiredPlayers);
+    if (slots_.size() < required) {
+        return formed;
+    }
+
+    std::vector<PlayerPtr> matchedPlayers;
+    if (algorithm_ == MatchAlgorithm::SORTED_WINDOW) {
+        formed = matchSortedWindow(matchedRooms, requiredPlayers);
+    } else {
+        // 锚点快照：本轮开始时队列中的玩家，按入队顺序
+        std::vector<Player::PlayerId> anchors;
+        anchors.reserve(slots_.size());
+        for (const auto& item : fifo_) {
+            if (isLive(item.first, item.second)) {
+                anchors.push_back(item.second);
+            }
+        }
+
+        CandidateBuffer buffer;
+        for (auto playerId : anchors) {
+            if (slots_.size() < required) {
                 break;
             }
+
+            // 已被之前的锚点匹配走的玩家在matchAnchor中直接跳过
+            if (matchAnchor(playerId, requiredPlayers, matchedPlayers, buffer)) {
+                removeMatched(matchedPlayers);
+                matchedRooms.push_back(matchedPlayers);
+                ++formed;
+            }
         }
-        
-        if (canMatch) {
-            matchedPlayers.push_back(queue_[i]);
+    }
+
+    // 剩余玩家中等待超时的，按入队顺序强制成组
+    while (forceMatchOnTimeout && forceMatchOldest(requiredPlayers, timeoutThreshold, matchedPlayers)) {
+        removeMatched(matchedPlayers);
+        matchedRooms.push_back(matchedPlayers);
+        ++formed;
+    }
+
+    pruneEmptyBuckets();
+    return formed;
+}
+
+size_t MatchQueue::matchSortedWindow(std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers) {
+    size_t k = static_cast<size_t>(std::max(requiredPlayers, 1));
+
+    // 评分快照：桶按评分有序，只需在桶内排序
+    std::vector<std::pair<const RatingBucket*, size_t>> order;
+    order.reserve(slots_.size());
+    for (const auto& pair : buckets_) {
+        const RatingBucket& bucket = pair.second;
+        size_t first = order.size();
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            order.emplace_back(&bucket, i);
         }
+        std::sort(order.begin() + first, order.end(),
+            [](const std::pair<const RatingBucket*, size_t>& a, const std::pair<const RatingBucket*, size_t>& b) {
+                const RatingBucket& bucket = *a.first;
+                if (bucket.ratings[a.second] != bucket.ratings[b.second]) {
+                    return bucket.ratings[a.second] < bucket.ratings[b.second];
+                }
+                return bucket.seqs[a.second] < bucket.seqs[b.second];
+            });
     }
-    
-    // 如果找不到足够匹配的玩家，但队列中有足够多的玩家，且启用了超时匹配
-    if (matchedPlayers.size() < requiredPlayers && queue_.size() >= requiredPlayers && forceMatchOnTimeout) {
-        // 获取当前时间
-        auto now = std::chrono::system_clock::now();
-        auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()).count();
-            
-        // 检查第一个玩家的等待时间是否超过阈值
-        if (nowMs - queue_[0]->getLastActivityTime() > timeoutThreshold) {
-            std::cout << "Force matching due to timeout: " << 
-                         (nowMs - queue_[0]->getLastActivityTime()) << "ms > " << 
-                         timeoutThreshold << "ms" << std::endl;
-            
-            // 重置匹配列表，使用贪婪算法
-            matchedPlayers.clear();
-            for (size_t i = 0; i < requiredPlayers && i < queue_.size(); ++i) {
-                matchedPlayers.push_back(queue_[i]);
+
+    size_t n = order.size();
+    if (n < k) {
+        return 0;
+    }
+
+    std::vector<int> ratings(n);
+    std::vector<uint64_t> enqueueTimes(n);
+    std::vector<PlayerPtr> players;
+    bool needPlayers = matchStrategy_->usesPlayerObjects();
+    if (needPlayers) {
+        players.resize(n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const RatingBucket& bucket = *order[i].first;
+        ratings[i] = bucket.ratings[order[i].second];
+        enqueueTimes[i] = bucket.enqueueTimes[order[i].second];
+        if (needPlayers) {
+            players[i] = bucket.players[order[i].second];
+        }
+    }
+
+    // reach[i]：紧随i之后、与i逐个都能匹配的连续玩家数（最多k-1）
+    std::vector<size_t> reach(n, 0);
+    std::vector<uint64_t> mask(MatchStrategy::maskWords(k - 1));
+    for (size_t i = 0; i + 1 < n && k > 1; ++i) {
+        MatchCandidates batch;
+        batch.ratings = ratings.data() + i + 1;
+        batch.enqueueTimes = enqueueTimes.data() + i + 1;
+        batch.players = needPlayers ? players.data() + i + 1 : nullptr;
+        batch.count = std::min(k - 1, n - i - 1);
+        const PlayerPtr& anchor = order[i].first->players[order[i].second];
+        matchStrategy_->matchBatch(anchor, ratings[i], enqueueTimes[i], batch, mask.data());
+
+        size_t count = 0;
+        while (count < batch.count && ((mask[count / 64] >> (count % 64)) & 1)) {
+            ++count;
+        }
+        reach[i] = count;
+    }
+
+    // 相邻k名玩家[i, i+k)两两可匹配时才能组成一个房间
+    auto isRoom = [&](size_t start) {
+        for (size_t j = start; j + 1 < start + k; ++j) {
+            if (j + reach[j] < start + k - 1) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // 动态规划：前i名玩家中最多能组成的房间数，相同时取评分跨度总和最小的划分
+    std::vector<size_t> rooms(n + 1, 0);
+    std::vector<int64_t> spread(n + 1, 0);
+    std::vector<bool> closesRoom(n + 1, false);
+    for (size_t i = 1; i <= n; ++i) {
+        rooms[i] = rooms[i - 1];
+        spread[i] = spread[i - 1];
+        if (i >= k && isRoom(i - k)) {
+            size_t withRoom = rooms[i - k] + 1;
+            int64_t withSpread = spread[i - k] + (static_cast<int64_t>(ratings[i - 1]) - ratings[i - k]);
+            if (withRoom > rooms[i] || (withRoom == rooms[i] && withSpread < spread[i])) {
+                rooms[i] = withRoom;
+                spread[i] = withSpread;
+                closesRoom[i] = true;
             }
         }
     }
+
+    // 回溯得到各房间，组成房间时才复制玩家对象
+    std::vector<std::vector<PlayerPtr>> formedRooms;
+    for (size_t i = n; i > 0;) {
+        if (!closesRoom[i]) {
+            --i;
+            continue;
+        }
+        std::vector<PlayerPtr> room;
+        for (size_t j = i - k; j < i; ++j) {
+            room.push_back(order[j].first->players[order[j].second]);
+        }
+        formedRooms.push_back(std::move(room));
+        i -= k;
+    }
+
+    for (auto it = formedRooms.rbegin(); it != formedRooms.rend(); ++it) {
+        removeMatched(*it);
+        matchedRooms.push_back(std::move(*it));
+    }
+    return formedRooms.size();
+}
+
+size_t MatchQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 尚未应用的请求属于队列的逻辑状态，计数前先应用
+    const_cast<MatchQueue*>(this)->drainPending();
+    return slots_.size();
+}
+
+size_t MatchQueue::bucketCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buckets_.size();
+}
+
+size_t MatchQueue::matchAcross(const std::vector<MatchQueue*>& queues, int minRating, int maxRating,
+                               std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                               bool forceMatchOnTimeout, uint64_t timeoutThreshold) {
+    if (queues.empty()) {
+        return 0;
+    }
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(queues.size());
+    for (MatchQueue* queue : queues) {
+        locks.emplace_back(queue->mutex_);
+        queue->drainPending();
+    }
     
-    // 如果匹配成功，从队列中移除这些玩家
-    if (matchedPlayers.size() == requiredPlayers) {
-        for (const auto& player : matchedPlayers) {
-            player->setStatus(false);
-            auto it = std::find_if(queue_.begin(), queue_.end(),
-                [player](const PlayerPtr& p) {
-                    return p->getId() == player->getId();
-                });
-            if (it != queue_.end()) {
-                queue_.erase(it);
+    // 范围内的玩家及其所在队列的下标
+    std::vector<std::pair<size_t, CandidateRef>> entries;
+    std::vector<CandidateRef> refs;
+    for (size_t q = 0; q < queues.size(); ++q) {
+        refs.clear();
+        queues[q]->collectRange(minRating, maxRating, refs);
+        if (q == 0 && refs.empty()) {
+            return 0;
+        }
+        for (const auto& ref : refs) {
+            entries.emplace_back(q, ref);
+        }
+    }
+    if (entries.size() < static_cast<size_t>(requiredPlayers)) {
+        return 0;
+    }
+    
+    // 范围内只有第一个队列的全部玩家时，直接在原队列上匹配，不必复制
+    MatchQueue& first = *queues.front();
+    if (entries.back().first == 0 && entries.size() == first.slots_.size()) {
+        return first.matchLocked(matchedRooms, requiredPlayers, forceMatchOnTimeout, timeoutThreshold);
+    }
+    
+    // 排序键与锚点顺序一致：入队时间，其次队列下标，同一队列内按入队顺序
+    std::sort(entries.begin(), entries.end(),
+        [](const std::pair<size_t, CandidateRef>& a, const std::pair<size_t, CandidateRef>& b) {
+            uint64_t timeA = a.second.bucket->enqueueTimes[a.second.index];
+            uint64_t timeB = b.second.bucket->enqueueTimes[b.second.index];
+            if (timeA != timeB) {
+                return timeA < timeB;
+            }
+            if (a.first != b.first) {
+                return a.first < b.first;
+            }
+            return a.second.seq < b.second.seq;
+        });
+    
+    MatchQueue merged(0);
+    merged.matchStrategy_ = first.matchStrategy_;
+    merged.algorithm_ = first.algorithm_;
+    for (const auto& entry : entries) {
+        const CandidateRef& ref = entry.second;
+        merged.insertEntry(ref.bucket->players[ref.index], ref.bucket->ratings[ref.index],
+                           ref.bucket->enqueueTimes[ref.index]);
+    }
+    
+    size_t firstRoom = matchedRooms.size();
+    size_t formed = merged.matchLocked(matchedRooms, requiredPlayers, forceMatchOnTimeout, timeoutThreshold);
+    for (size_t i = firstRoom; i < matchedRooms.size(); ++i) {
+        for (const auto& player : matchedRooms[i]) {
+            for (MatchQueue* queue : queues) {
+                queue->eraseEntry(player->getId());
             }
         }
-        return true;
+    }
+    // entries持有各队列的桶指针，全部移除完成后再清理空桶
+    for (MatchQueue* queue : queues) {
+        queue->pruneEmptyBuckets();
+    }
+    return formed;
+}
+
+size_t MatchQueue::forceMatchAcross(const std::vector<MatchQueue*>& queues,
+                                    std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                                    uint64_t timeoutThreshold) {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(queues.size());
+    for (MatchQueue* queue : queues) {
+        locks.emplace_back(queue->mutex_);
+        queue->drainPending();
     }
     
-    matchedPlayers.clear();
-    return false;
+    uint64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    size_t required = static_cast<size_t>(std::max(requiredPlayers, 1));
+    
+    struct OldestEntry {
+        uint64_t enqueueTime;
+        size_t queue;
+        uint64_t seq;
+        PlayerPtr player;
+    };
+    std::vector<OldestEntry> oldest;
+    size_t formed = 0;
+    while (true) {
+        // 每个队列按入队顺序取前required名，合起来即包含全局最早的required名
+        oldest.clear();
+        for (size_t q = 0; q < queues.size(); ++q) {
+            const MatchQueue& queue = *queues[q];
+            size_t taken = 0;
+            size_t index = 0;
+            for (auto it = queue.fifo_.begin(); it != queue.fifo_.end() && taken < required; ++it) {
+                const RatingBucket* bucket = queue.locate(it->second, index);
+                if (bucket && bucket->seqs[index] == it->first) {
+                    oldest.push_back(OldestEntry{bucket->enqueueTimes[index], q, it->first, bucket->players[index]});
+                    ++taken;
+                }
+            }
+        }
+        if (oldest.size() < required) {
+            break;
+        }
+        std::sort(oldest.begin(), oldest.end(), [](const OldestEntry& a, const OldestEntry& b) {
+            if (a.enqueueTime != b.enqueueTime) {
+                return a.enqueueTime < b.enqueueTime;
+            }
+            if (a.queue != b.queue) {
+                return a.queue < b.queue;
+            }
+            return a.seq < b.seq;
+        });
+        
+        uint64_t enqueueTime = oldest.front().enqueueTime;
+        if (nowMs <= enqueueTime || nowMs - enqueueTime <= timeoutThreshold) {
+            break;
+        }
+        std::cout << "Force matching across shards due to timeout: " <<
+                     (nowMs - enqueueTime) << "ms > " <<
+                     timeoutThreshold << "ms" << std::endl;
+        
+        std::vector<PlayerPtr> matchedPlayers;
+        for (size_t i = 0; i < required; ++i) {
+            matchedPlayers.push_back(oldest[i].player);
+            queues[oldest[i].queue]->removeMatched({oldest[i].player});
+        }
+        matchedRooms.push_back(std::move(matchedPlayers));
+        ++formed;
+    }
+    for (MatchQueue* queue : queues) {
+        queue->pruneEmptyBuckets();
+    }
+    return formed;
 }
 
-size_t MatchQueue::size() const {
+bool MatchQueue::getOldestActivityTime(uint64_t& activityTime) {
     std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    drainPending();
+    Player::PlayerId oldestId = 0;
+    if (!oldestEntry(oldestId)) {
+        return false;
+    }
+    size_t index = 0;
+    activityTime = locate(oldestId, index)->enqueueTimes[index];
+    return true;
+}
+
+uint64_t MatchQueue::getVersion() const {
+    return version_.load();
+}
+
+uint64_t MatchQueue::waitForChange(uint64_t knownVersion, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++waiters_;
+    changed_.wait_until(lock, deadline, [this, knownVersion] { return version_.load() != knownVersion; });
+    --waiters_;
+    return version_.load();
+}
+
+uint64_t MatchQueue::waitForChange(uint64_t knownVersion) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++waiters_;
+    changed_.wait(lock, [this, knownVersion] { return version_.load() != knownVersion; });
+    --waiters_;
+    return version_.load();
+}
+
+void MatchQueue::interrupt() {
+    publishChange();
 }
 
 void MatchQueue::setMatchStrategy(std::shared_ptr<MatchStrategy> strategy) {
     std::lock_guard<std::mutex> lock(mutex_);
-    matchStrategy_ = strategy;
+    std::atomic_store(&matchStrategy_, strategy);
 }
 
 std::shared_ptr<MatchStrategy> MatchQueue::getMatchStrategy() const {
+    return std::atomic_load(&matchStrategy_);
+}
+
+void MatchQueue::setMatchAlgorithm(MatchAlgorithm algorithm) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    algorithm_ = algorithm;
+}
+
+MatchAlgorithm MatchQueue::getMatchAlgorithm() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return matchStrategy_;
+    return algorithm_;
 }
 
 void MatchQueue::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& player : queue_) {
-        player->setStatus(false);
+    drainPending();
+    for (auto& bucket : buckets_) {
+        for (auto& player : bucket.second.players) {
+            player->setStatus(false);
+        }
     }
-    queue_.clear();
+    buckets_.clear();
+    slots_.clear();
+    fifo_.clear();
 }
 
-} // namespace gmatch 
\ No newline at end of file
+} // namespace gmatch
@@ -1,32 +1,194 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <deque>
+#include <map>
+#include <unordered_map>
 #include <memory>
 #include <cstdint>
+#include <atomic>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
 #include "Player.h"
 #include "MatchStrategy.h"
+#include "../util/MpscRing.h"
 
 namespace gmatch {
 
+// 批量匹配算法
+enum class MatchAlgorithm {
+    ANCHOR_GREEDY,  // 按入队顺序以每个玩家为锚点，贪心选择最早入队的可匹配玩家
+    SORTED_WINDOW   // 按评分排序后用滑动窗口划分房间，使本轮成房数最多、评分跨度总和最小
+};
+
+// 算法名称，用于配置和状态输出："greedy" / "sorted_window"
+const char* matchAlgorithmName(MatchAlgorithm algorithm);
+bool parseMatchAlgorithm(const std::string& name, MatchAlgorithm& algorithm);
+
 // 匹配队列
+// 玩家按入队评分放入固定宽度的评分桶，候选查找只扫描锚点评分窗口覆盖的桶；
+// 另维护一条FIFO序列保证"最早入队的玩家作为锚点"的公平性。
+// 桶内数据按列存放，匹配过程只顺序读取连续的评分/时间数组，不访问分散在堆上的Player对象。
+// 入队/出队请求先写入无锁MPSC环形缓冲区，由持锁的匹配线程在下一次访问队列时按写入顺序批量应用，
+// 网络线程不会阻塞在正在进行的匹配上。
 class MatchQueue {
 public:
-    MatchQueue();
+    // 评分桶宽度
+    static constexpr int RATING_BUCKET_WIDTH = 100;
+    // 默认入队请求缓冲区容量
+    static constexpr size_t DEFAULT_INGRESS_CAPACITY = 4096;
+
+    // ingressCapacity为0时不使用缓冲区，入队/出队直接加锁修改队列
+    explicit MatchQueue(size_t ingressCapacity = DEFAULT_INGRESS_CAPACITY);
+    
+    // 入队/出队只写入请求缓冲区，不等待匹配线程；缓冲区已满时退化为加锁直接修改。
+    // 同一线程先后提交的请求按提交顺序生效，离开后重新加入不会被颠倒
     void addPlayer(const PlayerPtr& player);
     void removePlayer(Player::PlayerId playerId);
-    bool tryMatchPlayers(std::vector<PlayerPtr>& matchedPlayers, int requiredPlayers, 
+    // 批量入队/出队：按顺序提交，缓冲区写满时只加一次锁应用剩余的请求，版本号只递增一次
+    void addPlayers(const std::vector<PlayerPtr>& players);
+    void removePlayers(const std::vector<Player::PlayerId>& playerIds);
+    bool tryMatchPlayers(std::vector<PlayerPtr>& matchedPlayers, int requiredPlayers,
                         bool forceMatchOnTimeout = false, uint64_t timeoutThreshold = 5000);
+    
+    // 批量匹配：在一次加锁内按入队顺序依次以每个剩余玩家为锚点，组出所有可能的房间
+    // 返回组成的房间数，每个房间的玩家列表追加到matchedRooms
+    size_t matchAll(std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                    bool forceMatchOnTimeout = false, uint64_t timeoutThreshold = 5000);
+    
+    // 跨队列匹配：按顺序锁住各队列，取入队评分在[minRating, maxRating]内的玩家，
+    // 按入队时间合并（时间相同时靠前的队列在前，同一队列内保持入队顺序）后在一轮内批量匹配，
+    // 匹配成功的玩家从各自队列中移除。queues[0]中没有范围内的玩家时不匹配。
+    // 用于评分分片与其评分窗口覆盖的上级分片一起匹配；同时锁多个队列的调用都按分片顺序排列，避免死锁
+    static size_t matchAcross(const std::vector<MatchQueue*>& queues, int minRating, int maxRating,
+                              std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                              bool forceMatchOnTimeout = false, uint64_t timeoutThreshold = 5000);
+    
+    // 跨队列超时强制匹配：所有队列中最早入队的玩家等待超过阈值时，取所有队列中最早入队的
+    // requiredPlayers名玩家组成房间，直到不再超时或人数不足。用于各分片人数都不足一个房间的情况
+    static size_t forceMatchAcross(const std::vector<MatchQueue*>& queues,
+                                   std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                                   uint64_t timeoutThreshold);
     size_t size() const;
+    // 评分桶数量，匹配过程中变空的桶在本轮结束时清理
+    size_t bucketCount() const;
+    
+    // 获取队列中最早入队玩家的活动时间，队列为空时返回false
+    bool getOldestActivityTime(uint64_t& activityTime);
+    
+    // 队列版本号，每次外部入队/出队请求提交时递增，不加锁
+    uint64_t getVersion() const;
+    
+    // 阻塞直到版本号不同于knownVersion、被interrupt()唤醒或到达deadline，返回当前版本号
+    uint64_t waitForChange(uint64_t knownVersion, std::chrono::steady_clock::time_point deadline);
+    uint64_t waitForChange(uint64_t knownVersion);
     
+    // 唤醒所有等待队列变化的线程
+    void interrupt();
+
     void setMatchStrategy(std::shared_ptr<MatchStrategy> strategy);
     std::shared_ptr<MatchStrategy> getMatchStrategy() const;
-    void clear();
     
+    // 设置matchAll使用的批量匹配算法，默认ANCHOR_GREEDY
+    void setMatchAlgorithm(MatchAlgorithm algorithm);
+    MatchAlgorithm getMatchAlgorithm() const;
+    void clear();
+
 private:
-    std::vector<PlayerPtr> queue_;
+    // 评分桶，按列连续存放：匹配循环只读取seqs/ids/ratings/enqueueTimes，
+    // 玩家对象只在组成房间或策略需要逐对判断时才访问
+    // ratings与enqueueTimes为入队时的评分和活动时间快照
+    struct RatingBucket {
+        std::vector<uint64_t> seqs;
+        std::vector<Player::PlayerId> ids;
+        std::vector<int> ratings;
+        std::vector<uint64_t> enqueueTimes;
+        std::vector<PlayerPtr> players;
+
+        size_t size() const { return ids.size(); }
+    };
+
+    // 玩家在评分桶中的位置
+    struct Slot {
+        int bucket;
+        size_t index;
+        uint64_t seq;
+    };
+
+    // 候选玩家在桶中的位置
+    struct CandidateRef {
+        uint64_t seq;
+        const RatingBucket* bucket;
+        size_t index;
+    };
+
+    // 锚点匹配时复用的缓冲区：窗口覆盖的每个桶在mask中占连续一段，
+    // 策略直接在桶的列数组上批量判断，无需复制候选
+    struct CandidateBuffer {
+        // 桶及其在mask中的起始字下标
+        std::vector<std::pair<const RatingBucket*, size_t>> segments;
+        std::vector<uint64_t> mask;
+        std::vector<uint64_t> pairMask;
+        std::vector<std::pair<const RatingBucket*, size_t>> picked;
+    };
+
+    // 入队/出队请求，评分和活动时间在提交线程上取快照
+    struct PendingCommand {
+        bool join = false;
+        Player::PlayerId playerId = 0;
+        PlayerPtr player;
+        int rating = 0;
+        uint64_t enqueueTime = 0;
+    };
+
+    static int bucketOf(int rating);
+
+    // 递增版本号，有线程在等待时才加锁唤醒
+    void publishChange();
+    // 按顺序提交count个请求并发布一次变化
+    void submit(PendingCommand* commands, size_t count);
+
+    // 以下方法要求调用方已持有mutex_
+    // 按提交顺序应用缓冲区中的请求；waitForClaimed为true时等待已领取但尚未发布的槽位写完
+    void drainPending(bool waitForClaimed = false);
+    void applyCommand(PendingCommand& command);
+    bool isLive(uint64_t seq, Player::PlayerId playerId) const;
+    const RatingBucket* locate(Player::PlayerId playerId, size_t& index) const;
+    bool oldestEntry(Player::PlayerId& playerId);
+    void insertEntry(const PlayerPtr& player, int rating, uint64_t enqueueTime);
+    // 只修改桶内数据，不删除变空的桶：匹配过程中CandidateBuffer持有桶的指针
+    void eraseEntry(Player::PlayerId playerId);
+    // 删除空桶，只能在一轮匹配结束、不再持有桶指针时调用
+    void pruneEmptyBuckets();
+    void scoreSegments(const PlayerPtr& player, int rating, uint64_t enqueueTime, const CandidateBuffer& buffer,
+                       uint64_t* mask) const;
+    void collectRange(int minRating, int maxRating, std::vector<CandidateRef>& entries) const;
+    size_t matchLocked(std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers,
+                       bool forceMatchOnTimeout, uint64_t timeoutThreshold);
+    bool matchAnchor(Player::PlayerId anchorId, int requiredPlayers, std::vector<PlayerPtr>& matchedPlayers,
+                     CandidateBuffer& buffer);
+    size_t matchSortedWindow(std::vector<std::vector<PlayerPtr>>& matchedRooms, int requiredPlayers);
+    bool forceMatchOldest(int requiredPlayers, uint64_t timeoutThreshold, std::vector<PlayerPtr>& matchedPlayers);
+    void removeMatched(const std::vector<PlayerPtr>& matchedPlayers);
+
+    std::map<int, RatingBucket> buckets_;
+    std::unordered_map<Player::PlayerId, Slot> slots_;
+    // FIFO序列，已移除的玩家延迟清理（seq与slots_中记录不一致即视为失效）
+    std::deque<std::pair<uint64_t, Player::PlayerId>> fifo_;
+    uint64_t nextSeq_ = 0;
+    
+    std::unique_ptr<MpscRing<PendingCommand>> ingress_;
+    
+    std::atomic<uint64_t> version_{0};
+    std::atomic<int> waiters_{0};
+    std::condition_variable changed_;
+
+    // 通过std::atomic_load读取，入队线程查询策略时不等待匹配线程释放mutex_
     std::shared_ptr<MatchStrategy> matchStrategy_;
+    MatchAlgorithm algorithm_ = MatchAlgorithm::ANCHOR_GREEDY;
     mutable std::mutex mutex_;
 };
 
-} // namespace gmatch 
\ No newline at end of file
+} // namespace gmatch
@@ -1,8 +1,44 @@
 #include "MatchStrategy.h"
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include "../util/TimeUtil.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace gmatch {
 
+namespace {
+
+inline void setMaskBit(uint64_t* mask, size_t index) {
+    mask[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+// rating ± diff，在int64_t中计算后截断到int范围，评分接近INT_MAX/INT_MIN时不会溢出
+inline void clampWindow(int rating, int diff, int& minRating, int& maxRating) {
+    constexpr int64_t lowest = std::numeric_limits<int>::min();
+    constexpr int64_t highest = std::numeric_limits<int>::max();
+    minRating = static_cast<int>(std::max<int64_t>(static_cast<int64_t>(rating) - diff, lowest));
+    maxRating = static_cast<int>(std::min<int64_t>(static_cast<int64_t>(rating) + diff, highest));
+}
+
+} // namespace
+
+// MatchStrategy 默认批量实现
+void MatchStrategy::matchBatch(const PlayerPtr& anchor, int /*anchorRating*/, uint64_t /*anchorEnqueueTime*/,
+                               const MatchCandidates& candidates, uint64_t* mask) const {
+    std::fill(mask, mask + maskWords(candidates.count), 0);
+    for (size_t i = 0; i < candidates.count; ++i) {
+        if (isMatch(anchor, candidates.players[i])) {
+            setMaskBit(mask, i);
+        }
+    }
+}
+
 // RatingBasedStrategy 实现
 RatingBasedStrategy::RatingBasedStrategy(int maxRatingDiff)
     : maxRatingDiff_(maxRatingDiff) {
@@ -13,4 +49,95 @@ bool RatingBasedStrategy::isMatch(const PlayerPtr& player1, const PlayerPtr& pla
     return ratingDiff <= maxRatingDiff_;
 }
 
-} // namespace gmatch 
\ No newline at end of file
+void RatingBasedStrategy::matchBatch(const PlayerPtr& /*anchor*/, int anchorRating, uint64_t /*anchorEnqueueTime*/,
+                                     const MatchCandidates& candidates, uint64_t* mask) const {
+    const int* ratings = candidates.ratings;
+    size_t count = candidates.count;
+    std::fill(mask, mask + maskWords(count), 0);
+    
+    size_t i = 0;
+#if defined(__AVX2__)
+    // 每次比较8个评分，步长整除64，结果不会跨越mask字
+    const __m256i anchorVec = _mm256_set1_epi32(anchorRating);
+    const __m256i limitVec = _mm256_set1_epi32(maxRatingDiff_);
+    for (; i + 8 <= count; i += 8) {
+        __m256i ratingVec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ratings + i));
+        __m256i diff = _mm256_abs_epi32(_mm256_sub_epi32(ratingVec, anchorVec));
+        __m256i over = _mm256_cmpgt_epi32(diff, limitVec);
+        uint64_t bits = ~static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(over))) & 0xFF;
+        mask[i / 64] |= bits << (i % 64);
+    }
+#elif defined(__SSE2__)
+    // SSE2没有整数绝对值指令，分别与上下限比较
+    const __m128i anchorVec = _mm_set1_epi32(anchorRating);
+    const __m128i upperVec = _mm_set1_epi32(maxRatingDiff_);
+    const __m128i lowerVec = _mm_set1_epi32(-maxRatingDiff_);
+    for (; i + 4 <= count; i += 4) {
+        __m128i ratingVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ratings + i));
+        __m128i diff = _mm_sub_epi32(ratingVec, anchorVec);
+        __m128i over = _mm_or_si128(_mm_cmpgt_epi32(diff, upperVec), _mm_cmpgt_epi32(lowerVec, diff));
+        uint64_t bits = ~static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(over))) & 0xF;
+        mask[i / 64] |= bits << (i % 64);
+    }
+#endif
+    
+    // 标量处理剩余部分
+    for (; i < count; ++i) {
+        if (std::abs(ratings[i] - anchorRating) <= maxRatingDiff_) {
+            setMaskBit(mask, i);
+        }
+    }
+}
+
+bool RatingBasedStrategy::getRatingWindow(const PlayerPtr& /*anchor*/, int anchorRating,
+                                          int& minRating, int& maxRating) const {
+    clampWindow(anchorRating, maxRatingDiff_, minRating, maxRating);
+    return true;
+}
+
+// WaitTimeExpandingStrategy 实现
+WaitTimeExpandingStrategy::WaitTimeExpandingStrategy(int baseRatingDiff, int expandPerSecond, int maxRatingDiff)
+    : baseRatingDiff_(baseRatingDiff), expandPerSecond_(expandPerSecond),
+      maxRatingDiff_(std::max(baseRatingDiff, maxRatingDiff)) {
+}
+
+int WaitTimeExpandingStrategy::getAllowedRatingDiff(const PlayerPtr& player, uint64_t nowMs) const {
+    return getAllowedRatingDiff(player->getLastActivityTime(), nowMs);
+}
+
+int WaitTimeExpandingStrategy::getAllowedRatingDiff(uint64_t activityTime, uint64_t nowMs) const {
+    uint64_t waitedMs = nowMs > activityTime ? nowMs - activityTime : 0;
+    int64_t allowed = baseRatingDiff_ + static_cast<int64_t>(expandPerSecond_) * waitedMs / 1000;
+    return static_cast<int>(std::min<int64_t>(allowed, maxRatingDiff_));
+}
+
+bool WaitTimeExpandingStrategy::isMatch(const PlayerPtr& player1, const PlayerPtr& player2) const {
+    uint64_t nowMs = TimeUtil::currentTimeMillis();
+    int allowed = std::max(getAllowedRatingDiff(player1, nowMs), getAllowedRatingDiff(player2, nowMs));
+    int ratingDiff = std::abs(player1->getRating() - player2->getRating());
+    return ratingDiff <= allowed;
+}
+
+void WaitTimeExpandingStrategy::matchBatch(const PlayerPtr& /*anchor*/, int anchorRating,
+                                           uint64_t anchorEnqueueTime,
+                                           const MatchCandidates& candidates, uint64_t* mask) const {
+    std::fill(mask, mask + maskWords(candidates.count), 0);
+    
+    uint64_t nowMs = TimeUtil::currentTimeMillis();
+    int anchorAllowed = getAllowedRatingDiff(anchorEnqueueTime, nowMs);
+    for (size_t i = 0; i < candidates.count; ++i) {
+        int ratingDiff = std::abs(candidates.ratings[i] - anchorRating);
+        if (ratingDiff <= anchorAllowed ||
+            ratingDiff <= getAllowedRatingDiff(candidates.enqueueTimes[i], nowMs)) {
+            setMaskBit(mask, i);
+        }
+    }
+}
+
+bool WaitTimeExpandingStrategy::getRatingWindow(const PlayerPtr& /*anchor*/, int anchorRating,
+                                                int& minRating, int& maxRating) const {
+    clampWindow(anchorRating, maxRatingDiff_, minRating, maxRating);
+    return true;
+}
+
+} // namespace gmatch
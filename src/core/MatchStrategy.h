@@ -1,15 +1,55 @@
 #pragma once
 
 #include <memory>
+#include <cstddef>
+#include <cstdint>
 #include "Player.h"
 
 namespace gmatch {
 
+// 批量匹配的候选集合，评分连续存放以便向量化比较
+// ratings和enqueueTimes为队列中记录的入队评分与活动时间，
+// players与其一一对应，供逐对判断的策略使用；策略的usesPlayerObjects()返回false时可能为空
+struct MatchCandidates {
+    const int* ratings = nullptr;
+    const uint64_t* enqueueTimes = nullptr;
+    const PlayerPtr* players = nullptr;
+    size_t count = 0;
+};
+
 // 匹配策略接口
 class MatchStrategy {
 public:
     virtual ~MatchStrategy() = default;
     virtual bool isMatch(const PlayerPtr& player1, const PlayerPtr& player2) const = 0;
+    
+    // 批量判断anchor与每个候选能否匹配：第i个候选的结果写入mask[i / 64]的第(i % 64)位
+    // anchorRating和anchorEnqueueTime为队列中记录的anchor入队评分与活动时间
+    // mask至少包含maskWords(candidates.count)个元素；默认实现逐对调用isMatch
+    virtual void matchBatch(const PlayerPtr& anchor, int anchorRating, uint64_t anchorEnqueueTime,
+                            const MatchCandidates& candidates, uint64_t* mask) const;
+    
+    // matchBatch是否需要访问候选的Player对象，返回false时队列可以不提供players
+    virtual bool usesPlayerObjects() const {
+        return true;
+    }
+    
+    // 容纳count个候选结果所需的mask字数
+    static size_t maskWords(size_t count) {
+        return (count + 63) / 64;
+    }
+    
+    // 获取可能与anchor匹配的评分区间，供队列按评分索引缩小候选范围；anchorRating为队列中记录的入队评分
+    // 返回false表示该策略不按评分限制候选，队列将退化为全量扫描
+    virtual bool getRatingWindow(const PlayerPtr& /*anchor*/, int /*anchorRating*/,
+                                 int& /*minRating*/, int& /*maxRating*/) const {
+        return false;
+    }
+    
+    // 任意两名可匹配玩家之间的最大评分差，-1表示不限制
+    virtual int getMaxRatingDiff() const {
+        return -1;
+    }
 };
 
 // 基于评分差异的匹配策略
@@ -18,10 +58,48 @@ public:
     RatingBasedStrategy(int maxRatingDiff = 300);
     bool isMatch(const PlayerPtr& player1, const PlayerPtr& player2) const override;
     
+    // 只比较评分数组，按编译目标使用AVX2/SSE2指令，其余平台为标量实现
+    void matchBatch(const PlayerPtr& anchor, int anchorRating, uint64_t anchorEnqueueTime,
+                    const MatchCandidates& candidates, uint64_t* mask) const override;
+    bool usesPlayerObjects() const override { return false; }
+    bool getRatingWindow(const PlayerPtr& anchor, int anchorRating, int& minRating, int& maxRating) const override;
+    
     // 获取最大评分差异
-    int getMaxRatingDiff() const { return maxRatingDiff_; }
+    int getMaxRatingDiff() const override { return maxRatingDiff_; }
+    
+private:
+    int maxRatingDiff_;
+};
+
+// 随等待时间放宽评分差异的匹配策略
+// 玩家允许的评分差为 base + expandPerSecond * 等待秒数，不超过maxRatingDiff；
+// 两名玩家中等待更久的一方的容忍度决定能否匹配。isMatch的等待时间取自Player::getLastActivityTime()，
+// 队列批量匹配时取自入队时记录的活动时间。
+class WaitTimeExpandingStrategy : public MatchStrategy {
+public:
+    WaitTimeExpandingStrategy(int baseRatingDiff = 100, int expandPerSecond = 50, int maxRatingDiff = 1000);
+    bool isMatch(const PlayerPtr& player1, const PlayerPtr& player2) const override;
+    
+    // 整批共用同一时刻和锚点容忍度，锚点和候选的等待时间都取自队列记录的入队时间
+    void matchBatch(const PlayerPtr& anchor, int anchorRating, uint64_t anchorEnqueueTime,
+                    const MatchCandidates& candidates, uint64_t* mask) const override;
+    bool usesPlayerObjects() const override { return false; }
+    
+    // 之前未能成组的锚点仍是后续锚点的候选，它们等待得更久，容忍度可能大于当前锚点，
+    // 因此候选区间取容忍度上限maxRatingDiff
+    bool getRatingWindow(const PlayerPtr& anchor, int anchorRating, int& minRating, int& maxRating) const override;
+    int getMaxRatingDiff() const override { return maxRatingDiff_; }
+    
+    // 获取玩家在指定时刻允许的评分差
+    int getAllowedRatingDiff(const PlayerPtr& player, uint64_t nowMs) const;
+    int getAllowedRatingDiff(uint64_t activityTime, uint64_t nowMs) const;
+    
+    int getBaseRatingDiff() const { return baseRatingDiff_; }
+    int getExpandPerSecond() const { return expandPerSecond_; }
     
 private:
+    int baseRatingDiff_;
+    int expandPerSecond_;
     int maxRatingDiff_;
 };
 
@@ -33,6 +33,7 @@ bool Room::removePlayer(Player::PlayerId playerId) {
     auto it = players_.find(playerId);
     if (it != players_.end()) {
         players_.erase(it);
+        teams_.erase(playerId);
         if (status_ == Status::READY) {
             status_ = Status::WAITING;
         }
@@ -77,4 +78,28 @@ double Room::getAverageRating() const {
     return static_cast<double>(sum) / players_.size();
 }
 
+bool Room::setTeam(Player::PlayerId playerId, int team) {
+    if (team < 0 || players_.count(playerId) == 0) {
+        return false;
+    }
+    teams_[playerId] = team;
+    teamCount_ = std::max(teamCount_, team + 1);
+    return true;
+}
+
+int Room::getTeam(Player::PlayerId playerId) const {
+    auto it = teams_.find(playerId);
+    return it != teams_.end() ? it->second : -1;
+}
+
+std::vector<PlayerPtr> Room::getTeamPlayers(int team) const {
+    std::vector<PlayerPtr> result;
+    for (const auto& pair : teams_) {
+        if (pair.second == team) {
+            result.push_back(players_.at(pair.first));
+        }
+    }
+    return result;
+}
+
 } // namespace gmatch 
\ No newline at end of file
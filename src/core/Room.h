@@ -38,6 +38,12 @@ public:
     
     bool isRatingInRange(int rating) const;
     double getAverageRating() const;
+    
+    // 队伍分配，玩家必须已在房间中；未分配队伍的玩家getTeam返回-1
+    bool setTeam(Player::PlayerId playerId, int team);
+    int getTeam(Player::PlayerId playerId) const;
+    int getTeamCount() const { return teamCount_; }
+    std::vector<PlayerPtr> getTeamPlayers(int team) const;
 
 private:
     RoomId id_;
@@ -46,6 +52,8 @@ private:
     int minRating_;  // 最小允许评分，0表示不限制
     int maxRating_;  // 最大允许评分，0表示不限制
     std::unordered_map<Player::PlayerId, PlayerPtr> players_;
+    std::unordered_map<Player::PlayerId, int> teams_;
+    int teamCount_ = 0;
     uint64_t creationTime_;
 };
 
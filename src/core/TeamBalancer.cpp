@@ -0,0 +1,130 @@
+#include "TeamBalancer.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+namespace gmatch {
+
+namespace {
+
+// 按各队总评分和人数计算平均评分的最大差值
+double spreadOf(const std::vector<int64_t>& sums, const std::vector<int>& sizes) {
+    double maxAverage = 0.0;
+    double minAverage = 0.0;
+    bool first = true;
+    for (size_t t = 0; t < sums.size(); ++t) {
+        if (sizes[t] == 0) {
+            continue;
+        }
+        double average = static_cast<double>(sums[t]) / sizes[t];
+        if (first) {
+            maxAverage = minAverage = average;
+            first = false;
+        } else {
+            maxAverage = std::max(maxAverage, average);
+            minAverage = std::min(minAverage, average);
+        }
+    }
+    return maxAverage - minAverage;
+}
+
+} // namespace
+
+TeamBalancer::TeamBalancer(int teamCount, uint32_t budgetUs)
+    : teamCount_(teamCount), budgetUs_(budgetUs) {
+}
+
+std::vector<int> TeamBalancer::assignTeams(const std::vector<PlayerPtr>& players) const {
+    std::vector<int> ratings;
+    ratings.reserve(players.size());
+    for (const auto& player : players) {
+        ratings.push_back(player->getRating());
+    }
+    return assignTeams(ratings);
+}
+
+std::vector<int> TeamBalancer::assignTeams(const std::vector<int>& ratings) const {
+    size_t count = ratings.size();
+    std::vector<int> teams(count, 0);
+    if (teamCount_ <= 1 || count < static_cast<size_t>(teamCount_)) {
+        return teams;
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budgetUs_);
+    
+    // 每队人数：前count % teamCount支队伍多一人
+    std::vector<int> capacity(teamCount_, static_cast<int>(count / teamCount_));
+    for (size_t t = 0; t < count % teamCount_; ++t) {
+        ++capacity[t];
+    }
+    
+    // 贪心：评分从高到低，分配给未满且总评分最低的队伍
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ratings](size_t a, size_t b) {
+        return ratings[a] > ratings[b];
+    });
+    
+    std::vector<int64_t> sums(teamCount_, 0);
+    std::vector<int> sizes(teamCount_, 0);
+    for (size_t index : order) {
+        int best = -1;
+        for (int t = 0; t < teamCount_; ++t) {
+            if (sizes[t] < capacity[t] && (best < 0 || sums[t] < sums[best])) {
+                best = t;
+            }
+        }
+        teams[index] = best;
+        sums[best] += ratings[index];
+        ++sizes[best];
+    }
+    
+    // 局部交换：每轮执行一次使差距缩小最多的跨队交换，直到无法改进或超出时间预算
+    double current = spreadOf(sums, sizes);
+    while (current > 0.0 && std::chrono::steady_clock::now() < deadline) {
+        double bestSpread = current;
+        size_t bestI = 0, bestJ = 0;
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = i + 1; j < count; ++j) {
+                int a = teams[i], b = teams[j];
+                if (a == b || ratings[i] == ratings[j]) {
+                    continue;
+                }
+                int64_t delta = static_cast<int64_t>(ratings[j]) - ratings[i];
+                sums[a] += delta;
+                sums[b] -= delta;
+                double spread = spreadOf(sums, sizes);
+                sums[a] -= delta;
+                sums[b] += delta;
+                if (spread < bestSpread) {
+                    bestSpread = spread;
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
+        }
+        
+        if (bestSpread >= current) {
+            break;
+        }
+        int64_t delta = static_cast<int64_t>(ratings[bestJ]) - ratings[bestI];
+        sums[teams[bestI]] += delta;
+        sums[teams[bestJ]] -= delta;
+        std::swap(teams[bestI], teams[bestJ]);
+        current = bestSpread;
+    }
+    
+    return teams;
+}
+
+double TeamBalancer::ratingSpread(const std::vector<int>& ratings, const std::vector<int>& teams, int teamCount) {
+    std::vector<int64_t> sums(std::max(teamCount, 1), 0);
+    std::vector<int> sizes(std::max(teamCount, 1), 0);
+    for (size_t i = 0; i < ratings.size() && i < teams.size(); ++i) {
+        sums[teams[i]] += ratings[i];
+        ++sizes[teams[i]];
+    }
+    return spreadOf(sums, sizes);
+}
+
+} // namespace gmatch
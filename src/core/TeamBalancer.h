@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "Player.h"
+
+namespace gmatch {
+
+// 队伍分配器
+// 把一个房间的玩家分成teamCount支人数相差不超过1的队伍，使各队平均评分尽量接近：
+// 先按评分从高到低贪心分配到当前总评分最低的队伍，再在时间预算内反复执行能缩小差距的最优交换。
+class TeamBalancer {
+public:
+    explicit TeamBalancer(int teamCount = 2, uint32_t budgetUs = 50);
+    
+    // 返回每名玩家的队伍编号，与输入下标一一对应
+    // teamCount不大于1或玩家数少于队伍数时所有玩家都在0号队伍
+    std::vector<int> assignTeams(const std::vector<PlayerPtr>& players) const;
+    std::vector<int> assignTeams(const std::vector<int>& ratings) const;
+    
+    // 各队平均评分中最高与最低的差值
+    static double ratingSpread(const std::vector<int>& ratings, const std::vector<int>& teams, int teamCount);
+    
+    int getTeamCount() const { return teamCount_; }
+    uint32_t getBudgetUs() const { return budgetUs_; }
+    
+private:
+    int teamCount_;
+    uint32_t budgetUs_;  // 局部交换阶段的时间预算(微秒)，0表示只做贪心分配
+};
+
+} // namespace gmatch
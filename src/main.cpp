@@ -4,6 +4,7 @@
 #include <thread>
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
 #include <execinfo.h>
 #include <ctime>
 #include "server/MatchServer.h"
@@ -18,6 +19,9 @@ std::unique_ptr<MatchServer> g_server;
 // 跟踪是否已经在处理信号中
 static std::atomic<bool> g_handlingSignal(false);
 
+// 收到SIGUSR2后由主线程把监听套接字和玩家交给新进程
+static std::atomic<bool> g_handoffRequested(false);
+
 // 检查命令行是否包含特定选项
 bool hasOption(char* argv[], int argc, const char* option);
 
@@ -80,19 +84,51 @@ void signalHandler(int signal) {
     }
 }
 
+// 交接信号只设置标志，交接过程在主线程中执行
+void handoffSignalHandler(int) {
+    g_handoffRequested = true;
+}
+
 // 显示帮助信息
 void showHelp(const char* programName) {
     std::cout << "Usage: " << programName << " [options]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  --config FILE      Config file path (default: config.ini)" << std::endl;
-    std::cout << "  --address ADDR     Server address (default: 0.0.0.0)" << std::endl;
+    std::cout << "  --address ADDR     Server address: IPv4, IPv6 or unix:/path (default: 0.0.0.0)" << std::endl;
     std::cout << "  --port PORT        Server port (default: 9090)" << std::endl;
+    std::cout << "  --listen LIST      Extra comma-separated listen addresses, e.g. \"[::]:9090,unix:/run/gmatch.sock\" (default: none)" << std::endl;
     std::cout << "  --players NUM      Players per room (default: 2)" << std::endl;
     std::cout << "  --max-diff NUM     Max rating difference (default: 300)" << std::endl;
+    std::cout << "  --match-workers N  Match worker threads / rating shards (default: 0 = hardware concurrency)" << std::endl;
+    std::cout << "  --expand-rate NUM  Widen the allowed rating diff by NUM per second of waiting (default: 0 = off)" << std::endl;
+    std::cout << "  --max-diff-cap NUM Upper bound of the widened rating diff (default: 1000)" << std::endl;
+    std::cout << "  --match-algorithm NAME  Batch matcher: greedy or sorted_window (default: greedy)" << std::endl;
+    std::cout << "  --io-model NAME    Network I/O model: reactor (epoll I/O threads) or thread (one thread per connection) (default: reactor)" << std::endl;
+    std::cout << "  --io-threads N     I/O threads in reactor mode (default: 0 = hardware concurrency)" << std::endl;
+    std::cout << "  --reuse-port       Open one SO_REUSEPORT listener per I/O thread instead of a single accept thread" << std::endl;
+    std::cout << "  --handoff-path PATH  Unix socket used to hand listeners and players to a restarted server on SIGUSR2 (default: none)" << std::endl;
+    std::cout << "  --takeover         Wait on the handoff path for the running server to hand over, instead of binding" << std::endl;
+    std::cout << "  --idle-timeout MS  Close connections that send nothing for MS milliseconds (default: 0 = never)" << std::endl;
+    std::cout << "  --heartbeat MS     Send a heartbeat to connections idle for MS milliseconds (default: 0 = off)" << std::endl;
+    std::cout << "  --max-connections N Concurrent connections before new ones are closed (default: 10000, 0 = unlimited)" << std::endl;
+    std::cout << "  --rate-limit N     Requests per second allowed on each connection (default: 100, 0 = unlimited)" << std::endl;
+    std::cout << "  --rate-burst N     Requests a connection may send in a burst above the rate limit (default: 200)" << std::endl;
+    std::cout << "  --request-workers N Threads handling client requests (default: 0 = hardware concurrency)" << std::endl;
+    std::cout << "  --max-pending-requests N  Queued requests before new ones are rejected as busy (default: 65536)" << std::endl;
+    std::cout << "  --framing NAME     Message framing: line (newline-delimited) or length (4-byte big-endian prefix) (default: line)" << std::endl;
+    std::cout << "  --no-binary-protocol  Reject the compact binary protocol; every connection speaks JSON" << std::endl;
+    std::cout << "  --max-frame-size N Largest accepted request in bytes (default: 1048576)" << std::endl;
+    std::cout << "  --send-hwm N       Pending output bytes per connection before a client counts as a slow consumer (default: 1048576)" << std::endl;
+    std::cout << "  --slow-consumer NAME  Slow consumer policy: backpressure (pause reading) or disconnect (default: backpressure)" << std::endl;
     std::cout << "  --log-file FILE    Log file path (default: match_server.log)" << std::endl;
     std::cout << "  --log-level LEVEL  Log level (0=DEBUG, 1=INFO, 2=WARNING, 3=ERROR, 4=FATAL) (default: 1)" << std::endl;
     std::cout << "  --no-force-match   Disable force match on timeout" << std::endl;
     std::cout << "  --match-timeout    Match timeout threshold in milliseconds (default: 5000)" << std::endl;
+    std::cout << "  --match-interval   Max wait between match ticks in milliseconds (default: 100)" << std::endl;
+    std::cout << "  --match-coalesce   Coalescing window after a queue change in milliseconds (default: 10)" << std::endl;
+    std::cout << "  --poll-match       Poll the queue every match interval instead of waking on queue changes" << std::endl;
+    std::cout << "  --teams NUM        Teams per room, balanced by rating (default: 2, 1 = no teams)" << std::endl;
+    std::cout << "  --team-budget-us N Time budget per room for team balancing in microseconds (default: 50)" << std::endl;
     std::cout << "  --status-interval  Status interval in seconds (default: 0)" << std::endl;
     std::cout << "  --help             Display this help message" << std::endl;
 }
@@ -103,18 +139,46 @@ int main(int argc, char* argv[]) {
     signal(SIGTERM, signalHandler);
     signal(SIGSEGV, signalHandler);
     signal(SIGABRT, signalHandler);
+    signal(SIGUSR2, handoffSignalHandler);
     
     // 默认配置
     std::string configFile = "config.ini";
     std::string address = "0.0.0.0";
     uint16_t port = 9090;
+    std::string listen;  // 默认只监听address:port
     int playersPerRoom = 2;
     int maxRatingDiff = 300;
+    int matchWorkers = 0;  // 默认使用硬件并发数
+    int ratingExpandPerSec = 0;  // 默认不随等待时间放宽评分差
+    int maxRatingDiffCap = 1000;
+    std::string matchAlgorithm = "greedy";  // 默认按入队顺序贪心匹配
+    std::string ioModel = "reactor";  // 默认使用epoll I/O线程
+    int ioThreads = 0;  // 默认使用硬件并发数
+    bool reusePort = false;  // 默认由单独的接受线程接受连接
+    std::string handoffPath;  // 默认不支持重启时交接
+    bool takeover = false;
+    int idleTimeout = 0;  // 默认不断开空闲连接
+    int heartbeatInterval = 0;  // 默认不发送心跳
+    int maxConnections = 10000;
+    int rateLimit = 100;  // 每个连接每秒的请求数
+    int rateBurst = 200;
+    int requestWorkers = 0;  // 默认使用硬件并发数
+    int maxPendingRequests = 65536;
+    std::string framing = "line";  // 默认按行分帧
+    bool binaryProtocol = true;  // 默认允许客户端协商二进制协议
+    int maxFrameSize = 1024 * 1024;
+    int sendHighWaterMark = 1024 * 1024;
+    std::string slowConsumer = "backpressure";  // 默认暂停读取慢消费者的请求
     std::string logFile = "match_server.log";
     LogLevel logLevel = LogLevel::INFO;
     bool configFileSpecified = false;
     bool forceMatchOnTimeout = true;  // 默认启用超时匹配
     uint64_t matchTimeoutThreshold = 5000;  // 默认超时阈值5秒
+    uint32_t matchInterval = 100;  // 默认每100毫秒执行一轮匹配
+    uint32_t matchCoalesce = 10;  // 默认合并窗口10毫秒
+    bool eventDrivenMatching = true;  // 默认由队列变化唤醒匹配
+    int teamCount = 2;  // 默认每个房间分为两队
+    int teamBalanceBudget = 50;  // 默认每个房间分队最多50微秒
     int statusInterval = 0;  // 默认不输出状态
     
     // 处理命令行参数
@@ -129,10 +193,54 @@ int main(int argc, char* argv[]) {
             address = argv[++i];
         } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
             port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+            listen = argv[++i];
         } else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
             playersPerRoom = std::stoi(argv[++i]);
         } else if (strcmp(argv[i], "--max-diff") == 0 && i + 1 < argc) {
             maxRatingDiff = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--match-workers") == 0 && i + 1 < argc) {
+            matchWorkers = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--expand-rate") == 0 && i + 1 < argc) {
+            ratingExpandPerSec = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-diff-cap") == 0 && i + 1 < argc) {
+            maxRatingDiffCap = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--match-algorithm") == 0 && i + 1 < argc) {
+            matchAlgorithm = argv[++i];
+        } else if (strcmp(argv[i], "--io-model") == 0 && i + 1 < argc) {
+            ioModel = argv[++i];
+        } else if (strcmp(argv[i], "--io-threads") == 0 && i + 1 < argc) {
+            ioThreads = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reuse-port") == 0) {
+            reusePort = true;
+        } else if (strcmp(argv[i], "--handoff-path") == 0 && i + 1 < argc) {
+            handoffPath = argv[++i];
+        } else if (strcmp(argv[i], "--takeover") == 0) {
+            takeover = true;
+        } else if (strcmp(argv[i], "--idle-timeout") == 0 && i + 1 < argc) {
+            idleTimeout = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--heartbeat") == 0 && i + 1 < argc) {
+            heartbeatInterval = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-connections") == 0 && i + 1 < argc) {
+            maxConnections = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rate-limit") == 0 && i + 1 < argc) {
+            rateLimit = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rate-burst") == 0 && i + 1 < argc) {
+            rateBurst = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--request-workers") == 0 && i + 1 < argc) {
+            requestWorkers = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-pending-requests") == 0 && i + 1 < argc) {
+            maxPendingRequests = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--framing") == 0 && i + 1 < argc) {
+            framing = argv[++i];
+        } else if (strcmp(argv[i], "--no-binary-protocol") == 0) {
+            binaryProtocol = false;
+        } else if (strcmp(argv[i], "--max-frame-size") == 0 && i + 1 < argc) {
+            maxFrameSize = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--send-hwm") == 0 && i + 1 < argc) {
+            sendHighWaterMark = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--slow-consumer") == 0 && i + 1 < argc) {
+            slowConsumer = argv[++i];
         } else if (strcmp(argv[i], "--log-file") == 0 && i + 1 < argc) {
             logFile = argv[++i];
         } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
@@ -146,6 +254,16 @@ int main(int argc, char* argv[]) {
             forceMatchOnTimeout = false;
         } else if (strcmp(argv[i], "--match-timeout") == 0 && i + 1 < argc) {
             matchTimeoutThreshold = static_cast<uint64_t>(std::stoi(argv[++i]));
+        } else if (strcmp(argv[i], "--match-interval") == 0 && i + 1 < argc) {
+            matchInterval = static_cast<uint32_t>(std::stoi(argv[++i]));
+        } else if (strcmp(argv[i], "--match-coalesce") == 0 && i + 1 < argc) {
+            matchCoalesce = static_cast<uint32_t>(std::stoi(argv[++i]));
+        } else if (strcmp(argv[i], "--teams") == 0 && i + 1 < argc) {
+            teamCount = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--team-budget-us") == 0 && i + 1 < argc) {
+            teamBalanceBudget = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--poll-match") == 0) {
+            eventDrivenMatching = false;
         } else if (strcmp(argv[i], "--status-interval") == 0 && i + 1 < argc) {
             statusInterval = std::stoi(argv[++i]);
         } else {
@@ -165,12 +283,75 @@ int main(int argc, char* argv[]) {
         if (!hasOption(argv, argc, "--port")) {
             port = config.get<int>("port", port);
         }
+        if (!hasOption(argv, argc, "--listen")) {
+            listen = config.get<std::string>("listen", listen);
+        }
         if (!hasOption(argv, argc, "--players")) {
             playersPerRoom = config.get<int>("players_per_room", playersPerRoom);
         }
         if (!hasOption(argv, argc, "--max-diff")) {
             maxRatingDiff = config.get<int>("max_rating_diff", maxRatingDiff);
         }
+        if (!hasOption(argv, argc, "--match-workers")) {
+            matchWorkers = config.get<int>("match_workers", matchWorkers);
+        }
+        if (!hasOption(argv, argc, "--expand-rate")) {
+            ratingExpandPerSec = config.get<int>("rating_expand_per_sec", ratingExpandPerSec);
+        }
+        if (!hasOption(argv, argc, "--max-diff-cap")) {
+            maxRatingDiffCap = config.get<int>("max_rating_diff_cap", maxRatingDiffCap);
+        }
+        if (!hasOption(argv, argc, "--match-algorithm")) {
+            matchAlgorithm = config.get<std::string>("match_algorithm", matchAlgorithm);
+        }
+        if (!hasOption(argv, argc, "--io-model")) {
+            ioModel = config.get<std::string>("io_model", ioModel);
+        }
+        if (!hasOption(argv, argc, "--io-threads")) {
+            ioThreads = config.get<int>("io_threads", ioThreads);
+        }
+        if (!hasOption(argv, argc, "--reuse-port")) {
+            reusePort = config.get<int>("reuse_port", reusePort ? 1 : 0) != 0;
+        }
+        if (!hasOption(argv, argc, "--handoff-path")) {
+            handoffPath = config.get<std::string>("handoff_path", handoffPath);
+        }
+        if (!hasOption(argv, argc, "--idle-timeout")) {
+            idleTimeout = config.get<int>("idle_timeout_ms", idleTimeout);
+        }
+        if (!hasOption(argv, argc, "--heartbeat")) {
+            heartbeatInterval = config.get<int>("heartbeat_interval_ms", heartbeatInterval);
+        }
+        if (!hasOption(argv, argc, "--max-connections")) {
+            maxConnections = config.get<int>("max_connections", maxConnections);
+        }
+        if (!hasOption(argv, argc, "--rate-limit")) {
+            rateLimit = config.get<int>("request_rate_limit", rateLimit);
+        }
+        if (!hasOption(argv, argc, "--rate-burst")) {
+            rateBurst = config.get<int>("request_burst", rateBurst);
+        }
+        if (!hasOption(argv, argc, "--request-workers")) {
+            requestWorkers = config.get<int>("request_workers", requestWorkers);
+        }
+        if (!hasOption(argv, argc, "--max-pending-requests")) {
+            maxPendingRequests = config.get<int>("max_pending_requests", maxPendingRequests);
+        }
+        if (!hasOption(argv, argc, "--framing")) {
+            framing = config.get<std::string>("framing", framing);
+        }
+        if (!hasOption(argv, argc, "--no-binary-protocol")) {
+            binaryProtocol = config.get<int>("binary_protocol", binaryProtocol ? 1 : 0) != 0;
+        }
+        if (!hasOption(argv, argc, "--max-frame-size")) {
+            maxFrameSize = config.get<int>("max_frame_size", maxFrameSize);
+        }
+        if (!hasOption(argv, argc, "--send-hwm")) {
+            sendHighWaterMark = config.get<int>("send_high_water_mark", sendHighWaterMark);
+        }
+        if (!hasOption(argv, argc, "--slow-consumer")) {
+            slowConsumer = config.get<std::string>("slow_consumer_policy", slowConsumer);
+        }
         if (!hasOption(argv, argc, "--log-file")) {
             logFile = config.get<std::string>("log_file", logFile);
         }
@@ -178,14 +359,55 @@ int main(int argc, char* argv[]) {
             int logLevelInt = config.get<int>("log_level", static_cast<int>(logLevel));
             logLevel = static_cast<LogLevel>(logLevelInt);
         }
+        if (!hasOption(argv, argc, "--match-interval")) {
+            matchInterval = config.get<int>("match_interval_ms", matchInterval);
+        }
+        if (!hasOption(argv, argc, "--match-coalesce")) {
+            matchCoalesce = config.get<int>("match_coalesce_ms", matchCoalesce);
+        }
+        if (!hasOption(argv, argc, "--teams")) {
+            teamCount = config.get<int>("team_count", teamCount);
+        }
+        if (!hasOption(argv, argc, "--team-budget-us")) {
+            teamBalanceBudget = config.get<int>("team_balance_budget_us", teamBalanceBudget);
+        }
+        if (!hasOption(argv, argc, "--poll-match")) {
+            eventDrivenMatching = config.get<int>("match_event_driven", eventDrivenMatching ? 1 : 0) != 0;
+        }
     } else if (!configFileSpecified) {
         // 创建默认配置
         config.set("address", address);
         config.set("port", port);
+        config.set("listen", listen);
         config.set("players_per_room", playersPerRoom);
         config.set("max_rating_diff", maxRatingDiff);
+        config.set("match_workers", matchWorkers);
+        config.set("rating_expand_per_sec", ratingExpandPerSec);
+        config.set("max_rating_diff_cap", maxRatingDiffCap);
+        config.set("match_algorithm", matchAlgorithm);
+        config.set("io_model", ioModel);
+        config.set("io_threads", ioThreads);
+        config.set("reuse_port", reusePort ? 1 : 0);
+        config.set("handoff_path", handoffPath);
+        config.set("idle_timeout_ms", idleTimeout);
+        config.set("heartbeat_interval_ms", heartbeatInterval);
+        config.set("max_connections", maxConnections);
+        config.set("request_rate_limit", rateLimit);
+        config.set("request_burst", rateBurst);
+        config.set("request_workers", requestWorkers);
+        config.set("max_pending_requests", maxPendingRequests);
+        config.set("framing", framing);
+        config.set("binary_protocol", binaryProtocol ? 1 : 0);
+        config.set("max_frame_size", maxFrameSize);
+        config.set("send_high_water_mark", sendHighWaterMark);
+        config.set("slow_consumer_policy", slowConsumer);
         config.set("log_file", logFile);
         config.set("log_level", static_cast<int>(logLevel));
+        config.set("match_interval_ms", static_cast<int>(matchInterval));
+        config.set("match_coalesce_ms", static_cast<int>(matchCoalesce));
+        config.set("match_event_driven", eventDrivenMatching ? 1 : 0);
+        config.set("team_count", teamCount);
+        config.set("team_balance_budget_us", teamBalanceBudget);
         
         config.saveToFile("config.ini");
     }
@@ -198,15 +420,91 @@ int main(int argc, char* argv[]) {
     LOG_INFO("Starting GMatch server...");
     LOG_INFO("Address: %s", address.c_str());
     LOG_INFO("Port: %d", port);
+    if (!listen.empty()) {
+        LOG_INFO("Extra listen addresses: %s", listen.c_str());
+    }
     LOG_INFO("Players per room: %d", playersPerRoom);
     LOG_INFO("Max rating difference: %d", maxRatingDiff);
+    if (ratingExpandPerSec > 0) {
+        LOG_INFO("Rating difference expands by %d/s up to %d", ratingExpandPerSec, maxRatingDiffCap);
+    }
+    LOG_INFO("Match workers: %d", matchWorkers);
+    
+    MatchAlgorithm algorithm = MatchAlgorithm::ANCHOR_GREEDY;
+    if (!parseMatchAlgorithm(matchAlgorithm, algorithm)) {
+        LOG_WARNING("Unknown match algorithm: %s, using greedy", matchAlgorithm.c_str());
+    }
+    LOG_INFO("Match algorithm: %s", matchAlgorithmName(algorithm));
+    LOG_INFO("Match interval: %u ms", matchInterval);
+    LOG_INFO("Event driven matching: %s (coalesce %u ms)", eventDrivenMatching ? "on" : "off", matchCoalesce);
+    LOG_INFO("Teams per room: %d (balance budget %d us)", teamCount, teamBalanceBudget);
+    
+    IoModel model = IoModel::REACTOR;
+    if (!parseIoModel(ioModel, model)) {
+        LOG_WARNING("Unknown io model: %s, using reactor", ioModel.c_str());
+    }
+    LOG_INFO("IO model: %s (io threads: %d, reuse port: %s)", ioModelName(model), ioThreads, reusePort ? "on" : "off");
+    if (!handoffPath.empty()) {
+        LOG_INFO("Handoff path: %s (send SIGUSR2 to hand off to a server started with --takeover)", handoffPath.c_str());
+    }
+    
+    LOG_INFO("Idle timeout: %d ms (heartbeat interval: %d ms)", idleTimeout, heartbeatInterval);
+    LOG_INFO("Max connections: %d (rate limit: %d req/s per connection, burst: %d)", maxConnections, rateLimit, rateBurst);
+    LOG_INFO("Request workers: %d (max pending requests: %d)", requestWorkers, maxPendingRequests);
+    
+    FramingMode framingMode = FramingMode::LINE;
+    if (!parseFramingMode(framing, framingMode)) {
+        LOG_WARNING("Unknown framing mode: %s, using line", framing.c_str());
+    }
+    LOG_INFO("Framing: %s (max frame size: %d bytes, binary protocol: %s)", framingModeName(framingMode), maxFrameSize,
+             binaryProtocol ? "on" : "off");
+    
+    SlowConsumerPolicy slowConsumerPolicy = SlowConsumerPolicy::BACKPRESSURE;
+    if (!parseSlowConsumerPolicy(slowConsumer, slowConsumerPolicy)) {
+        LOG_WARNING("Unknown slow consumer policy: %s, using backpressure", slowConsumer.c_str());
+    }
+    LOG_INFO("Send high water mark: %d bytes (slow consumer policy: %s)", sendHighWaterMark,
+             slowConsumerPolicyName(slowConsumerPolicy));
     
     // 创建并启动服务器
     g_server = std::make_unique<MatchServer>(address, port);
+    g_server->setMatchWorkers(static_cast<size_t>(std::max(matchWorkers, 0)));
     g_server->setPlayersPerRoom(playersPerRoom);
-    g_server->setMaxRatingDifference(maxRatingDiff);
+    if (ratingExpandPerSec > 0) {
+        g_server->setRatingExpansion(maxRatingDiff, ratingExpandPerSec, maxRatingDiffCap);
+    } else {
+        g_server->setMaxRatingDifference(maxRatingDiff);
+    }
+    g_server->setMatchAlgorithm(algorithm);
     g_server->setForceMatchOnTimeout(forceMatchOnTimeout);
     g_server->setMatchTimeoutThreshold(matchTimeoutThreshold);
+    g_server->setMatchInterval(matchInterval);
+    g_server->setEventDrivenMatching(eventDrivenMatching);
+    g_server->setMatchCoalesceWindow(matchCoalesce);
+    g_server->setTeamCount(teamCount);
+    g_server->setTeamBalanceBudget(static_cast<uint32_t>(std::max(teamBalanceBudget, 0)));
+    g_server->setIoModel(model);
+    g_server->setIoThreads(static_cast<size_t>(std::max(ioThreads, 0)));
+    g_server->setReusePort(reusePort);
+    g_server->setListenAddresses(listen);
+    g_server->setHandoffPath(handoffPath);
+    g_server->setIdleTimeout(static_cast<uint32_t>(std::max(idleTimeout, 0)));
+    g_server->setHeartbeatInterval(static_cast<uint32_t>(std::max(heartbeatInterval, 0)));
+    g_server->setMaxConnections(static_cast<size_t>(std::max(maxConnections, 0)));
+    g_server->setRequestRateLimit(static_cast<uint32_t>(std::max(rateLimit, 0)), static_cast<uint32_t>(std::max(rateBurst, 0)));
+    g_server->setRequestWorkers(static_cast<size_t>(std::max(requestWorkers, 0)));
+    g_server->setMaxPendingRequests(static_cast<size_t>(std::max(maxPendingRequests, 1)));
+    g_server->setFramingMode(framingMode);
+    g_server->setBinaryProtocol(binaryProtocol);
+    g_server->setMaxFrameSize(static_cast<size_t>(std::max(maxFrameSize, 1)));
+    g_server->setSendHighWaterMark(static_cast<size_t>(std::max(sendHighWaterMark, 1)));
+    g_server->setSlowConsumerPolicy(slowConsumerPolicy);
+    
+    // 接手正在运行的服务器：等待它收到SIGUSR2后交出监听套接字和玩家，最多等待60秒
+    if (takeover && !g_server->takeover(60000)) {
+        LOG_FATAL("Failed to take over from the running server");
+        return 1;
+    }
     
     if (!g_server->start()) {
         LOG_FATAL("Failed to start server");
@@ -218,6 +516,13 @@ int main(int argc, char* argv[]) {
     // 主线程等待，让工作线程继续运行
     time_t lastStatusTime = 0;
     while (g_server->isRunning()) {
+        if (g_handoffRequested.exchange(false)) {
+            if (g_server->handoff()) {
+                LOG_INFO("Handed off to the new server, exiting");
+                break;
+            }
+        }
+        
         time_t now = time(nullptr);
         
         // 如果启用了状态输出，并且时间间隔已到，则输出匹配状态
@@ -226,7 +531,8 @@ int main(int argc, char* argv[]) {
             lastStatusTime = now;
         }
         
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        // 较短的间隔使交接信号能及时处理
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
     return 0;
@@ -0,0 +1,191 @@
+#include "BinaryRequestHandler.h"
+#include "../util/Logger.h"
+
+namespace gmatch {
+
+namespace {
+
+// 成功响应的消息头，调用方继续写入消息体
+BinaryWriter beginResponse(std::string& out, const BinaryHeader& header) {
+    BinaryWriter writer(out);
+    writer.header(header.opcode, BinaryStatus::OK, header.requestId);
+    return writer;
+}
+
+void errorResponse(std::string& out, const BinaryHeader& header, BinaryStatus status, std::string_view message) {
+    appendBinaryError(out, header.opcode, header.requestId, status, message);
+}
+
+// 读取只含玩家ID的请求体
+bool readPlayerId(BinaryReader& body, Player::PlayerId& playerId) {
+    uint64_t id;
+    if (!body.u64(id) || !body.atEnd()) {
+        return false;
+    }
+    playerId = id;
+    return true;
+}
+
+} // namespace
+
+void BinaryRequestHandler::handleRequest(std::string_view request, TcpConnection::ConnectionId clientId,
+                                         std::string& response) {
+    BinaryHeader header;
+    BinaryReader body(request);
+    if (!body.header(header)) {
+        errorResponse(response, BinaryHeader(), BinaryStatus::INVALID_COMMAND, "Invalid message header");
+        return;
+    }
+
+    LOG_DEBUG("Received binary request: opcode %u, request id %u, %zu bytes",
+              static_cast<unsigned>(header.opcode), header.requestId, request.size());
+
+    switch (header.opcode) {
+        case BinaryOpcode::CREATE_PLAYER:
+            handleCreatePlayer(header, body, clientId, response);
+            break;
+        case BinaryOpcode::JOIN_MATCHMAKING:
+            handleJoinMatchmaking(header, body, clientId, response);
+            break;
+        case BinaryOpcode::LEAVE_MATCHMAKING:
+            handleLeaveMatchmaking(header, body, response);
+            break;
+        case BinaryOpcode::GET_ROOMS:
+            handleGetRooms(header, response);
+            break;
+        case BinaryOpcode::GET_PLAYER_INFO:
+            handleGetPlayerInfo(header, body, clientId, response);
+            break;
+        case BinaryOpcode::GET_QUEUE_STATUS:
+            handleGetQueueStatus(header, response);
+            break;
+        default:
+            errorResponse(response, header, BinaryStatus::INVALID_COMMAND, "Unknown command");
+            break;
+    }
+}
+
+void BinaryRequestHandler::handleCreatePlayer(const BinaryHeader& header, BinaryReader& body,
+                                              TcpConnection::ConnectionId clientId, std::string& out) {
+    int32_t rating;
+    std::string_view nameValue;
+    if (!body.i32(rating) || !body.str(nameValue) || !body.atEnd()) {
+        errorResponse(out, header, BinaryStatus::INVALID_ARGUMENT, "Invalid create_player request");
+        return;
+    }
+    std::string name = nameValue.empty() ? std::string("Player") : std::string(nameValue);
+
+    // 异常时丢弃已写出的部分响应
+    size_t start = out.size();
+    try {
+        auto player = MatchManager::getInstance().createPlayer(name, rating);
+        if (!player) {
+            LOG_ERROR("Failed to create player");
+            errorResponse(out, header, BinaryStatus::ERROR, "Failed to create player");
+            return;
+        }
+
+        if (onPlayerCreatedCallback_) {
+            try {
+                onPlayerCreatedCallback_(clientId, player->getId());
+            } catch (const std::exception& e) {
+                LOG_ERROR("Exception in player created callback: %s", e.what());
+            } catch (...) {
+                LOG_ERROR("Unknown exception in player created callback");
+            }
+        }
+
+        BinaryWriter writer = beginResponse(out, header);
+        writer.u64(player->getId());
+        writer.i32(player->getRating());
+        writer.str(player->getName());
+    } catch (const std::exception& e) {
+        LOG_ERROR("Exception creating player: %s", e.what());
+        out.resize(start);
+        errorResponse(out, header, BinaryStatus::INTERNAL_ERROR, std::string("Exception creating player: ") + e.what());
+    } catch (...) {
+        LOG_ERROR("Unknown exception creating player");
+        out.resize(start);
+        errorResponse(out, header, BinaryStatus::INTERNAL_ERROR, "Unknown exception creating player");
+    }
+}
+
+void BinaryRequestHandler::handleJoinMatchmaking(const BinaryHeader& header, BinaryReader& body,
+                                                 TcpConnection::ConnectionId clientId, std::string& out) {
+    Player::PlayerId playerId = 0;
+    if (!readPlayerId(body, playerId)) {
+        errorResponse(out, header, BinaryStatus::INVALID_ARGUMENT, "Invalid player ID");
+        return;
+    }
+
+    auto& matchManager = MatchManager::getInstance();
+    if (onPlayerClaimedCallback_ && matchManager.getPlayer(playerId)) {
+        onPlayerClaimedCallback_(clientId, playerId);
+    }
+    if (!matchManager.joinMatchmaking(playerId)) {
+        errorResponse(out, header, BinaryStatus::ERROR, "Failed to join matchmaking queue");
+        return;
+    }
+
+    beginResponse(out, header);
+}
+
+void BinaryRequestHandler::handleLeaveMatchmaking(const BinaryHeader& header, BinaryReader& body, std::string& out) {
+    Player::PlayerId playerId = 0;
+    if (!readPlayerId(body, playerId)) {
+        errorResponse(out, header, BinaryStatus::INVALID_ARGUMENT, "Invalid player ID");
+        return;
+    }
+
+    if (!MatchManager::getInstance().leaveMatchmaking(playerId)) {
+        errorResponse(out, header, BinaryStatus::ERROR, "Failed to leave matchmaking queue");
+        return;
+    }
+
+    beginResponse(out, header);
+}
+
+void BinaryRequestHandler::handleGetRooms(const BinaryHeader& header, std::string& out) {
+    auto rooms = MatchManager::getInstance().getAllRooms();
+
+    BinaryWriter writer = beginResponse(out, header);
+    writer.u32(static_cast<uint32_t>(rooms.size()));
+    for (const auto& room : rooms) {
+        writer.u64(room->getId());
+        writer.u8(static_cast<uint8_t>(room->getStatus()));
+        writer.u16(static_cast<uint16_t>(room->getPlayerCount()));
+        writer.u16(static_cast<uint16_t>(room->getCapacity()));
+        writer.f64(room->getAverageRating());
+    }
+}
+
+void BinaryRequestHandler::handleGetPlayerInfo(const BinaryHeader& header, BinaryReader& body,
+                                               TcpConnection::ConnectionId clientId, std::string& out) {
+    Player::PlayerId playerId = 0;
+    if (!readPlayerId(body, playerId)) {
+        errorResponse(out, header, BinaryStatus::INVALID_ARGUMENT, "Invalid player ID");
+        return;
+    }
+
+    auto player = MatchManager::getInstance().getPlayer(playerId);
+    if (!player) {
+        errorResponse(out, header, BinaryStatus::PLAYER_NOT_FOUND, "Player not found");
+        return;
+    }
+    if (onPlayerClaimedCallback_) {
+        onPlayerClaimedCallback_(clientId, playerId);
+    }
+
+    BinaryWriter writer = beginResponse(out, header);
+    writer.u64(player->getId());
+    writer.i32(player->getRating());
+    writer.u8(player->isInQueue() ? 1 : 0);
+    writer.str(player->getName());
+}
+
+void BinaryRequestHandler::handleGetQueueStatus(const BinaryHeader& header, std::string& out) {
+    BinaryWriter writer = beginResponse(out, header);
+    writer.u64(MatchManager::getInstance().getQueueSize());
+}
+
+} // namespace gmatch
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "RequestHandler.h"
+#include "../util/BinaryProtocol.h"
+
+namespace gmatch {
+
+// 二进制协议请求处理器，命令与JsonRequestHandler相同，消息格式见BinaryProtocol.h。
+// 请求和返回的响应都不含长度前缀，由连接按二进制分帧方式编码
+class BinaryRequestHandler : public RequestHandler {
+public:
+    using PlayerCallback = JsonRequestHandler::PlayerCreatedCallback;
+
+    using RequestHandler::handleRequest;
+    void handleRequest(std::string_view request, TcpConnection::ConnectionId clientId, std::string& response) override;
+
+    // 与JsonRequestHandler的同名回调含义相同
+    void setPlayerCreatedCallback(PlayerCallback callback) {
+        onPlayerCreatedCallback_ = callback;
+    }
+    void setPlayerClaimedCallback(PlayerCallback callback) {
+        onPlayerClaimedCallback_ = callback;
+    }
+
+private:
+    void handleCreatePlayer(const BinaryHeader& header, BinaryReader& body, TcpConnection::ConnectionId clientId,
+                            std::string& out);
+    void handleJoinMatchmaking(const BinaryHeader& header, BinaryReader& body, TcpConnection::ConnectionId clientId,
+                               std::string& out);
+    void handleLeaveMatchmaking(const BinaryHeader& header, BinaryReader& body, std::string& out);
+    void handleGetRooms(const BinaryHeader& header, std::string& out);
+    void handleGetPlayerInfo(const BinaryHeader& header, BinaryReader& body, TcpConnection::ConnectionId clientId,
+                             std::string& out);
+    void handleGetQueueStatus(const BinaryHeader& header, std::string& out);
+
+    PlayerCallback onPlayerCreatedCallback_;
+    PlayerCallback onPlayerClaimedCallback_;
+};
+
+} // namespace gmatch
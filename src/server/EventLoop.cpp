@@ -0,0 +1,261 @@
+#include "EventLoop.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "../util/Logger.h"
+
+namespace gmatch {
+
+namespace {
+// 单次epoll_wait最多返回的事件数
+constexpr int MAX_EVENTS = 256;
+}
+
+EventLoop::EventLoop() {
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    if (wakeupFd_ >= 0) {
+        close(wakeupFd_);
+    }
+    if (epollFd_ >= 0) {
+        close(epollFd_);
+    }
+}
+
+bool EventLoop::start() {
+    if (running_) {
+        return true;
+    }
+    if (epollFd_ >= 0) {
+        // 停止后重新启动，沿用已有的epoll实例
+        running_ = true;
+        thread_ = std::thread(&EventLoop::loop, this);
+        return true;
+    }
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        LOG_ERROR("Failed to create epoll instance: %s", strerror(errno));
+        return false;
+    }
+
+    wakeupFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd_ < 0) {
+        LOG_ERROR("Failed to create eventfd: %s", strerror(errno));
+        close(epollFd_);
+        epollFd_ = -1;
+        return false;
+    }
+
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = wakeupFd_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeupFd_, &event) < 0) {
+        LOG_ERROR("Failed to register eventfd: %s", strerror(errno));
+        close(wakeupFd_);
+        close(epollFd_);
+        wakeupFd_ = -1;
+        epollFd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&EventLoop::loop, this);
+    return true;
+}
+
+void EventLoop::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    wakeup();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    threadId_ = std::thread::id();
+
+    // 循环已退出，剩余任务和处理函数在当前线程中释放
+    // epoll实例和eventfd保留到析构，停止后仍在投递任务的线程不会写入已关闭的描述符
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pendingFunctors_.clear();
+    }
+    for (const auto& item : handlers_) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, item.first, nullptr);
+    }
+    handlers_.clear();
+    for (int fd : timerFds_) {
+        close(fd);
+    }
+    timerFds_.clear();
+}
+
+bool EventLoop::addFd(int fd, uint32_t events, EventHandler handler) {
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        LOG_ERROR("Failed to add fd %d to epoll: %s", fd, strerror(errno));
+        return false;
+    }
+    handlers_[fd] = std::make_shared<EventHandler>(std::move(handler));
+    return true;
+}
+
+bool EventLoop::modifyFd(int fd, uint32_t events) {
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+        LOG_ERROR("Failed to modify fd %d in epoll: %s", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::runEvery(uint32_t intervalMs, Functor functor) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create timerfd: %s", strerror(errno));
+        return false;
+    }
+
+    struct itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    spec.it_interval.tv_sec = intervalMs / 1000;
+    spec.it_interval.tv_nsec = static_cast<long>(intervalMs % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+        LOG_ERROR("Failed to arm timerfd: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    bool added = addFd(fd, EPOLLIN, [fd, functor](uint32_t) {
+        // 读出到期次数以清除可读状态，错过的多次到期只执行一次
+        uint64_t expirations = 0;
+        if (read(fd, &expirations, sizeof(expirations)) > 0) {
+            functor();
+        }
+    });
+    if (!added) {
+        close(fd);
+        return false;
+    }
+    timerFds_.push_back(fd);
+    return true;
+}
+
+void EventLoop::removeFd(int fd) {
+    auto it = handlers_.find(fd);
+    if (it == handlers_.end()) {
+        return;
+    }
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    handlers_.erase(it);
+}
+
+void EventLoop::runInLoop(Functor functor) {
+    if (isInLoopThread()) {
+        functor();
+    } else {
+        queueInLoop(std::move(functor));
+    }
+}
+
+void EventLoop::queueInLoop(Functor functor) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pendingFunctors_.push_back(std::move(functor));
+    }
+    // 在I/O线程处理事件时加入的任务会在本轮末尾执行，无需唤醒
+    if (!isInLoopThread() || callingPendingFunctors_) {
+        wakeup();
+    }
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    if (wakeupFd_ >= 0 && write(wakeupFd_, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+        LOG_ERROR("Failed to wake up event loop: %s", strerror(errno));
+    }
+}
+
+void EventLoop::handleWakeup() {
+    uint64_t value = 0;
+    while (read(wakeupFd_, &value, sizeof(value)) > 0) {
+    }
+}
+
+void EventLoop::runPendingFunctors() {
+    std::vector<Functor> functors;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        functors.swap(pendingFunctors_);
+    }
+    callingPendingFunctors_ = true;
+    for (auto& functor : functors) {
+        try {
+            functor();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Exception in event loop task: %s", e.what());
+        } catch (...) {
+            LOG_ERROR("Unknown exception in event loop task");
+        }
+    }
+    callingPendingFunctors_ = false;
+}
+
+void EventLoop::loop() {
+    threadId_ = std::this_thread::get_id();
+    LOG_DEBUG("Event loop started");
+
+    std::vector<struct epoll_event> events(MAX_EVENTS);
+    while (running_) {
+        int count = epoll_wait(epollFd_, events.data(), MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeupFd_) {
+                handleWakeup();
+                continue;
+            }
+            // 本轮中已被移除的文件描述符不再处理
+            auto it = handlers_.find(fd);
+            if (it == handlers_.end()) {
+                continue;
+            }
+            // 持有一份引用，处理函数内部移除自身时不会被提前销毁
+            std::shared_ptr<EventHandler> handler = it->second;
+            try {
+                (*handler)(events[i].events);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Exception in event handler for fd %d: %s", fd, e.what());
+            } catch (...) {
+                LOG_ERROR("Unknown exception in event handler for fd %d", fd);
+            }
+        }
+
+        runPendingFunctors();
+    }
+
+    LOG_DEBUG("Event loop stopped");
+}
+
+} // namespace gmatch
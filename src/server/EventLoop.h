@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+namespace gmatch {
+
+// epoll事件循环，每个实例独占一个I/O线程
+// 文件描述符的注册、修改和移除只能在本循环线程中进行，其他线程通过runInLoop/queueInLoop投递任务
+class EventLoop {
+public:
+    using Functor = std::function<void()>;
+    using EventHandler = std::function<void(uint32_t events)>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // 创建epoll实例并启动循环线程
+    bool start();
+
+    // 停止循环线程并释放所有已注册的处理函数
+    void stop();
+
+    bool isRunning() const { return running_; }
+    bool isInLoopThread() const { return std::this_thread::get_id() == threadId_.load(); }
+
+    // 以下三个方法只能在循环线程中调用
+    // events为EPOLLIN/EPOLLOUT/EPOLLET等标志组合
+    bool addFd(int fd, uint32_t events, EventHandler handler);
+    bool modifyFd(int fd, uint32_t events);
+    // 可以在处理函数内部移除自身，正在执行的处理函数在返回后才销毁
+    void removeFd(int fd);
+
+    // 在循环线程中执行：当前就在循环线程时立即执行，否则排队并唤醒循环
+    void runInLoop(Functor functor);
+    void queueInLoop(Functor functor);
+
+    // 每隔intervalMs毫秒在循环线程中执行一次functor，只能在循环线程中调用；定时器在stop()时释放
+    bool runEvery(uint32_t intervalMs, Functor functor);
+
+    // 已注册的文件描述符数量，只能在循环线程中调用
+    size_t getFdCount() const { return handlers_.size(); }
+
+private:
+    void loop();
+    void wakeup();
+    void handleWakeup();
+    void runPendingFunctors();
+
+    int epollFd_ = -1;
+    int wakeupFd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::atomic<std::thread::id> threadId_;
+
+    std::mutex pendingMutex_;
+    std::vector<Functor> pendingFunctors_;
+    // 正在执行任务队列，此时新加入的任务需要唤醒下一轮，只在I/O线程中访问
+    bool callingPendingFunctors_ = false;
+
+    std::unordered_map<int, std::shared_ptr<EventHandler>> handlers_;
+    std::vector<int> timerFds_;
+};
+
+} // namespace gmatch
@@ -0,0 +1,337 @@
+#include "Handoff.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include "../util/Logger.h"
+#include "../util/SocketAddress.h"
+
+namespace gmatch {
+
+namespace {
+
+constexpr uint32_t HANDOFF_MAGIC = 0x474d484f;  // "GMHO"
+constexpr uint32_t HANDOFF_VERSION = 1;
+constexpr char HANDOFF_ACK = 'K';
+// 状态中单个玩家名的长度上限，超过视为数据损坏
+constexpr uint32_t MAX_HANDOFF_NAME = 64 * 1024;
+constexpr uint64_t MAX_HANDOFF_PAYLOAD = 1ULL << 30;
+
+// 随监听套接字一起发送的消息头，状态数据紧跟其后
+struct HandoffHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fdCount;
+    uint32_t reserved;
+    uint64_t payloadSize;
+};
+
+using Clock = std::chrono::steady_clock;
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::string_view& in, T& value) {
+    if (in.size() < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, in.data(), sizeof(value));
+    in.remove_prefix(sizeof(value));
+    return true;
+}
+
+// 等待fd可读直到deadline，超时返回false
+bool waitReadable(int fd, Clock::time_point deadline) {
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, static_cast<int>(remaining));
+        if (ready > 0) {
+            return true;
+        }
+        if (ready < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+bool readFully(int fd, char* data, size_t size, Clock::time_point deadline) {
+    while (size > 0) {
+        if (!waitReadable(fd, deadline)) {
+            return false;
+        }
+        ssize_t n = recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool writeFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool handoffAddress(const std::string& path, SocketAddress& address) {
+    if (!parseSocketAddress(UNIX_ADDRESS_PREFIX + path, 0, address)) {
+        LOG_ERROR("Invalid handoff path: %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::string encodeHandoffState(const HandoffState& state) {
+    std::string out;
+    appendValue<uint64_t>(out, state.nextPlayerId);
+    appendValue<uint32_t>(out, static_cast<uint32_t>(state.players.size()));
+    for (const auto& player : state.players) {
+        appendValue<uint64_t>(out, player.id);
+        appendValue<int32_t>(out, player.rating);
+        appendValue<uint8_t>(out, player.inQueue ? 1 : 0);
+        appendValue<uint64_t>(out, player.lastActivityTime);
+        appendValue<uint32_t>(out, static_cast<uint32_t>(player.name.size()));
+        out.append(player.name);
+    }
+    return out;
+}
+
+bool decodeHandoffState(std::string_view data, HandoffState& state) {
+    uint64_t nextPlayerId = 0;
+    uint32_t count = 0;
+    if (!readValue(data, nextPlayerId) || !readValue(data, count)) {
+        return false;
+    }
+
+    std::vector<PlayerSnapshot> players;
+    for (uint32_t i = 0; i < count; ++i) {
+        PlayerSnapshot player;
+        uint64_t id = 0;
+        int32_t rating = 0;
+        uint8_t inQueue = 0;
+        uint32_t nameSize = 0;
+        if (!readValue(data, id) || !readValue(data, rating) || !readValue(data, inQueue) ||
+            !readValue(data, player.lastActivityTime) || !readValue(data, nameSize) ||
+            nameSize > MAX_HANDOFF_NAME || data.size() < nameSize) {
+            return false;
+        }
+        player.id = id;
+        player.rating = rating;
+        player.inQueue = inQueue != 0;
+        player.name.assign(data.data(), nameSize);
+        data.remove_prefix(nameSize);
+        players.push_back(std::move(player));
+    }
+    if (!data.empty()) {
+        return false;
+    }
+
+    state.nextPlayerId = nextPlayerId;
+    state.players = std::move(players);
+    return true;
+}
+
+int listenHandoff(const std::string& path) {
+    SocketAddress address;
+    if (!handoffAddress(path, address)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create handoff socket: %s", strerror(errno));
+        return -1;
+    }
+
+    // 只替换套接字类型的文件，避免误删同名的普通文件
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path.c_str());
+    }
+    if (bind(fd, address.get(), address.length) < 0 || listen(fd, 1) < 0) {
+        LOG_ERROR("Failed to listen on handoff socket %s: %s", path.c_str(), strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int acceptHandoff(int listenFd, uint32_t timeoutMs) {
+    if (!waitReadable(listenFd, Clock::now() + std::chrono::milliseconds(timeoutMs))) {
+        return -1;
+    }
+    int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Failed to accept handoff connection: %s", strerror(errno));
+    }
+    return fd;
+}
+
+int connectHandoff(const std::string& path) {
+    SocketAddress address;
+    if (!handoffAddress(path, address)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create handoff socket: %s", strerror(errno));
+        return -1;
+    }
+    if (connect(fd, address.get(), address.length) < 0) {
+        LOG_ERROR("No process is waiting for a handoff at %s: %s", path.c_str(), strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendHandoff(int fd, const std::vector<int>& listenFds, const std::string& payload) {
+    if (listenFds.size() > MAX_HANDOFF_FDS) {
+        LOG_ERROR("Too many listen sockets to hand off: %zu", listenFds.size());
+        return false;
+    }
+
+    HandoffHeader header = {HANDOFF_MAGIC, HANDOFF_VERSION, static_cast<uint32_t>(listenFds.size()), 0,
+                            payload.size()};
+    struct iovec iov = {&header, sizeof(header)};
+
+    // 监听套接字作为辅助数据附在消息头上，接收方得到指向同一套接字的新描述符
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_HANDOFF_FDS)] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (!listenFds.empty()) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * listenFds.size());
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * listenFds.size());
+        std::memcpy(CMSG_DATA(cmsg), listenFds.data(), sizeof(int) * listenFds.size());
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent != static_cast<ssize_t>(sizeof(header))) {
+        LOG_ERROR("Failed to send handoff header: %s", sent < 0 ? strerror(errno) : "short write");
+        return false;
+    }
+    if (!writeFully(fd, payload.data(), payload.size())) {
+        LOG_ERROR("Failed to send handoff state: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool receiveHandoff(int fd, std::vector<int>& listenFds, std::string& payload, uint32_t timeoutMs) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    listenFds.clear();
+
+    HandoffHeader header = {};
+    struct iovec iov = {&header, sizeof(header)};
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_HANDOFF_FDS)] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (!waitReadable(fd, deadline)) {
+        LOG_ERROR("Timed out waiting for handoff data");
+        return false;
+    }
+    ssize_t received;
+    do {
+        received = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) {
+        LOG_ERROR("Failed to receive handoff header: %s", received < 0 ? strerror(errno) : "connection closed");
+        return false;
+    }
+
+    // 先取出描述符，之后任何失败都要关闭它们
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const unsigned char* data = CMSG_DATA(cmsg);
+            for (size_t i = 0; i < count; ++i) {
+                int passedFd;
+                std::memcpy(&passedFd, data + i * sizeof(int), sizeof(int));
+                listenFds.push_back(passedFd);
+            }
+        }
+    }
+    auto fail = [&listenFds](const char* reason) {
+        LOG_ERROR("Invalid handoff: %s", reason);
+        for (int listenFd : listenFds) {
+            close(listenFd);
+        }
+        listenFds.clear();
+        return false;
+    };
+
+    if ((msg.msg_flags & MSG_CTRUNC) != 0) {
+        return fail("too many listen sockets");
+    }
+    // 消息头可能被拆成多次到达，剩余部分不再携带描述符
+    if (static_cast<size_t>(received) < sizeof(header) &&
+        !readFully(fd, reinterpret_cast<char*>(&header) + received, sizeof(header) - received, deadline)) {
+        return fail("truncated header");
+    }
+    if (header.magic != HANDOFF_MAGIC || header.version != HANDOFF_VERSION) {
+        return fail("unknown header");
+    }
+    if (header.fdCount != listenFds.size()) {
+        return fail("listen socket count mismatch");
+    }
+    if (header.payloadSize > MAX_HANDOFF_PAYLOAD) {
+        return fail("state too large");
+    }
+
+    payload.resize(header.payloadSize);
+    if (!readFully(fd, payload.data(), payload.size(), deadline)) {
+        return fail("truncated state");
+    }
+    return true;
+}
+
+bool sendHandoffAck(int fd) {
+    return writeFully(fd, &HANDOFF_ACK, 1);
+}
+
+bool waitHandoffAck(int fd, uint32_t timeoutMs) {
+    char ack = 0;
+    return readFully(fd, &ack, 1, Clock::now() + std::chrono::milliseconds(timeoutMs)) && ack == HANDOFF_ACK;
+}
+
+} // namespace gmatch
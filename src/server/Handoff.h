@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../core/MatchManager.h"
+
+namespace gmatch {
+
+// 进程交接：重启时旧进程停止接受连接，把监听套接字(SCM_RIGHTS)和玩家状态经Unix域套接字交给新进程。
+// 新进程先在交接路径上监听，旧进程收到信号后连接过去发送，新进程确认后旧进程退出。
+// 监听套接字在两个进程间没有关闭过，交接期间到达的连接留在内核的等待队列中，由新进程接受
+
+// 单次交接最多传递的监听套接字数
+constexpr size_t MAX_HANDOFF_FDS = 64;
+
+// 交接的玩家状态
+struct HandoffState {
+    std::vector<PlayerSnapshot> players;
+    Player::PlayerId nextPlayerId = 1;
+};
+
+// 状态按本机字节序编码，只用于同一台机器上的两个进程之间；数据不完整时decode返回false
+std::string encodeHandoffState(const HandoffState& state);
+bool decodeHandoffState(std::string_view data, HandoffState& state);
+
+// 新进程：在path上创建交接监听套接字，已存在的套接字文件会被替换；失败时返回-1
+int listenHandoff(const std::string& path);
+// 新进程：等待旧进程连接，最多timeoutMs毫秒，超时或失败返回-1
+int acceptHandoff(int listenFd, uint32_t timeoutMs);
+// 旧进程：连接新进程的交接套接字，没有新进程在等待时返回-1
+int connectHandoff(const std::string& path);
+
+// 旧进程：发送监听套接字和编码后的状态
+bool sendHandoff(int fd, const std::vector<int>& listenFds, const std::string& payload);
+// 新进程：接收监听套接字和状态，最多等待timeoutMs毫秒；收到的套接字由调用方负责关闭
+bool receiveHandoff(int fd, std::vector<int>& listenFds, std::string& payload, uint32_t timeoutMs);
+
+// 新进程接收并恢复状态后确认，旧进程收到确认后才退出
+bool sendHandoffAck(int fd);
+bool waitHandoffAck(int fd, uint32_t timeoutMs);
+
+} // namespace gmatch
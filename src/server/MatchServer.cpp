@@ -1,20 +1,56 @@
 #include "MatchServer.h"
+#include "Handoff.h"
 #include "../util/Logger.h"
 #include "../util/Config.h"
-#include <sstream>
+#include "../util/JsonWriter.h"
+#include <unistd.h>
+#include <algorithm>
 
 namespace gmatch {
 
+namespace {
+// 请求队列已满时直接返回的响应，预先构造避免在过载时再分配
+const std::string SERVER_BUSY_RESPONSE = "{\"cmd\":\"error\",\"success\":false,\"message\":\"Server busy\"}";
+// 超过请求限速时返回的响应
+const std::string RATE_LIMITED_RESPONSE = "{\"cmd\":\"error\",\"success\":false,\"message\":\"Rate limit exceeded\"}";
+// 发给空闲连接的心跳
+const std::string HEARTBEAT_MESSAGE = "{\"cmd\":\"heartbeat\",\"success\":true,\"message\":\"ping\"}";
+// 交接时等待已提交请求处理完的最长时间
+constexpr uint32_t HANDOFF_DRAIN_TIMEOUT_MS = 2000;
+// 旧进程等待新进程启动并确认的最长时间
+constexpr uint32_t HANDOFF_ACK_TIMEOUT_MS = 10000;
+// 交接来的玩家等待客户端重新连接认领的时间
+constexpr uint32_t HANDOFF_CLAIM_TIMEOUT_MS = 30000;
+// 工作线程复用的响应缓冲区超过该容量时用完即释放，避免偶尔的大响应(如房间列表)长期占用内存
+constexpr size_t RESPONSE_BUFFER_RETAIN_BYTES = 64 * 1024;
+
+// 每个工作线程一个响应缓冲区，处理器直接把响应写入其中，稳定后生成响应不再分配内存
+std::string& acquireResponseBuffer() {
+    thread_local std::string buffer;
+    buffer.clear();
+    return buffer;
+}
+
+void releaseResponseBuffer(std::string& buffer) {
+    if (buffer.capacity() > RESPONSE_BUFFER_RETAIN_BYTES) {
+        std::string().swap(buffer);
+    }
+}
+}
+
 MatchServer::MatchServer(const std::string& address, uint16_t port) {
     server_ = std::make_unique<TcpServer>(address, port);
     requestHandler_ = std::make_unique<JsonRequestHandler>();
+    binaryHandler_ = std::make_unique<BinaryRequestHandler>();
+    // JSON请求以'{'开头，长度分帧的合法长度不会以魔数开头，默认允许协商二进制协议
+    server_->setBinaryProtocol(true);
     
     // 设置回调函数
     server_->setConnectionCallback([this](const TcpConnectionPtr& conn) {
         onClientConnected(conn);
     });
     
-    server_->setMessageCallback([this](const TcpConnectionPtr& conn, const std::string& message) {
+    server_->setMessageCallback([this](const TcpConnectionPtr& conn, std::string_view message) {
         onClientMessage(conn, message);
     });
     
@@ -22,14 +58,25 @@ MatchServer::MatchServer(const std::string& address, uint16_t port) {
         onClientDisconnected(conn);
     });
     
-    // 设置玩家创建回调
-    static_cast<JsonRequestHandler*>(requestHandler_.get())->setPlayerCreatedCallback(
-        [this](TcpConnection::ConnectionId clientId, Player::PlayerId playerId) {
-            std::lock_guard<std::mutex> lock(clientMapMutex_);
-            clientPlayerMap_[clientId] = playerId;
-            LOG_DEBUG("Mapped client %llu to player %llu", clientId, playerId);
-        }
-    );
+    // 设置玩家创建和认领回调，两种协议的处理器共用
+    auto playerCreated = [this](TcpConnection::ConnectionId clientId, Player::PlayerId playerId) {
+        std::lock_guard<std::mutex> lock(clientMapMutex_);
+        bindPlayer(clientId, playerId);
+        LOG_DEBUG("Mapped client %llu to player %llu", clientId, playerId);
+    };
+    auto playerClaimed = [this](TcpConnection::ConnectionId clientId, Player::PlayerId playerId) {
+        onPlayerClaimed(clientId, playerId);
+    };
+    requestHandler_->setPlayerCreatedCallback(playerCreated);
+    requestHandler_->setPlayerClaimedCallback(playerClaimed);
+    binaryHandler_->setPlayerCreatedCallback(playerCreated);
+    binaryHandler_->setPlayerClaimedCallback(playerClaimed);
+    
+    // 带id的请求由客户端按id对应响应，不需要按顺序完成：从连接的串行队列中分离，
+    // 同一连接的后续请求可以由其他工作线程同时处理
+    requestHandler_->setRequestIdCallback([this] {
+        executor_->detachCurrentTask();
+    });
     
     // 初始化匹配管理器
     auto& matchManager = MatchManager::getInstance();
@@ -58,7 +105,37 @@ bool MatchServer::start() {
     }
     
     LOG_INFO("Starting match server...");
-    return server_->start();
+    
+    // 先恢复交接来的玩家，再开始接受连接
+    bool takingOver = handoffChannel_ >= 0;
+    if (takingOver) {
+        MatchManager::getInstance().importPlayers(inheritedPlayers_, inheritedNextPlayerId_);
+        std::unordered_set<Player::PlayerId> players;
+        for (const auto& player : inheritedPlayers_) {
+            players.insert(player.id);
+        }
+        watchUnclaimedPlayers(std::move(players));
+        inheritedPlayers_.clear();
+        server_->adoptListenSockets(std::move(inheritedSockets_));
+        inheritedSockets_.clear();
+    }
+    
+    executor_ = std::make_unique<RequestExecutor>(requestWorkers_, maxPendingRequests_);
+    executor_->start();
+    bool started = server_->start();
+    if (!started) {
+        executor_->stop();
+    }
+    
+    // 启动失败时不确认，旧进程会恢复服务
+    if (takingOver) {
+        if (started && !sendHandoffAck(handoffChannel_)) {
+            LOG_WARNING("Failed to acknowledge handoff, the previous process may resume serving");
+        }
+        close(handoffChannel_);
+        handoffChannel_ = -1;
+    }
+    return started;
 }
 
 void MatchServer::stop() {
@@ -66,6 +143,12 @@ void MatchServer::stop() {
         LOG_INFO("Stopping match server...");
         server_->stop();
     }
+    stopClaimReaper();
+    
+    // 服务器停止后不再有新请求提交，等待正在处理的请求结束
+    if (executor_) {
+        executor_->stop();
+    }
     
     // 关闭匹配管理器
     MatchManager::getInstance().shutdown();
@@ -78,7 +161,17 @@ void MatchServer::setPlayersPerRoom(int playersPerRoom) {
     // 重新初始化匹配管理器
     auto& matchManager = MatchManager::getInstance();
     matchManager.shutdown();
-    matchManager.init(playersPerRoom);
+    matchManager.init(playersPerRoom, config.get<int>("match_workers", 0));
+}
+
+void MatchServer::setMatchWorkers(size_t workerCount) {
+    auto& config = Config::getInstance();
+    config.set("match_workers", static_cast<int>(workerCount));
+    
+    // 重新初始化匹配管理器
+    auto& matchManager = MatchManager::getInstance();
+    matchManager.shutdown();
+    matchManager.init(config.get<int>("players_per_room", 2), workerCount);
 }
 
 void MatchServer::setMaxRatingDifference(int maxDiff) {
@@ -89,6 +182,23 @@ void MatchServer::setMaxRatingDifference(int maxDiff) {
     MatchManager::getInstance().setMaxRatingDifference(maxDiff);
 }
 
+void MatchServer::setRatingExpansion(int maxDiff, int expandPerSecond, int maxDiffCap) {
+    auto& config = Config::getInstance();
+    config.set("max_rating_diff", maxDiff);
+    config.set("rating_expand_per_sec", expandPerSecond);
+    config.set("max_rating_diff_cap", maxDiffCap);
+    
+    MatchManager::getInstance().setMatchStrategy(
+        std::make_shared<WaitTimeExpandingStrategy>(maxDiff, expandPerSecond, maxDiffCap));
+}
+
+void MatchServer::setMatchAlgorithm(MatchAlgorithm algorithm) {
+    auto& config = Config::getInstance();
+    config.set("match_algorithm", std::string(matchAlgorithmName(algorithm)));
+    
+    MatchManager::getInstance().setMatchAlgorithm(algorithm);
+}
+
 void MatchServer::setLogLevel(LogLevel level) {
     Logger::getInstance().setLogLevel(level);
 }
@@ -105,42 +215,76 @@ void MatchServer::onClientConnected(const TcpConnectionPtr& conn) {
     LOG_INFO("Client connected: %llu", conn->getId());
 }
 
-void MatchServer::onClientMessage(const TcpConnectionPtr& conn, const std::string& message) {
-    LOG_DEBUG("Received message from client %llu: %s", conn->getId(), message.c_str());
+void MatchServer::onClientMessage(const TcpConnectionPtr& conn, std::string_view message) {
+    LOG_DEBUG("Received message from client %llu: %.*s", conn->getId(), static_cast<int>(message.size()), message.data());
     
-    // 处理请求
-    std::string response = requestHandler_->handleRequest(message, conn->getId());
-    
-    // 发送响应
-    conn->send(response);
+    // 在工作线程中处理请求并发送响应，I/O线程继续读取其他连接
+    // message指向接收缓冲区，处理前缓冲区就会被复用，这里是读路径上唯一一次复制，之后的解析都使用视图
+    // 按连接协商的协议选择处理器，协商在第一条消息之前已经完成
+    bool binary = conn->getProtocol() == WireProtocol::BINARY;
+    RequestHandler* handler = binary ? static_cast<RequestHandler*>(binaryHandler_.get()) : requestHandler_.get();
+    // 响应写入线程复用的缓冲区，编码成帧放入连接的发送队列时是唯一一次分配
+    bool accepted = executor_->submit(conn->getId(), [handler, conn, request = std::string(message)] {
+        std::string& response = acquireResponseBuffer();
+        handler->handleRequest(request, conn->getId(), response);
+        conn->send(response);
+        releaseResponseBuffer(response);
+    });
+    if (!accepted) {
+        LOG_WARNING("Request queue full, rejecting request from client %llu", conn->getId());
+        if (binary) {
+            conn->send(encodeBinaryError(message, BinaryStatus::SERVER_BUSY, "Server busy"));
+        } else {
+            std::string busy;
+            if (appendJsonWithRequestId(message, SERVER_BUSY_RESPONSE, busy)) {
+                conn->send(busy);
+            } else {
+                conn->send(SERVER_BUSY_RESPONSE);
+            }
+        }
+    }
 }
 
 void MatchServer::onClientDisconnected(const TcpConnectionPtr& conn) {
     LOG_INFO("Client disconnected: %llu", conn->getId());
     
+    // 等该连接已提交的请求(包括已分离的带id请求)都处理完才执行，避免先清理玩家、之后又处理该连接的加入请求
+    auto id = conn->getId();
+    bool submitted = executor_ && executor_->submitBarrier(id, [this, id] {
+        cleanupClient(id);
+        executor_->remove(id);
+    });
+    if (!submitted) {
+        cleanupClient(id);
+    }
+}
+
+void MatchServer::cleanupClient(TcpConnection::ConnectionId clientId) {
     // 如果客户端有关联的玩家，清理相关资源
-    Player::PlayerId playerId = 0;
+    std::vector<Player::PlayerId> playerIds;
     {
         std::lock_guard<std::mutex> lock(clientMapMutex_);
-        auto it = clientPlayerMap_.find(conn->getId());
-        if (it != clientPlayerMap_.end()) {
-            playerId = it->second;
-            LOG_DEBUG("Found player %llu for client %llu, removing mapping", playerId, conn->getId());
-            clientPlayerMap_.erase(it);
-        } else {
-            LOG_DEBUG("No player mapping found for client %llu", conn->getId());
+        auto it = clientPlayers_.find(clientId);
+        if (it == clientPlayers_.end()) {
+            LOG_DEBUG("No player mapping found for client %llu", clientId);
             return;  // 如果没有关联的玩家，直接返回
         }
+        playerIds = std::move(it->second);
+        clientPlayers_.erase(it);
+        for (auto playerId : playerIds) {
+            playerClients_.erase(playerId);
+        }
+        LOG_DEBUG("Found %zu players for client %llu, removing mapping", playerIds.size(), clientId);
     }
     
     // 在释放map锁后再调用removePlayer，避免死锁
-    if (playerId > 0) {
+    auto& matchManager = MatchManager::getInstance();
+    for (auto playerId : playerIds) {
         try {
             LOG_DEBUG("Removing player %llu from MatchManager", playerId);
-            auto& matchManager = MatchManager::getInstance();
             if (!matchManager.getPlayer(playerId)) {
                 LOG_WARNING("Player %llu already removed or not found", playerId);
-                return;
+                continue;
             }
             matchManager.removePlayer(playerId);
             LOG_DEBUG("Player %llu successfully removed", playerId);
@@ -160,55 +304,95 @@ void MatchServer::onMatchNotify(const RoomPtr& room) {
     LOG_INFO("Match found! Room ID: %llu, Players: %d/%d", 
              room->getId(), room->getPlayerCount(), room->getCapacity());
     
-    // 创建通知消息
-    std::ostringstream oss;
-    oss << "{\"room_id\":" << room->getId()
-        << ",\"players\":[";
-    
+    // 创建通知消息，按玩家数预留空间，名称较短时只分配一次
     auto players = room->getPlayers();
-    for (size_t i = 0; i < players.size(); ++i) {
-        if (i > 0) {
-            oss << ",";
-        }
-        oss << "{\"player_id\":" << players[i]->getId()
-            << ",\"name\":\"" << players[i]->getName()
-            << "\",\"rating\":" << players[i]->getRating()
-            << "}";
+    std::string notification;
+    notification.reserve(128 + players.size() * 80);
+    JsonWriter json(notification);
+    json.beginObject()
+        .key("cmd").string("match_notify")
+        .key("success").boolean(true)
+        .key("message").string("Match found")
+        .key("data").beginObject()
+        .key("room_id").integer(room->getId())
+        .key("teams").integer(room->getTeamCount())
+        .key("players").beginArray();
+    for (const auto& player : players) {
+        json.beginObject()
+            .key("player_id").integer(player->getId())
+            .key("name").string(player->getName())
+            .key("rating").integer(player->getRating())
+            .key("team").integer(room->getTeam(player->getId()))
+            .endObject();
     }
+    json.endArray().endObject().endObject();
     
-    oss << "]}";
-    
-    std::string notification = "{\"cmd\":\"match_notify\",\"success\":true,\"message\":\"Match found\",\"data\":"
-                               + oss.str() + "}";
+    // 二进制协议的通知
+    std::string binaryNotification;
+    binaryNotification.reserve(BINARY_HEADER_SIZE + 12 + players.size() * 32);
+    BinaryWriter writer(binaryNotification);
+    writer.header(BinaryOpcode::MATCH_NOTIFY, BinaryStatus::OK, 0);
+    writer.u64(room->getId());
+    writer.u16(static_cast<uint16_t>(room->getTeamCount()));
+    writer.u16(static_cast<uint16_t>(players.size()));
+    for (const auto& player : players) {
+        writer.u64(player->getId());
+        writer.i32(player->getRating());
+        writer.i16(static_cast<int16_t>(room->getTeam(player->getId())));
+        writer.str(player->getName());
+    }
     
     // 向所有匹配的玩家发送通知
-    std::lock_guard<std::mutex> lock(clientMapMutex_);
-    for (const auto& player : players) {
-        for (const auto& pair : clientPlayerMap_) {
-            if (pair.second == player->getId()) {
-                server_->sendToClient(pair.first, notification);
-                break;
+    // 同一连接代理的多个玩家在同一房间时只发送一次
+    std::vector<TcpConnection::ConnectionId> clients;
+    {
+        std::lock_guard<std::mutex> lock(clientMapMutex_);
+        for (const auto& player : players) {
+            auto it = playerClients_.find(player->getId());
+            if (it != playerClients_.end() &&
+                std::find(clients.begin(), clients.end(), it->second) == clients.end()) {
+                clients.push_back(it->second);
             }
         }
     }
+    for (auto clientId : clients) {
+        server_->sendToClient(clientId, notification, binaryNotification);
+    }
 }
 
 void MatchServer::onPlayerStatusChanged(Player::PlayerId playerId, bool inQueue) {
     LOG_DEBUG("Player %llu %s queue", playerId, inQueue ? "joined" : "left");
     
     // 向客户端发送状态变更通知
-    std::string status = inQueue ? "in_queue" : "left_queue";
-    std::string notification = "{\"cmd\":\"status_changed\",\"success\":true,\"message\":\"Player status changed\","
-                               "\"data\":{\"player_id\":" + std::to_string(playerId) + 
-                               ",\"status\":\"" + status + "\"}}";
+    std::string notification;
+    notification.reserve(128);
+    JsonWriter json(notification);
+    json.beginObject()
+        .key("cmd").string("status_changed")
+        .key("success").boolean(true)
+        .key("message").string("Player status changed")
+        .key("data").beginObject()
+        .key("player_id").integer(playerId)
+        .key("status").string(inQueue ? "in_queue" : "left_queue")
+        .endObject()
+        .endObject();
     
-    std::lock_guard<std::mutex> lock(clientMapMutex_);
-    for (const auto& pair : clientPlayerMap_) {
-        if (pair.second == playerId) {
-            server_->sendToClient(pair.first, notification);
-            break;
+    std::string binaryNotification;
+    BinaryWriter writer(binaryNotification);
+    writer.header(BinaryOpcode::STATUS_CHANGED, BinaryStatus::OK, 0);
+    writer.u64(playerId);
+    writer.u8(inQueue ? 1 : 0);
+    
+    TcpConnection::ConnectionId clientId;
+    {
+        std::lock_guard<std::mutex> lock(clientMapMutex_);
+        auto it = playerClients_.find(playerId);
+        if (it == playerClients_.end()) {
+            return;
         }
+        clientId = it->second;
     }
+    server_->sendToClient(clientId, notification, binaryNotification);
 }
 
 void MatchServer::setForceMatchOnTimeout(bool enable) {
@@ -221,9 +405,361 @@ void MatchServer::setMatchTimeoutThreshold(uint64_t ms) {
     matchManager.setMatchTimeoutThreshold(ms);
 }
 
+void MatchServer::setMatchInterval(uint32_t ms) {
+    auto& matchManager = MatchManager::getInstance();
+    matchManager.setMatchInterval(ms);
+}
+
+void MatchServer::setEventDrivenMatching(bool enable) {
+    auto& matchManager = MatchManager::getInstance();
+    matchManager.setEventDrivenMatching(enable);
+}
+
+void MatchServer::setMatchCoalesceWindow(uint32_t ms) {
+    auto& matchManager = MatchManager::getInstance();
+    matchManager.setMatchCoalesceWindow(ms);
+}
+
+void MatchServer::setTeamCount(int teamCount) {
+    auto& config = Config::getInstance();
+    config.set("team_count", teamCount);
+    
+    MatchManager::getInstance().setTeamCount(teamCount);
+}
+
+void MatchServer::setTeamBalanceBudget(uint32_t us) {
+    auto& config = Config::getInstance();
+    config.set("team_balance_budget_us", static_cast<int>(us));
+    
+    MatchManager::getInstance().setTeamBalanceBudget(us);
+}
+
+void MatchServer::setIoModel(IoModel model) {
+    auto& config = Config::getInstance();
+    config.set("io_model", std::string(ioModelName(model)));
+    
+    server_->setIoModel(model);
+}
+
+void MatchServer::setIoThreads(size_t threadCount) {
+    auto& config = Config::getInstance();
+    config.set("io_threads", static_cast<int>(threadCount));
+    
+    server_->setIoThreads(threadCount);
+}
+
+void MatchServer::setReusePort(bool enable) {
+    auto& config = Config::getInstance();
+    config.set("reuse_port", enable ? 1 : 0);
+    
+    server_->setReusePort(enable);
+}
+
+void MatchServer::setListenAddresses(const std::string& addresses) {
+    auto& config = Config::getInstance();
+    config.set("listen", addresses);
+    
+    std::istringstream stream(addresses);
+    std::string address;
+    while (std::getline(stream, address, ',')) {
+        address.erase(0, address.find_first_not_of(" \t"));
+        address.erase(address.find_last_not_of(" \t") + 1);
+        if (!address.empty()) {
+            server_->addListenAddress(address);
+        }
+    }
+}
+
+void MatchServer::setHandoffPath(const std::string& path) {
+    auto& config = Config::getInstance();
+    config.set("handoff_path", path);
+    
+    handoffPath_ = path;
+}
+
+bool MatchServer::takeover(uint32_t timeoutMs) {
+    if (handoffPath_.empty()) {
+        LOG_ERROR("Takeover requested but no handoff path is set");
+        return false;
+    }
+    
+    int listenFd = listenHandoff(handoffPath_);
+    if (listenFd < 0) {
+        return false;
+    }
+    LOG_INFO("Waiting up to %u ms for the running server to hand off at %s", timeoutMs, handoffPath_.c_str());
+    int channel = acceptHandoff(listenFd, timeoutMs);
+    close(listenFd);
+    unlink(handoffPath_.c_str());
+    if (channel < 0) {
+        LOG_ERROR("No server handed off at %s", handoffPath_.c_str());
+        return false;
+    }
+    
+    std::vector<int> listenFds;
+    std::string payload;
+    HandoffState state;
+    if (!receiveHandoff(channel, listenFds, payload, HANDOFF_ACK_TIMEOUT_MS)) {
+        close(channel);
+        return false;
+    }
+    if (!decodeHandoffState(payload, state)) {
+        LOG_ERROR("Invalid handoff state (%zu bytes)", payload.size());
+        for (int fd : listenFds) {
+            close(fd);
+        }
+        close(channel);
+        return false;
+    }
+    
+    LOG_INFO("Received %zu listen sockets and %zu players from the previous server", listenFds.size(),
+             state.players.size());
+    handoffChannel_ = channel;
+    inheritedSockets_ = std::move(listenFds);
+    inheritedPlayers_ = std::move(state.players);
+    inheritedNextPlayerId_ = state.nextPlayerId;
+    return true;
+}
+
+bool MatchServer::handoff() {
+    if (handoffPath_.empty()) {
+        LOG_ERROR("Handoff requested but no handoff path is set");
+        return false;
+    }
+    if (!isRunning()) {
+        return false;
+    }
+    
+    // 先确认有新进程在等待，否则不做任何改变
+    int channel = connectHandoff(handoffPath_);
+    if (channel < 0) {
+        return false;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    LOG_INFO("Handing off to the server waiting at %s", handoffPath_.c_str());
+    
+    // 停止接受连接，新连接留在监听套接字的队列中；停止匹配，之后不会再产生需要通知的房间
+    std::vector<int> listenFds = server_->releaseListenSockets();
+    auto& matchManager = MatchManager::getInstance();
+    matchManager.stopMatching();
+    
+    // 关闭已有连接，不再有新请求提交；已提交的请求处理完后玩家状态不再变化
+    server_->stop();
+    if (executor_) {
+        if (!executor_->waitIdle(HANDOFF_DRAIN_TIMEOUT_MS)) {
+            LOG_WARNING("Requests still pending after %u ms, dropping them", HANDOFF_DRAIN_TIMEOUT_MS);
+        }
+        executor_->stop();
+    }
+    
+    HandoffState state;
+    state.players = matchManager.exportPlayers(state.nextPlayerId);
+    bool handedOff = sendHandoff(channel, listenFds, encodeHandoffState(state)) &&
+                     waitHandoffAck(channel, HANDOFF_ACK_TIMEOUT_MS);
+    close(channel);
+    
+    if (!handedOff) {
+        // 监听套接字仍在本进程中，连接已关闭，客户端重新连接后认领自己的玩家
+        LOG_ERROR("Handoff was not acknowledged, resuming service");
+        matchManager.resumeMatching();
+        orphanConnectedPlayers();
+        server_->adoptListenSockets(std::move(listenFds));
+        executor_->start();
+        if (!server_->start()) {
+            LOG_ERROR("Failed to resume service after handoff failure");
+        }
+        return false;
+    }
+    
+    for (int fd : listenFds) {
+        close(fd);
+    }
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    LOG_INFO("Handed off %zu listen sockets and %zu players in %lld ms", listenFds.size(), state.players.size(),
+             static_cast<long long>(elapsedMs));
+    return true;
+}
+
+void MatchServer::orphanConnectedPlayers() {
+    std::unordered_set<Player::PlayerId> players;
+    {
+        std::lock_guard<std::mutex> lock(clientMapMutex_);
+        for (const auto& pair : playerClients_) {
+            players.insert(pair.first);
+        }
+        clientPlayers_.clear();
+        playerClients_.clear();
+    }
+    watchUnclaimedPlayers(std::move(players));
+}
+
+void MatchServer::watchUnclaimedPlayers(std::unordered_set<Player::PlayerId> players) {
+    if (players.empty()) {
+        return;
+    }
+    
+    // 已有的等待线程带着尚未认领的玩家一起重新计时
+    stopClaimReaper();
+    std::lock_guard<std::mutex> lock(clientMapMutex_);
+    unclaimedPlayers_.insert(players.begin(), players.end());
+    claimDeadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(HANDOFF_CLAIM_TIMEOUT_MS);
+    stopClaimReaper_ = false;
+    claimReaper_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(clientMapMutex_);
+        while (!stopClaimReaper_ && std::chrono::steady_clock::now() < claimDeadline_) {
+            claimReaperCondition_.wait_until(lock, claimDeadline_);
+        }
+        if (stopClaimReaper_) {
+            return;
+        }
+        auto unclaimed = std::move(unclaimedPlayers_);
+        unclaimedPlayers_.clear();
+        lock.unlock();
+        
+        auto& matchManager = MatchManager::getInstance();
+        for (auto playerId : unclaimed) {
+            if (matchManager.getPlayer(playerId)) {
+                matchManager.removePlayer(playerId);
+            }
+        }
+        if (!unclaimed.empty()) {
+            LOG_INFO("Removed %zu players not claimed within %u ms", unclaimed.size(), HANDOFF_CLAIM_TIMEOUT_MS);
+        }
+    });
+}
+
+void MatchServer::stopClaimReaper() {
+    {
+        std::lock_guard<std::mutex> lock(clientMapMutex_);
+        stopClaimReaper_ = true;
+    }
+    claimReaperCondition_.notify_all();
+    if (claimReaper_.joinable()) {
+        claimReaper_.join();
+    }
+}
+
+void MatchServer::onPlayerClaimed(TcpConnection::ConnectionId clientId, Player::PlayerId playerId) {
+    std::lock_guard<std::mutex> lock(clientMapMutex_);
+    if (unclaimedPlayers_.erase(playerId) > 0) {
+        bindPlayer(clientId, playerId);
+        LOG_DEBUG("Client %llu claimed player %llu", clientId, playerId);
+    }
+}
+
+void MatchServer::bindPlayer(TcpConnection::ConnectionId clientId, Player::PlayerId playerId) {
+    auto [it, inserted] = playerClients_.emplace(playerId, clientId);
+    if (!inserted) {
+        if (it->second == clientId) {
+            return;
+        }
+        // 玩家改由另一个连接代理，从原连接的列表中移除
+        auto& previous = clientPlayers_[it->second];
+        previous.erase(std::remove(previous.begin(), previous.end(), playerId), previous.end());
+        it->second = clientId;
+    }
+    clientPlayers_[clientId].push_back(playerId);
+}
+
+void MatchServer::setFramingMode(FramingMode mode) {
+    auto& config = Config::getInstance();
+    config.set("framing", std::string(framingModeName(mode)));
+    
+    server_->setFramingMode(mode);
+}
+
+void MatchServer::setMaxFrameSize(size_t maxFrameSize) {
+    auto& config = Config::getInstance();
+    config.set("max_frame_size", static_cast<int>(maxFrameSize));
+    
+    server_->setMaxFrameSize(maxFrameSize);
+}
+
+void MatchServer::setBinaryProtocol(bool enable) {
+    auto& config = Config::getInstance();
+    config.set("binary_protocol", enable ? 1 : 0);
+    
+    server_->setBinaryProtocol(enable);
+}
+
+void MatchServer::setSendHighWaterMark(size_t bytes) {
+    auto& config = Config::getInstance();
+    config.set("send_high_water_mark", static_cast<int>(bytes));
+    
+    server_->setSendHighWaterMark(bytes);
+}
+
+void MatchServer::setSlowConsumerPolicy(SlowConsumerPolicy policy) {
+    auto& config = Config::getInstance();
+    config.set("slow_consumer_policy", std::string(slowConsumerPolicyName(policy)));
+    
+    server_->setSlowConsumerPolicy(policy);
+}
+
+void MatchServer::setIdleTimeout(uint32_t ms) {
+    auto& config = Config::getInstance();
+    config.set("idle_timeout_ms", static_cast<int>(ms));
+    
+    server_->setIdleTimeout(ms);
+}
+
+void MatchServer::setHeartbeatInterval(uint32_t ms) {
+    auto& config = Config::getInstance();
+    config.set("heartbeat_interval_ms", static_cast<int>(ms));
+    
+    server_->setHeartbeat(ms, HEARTBEAT_MESSAGE);
+}
+
+void MatchServer::setMaxConnections(size_t maxConnections) {
+    auto& config = Config::getInstance();
+    config.set("max_connections", static_cast<int>(maxConnections));
+    
+    server_->setMaxConnections(maxConnections);
+}
+
+void MatchServer::setRequestRateLimit(uint32_t requestsPerSecond, uint32_t burst) {
+    auto& config = Config::getInstance();
+    config.set("request_rate_limit", static_cast<int>(requestsPerSecond));
+    config.set("request_burst", static_cast<int>(burst));
+    
+    server_->setRateLimit(requestsPerSecond, burst, RATE_LIMITED_RESPONSE);
+}
+
+void MatchServer::setRequestWorkers(size_t workerCount) {
+    auto& config = Config::getInstance();
+    config.set("request_workers", static_cast<int>(workerCount));
+    
+    requestWorkers_ = workerCount;
+}
+
+void MatchServer::setMaxPendingRequests(size_t maxPending) {
+    auto& config = Config::getInstance();
+    config.set("max_pending_requests", static_cast<int>(maxPending));
+    
+    maxPendingRequests_ = maxPending;
+}
+
+RequestExecutor::Stats MatchServer::getRequestStats() const {
+    return executor_ ? executor_->getStats() : RequestExecutor::Stats();
+}
+
 void MatchServer::printMatchmakingStatus(std::ostream& out) const {
     auto& matchManager = MatchManager::getInstance();
     matchManager.printMatchmakingStatus(out);
+    
+    if (executor_) {
+        auto stats = executor_->getStats();
+        out << "Requests: depth " << stats.queueDepth << " (peak " << stats.peakQueueDepth << "/"
+            << executor_->getMaxPending() << "), completed " << stats.completed << ", rejected " << stats.rejected
+            << ", stolen " << stats.stolen << "\n";
+        out << "  wait avg " << stats.avgQueueWaitUs << " us, handler avg " << stats.avgHandlerUs << " us, p50 <"
+            << stats.p50HandlerUs << " us, p99 <" << stats.p99HandlerUs << " us, max " << stats.maxHandlerUs
+            << " us" << std::endl;
+    }
+    
+    out << "Connections: " << server_->getConnectionCount() << ", rejected " << server_->getRejectedConnections()
+        << ", rate limited requests " << server_->getRateLimitedRequests() << std::endl;
 }
 
 } // namespace gmatch 
\ No newline at end of file
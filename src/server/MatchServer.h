@@ -2,8 +2,14 @@
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
 #include "TcpServer.h"
 #include "RequestHandler.h"
+#include "BinaryRequestHandler.h"
+#include "RequestExecutor.h"
 #include "../core/MatchManager.h"
 #include "../util/Logger.h"
 
@@ -18,14 +24,93 @@ public:
     void stop();
     
     void setPlayersPerRoom(int playersPerRoom);
+    
+    // 设置匹配工作线程数，0表示使用硬件并发数
+    void setMatchWorkers(size_t workerCount);
     void setMaxRatingDifference(int maxDiff);
     
+    // 启用随等待时间放宽的评分差异：从maxDiff起每秒放宽expandPerSecond，上限maxDiffCap
+    void setRatingExpansion(int maxDiff, int expandPerSecond, int maxDiffCap);
+    
+    // 设置批量匹配算法
+    void setMatchAlgorithm(MatchAlgorithm algorithm);
+    
     // 设置是否启用超时强制匹配
     void setForceMatchOnTimeout(bool enable);
     
     // 设置超时强制匹配的阈值(毫秒)
     void setMatchTimeoutThreshold(uint64_t ms);
     
+    // 设置匹配轮询间隔(毫秒)
+    void setMatchInterval(uint32_t ms);
+    
+    // 设置是否由队列变化唤醒匹配线程
+    void setEventDrivenMatching(bool enable);
+    
+    // 设置匹配合并窗口(毫秒)
+    void setMatchCoalesceWindow(uint32_t ms);
+    
+    // 设置每个房间的队伍数，不大于1时不分队
+    void setTeamCount(int teamCount);
+    
+    // 设置每个房间分队的时间预算(微秒)
+    void setTeamBalanceBudget(uint32_t us);
+    
+    // 设置网络I/O模型和I/O线程数(0表示使用硬件并发数)，需在start()之前调用
+    void setIoModel(IoModel model);
+    void setIoThreads(size_t threadCount);
+    
+    // 为每个I/O线程打开一个SO_REUSEPORT监听套接字，需在start()之前调用
+    void setReusePort(bool enable);
+    
+    // 在主地址之外同时监听的地址，逗号分隔，如"[::]:8080, unix:/run/gmatch.sock"，需在start()之前调用
+    void setListenAddresses(const std::string& addresses);
+    
+    // 设置消息分帧方式和单帧最大字节数，需在start()之前调用
+    void setFramingMode(FramingMode mode);
+    void setMaxFrameSize(size_t maxFrameSize);
+    
+    // 允许客户端在连接开头协商二进制协议(见BinaryProtocol.h)，需在start()之前调用
+    void setBinaryProtocol(bool enable);
+    
+    // 设置每个连接发送缓冲区的高水位(字节)及慢消费者的处理方式，需在start()之前调用
+    void setSendHighWaterMark(size_t bytes);
+    void setSlowConsumerPolicy(SlowConsumerPolicy policy);
+    
+    // 设置空闲连接超时(毫秒)和心跳间隔(毫秒)，0表示关闭，需在start()之前调用
+    // 客户端收到心跳后回复一个空帧即可保持连接
+    void setIdleTimeout(uint32_t ms);
+    void setHeartbeatInterval(uint32_t ms);
+    
+    // 设置同时保持的连接数上限，0表示不限制，需在start()之前调用
+    void setMaxConnections(size_t maxConnections);
+    // 设置每个连接每秒的请求数上限和允许的突发请求数，0表示不限速，需在start()之前调用
+    // 超过限速的请求不做处理，直接返回预先编码的错误响应
+    void setRequestRateLimit(uint32_t requestsPerSecond, uint32_t burst);
+    
+    // 设置进程交接使用的Unix域套接字路径，空串表示不支持交接
+    void setHandoffPath(const std::string& path);
+    
+    // 新进程：在交接路径上等待旧进程交出监听套接字和玩家状态，最多等待timeoutMs毫秒，需在start()之前调用。
+    // 收到的套接字和玩家在start()中接手，start()成功后才向旧进程确认
+    bool takeover(uint32_t timeoutMs);
+    
+    // 旧进程：停止接受连接，关闭已有连接并等待已提交的请求处理完，把监听套接字和玩家状态交给
+    // 在交接路径上等待的新进程。成功后服务器停止；没有新进程等待时不做任何改变，
+    // 新进程没有确认时恢复服务。返回是否已交接
+    bool handoff();
+    
+    // 设置请求处理线程数(0表示使用硬件并发数)和等待处理的请求数上限，需在start()之前调用
+    void setRequestWorkers(size_t workerCount);
+    void setMaxPendingRequests(size_t maxPending);
+    
+    // 请求处理的排队深度和耗时指标，服务器未启动时返回空指标
+    RequestExecutor::Stats getRequestStats() const;
+    
+    // 因连接数上限被拒绝的连接数和因限速被拒绝的请求数
+    uint64_t getRejectedConnections() const { return server_->getRejectedConnections(); }
+    uint64_t getRateLimitedRequests() const { return server_->getRateLimitedRequests(); }
+    
     // 输出当前匹配系统状态
     void printMatchmakingStatus(std::ostream& out = std::cout) const;
     
@@ -36,18 +121,50 @@ public:
     
 private:
     void onClientConnected(const TcpConnectionPtr& conn);
-    void onClientMessage(const TcpConnectionPtr& conn, const std::string& message);
+    void onClientMessage(const TcpConnectionPtr& conn, std::string_view message);
     void onClientDisconnected(const TcpConnectionPtr& conn);
+    // 移除连接关联的玩家
+    void cleanupClient(TcpConnection::ConnectionId clientId);
+    
+    // 交接来的玩家等待客户端重新连接认领，超时未认领的玩家被移除
+    void watchUnclaimedPlayers(std::unordered_set<Player::PlayerId> players);
+    void onPlayerClaimed(TcpConnection::ConnectionId clientId, Player::PlayerId playerId);
+    void stopClaimReaper();
+    // 把玩家关联到连接，调用方持有clientMapMutex_
+    void bindPlayer(TcpConnection::ConnectionId clientId, Player::PlayerId playerId);
+    // 把已关闭连接关联的玩家转为待认领，交接失败恢复服务时使用
+    void orphanConnectedPlayers();
     
     void onMatchNotify(const RoomPtr& room);
     void onPlayerStatusChanged(Player::PlayerId playerId, bool inQueue);
     
     std::unique_ptr<TcpServer> server_;
     std::unique_ptr<JsonRequestHandler> requestHandler_;
+    std::unique_ptr<BinaryRequestHandler> binaryHandler_;
+    
+    // 请求在工作线程中处理，同一连接的请求按顺序执行
+    std::unique_ptr<RequestExecutor> executor_;
+    size_t requestWorkers_ = 0;
+    size_t maxPendingRequests_ = RequestExecutor::DEFAULT_MAX_PENDING;
     
-    std::unordered_map<TcpConnection::ConnectionId, Player::PlayerId> clientPlayerMap_;
+    // 每个连接创建或认领的玩家(网关通过一个连接代理多个玩家)，以及玩家所在的连接，用于按玩家发送通知
+    std::unordered_map<TcpConnection::ConnectionId, std::vector<Player::PlayerId>> clientPlayers_;
+    std::unordered_map<Player::PlayerId, TcpConnection::ConnectionId> playerClients_;
     std::mutex clientMapMutex_;
     
+    // 进程交接
+    std::string handoffPath_;
+    int handoffChannel_ = -1;             // takeover()收到状态后保留到start()确认
+    std::vector<int> inheritedSockets_;
+    std::vector<PlayerSnapshot> inheritedPlayers_;
+    Player::PlayerId inheritedNextPlayerId_ = 1;
+    // 尚未被重新连接的客户端认领的玩家，由clientMapMutex_保护
+    std::unordered_set<Player::PlayerId> unclaimedPlayers_;
+    std::thread claimReaper_;
+    std::condition_variable claimReaperCondition_;
+    std::chrono::steady_clock::time_point claimDeadline_;
+    bool stopClaimReaper_ = false;
+    
     bool initialized_ = false;
 };
 
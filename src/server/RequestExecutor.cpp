@@ -0,0 +1,352 @@
+#include "RequestExecutor.h"
+#include <algorithm>
+#include "../util/Logger.h"
+
+namespace gmatch {
+
+namespace {
+// 一个strand连续执行的任务数上限，超过后让出工作线程，避免请求密集的连接饿死其他连接
+constexpr size_t MAX_TASKS_PER_TURN = 16;
+
+// 当前线程所属的执行器及工作线程序号，用于把工作线程内提交的任务留在本线程
+thread_local const RequestExecutor* currentExecutor = nullptr;
+thread_local size_t currentWorker = 0;
+
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+}
+
+RequestExecutor::RequestExecutor(size_t workerCount, size_t maxPending)
+    : workerCount_(workerCount), maxPending_(std::max<size_t>(maxPending, 1)) {
+    if (workerCount_ == 0) {
+        workerCount_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+RequestExecutor::~RequestExecutor() {
+    stop();
+}
+
+void RequestExecutor::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+
+    for (size_t i = 0; i < workerCount_; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workerCount_; ++i) {
+        workers_[i]->thread = std::thread(&RequestExecutor::workerLoop, this, i);
+    }
+    LOG_INFO("Request executor started with %zu workers (max pending %zu)", workerCount_, maxPending_);
+}
+
+void RequestExecutor::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+    }
+    idleCondition_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    workers_.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(strandsMutex_);
+        strands_.clear();
+    }
+    size_t dropped = pending_.exchange(0);
+    readyStrands_ = 0;
+    if (dropped > 0) {
+        LOG_WARNING("Request executor stopped with %zu pending tasks dropped", dropped);
+    }
+}
+
+bool RequestExecutor::waitIdle(uint32_t timeoutMs) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (pending_ > 0) {
+        if (!running_ || Clock::now() >= deadline) {
+            return pending_ == 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+bool RequestExecutor::submit(Key key, Task task, bool force) {
+    return enqueue(key, std::move(task), force, false);
+}
+
+bool RequestExecutor::submitBarrier(Key key, Task task) {
+    return enqueue(key, std::move(task), true, true);
+}
+
+bool RequestExecutor::enqueue(Key key, Task task, bool force, bool barrier) {
+    if (!running_) {
+        return false;
+    }
+
+    // 先占用名额再入队，超过上限时退回
+    size_t depth = pending_.fetch_add(1) + 1;
+    if (!force && depth > maxPending_) {
+        pending_.fetch_sub(1);
+        ++rejected_;
+        return false;
+    }
+    ++submitted_;
+    updateMax(peakPending_, depth);
+
+    StrandPtr strand;
+    {
+        std::lock_guard<std::mutex> lock(strandsMutex_);
+        auto& slot = strands_[key];
+        if (!slot) {
+            slot = std::make_shared<Strand>();
+            slot->home = static_cast<size_t>(key % workerCount_);
+        }
+        strand = slot;
+    }
+
+    bool needSchedule = false;
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        strand->tasks.push_back(PendingTask{std::move(task), Clock::now(), barrier});
+        if (!strand->scheduled) {
+            strand->scheduled = true;
+            needSchedule = true;
+        }
+    }
+    if (needSchedule) {
+        schedule(strand);
+    }
+    return true;
+}
+
+bool RequestExecutor::detachCurrentTask() {
+    if (currentExecutor != this) {
+        return false;
+    }
+    Worker& worker = *workers_[currentWorker];
+    if (!worker.current || worker.detached) {
+        return false;
+    }
+    worker.detached = true;
+
+    // strand交给其他工作线程继续执行，本线程执行完当前任务后不再回到这个strand
+    const StrandPtr& strand = *worker.current;
+    bool needSchedule = false;
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        ++strand->detached;
+        if (strand->tasks.empty()) {
+            strand->scheduled = false;
+        } else {
+            needSchedule = true;
+        }
+    }
+    if (needSchedule) {
+        schedule(strand);
+    }
+    return true;
+}
+
+void RequestExecutor::finishDetached(const StrandPtr& strand) {
+    bool resume = false;
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        if (--strand->detached == 0 && strand->blocked) {
+            strand->blocked = false;
+            resume = true;
+        }
+    }
+    if (resume) {
+        schedule(strand);
+    }
+}
+
+void RequestExecutor::remove(Key key) {
+    std::lock_guard<std::mutex> lock(strandsMutex_);
+    strands_.erase(key);
+}
+
+void RequestExecutor::schedule(const StrandPtr& strand) {
+    size_t target = currentExecutor == this ? currentWorker : strand->home;
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->ready.push_back(strand);
+    }
+    readyStrands_.fetch_add(1);
+
+    // 空闲线程先登记再检查readyStrands_，这里先增加readyStrands_再检查登记，两者至少有一方看到对方
+    if (idleWorkers_.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex_);
+        }
+        idleCondition_.notify_one();
+    }
+}
+
+RequestExecutor::StrandPtr RequestExecutor::takeStrand(size_t index) {
+    // 先取自己的就绪队列，再按顺序从其他工作线程窃取最早就绪的strand
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        size_t victim = (index + i) % workers_.size();
+        Worker& worker = *workers_[victim];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.ready.empty()) {
+            continue;
+        }
+        StrandPtr strand = std::move(worker.ready.front());
+        worker.ready.pop_front();
+        readyStrands_.fetch_sub(1);
+        if (victim != index) {
+            ++stolen_;
+        }
+        return strand;
+    }
+    return nullptr;
+}
+
+void RequestExecutor::runStrand(const StrandPtr& strand, size_t index) {
+    Worker& worker = *workers_[index];
+    for (size_t executed = 0; executed < MAX_TASKS_PER_TURN; ++executed) {
+        PendingTask pending;
+        {
+            std::lock_guard<std::mutex> lock(strand->mutex);
+            if (strand->tasks.empty()) {
+                strand->scheduled = false;
+                return;
+            }
+            // 屏障任务等已分离的任务完成，保持scheduled，期间提交的任务不会再次调度这个strand
+            if (strand->tasks.front().barrier && strand->detached > 0) {
+                strand->blocked = true;
+                return;
+            }
+            pending = std::move(strand->tasks.front());
+            strand->tasks.pop_front();
+        }
+
+        worker.current = &strand;
+        worker.detached = false;
+        auto startTime = Clock::now();
+        try {
+            pending.task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Exception in request task: %s", e.what());
+        } catch (...) {
+            LOG_ERROR("Unknown exception in request task");
+        }
+        worker.current = nullptr;
+        recordLatency(pending.enqueueTime, startTime, Clock::now());
+        pending_.fetch_sub(1);
+        ++completed_;
+
+        // 分离后strand已经交给其他工作线程
+        if (worker.detached) {
+            finishDetached(strand);
+            return;
+        }
+        if (!running_) {
+            return;
+        }
+    }
+
+    // 用完本轮配额，仍有任务时放回自己的就绪队列末尾，保持scheduled不变
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        if (strand->tasks.empty()) {
+            strand->scheduled = false;
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        workers_[index]->ready.push_back(strand);
+    }
+    readyStrands_.fetch_add(1);
+}
+
+void RequestExecutor::workerLoop(size_t index) {
+    currentExecutor = this;
+    currentWorker = index;
+
+    while (running_) {
+        StrandPtr strand = takeStrand(index);
+        if (strand) {
+            runStrand(strand, index);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        idleWorkers_.fetch_add(1);
+        idleCondition_.wait(lock, [this] { return !running_ || readyStrands_.load() > 0; });
+        idleWorkers_.fetch_sub(1);
+    }
+
+    currentExecutor = nullptr;
+}
+
+void RequestExecutor::recordLatency(Clock::time_point enqueueTime, Clock::time_point startTime,
+                                    Clock::time_point endTime) {
+    auto waitUs = std::chrono::duration_cast<std::chrono::microseconds>(startTime - enqueueTime).count();
+    auto handlerUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count());
+    totalQueueWaitUs_.fetch_add(static_cast<uint64_t>(waitUs), std::memory_order_relaxed);
+    totalHandlerUs_.fetch_add(handlerUs, std::memory_order_relaxed);
+    updateMax(maxHandlerUs_, handlerUs);
+
+    // 第i个桶统计耗时小于2^i微秒的任务
+    size_t bucket = 0;
+    while (bucket + 1 < LATENCY_BUCKETS && (uint64_t(1) << bucket) <= handlerUs) {
+        ++bucket;
+    }
+    handlerBuckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+RequestExecutor::Stats RequestExecutor::getStats() const {
+    Stats stats;
+    stats.submitted = submitted_;
+    stats.completed = completed_;
+    stats.rejected = rejected_;
+    stats.stolen = stolen_;
+    stats.queueDepth = pending_;
+    stats.peakQueueDepth = static_cast<size_t>(peakPending_.load());
+    stats.maxHandlerUs = maxHandlerUs_;
+    if (stats.completed > 0) {
+        stats.avgQueueWaitUs = static_cast<double>(totalQueueWaitUs_) / stats.completed;
+        stats.avgHandlerUs = static_cast<double>(totalHandlerUs_) / stats.completed;
+    }
+
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+        counts[i] = handlerBuckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    auto percentile = [&](double p) -> uint64_t {
+        uint64_t threshold = static_cast<uint64_t>(p * total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen > threshold) {
+                return uint64_t(1) << i;
+            }
+        }
+        return uint64_t(1) << (LATENCY_BUCKETS - 1);
+    };
+    if (total > 0) {
+        stats.p50HandlerUs = percentile(0.5);
+        stats.p99HandlerUs = percentile(0.99);
+    }
+    return stats;
+}
+
+} // namespace gmatch
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+namespace gmatch {
+
+// 请求执行器：把请求处理从I/O线程移到固定数量的工作线程
+// 同一个key(连接)的任务按提交顺序串行执行，不同key之间并行执行。
+// 每个key的任务排在一个串行队列(strand)中，同一时刻一个strand只在一个工作线程的就绪队列里，
+// 空闲的工作线程从其他线程的就绪队列中窃取strand。等待执行的任务总数有上限，超过时拒绝提交。
+// 任务可以在执行中把自己从strand中分离，之后同一key的任务不再等它完成。
+class RequestExecutor {
+public:
+    using Key = uint64_t;
+    using Task = std::function<void()>;
+
+    static constexpr size_t DEFAULT_MAX_PENDING = 65536;
+
+    // 运行指标快照，耗时单位为微秒
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;
+        uint64_t stolen = 0;          // 被其他工作线程窃取执行的strand次数
+        size_t queueDepth = 0;        // 等待执行和正在执行的任务数
+        size_t peakQueueDepth = 0;
+        double avgQueueWaitUs = 0.0;  // 从提交到开始执行
+        double avgHandlerUs = 0.0;    // 任务本身的执行耗时
+        uint64_t p50HandlerUs = 0;    // 按2的幂分桶估计，返回所在桶的上界
+        uint64_t p99HandlerUs = 0;
+        uint64_t maxHandlerUs = 0;
+    };
+
+    // workerCount为0时使用硬件并发数
+    explicit RequestExecutor(size_t workerCount = 0, size_t maxPending = DEFAULT_MAX_PENDING);
+    ~RequestExecutor();
+
+    RequestExecutor(const RequestExecutor&) = delete;
+    RequestExecutor& operator=(const RequestExecutor&) = delete;
+
+    void start();
+    // 等待正在执行的任务结束后停止，尚未执行的任务被丢弃；调用前需保证没有其他线程还在提交任务
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // 提交任务，等待执行的任务数达到上限或执行器已停止时返回false
+    // force为true时不受上限限制，用于连接关闭后的清理等不能丢弃的任务
+    bool submit(Key key, Task task, bool force = false);
+    
+    // 提交一个屏障任务：不受上限限制，等同一key之前提交的任务(包括已分离的)全部执行完才开始，
+    // 用于连接关闭后的清理
+    bool submitBarrier(Key key, Task task);
+    
+    // 在任务中调用：把当前任务从所在strand中分离，同一key的后续任务可以由其他工作线程立即开始执行，
+    // 不再等待当前任务完成。不在本执行器的任务中调用或已经分离时返回false
+    bool detachCurrentTask();
+
+    // 释放key对应的串行队列，已提交的任务仍会执行完
+    void remove(Key key);
+    
+    // 等待已提交的任务全部执行完，最多等待timeoutMs毫秒，超时返回false；调用前需停止提交
+    bool waitIdle(uint32_t timeoutMs);
+
+    size_t getWorkerCount() const { return workerCount_; }
+    size_t getMaxPending() const { return maxPending_; }
+    Stats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingTask {
+        Task task;
+        Clock::time_point enqueueTime;
+        bool barrier = false;
+    };
+
+    // 单个key的串行队列，scheduled表示已在某个工作线程的就绪队列中或正在执行
+    struct Strand {
+        std::mutex mutex;
+        std::deque<PendingTask> tasks;
+        bool scheduled = false;
+        size_t detached = 0;   // 已分离、仍在执行的任务数
+        bool blocked = false;  // 队首的屏障任务在等待已分离的任务，最后一个分离的任务完成时重新调度
+        size_t home = 0;       // 提交方不是工作线程时放入的就绪队列
+    };
+    using StrandPtr = std::shared_ptr<Strand>;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<StrandPtr> ready;
+        std::thread thread;
+        // 以下只由本工作线程访问：正在执行的任务所在的strand，以及该任务是否已分离
+        const StrandPtr* current = nullptr;
+        bool detached = false;
+    };
+
+    bool enqueue(Key key, Task task, bool force, bool barrier);
+    void finishDetached(const StrandPtr& strand);
+
+    void workerLoop(size_t index);
+    void schedule(const StrandPtr& strand);
+    StrandPtr takeStrand(size_t index);
+    void runStrand(const StrandPtr& strand, size_t index);
+    void recordLatency(Clock::time_point enqueueTime, Clock::time_point startTime, Clock::time_point endTime);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    size_t workerCount_;
+    size_t maxPending_;
+    std::atomic<bool> running_{false};
+
+    std::mutex strandsMutex_;
+    std::unordered_map<Key, StrandPtr> strands_;
+
+    // 就绪队列中的strand总数；空闲的工作线程在idleCondition_上等待
+    std::atomic<size_t> readyStrands_{0};
+    std::atomic<size_t> idleWorkers_{0};
+    std::mutex idleMutex_;
+    std::condition_variable idleCondition_;
+
+    // 指标
+    static constexpr size_t LATENCY_BUCKETS = 32;
+    std::atomic<size_t> pending_{0};
+    std::atomic<uint64_t> peakPending_{0};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> stolen_{0};
+    std::atomic<uint64_t> totalQueueWaitUs_{0};
+    std::atomic<uint64_t> totalHandlerUs_{0};
+    std::atomic<uint64_t> maxHandlerUs_{0};
+    std::atomic<uint64_t> handlerBuckets_[LATENCY_BUCKETS] = {};
+};
+
+} // namespace gmatch
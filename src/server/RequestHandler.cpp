@@ -1,161 +1,219 @@
 #include "RequestHandler.h"
-#include <sstream>
+#include <algorithm>
 #include <iostream>
 #include "../util/Logger.h"
 
 // 简单的JSON解析与生成，在实际环境中可以使用第三方库如nlohmann/json或RapidJSON
 namespace gmatch {
 
+namespace {
+
+// 解析data中的"player_id"字段
+enum class PlayerIdStatus { OK, MISSING, INVALID };
+
+PlayerIdStatus parsePlayerId(const JsonFields& fields, Player::PlayerId& playerId) {
+    const JsonValue* value = fields.find("player_id");
+    if (!value) {
+        return PlayerIdStatus::MISSING;
+    }
+    return value->getInteger(playerId) ? PlayerIdStatus::OK : PlayerIdStatus::INVALID;
+}
+
+// 批量命令中单个玩家失败的原因
+const char* matchmakingResultMessage(MatchmakingResult result, bool join) {
+    switch (result) {
+        case MatchmakingResult::OK:
+            return join ? "Joined matchmaking queue" : "Left matchmaking queue";
+        case MatchmakingResult::PLAYER_NOT_FOUND:
+            return "Player not found";
+        case MatchmakingResult::ALREADY_IN_QUEUE:
+            return "Player already in queue";
+        case MatchmakingResult::NOT_IN_QUEUE:
+            return "Player not in queue";
+        case MatchmakingResult::FAILED:
+        default:
+            return join ? "Failed to join matchmaking queue" : "Failed to leave matchmaking queue";
+    }
+}
+
+} // namespace
+
 JsonRequestHandler::JsonRequestHandler() 
     : onPlayerCreatedCallback_(nullptr) {
     // 注册默认命令处理器
-    registerCommandHandler("create_player", [this](const std::string& data, TcpConnection::ConnectionId clientId) {
-        return handleCreatePlayer(data, clientId);
-    });
+    commandHandlers_["create_player"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleCreatePlayer(request, clientId, out);
+    };
+    
+    commandHandlers_["join_matchmaking"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleJoinMatchmaking(request, clientId, out);
+    };
+    
+    commandHandlers_["leave_matchmaking"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleLeaveMatchmaking(request, clientId, out);
+    };
     
-    registerCommandHandler("join_matchmaking", [this](const std::string& data, TcpConnection::ConnectionId clientId) {
-        return handleJoinMatchmaking(data, clientId);
-    });
+    commandHandlers_["create_players"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleCreatePlayers(request, clientId, out);
+    };
     
-    registerCommandHandler("leave_matchmaking", [this](const std::string& data, TcpConnection::ConnectionId clientId) {
-        return handleLeaveMatchmaking(data, clientId);
-    });
+    commandHandlers_["join_matchmaking_batch"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleMatchmakingBatch(request, clientId, true, out);
+    };
     
-    registerCommandHandler("get_rooms", [this](const std::string& data, TcpConnection::ConnectionId clientId) {
-        return handleGetRooms(data, clientId);
-    });
+    commandHandlers_["leave_matchmaking_batch"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleMatchmakingBatch(request, clientId, false, out);
+    };
     
-    registerCommandHandler("get_player_info", [this](const std::string& data, TcpConnection::ConnectionId clientId) {
-        return handleGetPlayerInfo(data, clientId);
-    });
+    commandHandlers_["get_rooms"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleGetRooms(request, clientId, out);
+    };
     
-    registerCommandHandler("get_queue_status", [this](const std::string& data, TcpConnection::ConnectionId clientId) {
-        return handleGetQueueStatus(data, clientId);
-    });
+    commandHandlers_["get_player_info"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleGetPlayerInfo(request, clientId, out);
+    };
+    
+    commandHandlers_["get_queue_status"] = [this](const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+        handleGetQueueStatus(request, clientId, out);
+    };
 }
 
-std::string JsonRequestHandler::handleRequest(const std::string& request, TcpConnection::ConnectionId clientId) {
-    std::string command, data;
-    
-    if (!parseJsonRequest(request, command, data)) {
-        return createJsonResponse("error", false, "Invalid JSON format", "");
+void JsonRequestHandler::handleRequest(std::string_view request, TcpConnection::ConnectionId clientId,
+                                       std::string& response) {
+    JsonRequest parsed;
+    
+    if (!parseJsonRequest(request, parsed)) {
+        parsed.command = "error";
+        if (!isValidRequestId(parsed.id)) {
+            parsed.id = JsonValue();
+        }
+        writeJsonResponse(response, parsed, false, "Invalid JSON format");
+        return;
     }
     
-    LOG_DEBUG("Received command: %s, data: %s", command.c_str(), data.c_str());
+    LOG_DEBUG("Received command: %.*s, data: %.*s", static_cast<int>(parsed.command.size()), parsed.command.data(),
+              static_cast<int>(parsed.data.size()), parsed.data.data());
     
-    auto it = commandHandlers_.find(command);
+    if (parsed.hasId()) {
+        if (!isValidRequestId(parsed.id)) {
+            parsed.id = JsonValue();
+            writeJsonResponse(response, parsed, false, "Invalid request id");
+            return;
+        }
+        if (onRequestIdCallback_) {
+            onRequestIdCallback_();
+        }
+    }
+    
+    auto it = commandHandlers_.find(parsed.command);
     if (it != commandHandlers_.end()) {
-        return it->second(data, clientId);
+        it->second(parsed, clientId, response);
     } else {
-        return createJsonResponse(command, false, "Unknown command", "");
+        writeJsonResponse(response, parsed, false, "Unknown command");
     }
 }
 
 void JsonRequestHandler::registerCommandHandler(const std::string& command, CommandHandler handler) {
-    commandHandlers_[command] = handler;
+    // 自定义命令返回完整的响应，请求带id时插入id
+    commandHandlers_[command] = [handler = std::move(handler)](const JsonRequest& request,
+                                                               TcpConnection::ConnectionId clientId, std::string& out) {
+        if (request.hasId()) {
+            appendJsonWithId(handler(request, clientId), request.id, out);
+        } else {
+            out += handler(request, clientId);
+        }
+    };
 }
 
-bool JsonRequestHandler::parseJsonRequest(const std::string& request, std::string& command, std::string& data) {
-    // 简单的JSON解析
-    // 格式假设为: {"cmd":"命令名","data":{...}}
-    size_t cmdStart = request.find("\"cmd\"");
-    size_t dataStart = request.find("\"data\"");
-    
-    if (cmdStart == std::string::npos || dataStart == std::string::npos) {
+bool JsonRequestHandler::parseJsonRequest(std::string_view request, JsonRequest& parsed) {
+    // 格式为: {"id":请求ID,"cmd":"命令名","data":{...}}，id可选，一遍扫描同时取出顶层字段和data对象的字段
+    JsonFields top;
+    if (!parseJsonObject(request, top, "data", &parsed.fields)) {
         return false;
     }
     
-    // 解析命令
-    cmdStart = request.find(':', cmdStart) + 1;
-    size_t cmdEnd = request.find(',', cmdStart);
-    if (cmdEnd == std::string::npos) {
-        cmdEnd = request.find('}', cmdStart);
+    // id先取出，命令无效时的错误响应也能带回
+    if (const JsonValue* id = top.find("id")) {
+        parsed.id = *id;
     }
     
-    std::string cmdValue = request.substr(cmdStart, cmdEnd - cmdStart);
-    // 去除引号和空白
-    cmdValue.erase(std::remove_if(cmdValue.begin(), cmdValue.end(), 
-                                   [](char c) { return c == '\"' || c == ' '; }), 
-                   cmdValue.end());
-    command = cmdValue;
+    // 命令名不含转义字符，带转义的命令名按原文查找，结果是未知命令
+    const JsonValue* cmd = top.find("cmd");
+    if (!cmd || !cmd->isString()) {
+        return false;
+    }
+    parsed.command = cmd->text;
     
-    // 解析数据
-    dataStart = request.find(':', dataStart) + 1;
-    size_t dataEnd = request.rfind('}');
-    if (dataStart >= dataEnd) {
-        data = "{}";
+    const JsonValue* data = top.find("data");
+    if (!data) {
+        parsed.data = "{}";
+    } else if (data->isObject()) {
+        parsed.data = data->text;
     } else {
-        data = request.substr(dataStart, dataEnd - dataStart + 1);
+        return false;
     }
     
     return true;
 }
 
-std::string JsonRequestHandler::createJsonResponse(const std::string& command, bool success, 
-                                                  const std::string& message, const std::string& data) {
-    std::ostringstream oss;
-    oss << "{\"cmd\":\"" << command << "\",\"success\":" << (success ? "true" : "false") 
-        << ",\"message\":\"" << message << "\"";
-        
-    if (!data.empty()) {
-        oss << ",\"data\":" << data;
+void JsonRequestHandler::beginJsonResponse(JsonWriter& writer, const JsonRequest& request, std::string_view message) {
+    writer.beginObject();
+    if (request.hasId()) {
+        writer.key("id").value(request.id);
     }
-    
-    oss << "}";
-    return oss.str();
+    // 命令名是请求中的原文，已经是转义后的形式
+    writer.key("cmd").escapedString(request.command)
+        .key("success").boolean(true)
+        .key("message").string(message)
+        .key("data");
 }
 
-std::string JsonRequestHandler::handleCreatePlayer(const std::string& data, TcpConnection::ConnectionId clientId) {
+void JsonRequestHandler::endJsonResponse(JsonWriter& writer) {
+    writer.endObject();
+}
+
+void JsonRequestHandler::writeJsonResponse(std::string& out, const JsonRequest& request, bool success,
+                                           std::string_view message) {
+    JsonWriter writer(out);
+    writer.beginObject();
+    if (request.hasId()) {
+        writer.key("id").value(request.id);
+    }
+    writer.key("cmd").escapedString(request.command)
+        .key("success").boolean(success)
+        .key("message").string(message)
+        .endObject();
+}
+
+void JsonRequestHandler::handleCreatePlayer(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
     // 解析玩家名称和评分
     std::string name = "Player";
     int rating = 1500;
     
     LOG_DEBUG("Handling create_player request from client %llu", clientId);
     
-    // 简单的数据解析
-    size_t namePos = data.find("\"name\"");
-    size_t ratingPos = data.find("\"rating\"");
-    
-    if (namePos != std::string::npos) {
-        namePos = data.find(':', namePos) + 1;
-        size_t nameEnd = data.find(',', namePos);
-        if (nameEnd == std::string::npos) {
-            nameEnd = data.find('}', namePos);
-        }
-        
-        std::string nameValue = data.substr(namePos, nameEnd - namePos);
-        // 去除引号和空白
-        nameValue.erase(std::remove_if(nameValue.begin(), nameValue.end(), 
-                                     [](char c) { return c == '\"' || c == ' '; }), 
-                       nameValue.end());
-        if (!nameValue.empty()) {
-            name = nameValue;
+    // 字段值都是请求内的视图，只有名称最终需要复制(并解码转义)
+    if (const JsonValue* value = request.fields.find("name")) {
+        std::string parsedName;
+        if (!value->getString(parsedName)) {
+            LOG_WARNING("Failed to parse name value '%.*s', using default", static_cast<int>(value->text.size()), value->text.data());
+        } else if (!parsedName.empty()) {
+            name = std::move(parsedName);
             LOG_DEBUG("Parsed player name: %s", name.c_str());
         }
     }
     
-    if (ratingPos != std::string::npos) {
-        ratingPos = data.find(':', ratingPos) + 1;
-        size_t ratingEnd = data.find(',', ratingPos);
-        if (ratingEnd == std::string::npos) {
-            ratingEnd = data.find('}', ratingPos);
-        }
-        
-        std::string ratingValue = data.substr(ratingPos, ratingEnd - ratingPos);
-        // 去除空白
-        ratingValue.erase(std::remove_if(ratingValue.begin(), ratingValue.end(), 
-                                       [](char c) { return c == ' '; }), 
-                         ratingValue.end());
-        try {
-            rating = std::stoi(ratingValue);
+    if (const JsonValue* value = request.fields.find("rating")) {
+        if (value->getInteger(rating)) {
             LOG_DEBUG("Parsed player rating: %d", rating);
-        } catch (...) {
-            LOG_WARNING("Failed to parse rating value '%s', using default", ratingValue.c_str());
+        } else {
             // 使用默认评分
+            LOG_WARNING("Failed to parse rating value '%.*s', using default", static_cast<int>(value->text.size()), value->text.data());
         }
     }
     
-    // 创建玩家
+    // 创建玩家，异常时丢弃已写出的部分响应
+    size_t start = out.size();
     try {
         auto& matchManager = MatchManager::getInstance();
         auto player = matchManager.createPlayer(name, rating);
@@ -180,89 +238,70 @@ std::string JsonRequestHandler::handleCreatePlayer(const std::string& data, TcpC
                 LOG_WARNING("No player created callback registered!");
             }
             
-            std::ostringstream oss;
-            oss << "{\"player_id\":" << player->getId() 
-                << ",\"name\":\"" << player->getName() 
-                << "\",\"rating\":" << player->getRating() << "}";
-            
-            std::string response = createJsonResponse("create_player", true, "Player created successfully", oss.str());
-            LOG_DEBUG("create_player response: %s", response.c_str());
-            return response;
+            JsonWriter writer(out);
+            beginJsonResponse(writer, request, "Player created successfully");
+            writer.beginObject()
+                .key("player_id").integer(player->getId())
+                .key("name").string(player->getName())
+                .key("rating").integer(player->getRating())
+                .endObject();
+            endJsonResponse(writer);
+            LOG_DEBUG("create_player response: %s", out.c_str() + start);
         } else {
             LOG_ERROR("Failed to create player");
-            return createJsonResponse("create_player", false, "Failed to create player", "");
+            writeJsonResponse(out, request, false, "Failed to create player");
         }
     } catch (const std::exception& e) {
         LOG_ERROR("Exception creating player: %s", e.what());
-        return createJsonResponse("create_player", false, 
-                                std::string("Exception creating player: ") + e.what(), "");
+        out.resize(start);
+        writeJsonResponse(out, request, false, std::string("Exception creating player: ") + e.what());
     } catch (...) {
         LOG_ERROR("Unknown exception creating player");
-        return createJsonResponse("create_player", false, "Unknown exception creating player", "");
+        out.resize(start);
+        writeJsonResponse(out, request, false, "Unknown exception creating player");
     }
 }
 
-std::string JsonRequestHandler::handleJoinMatchmaking(const std::string& data, TcpConnection::ConnectionId clientId) {
+void JsonRequestHandler::handleJoinMatchmaking(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
     // 解析玩家ID
     Player::PlayerId playerId = 0;
-    
-    size_t playerIdPos = data.find("\"player_id\"");
-    if (playerIdPos != std::string::npos) {
-        playerIdPos = data.find(':', playerIdPos) + 1;
-        size_t playerIdEnd = data.find(',', playerIdPos);
-        if (playerIdEnd == std::string::npos) {
-            playerIdEnd = data.find('}', playerIdPos);
-        }
-        
-        std::string playerIdValue = data.substr(playerIdPos, playerIdEnd - playerIdPos);
-        // 去除空白
-        playerIdValue.erase(std::remove_if(playerIdValue.begin(), playerIdValue.end(), 
-                                         [](char c) { return c == ' '; }), 
-                           playerIdValue.end());
-        try {
-            playerId = std::stoull(playerIdValue);
-        } catch (...) {
-            return createJsonResponse("join_matchmaking", false, "Invalid player ID", "");
-        }
-    } else {
-        return createJsonResponse("join_matchmaking", false, "Player ID is required", "");
+    switch (parsePlayerId(request.fields, playerId)) {
+        case PlayerIdStatus::MISSING:
+            writeJsonResponse(out, request, false, "Player ID is required");
+            return;
+        case PlayerIdStatus::INVALID:
+            writeJsonResponse(out, request, false, "Invalid player ID");
+            return;
+        case PlayerIdStatus::OK:
+            break;
     }
     
     // 加入匹配队列
     auto& matchManager = MatchManager::getInstance();
+    if (onPlayerClaimedCallback_ && matchManager.getPlayer(playerId)) {
+        onPlayerClaimedCallback_(clientId, playerId);
+    }
     bool success = matchManager.joinMatchmaking(playerId);
     
     if (success) {
-        return createJsonResponse("join_matchmaking", true, "Joined matchmaking queue", "");
+        writeJsonResponse(out, request, true, "Joined matchmaking queue");
     } else {
-        return createJsonResponse("join_matchmaking", false, "Failed to join matchmaking queue", "");
+        writeJsonResponse(out, request, false, "Failed to join matchmaking queue");
     }
 }
 
-std::string JsonRequestHandler::handleLeaveMatchmaking(const std::string& data, TcpConnection::ConnectionId clientId) {
+void JsonRequestHandler::handleLeaveMatchmaking(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
     // 解析玩家ID
     Player::PlayerId playerId = 0;
-    
-    size_t playerIdPos = data.find("\"player_id\"");
-    if (playerIdPos != std::string::npos) {
-        playerIdPos = data.find(':', playerIdPos) + 1;
-        size_t playerIdEnd = data.find(',', playerIdPos);
-        if (playerIdEnd == std::string::npos) {
-            playerIdEnd = data.find('}', playerIdPos);
-        }
-        
-        std::string playerIdValue = data.substr(playerIdPos, playerIdEnd - playerIdPos);
-        // 去除空白
-        playerIdValue.erase(std::remove_if(playerIdValue.begin(), playerIdValue.end(), 
-                                         [](char c) { return c == ' '; }), 
-                           playerIdValue.end());
-        try {
-            playerId = std::stoull(playerIdValue);
-        } catch (...) {
-            return createJsonResponse("leave_matchmaking", false, "Invalid player ID", "");
-        }
-    } else {
-        return createJsonResponse("leave_matchmaking", false, "Player ID is required", "");
+    switch (parsePlayerId(request.fields, playerId)) {
+        case PlayerIdStatus::MISSING:
+            writeJsonResponse(out, request, false, "Player ID is required");
+            return;
+        case PlayerIdStatus::INVALID:
+            writeJsonResponse(out, request, false, "Invalid player ID");
+            return;
+        case PlayerIdStatus::OK:
+            break;
     }
     
     // 离开匹配队列
@@ -270,63 +309,214 @@ std::string JsonRequestHandler::handleLeaveMatchmaking(const std::string& data,
     bool success = matchManager.leaveMatchmaking(playerId);
     
     if (success) {
-        return createJsonResponse("leave_matchmaking", true, "Left matchmaking queue", "");
+        writeJsonResponse(out, request, true, "Left matchmaking queue");
     } else {
-        return createJsonResponse("leave_matchmaking", false, "Failed to leave matchmaking queue", "");
+        writeJsonResponse(out, request, false, "Failed to leave matchmaking queue");
     }
 }
 
-std::string JsonRequestHandler::handleGetRooms(const std::string& data, TcpConnection::ConnectionId clientId) {
-    auto& matchManager = MatchManager::getInstance();
-    auto rooms = matchManager.getAllRooms();
+void JsonRequestHandler::handleCreatePlayers(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+    const JsonValue* list = request.fields.find("players");
+    if (!list) {
+        writeJsonResponse(out, request, false, "Player list is required");
+        return;
+    }
+    if (list->type != JsonValue::Type::ARRAY) {
+        writeJsonResponse(out, request, false, "Invalid player list");
+        return;
+    }
     
-    std::ostringstream oss;
-    oss << "[";
+    // 先解析全部条目，不是对象的条目记为失败；名称和评分无效时与create_player一样使用默认值
+    std::vector<NewPlayer> players;
+    std::vector<bool> valid;
+    JsonArrayReader reader(list->text);
+    JsonValue element;
+    JsonFields fields;
+    while (reader.next(element, &fields)) {
+        if (players.size() >= MAX_BATCH_SIZE) {
+            writeJsonResponse(out, request, false, "Too many players in batch");
+            return;
+        }
+        NewPlayer player{"Player", 1500};
+        valid.push_back(element.isObject());
+        if (const JsonValue* value = fields.find("name")) {
+            std::string parsedName;
+            if (value->getString(parsedName) && !parsedName.empty()) {
+                player.name = std::move(parsedName);
+            }
+        }
+        if (const JsonValue* value = fields.find("rating")) {
+            value->getInteger(player.rating);
+        }
+        players.push_back(std::move(player));
+    }
+    if (reader.failed()) {
+        writeJsonResponse(out, request, false, "Invalid player list");
+        return;
+    }
     
-    bool first = true;
-    for (const auto& room : rooms) {
-        if (!first) {
-            oss << ",";
+    LOG_DEBUG("Handling create_players request for %zu players from client %llu", players.size(), clientId);
+    
+    // 只为有效条目创建玩家，结果按原顺序写回
+    std::vector<NewPlayer> creating;
+    creating.reserve(players.size());
+    for (size_t i = 0; i < players.size(); ++i) {
+        if (valid[i]) {
+            creating.push_back(std::move(players[i]));
         }
-        first = false;
+    }
+    
+    size_t start = out.size();
+    try {
+        auto created = MatchManager::getInstance().createPlayers(creating);
         
-        oss << "{\"room_id\":" << room->getId()
-            << ",\"status\":" << static_cast<int>(room->getStatus())
-            << ",\"player_count\":" << room->getPlayerCount()
-            << ",\"capacity\":" << room->getCapacity()
-            << ",\"avg_rating\":" << room->getAverageRating()
-            << "}";
+        // 建立客户端与玩家的映射关系
+        if (onPlayerCreatedCallback_) {
+            for (const auto& player : created) {
+                try {
+                    onPlayerCreatedCallback_(clientId, player->getId());
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Exception in player created callback: %s", e.what());
+                } catch (...) {
+                    LOG_ERROR("Unknown exception in player created callback");
+                }
+            }
+        }
+        
+        JsonWriter writer(out);
+        beginJsonResponse(writer, request, "Players created");
+        writer.beginObject()
+            .key("succeeded").integer(created.size())
+            .key("failed").integer(valid.size() - created.size())
+            .key("results").beginArray();
+        size_t next = 0;
+        for (bool isValid : valid) {
+            writer.beginObject();
+            if (isValid) {
+                const auto& player = created[next++];
+                writer.key("success").boolean(true)
+                    .key("player_id").integer(player->getId())
+                    .key("name").string(player->getName())
+                    .key("rating").integer(player->getRating());
+            } else {
+                writer.key("success").boolean(false)
+                    .key("message").string("Invalid player");
+            }
+            writer.endObject();
+        }
+        writer.endArray().endObject();
+        endJsonResponse(writer);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Exception creating players: %s", e.what());
+        out.resize(start);
+        writeJsonResponse(out, request, false, std::string("Exception creating players: ") + e.what());
+    } catch (...) {
+        LOG_ERROR("Unknown exception creating players");
+        out.resize(start);
+        writeJsonResponse(out, request, false, "Unknown exception creating players");
+    }
+}
+
+void JsonRequestHandler::handleMatchmakingBatch(const JsonRequest& request, TcpConnection::ConnectionId clientId,
+                                                bool join, std::string& out) {
+    const JsonValue* list = request.fields.find("player_ids");
+    if (!list) {
+        writeJsonResponse(out, request, false, "Player ID list is required");
+        return;
+    }
+    if (list->type != JsonValue::Type::ARRAY) {
+        writeJsonResponse(out, request, false, "Invalid player ID list");
+        return;
     }
     
-    oss << "]";
+    // 无效的ID不提交，结果中原样带回
+    std::vector<JsonValue> elements;
+    std::vector<bool> valid;
+    std::vector<Player::PlayerId> playerIds;
+    JsonArrayReader reader(list->text);
+    JsonValue element;
+    while (reader.next(element)) {
+        if (elements.size() >= MAX_BATCH_SIZE) {
+            writeJsonResponse(out, request, false, "Too many players in batch");
+            return;
+        }
+        Player::PlayerId playerId = 0;
+        valid.push_back(element.getInteger(playerId));
+        if (valid.back()) {
+            playerIds.push_back(playerId);
+        }
+        elements.push_back(element);
+    }
+    if (reader.failed()) {
+        writeJsonResponse(out, request, false, "Invalid player ID list");
+        return;
+    }
+    
+    auto& matchManager = MatchManager::getInstance();
+    if (join && onPlayerClaimedCallback_) {
+        // 认领只对交接后尚未认领的玩家生效，不存在的玩家不会被认领
+        for (auto playerId : playerIds) {
+            onPlayerClaimedCallback_(clientId, playerId);
+        }
+    }
+    auto results = join ? matchManager.joinMatchmakingBatch(playerIds) : matchManager.leaveMatchmakingBatch(playerIds);
+    
+    size_t succeeded = std::count(results.begin(), results.end(), MatchmakingResult::OK);
+    JsonWriter writer(out);
+    beginJsonResponse(writer, request, join ? "Batch join processed" : "Batch leave processed");
+    writer.beginObject()
+        .key("succeeded").integer(succeeded)
+        .key("failed").integer(elements.size() - succeeded)
+        .key("results").beginArray();
+    size_t next = 0;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        MatchmakingResult result = valid[i] ? results[next++] : MatchmakingResult::FAILED;
+        writer.beginObject()
+            .key("success").boolean(result == MatchmakingResult::OK)
+            .key("player_id").value(elements[i]);
+        if (!valid[i]) {
+            writer.key("message").string("Invalid player ID");
+        } else if (result != MatchmakingResult::OK) {
+            writer.key("message").string(matchmakingResultMessage(result, join));
+        }
+        writer.endObject();
+    }
+    writer.endArray().endObject();
+    endJsonResponse(writer);
+}
+
+void JsonRequestHandler::handleGetRooms(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
+    auto& matchManager = MatchManager::getInstance();
+    auto rooms = matchManager.getAllRooms();
     
-    return createJsonResponse("get_rooms", true, "Rooms retrieved successfully", oss.str());
+    JsonWriter writer(out);
+    beginJsonResponse(writer, request, "Rooms retrieved successfully");
+    writer.beginArray();
+    for (const auto& room : rooms) {
+        writer.beginObject()
+            .key("room_id").integer(room->getId())
+            .key("status").integer(static_cast<int>(room->getStatus()))
+            .key("player_count").integer(room->getPlayerCount())
+            .key("capacity").integer(room->getCapacity())
+            .key("avg_rating").number(room->getAverageRating())
+            .endObject();
+    }
+    writer.endArray();
+    endJsonResponse(writer);
 }
 
-std::string JsonRequestHandler::handleGetPlayerInfo(const std::string& data, TcpConnection::ConnectionId clientId) {
+void JsonRequestHandler::handleGetPlayerInfo(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
     // 解析玩家ID
     Player::PlayerId playerId = 0;
-    
-    size_t playerIdPos = data.find("\"player_id\"");
-    if (playerIdPos != std::string::npos) {
-        playerIdPos = data.find(':', playerIdPos) + 1;
-        size_t playerIdEnd = data.find(',', playerIdPos);
-        if (playerIdEnd == std::string::npos) {
-            playerIdEnd = data.find('}', playerIdPos);
-        }
-        
-        std::string playerIdValue = data.substr(playerIdPos, playerIdEnd - playerIdPos);
-        // 去除空白
-        playerIdValue.erase(std::remove_if(playerIdValue.begin(), playerIdValue.end(), 
-                                         [](char c) { return c == ' '; }), 
-                           playerIdValue.end());
-        try {
-            playerId = std::stoull(playerIdValue);
-        } catch (...) {
-            return createJsonResponse("get_player_info", false, "Invalid player ID", "");
-        }
-    } else {
-        return createJsonResponse("get_player_info", false, "Player ID is required", "");
+    switch (parsePlayerId(request.fields, playerId)) {
+        case PlayerIdStatus::MISSING:
+            writeJsonResponse(out, request, false, "Player ID is required");
+            return;
+        case PlayerIdStatus::INVALID:
+            writeJsonResponse(out, request, false, "Invalid player ID");
+            return;
+        case PlayerIdStatus::OK:
+            break;
     }
     
     // 获取玩家信息
@@ -334,27 +524,32 @@ std::string JsonRequestHandler::handleGetPlayerInfo(const std::string& data, Tcp
     auto player = matchManager.getPlayer(playerId);
     
     if (player) {
-        std::ostringstream oss;
-        oss << "{\"player_id\":" << player->getId() 
-            << ",\"name\":\"" << player->getName() 
-            << "\",\"rating\":" << player->getRating()
-            << ",\"in_queue\":" << (player->isInQueue() ? "true" : "false")
-            << "}";
+        if (onPlayerClaimedCallback_) {
+            onPlayerClaimedCallback_(clientId, playerId);
+        }
         
-        return createJsonResponse("get_player_info", true, "Player info retrieved successfully", oss.str());
+        JsonWriter writer(out);
+        beginJsonResponse(writer, request, "Player info retrieved successfully");
+        writer.beginObject()
+            .key("player_id").integer(player->getId())
+            .key("name").string(player->getName())
+            .key("rating").integer(player->getRating())
+            .key("in_queue").boolean(player->isInQueue())
+            .endObject();
+        endJsonResponse(writer);
     } else {
-        return createJsonResponse("get_player_info", false, "Player not found", "");
+        writeJsonResponse(out, request, false, "Player not found");
     }
 }
 
-std::string JsonRequestHandler::handleGetQueueStatus(const std::string& data, TcpConnection::ConnectionId clientId) {
+void JsonRequestHandler::handleGetQueueStatus(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out) {
     auto& matchManager = MatchManager::getInstance();
     size_t queueSize = matchManager.getQueueSize();
     
-    std::ostringstream oss;
-    oss << "{\"queue_size\":" << queueSize << "}";
-    
-    return createJsonResponse("get_queue_status", true, "Queue status retrieved successfully", oss.str());
+    JsonWriter writer(out);
+    beginJsonResponse(writer, request, "Queue status retrieved successfully");
+    writer.beginObject().key("queue_size").integer(queueSize).endObject();
+    endJsonResponse(writer);
 }
 
 } // namespace gmatch 
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <functional>
-#include <unordered_map>
+#include <map>
 #include "TcpServer.h"
 #include "../core/MatchManager.h"
+#include "../util/JsonReader.h"
+#include "../util/JsonWriter.h"
 
 namespace gmatch {
 
@@ -12,19 +15,47 @@ namespace gmatch {
 class RequestHandler {
 public:
     virtual ~RequestHandler() = default;
-    virtual std::string handleRequest(const std::string& request, TcpConnection::ConnectionId clientId) = 0;
+    // request只在调用期间有效。响应追加到response，调用方可以传入复用的缓冲区避免每个请求分配内存
+    virtual void handleRequest(std::string_view request, TcpConnection::ConnectionId clientId, std::string& response) = 0;
+    
+    std::string handleRequest(std::string_view request, TcpConnection::ConnectionId clientId) {
+        std::string response;
+        handleRequest(request, clientId, response);
+        return response;
+    }
+};
+
+// 解析后的JSON请求，所有视图都指向请求原文，只在处理期间有效
+struct JsonRequest {
+    std::string_view command;
+    // data对象的原文(含括号)，请求没有data字段时为"{}"
+    std::string_view data;
+    // data对象的顶层字段
+    JsonFields fields;
+    // 请求的"id"字段，响应原样带回；没有时text为空
+    JsonValue id;
+    
+    bool hasId() const { return !id.text.empty(); }
 };
 
 // JSON请求处理器
 class JsonRequestHandler : public RequestHandler {
 public:
-    using CommandHandler = std::function<std::string(const std::string&, TcpConnection::ConnectionId)>;
+    // 请求只解析一遍，处理器从request.fields中读取字段
+    using CommandHandler = std::function<std::string(const JsonRequest&, TcpConnection::ConnectionId)>;
+    // 内置命令直接把响应写入缓冲区
+    using ResponseWriter = std::function<void(const JsonRequest&, TcpConnection::ConnectionId, std::string&)>;
     using PlayerCreatedCallback = std::function<void(TcpConnection::ConnectionId, Player::PlayerId)>;
+    using RequestIdCallback = std::function<void()>;
+    
+    // 批量命令一次最多处理的条目数，限制单个请求持锁的时间
+    static constexpr size_t MAX_BATCH_SIZE = 1000;
     
     JsonRequestHandler();
     
     // 处理请求
-    std::string handleRequest(const std::string& request, TcpConnection::ConnectionId clientId) override;
+    using RequestHandler::handleRequest;
+    void handleRequest(std::string_view request, TcpConnection::ConnectionId clientId, std::string& response) override;
     
     // 注册命令处理器
     void registerCommandHandler(const std::string& command, CommandHandler handler);
@@ -34,26 +65,47 @@ public:
         onPlayerCreatedCallback_ = callback;
     }
     
+    // 设置玩家认领回调：客户端对已存在的玩家发送join_matchmaking或get_player_info时触发，
+    // 用于进程交接后重新连接的客户端找回自己的玩家
+    void setPlayerClaimedCallback(PlayerCreatedCallback callback) {
+        onPlayerClaimedCallback_ = callback;
+    }
+    
+    // 设置带id请求的回调：请求带有合法的id时在执行命令之前调用。客户端用id对应响应，
+    // 服务器借此让同一连接的后续请求不必等待这个请求完成
+    void setRequestIdCallback(RequestIdCallback callback) {
+        onRequestIdCallback_ = callback;
+    }
+    
 private:
-    // 解析JSON请求
-    bool parseJsonRequest(const std::string& request, std::string& command, std::string& data);
+    // 单遍解析JSON请求，结果中的视图指向request内部，不复制
+    bool parseJsonRequest(std::string_view request, JsonRequest& parsed);
     
-    // 构造JSON响应
-    std::string createJsonResponse(const std::string& command, bool success, const std::string& message, const std::string& data = "");
+    // 成功且带data的响应：写出公共字段和"data":，调用方接着写data的值，最后调用endJsonResponse。
+    // 请求带id时id作为第一个字段
+    static void beginJsonResponse(JsonWriter& writer, const JsonRequest& request, std::string_view message);
+    static void endJsonResponse(JsonWriter& writer);
+    // 不带data的响应
+    static void writeJsonResponse(std::string& out, const JsonRequest& request, bool success, std::string_view message);
     
-    // 命令处理映射表
-    std::unordered_map<std::string, CommandHandler> commandHandlers_;
+    // 命令处理映射表，透明比较器使得可以直接用string_view查找而不构造std::string
+    std::map<std::string, ResponseWriter, std::less<>> commandHandlers_;
     
-    // 玩家创建回调
+    // 玩家创建和认领回调
     PlayerCreatedCallback onPlayerCreatedCallback_;
+    PlayerCreatedCallback onPlayerClaimedCallback_;
+    RequestIdCallback onRequestIdCallback_;
     
     // 默认命令处理方法
-    std::string handleCreatePlayer(const std::string& data, TcpConnection::ConnectionId clientId);
-    std::string handleJoinMatchmaking(const std::string& data, TcpConnection::ConnectionId clientId);
-    std::string handleLeaveMatchmaking(const std::string& data, TcpConnection::ConnectionId clientId);
-    std::string handleGetRooms(const std::string& data, TcpConnection::ConnectionId clientId);
-    std::string handleGetPlayerInfo(const std::string& data, TcpConnection::ConnectionId clientId);
-    std::string handleGetQueueStatus(const std::string& data, TcpConnection::ConnectionId clientId);
+    void handleCreatePlayer(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out);
+    void handleJoinMatchmaking(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out);
+    void handleLeaveMatchmaking(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out);
+    void handleCreatePlayers(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out);
+    void handleMatchmakingBatch(const JsonRequest& request, TcpConnection::ConnectionId clientId, bool join,
+                                std::string& out);
+    void handleGetRooms(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out);
+    void handleGetPlayerInfo(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out);
+    void handleGetQueueStatus(const JsonRequest& request, TcpConnection::ConnectionId clientId, std::string& out);
 };
 
 } // namespace gmatch 
\ No newline at end of file
@@ -2,40 +2,78 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
+#include "../util/JsonWriter.h"
 #include "../util/Logger.h"
+#include "../util/TimeUtil.h"
 
 namespace gmatch {
 
+namespace {
+// 每次recv至少预留的接收缓冲区空间
+constexpr size_t READ_CHUNK_SIZE = 4096;
+// 单次writev最多合并的消息数
+constexpr int MAX_WRITE_IOVECS = 64;
+constexpr uint32_t READ_EVENTS = EPOLLIN | EPOLLRDHUP | EPOLLET;
+}
+
 // TcpConnection实现
-TcpConnection::TcpConnection(int socketFd, ConnectionId id)
-    : socketFd_(socketFd), id_(id) {
+TcpConnection::TcpConnection(int socketFd, ConnectionId id, EventLoop* loop)
+    : socketFd_(socketFd), id_(id), loop_(loop), lastReadTime_(TimeUtil::steadyTimeMillis()) {
     LOG_DEBUG("Creating TcpConnection with ID %llu", id);
 }
 
 TcpConnection::~TcpConnection() {
     LOG_DEBUG("Destroying TcpConnection with ID %llu", id_);
+    if (loop_) {
+        // 事件循环注册期间持有连接的引用，走到析构说明已不在循环中，直接关闭
+        if (connected_.exchange(false)) {
+            close(socketFd_);
+        }
+        return;
+    }
     // 断开连接但不触发回调，因为可能正在进行cleanup
     disconnectWithoutCallback();
+    
+    // 读线程持有最后一个引用时在读线程自身中析构，不能join自己
+    if (readThread_.joinable() && readThread_.get_id() == std::this_thread::get_id()) {
+        readThread_.detach();
+    }
 }
 
 void TcpConnection::disconnectWithoutCallback() {
+    if (loop_) {
+        if (loop_->isInLoopThread() || !loop_->isRunning()) {
+            closeInLoop(false);
+        } else {
+            auto self = shared_from_this();
+            loop_->queueInLoop([self] { self->closeInLoop(false); });
+        }
+        return;
+    }
+    
     bool wasConnected = connected_.exchange(false);
     LOG_DEBUG("Silent disconnecting client %llu (was connected: %d)", id_, wasConnected);
     
     if (wasConnected) {
         try {
             LOG_DEBUG("Closing socket for client %llu", id_);
-            close(socketFd_);
+            // shutdown唤醒阻塞在recv上的读线程，读线程退出后再关闭描述符
+            shutdown(socketFd_, SHUT_RDWR);
             
-            if (readThread_.joinable()) {
+            if (readThread_.joinable() && readThread_.get_id() != std::this_thread::get_id()) {
                 LOG_DEBUG("Joining read thread for client %llu", id_);
                 readThread_.join();
                 LOG_DEBUG("Read thread joined for client %llu", id_);
             }
+            close(socketFd_);
         } catch (const std::exception& e) {
             LOG_ERROR("Exception in silent disconnect for client %llu: %s", id_, e.what());
         } catch (...) {
@@ -45,19 +83,32 @@ void TcpConnection::disconnectWithoutCallback() {
 }
 
 void TcpConnection::disconnect() {
+    if (loop_) {
+        // 套接字只在所属I/O线程中关闭，避免描述符被复用后仍在循环中处理
+        if (loop_->isInLoopThread() || !loop_->isRunning()) {
+            closeInLoop(true);
+        } else {
+            auto self = shared_from_this();
+            loop_->queueInLoop([self] { self->closeInLoop(true); });
+        }
+        return;
+    }
+    
     bool wasConnected = connected_.exchange(false);
     LOG_DEBUG("Disconnecting client %llu (was connected: %d)", id_, wasConnected);
     
     if (wasConnected) {
         try {
             LOG_DEBUG("Closing socket for client %llu", id_);
-            close(socketFd_);
+            // shutdown唤醒阻塞在recv上的读线程，读线程退出后再关闭描述符
+            shutdown(socketFd_, SHUT_RDWR);
             
-            if (readThread_.joinable()) {
+            if (readThread_.joinable() && readThread_.get_id() != std::this_thread::get_id()) {
                 LOG_DEBUG("Joining read thread for client %llu", id_);
                 readThread_.join();
                 LOG_DEBUG("Read thread joined for client %llu", id_);
             }
+            close(socketFd_);
             
             // 只在之前是连接状态的情况下调用回调，避免重复调用
             if (disconnectCallback_) {
@@ -81,23 +132,65 @@ void TcpConnection::disconnect() {
     }
 }
 
-bool TcpConnection::send(const std::string& message) {
+bool TcpConnection::send(std::string_view message) {
     if (!connected_) {
         LOG_DEBUG("Attempt to send to disconnected client %llu", id_);
         return false;
     }
     
+    return sendEncoded(encodeFrame(getFramingMode(), message));
+}
+
+bool TcpConnection::sendEncoded(std::string frame) {
+    if (!connected_) {
+        return false;
+    }
+    
+    if (loop_) {
+        // 追加到发送缓冲区，由I/O线程在本轮事件处理结束后统一写出
+        bool slowConsumer = false;
+        bool scheduleFlush = false;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            size_t pending = outboundBytes_;
+            // 缓冲区为空时不算慢消费者，单条超过高水位的大消息照常发送
+            if (slowConsumerPolicy_ == SlowConsumerPolicy::DISCONNECT && pending > 0 &&
+                pending + frame.size() > highWaterMark_) {
+                slowConsumer = true;
+            } else {
+                outboundBytes_ = pending + frame.size();
+                outbound_.push_back(std::move(frame));
+                // 已等待可写时由EPOLLOUT事件写出
+                if (!flushScheduled_ && !writing_) {
+                    flushScheduled_ = true;
+                    scheduleFlush = true;
+                }
+            }
+        }
+        
+        if (slowConsumer) {
+            LOG_WARNING("Client %llu has %zu bytes pending output (high water mark %zu), disconnecting slow consumer",
+                        id_, getPendingOutputBytes(), highWaterMark_);
+            disconnect();
+            return false;
+        }
+        if (scheduleFlush) {
+            auto self = shared_from_this();
+            loop_->queueInLoop([self] { self->flushOutput(); });
+        }
+        return true;
+    }
+    
     std::lock_guard<std::mutex> lock(writeMutex_);
     
     size_t totalSent = 0;
-    size_t messageSize = message.size();
-    const char* buffer = message.c_str();
+    size_t messageSize = frame.size();
+    const char* buffer = frame.data();
     
     while (totalSent < messageSize) {
-        ssize_t sent = ::send(socketFd_, buffer + totalSent, messageSize - totalSent, 0);
+        ssize_t sent = ::send(socketFd_, buffer + totalSent, messageSize - totalSent, MSG_NOSIGNAL);
         if (sent <= 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // 缓冲区已满，稍后重试
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
                 continue;
             }
             LOG_ERROR("Send failed for client %llu: %s", id_, strerror(errno));
@@ -111,24 +204,289 @@ bool TcpConnection::send(const std::string& message) {
     return true;
 }
 
+void TcpConnection::flushOutput() {
+    if (!connected_) {
+        return;
+    }
+    
+    bool failed = false;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        flushScheduled_ = false;
+        
+        bool wantWrite = false;
+        while (!outbound_.empty()) {
+            // 把队列中的多条消息合并为一次系统调用
+            struct iovec iov[MAX_WRITE_IOVECS];
+            int count = 0;
+            size_t offset = outboundOffset_;
+            for (auto it = outbound_.begin(); it != outbound_.end() && count < MAX_WRITE_IOVECS; ++it) {
+                iov[count].iov_base = const_cast<char*>(it->data()) + offset;
+                iov[count].iov_len = it->size() - offset;
+                offset = 0;
+                ++count;
+            }
+            
+            // sendmsg等同于writev，但可以带MSG_NOSIGNAL避免对端关闭时触发SIGPIPE
+            struct msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+            ssize_t sent = sendmsg(socketFd_, &msg, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    wantWrite = true;
+                } else {
+                    LOG_ERROR("Send failed for client %llu: %s", id_, strerror(errno));
+                    failed = true;
+                }
+                break;
+            }
+            
+            // 移除已完整写出的消息，部分写出的记录偏移量
+            size_t remaining = static_cast<size_t>(sent);
+            outboundBytes_ -= remaining;
+            while (remaining > 0) {
+                size_t left = outbound_.front().size() - outboundOffset_;
+                if (remaining < left) {
+                    outboundOffset_ += remaining;
+                    break;
+                }
+                remaining -= left;
+                outbound_.pop_front();
+                outboundOffset_ = 0;
+            }
+        }
+        
+        // 套接字缓冲区已满时注册EPOLLOUT，写完后取消，避免边缘触发下空转
+        if (!failed && wantWrite != writing_) {
+            writing_ = wantWrite;
+            updateEvents(wantWrite);
+        }
+    }
+    
+    if (failed) {
+        closeInLoop(true);
+        return;
+    }
+    
+    // 发送缓冲区降到高水位一半以下后恢复读取
+    if (readPaused_ && outboundBytes_ <= highWaterMark_ / 2) {
+        LOG_DEBUG("Resuming reads for client %llu", id_);
+        readPaused_ = false;
+        handleRead();
+    }
+}
+
+bool TcpConnection::outputBlocked() const {
+    return loop_ && slowConsumerPolicy_ == SlowConsumerPolicy::BACKPRESSURE && outboundBytes_ > highWaterMark_;
+}
+
+void TcpConnection::updateEvents(bool wantWrite) {
+    loop_->modifyFd(socketFd_, wantWrite ? (READ_EVENTS | EPOLLOUT) : READ_EVENTS);
+}
+
 void TcpConnection::startReading() {
-    LOG_DEBUG("Starting read thread for client %llu", id_);
-    readThread_ = std::thread(&TcpConnection::readLoop, this);
+    if (!loop_) {
+        LOG_DEBUG("Starting read thread for client %llu", id_);
+        if (idleTimeoutMs_ > 0) {
+            // 超时后recv返回EAGAIN，读线程据此断开空闲连接
+            struct timeval timeout;
+            timeout.tv_sec = idleTimeoutMs_ / 1000;
+            timeout.tv_usec = static_cast<suseconds_t>(idleTimeoutMs_ % 1000) * 1000;
+            setsockopt(socketFd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+        // 读线程持有连接的引用，断开回调中移除连接后readLoop仍可安全访问成员
+        auto self = shared_from_this();
+        readThread_ = std::thread([self] { self->readLoop(); });
+        return;
+    }
+    
+    LOG_DEBUG("Registering client %llu with event loop", id_);
+    // 由accept4创建的套接字已是非阻塞的
+    int flags = fcntl(socketFd_, F_GETFL, 0);
+    if (flags < 0 || (!(flags & O_NONBLOCK) && fcntl(socketFd_, F_SETFL, flags | O_NONBLOCK) < 0)) {
+        LOG_ERROR("Failed to set non-blocking mode for client %llu: %s", id_, strerror(errno));
+    }
+    
+    // 注册后由事件循环持有连接的引用，直到连接关闭
+    auto self = shared_from_this();
+    loop_->runInLoop([self] {
+        if (!self->connected_) {
+            return;
+        }
+        bool added = self->loop_->addFd(self->socketFd_, READ_EVENTS,
+            [self](uint32_t events) {
+                self->handleEvent(events);
+            });
+        if (!added) {
+            self->closeInLoop(true);
+        }
+    });
+}
+
+void TcpConnection::handleEvent(uint32_t events) {
+    if (events & EPOLLOUT) {
+        flushOutput();
+    }
+    if (connected_ && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+        handleRead();
+    }
+}
+
+bool TcpConnection::negotiateProtocol() {
+    if (!binaryProtocol_) {
+        protocolNegotiated_ = true;
+        return true;
+    }
+    
+    // 以魔数开头的连接使用二进制协议，收到的字节还是魔数的前缀时等待更多数据
+    std::string_view pending = decoder_.peek();
+    size_t compared = std::min(pending.size(), BINARY_PROTOCOL_MAGIC.size());
+    if (compared == 0) {
+        return false;
+    }
+    if (pending.compare(0, compared, BINARY_PROTOCOL_MAGIC, 0, compared) == 0) {
+        if (compared < BINARY_PROTOCOL_MAGIC.size()) {
+            return false;
+        }
+        decoder_.consume(BINARY_PROTOCOL_MAGIC.size());
+        decoder_.setMode(FramingMode::BINARY);
+        protocol_ = WireProtocol::BINARY;
+        LOG_DEBUG("Client %llu negotiated binary protocol", id_);
+    }
+    protocolNegotiated_ = true;
+    return true;
+}
+
+bool TcpConnection::dispatchFrames() {
+    if (!protocolNegotiated_ && !negotiateProtocol()) {
+        return true;
+    }
+    
+    std::string_view frame;
+    uint64_t now = rateLimit_ ? TimeUtil::steadyTimeMillis() : 0;
+    // 发送缓冲区超过高水位时剩余的帧留在接收缓冲区，恢复读取后再分发
+    while (connected_ && !outputBlocked() && decoder_.nextFrame(frame)) {
+        // 空帧只用于保活，不分发
+        if (frame.empty()) {
+            continue;
+        }
+        // 超过限速的请求不进入请求处理，直接回复预先编码的拒绝响应
+        if (rateLimit_ && !requestBucket_.tryConsume(now)) {
+            ++rateLimit_->rejected;
+            LOG_DEBUG("Client %llu exceeded request rate limit", id_);
+            if (protocol_ == WireProtocol::BINARY) {
+                // 二进制协议的拒绝响应要带上请求的opcode和request_id
+                send(encodeBinaryError(frame, BinaryStatus::RATE_LIMITED, "Rate limit exceeded"));
+            } else {
+                // 带id的请求要带回id，客户端才能对应到是哪个请求被拒绝
+                std::string reply;
+                if (appendJsonWithRequestId(frame, rateLimit_->rejectMessage, reply)) {
+                    send(reply);
+                } else {
+                    sendEncoded(rateLimit_->rejectFrame);
+                }
+            }
+            continue;
+        }
+        if (messageCallback_) {
+            try {
+                messageCallback_(id_, frame);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Exception in message callback for client %llu: %s", id_, e.what());
+            } catch (...) {
+                LOG_ERROR("Unknown exception in message callback for client %llu", id_);
+            }
+        }
+    }
+    
+    if (decoder_.hasError()) {
+        LOG_WARNING("Frame from client %llu exceeds %zu bytes, closing connection", id_, decoder_.getMaxFrameSize());
+        return false;
+    }
+    return true;
+}
+
+void TcpConnection::handleRead() {
+    // 边缘触发：一直读到EAGAIN为止，每次读取前先分发接收缓冲区中已完整的帧
+    while (connected_) {
+        if (!dispatchFrames()) {
+            closeInLoop(true);
+            return;
+        }
+        // 对端不读取响应导致发送缓冲区超过高水位时暂停读取，不再处理新请求；
+        // 未读的数据留在内核缓冲区，TCP流控最终会让对端停止发送
+        if (outputBlocked()) {
+            if (!readPaused_) {
+                LOG_DEBUG("Pausing reads for client %llu, %zu bytes pending output", id_, getPendingOutputBytes());
+                readPaused_ = true;
+            }
+            return;
+        }
+        char* buffer = decoder_.beginWrite(READ_CHUNK_SIZE);
+        ssize_t bytesRead = recv(socketFd_, buffer, decoder_.writableBytes(), 0);
+        if (bytesRead > 0) {
+            LOG_DEBUG("Received %zd bytes from client %llu", bytesRead, id_);
+            decoder_.commitWrite(bytesRead);
+            lastReadTime_ = TimeUtil::steadyTimeMillis();
+        } else if (bytesRead == 0) {
+            LOG_DEBUG("Client %llu closed connection (bytesRead = 0)", id_);
+            closeInLoop(true);
+            return;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        } else {
+            LOG_ERROR("Recv error for client %llu: %s", id_, strerror(errno));
+            closeInLoop(true);
+            return;
+        }
+    }
+}
+
+void TcpConnection::closeInLoop(bool notify) {
+    if (!connected_.exchange(false)) {
+        return;
+    }
+    
+    LOG_DEBUG("Closing socket in event loop for client %llu", id_);
+    loop_->removeFd(socketFd_);
+    close(socketFd_);
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        outbound_.clear();
+        outboundOffset_ = 0;
+        outboundBytes_ = 0;
+        writing_ = false;
+    }
+    
+    if (notify && disconnectCallback_) {
+        try {
+            LOG_DEBUG("Calling disconnect callback for client %llu", id_);
+            disconnectCallback_(id_);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Exception in disconnect callback for client %llu: %s", id_, e.what());
+        } catch (...) {
+            LOG_ERROR("Unknown exception in disconnect callback for client %llu", id_);
+        }
+    }
 }
 
 void TcpConnection::readLoop() {
     LOG_DEBUG("Read loop started for client %llu", id_);
-    const size_t bufferSize = 4096;
-    char buffer[bufferSize];
     
     try {
         while (connected_) {
-            std::memset(buffer, 0, bufferSize);
-            
+            char* buffer = decoder_.beginWrite(READ_CHUNK_SIZE);
             ssize_t bytesRead = 0;
             try {
                 LOG_DEBUG("Waiting for data from client %llu", id_);
-                bytesRead = recv(socketFd_, buffer, bufferSize - 1, 0);
+                bytesRead = recv(socketFd_, buffer, decoder_.writableBytes(), 0);
                 LOG_DEBUG("Received %zd bytes from client %llu", bytesRead, id_);
             } catch (...) {
                 // 捕获潜在的接收异常
@@ -137,27 +495,22 @@ void TcpConnection::readLoop() {
             }
             
             if (bytesRead > 0) {
-                if (messageCallback_) {
-                    try {
-                        LOG_DEBUG("Calling message callback for client %llu", id_);
-                        messageCallback_(id_, std::string(buffer, bytesRead));
-                        LOG_DEBUG("Message callback completed for client %llu", id_);
-                    } catch (const std::exception& e) {
-                        LOG_ERROR("Exception in message callback for client %llu: %s", id_, e.what());
-                    } catch (...) {
-                        LOG_ERROR("Unknown exception in message callback for client %llu", id_);
-                    }
+                // 一次读取可能包含多个请求或半个请求，只分发完整的帧
+                decoder_.commitWrite(bytesRead);
+                if (!dispatchFrames()) {
+                    break;
                 }
             } else if (bytesRead == 0) {
                 // 客户端关闭连接
                 LOG_DEBUG("Client %llu closed connection (bytesRead = 0)", id_);
                 break;
-            } else {
-                // 错误
-                if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                    LOG_ERROR("Recv error for client %llu: %s", id_, strerror(errno));
-                    break;
-                }
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // 阻塞套接字只有设置了接收超时才会返回EAGAIN
+                LOG_INFO("Closing idle client %llu (no data for %u ms)", id_, idleTimeoutMs_);
+                break;
+            } else if (errno != EINTR) {
+                LOG_ERROR("Recv error for client %llu: %s", id_, strerror(errno));
+                break;
             }
         }
     } catch (const std::exception& e) {
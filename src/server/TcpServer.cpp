@@ -1,15 +1,68 @@
 #include "TcpServer.h"
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <future>
 #include <iostream>
 #include <stdexcept>
 #include "../util/Logger.h"
+#include "../util/TimeUtil.h"
 
 namespace gmatch {
 
+const char* ioModelName(IoModel model) {
+    switch (model) {
+        case IoModel::THREAD_PER_CONNECTION:
+            return "thread";
+        case IoModel::REACTOR:
+        default:
+            return "reactor";
+    }
+}
+
+bool parseIoModel(const std::string& name, IoModel& model) {
+    if (name == "reactor") {
+        model = IoModel::REACTOR;
+        return true;
+    }
+    if (name == "thread") {
+        model = IoModel::THREAD_PER_CONNECTION;
+        return true;
+    }
+    return false;
+}
+
+const char* slowConsumerPolicyName(SlowConsumerPolicy policy) {
+    switch (policy) {
+        case SlowConsumerPolicy::DISCONNECT:
+            return "disconnect";
+        case SlowConsumerPolicy::BACKPRESSURE:
+        default:
+            return "backpressure";
+    }
+}
+
+bool parseSlowConsumerPolicy(const std::string& name, SlowConsumerPolicy& policy) {
+    if (name == "backpressure") {
+        policy = SlowConsumerPolicy::BACKPRESSURE;
+        return true;
+    }
+    if (name == "disconnect") {
+        policy = SlowConsumerPolicy::DISCONNECT;
+        return true;
+    }
+    return false;
+}
+
 // TcpServer实现
 TcpServer::TcpServer(const std::string& address, uint16_t port)
     : address_(address), port_(port) {
@@ -29,53 +82,425 @@ bool TcpServer::start() {
     
     LOG_DEBUG("Starting TcpServer");
     
-    // 创建服务器socket
-    serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket_ < 0) {
-        LOG_ERROR("Failed to create server socket: %s", strerror(errno));
-        return false;
+    bool reusePort = reusePort_ && ioModel_ == IoModel::REACTOR;
+    if (reusePort_ && !reusePort) {
+        LOG_WARNING("SO_REUSEPORT listeners require the reactor io model, using a single accept thread");
     }
     
-    // 设置socket选项
-    int opt = 1;
-    if (setsockopt(serverSocket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        LOG_ERROR("Failed to set SO_REUSEADDR: %s", strerror(errno));
-        close(serverSocket_);
+    // 接手其他进程交出的监听套接字时不再解析和绑定配置的地址
+    bool adopted = !adoptedSockets_.empty();
+    if (!adopted && !parseSocketAddress(address_, port_, listenAddress_)) {
+        LOG_ERROR("Invalid address: %s", address_.c_str());
         return false;
     }
+    // Unix域套接字不支持SO_REUSEPORT分摊连接
+    if (!adopted && reusePort && listenAddress_.isUnix()) {
+        LOG_WARNING("SO_REUSEPORT does not apply to unix socket %s, using a single accept thread", address_.c_str());
+        reusePort = false;
+    }
     
-    // 绑定地址和端口
-    struct sockaddr_in serverAddr;
-    std::memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(port_);
+    rateLimit_.reset();
+    if (requestRate_ > 0) {
+        rateLimit_ = std::make_shared<RateLimit>();
+        rateLimit_->requestsPerSecond = requestRate_;
+        rateLimit_->burst = requestBurst_ > 0 ? requestBurst_ : requestRate_;
+        rateLimit_->rejectMessage = rateLimitMessage_;
+        rateLimit_->rejectFrame = encodeFrame(framingMode_, rateLimitMessage_);
+    }
     
-    if (inet_pton(AF_INET, address_.c_str(), &serverAddr.sin_addr) <= 0) {
-        LOG_ERROR("Invalid address: %s", address_.c_str());
-        close(serverSocket_);
+    // 二进制协议的心跳是没有消息体的HEARTBEAT消息
+    binaryHeartbeatMessage_.clear();
+    BinaryWriter(binaryHeartbeatMessage_).header(BinaryOpcode::HEARTBEAT, BinaryStatus::OK, 0);
+    
+    if (ioModel_ == IoModel::REACTOR && !startLoops()) {
         return false;
     }
     
-    if (bind(serverSocket_, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        LOG_ERROR("Failed to bind socket: %s", strerror(errno));
-        close(serverSocket_);
+    // 主地址在SO_REUSEPORT模式下由I/O线程接受，其余监听套接字都由接受线程接受
+    if (adopted) {
+        if (!startAdoptedListeners()) {
+            stopLoops();
+            closeListenSockets();
+            return false;
+        }
+    } else if (reusePort) {
+        if (!startReusePortListeners()) {
+            stopLoops();
+            return false;
+        }
+    } else if (!openAcceptSocket(listenAddress_)) {
+        stopLoops();
         return false;
     }
     
+    // 附加地址没有写端口时使用主地址的端口；接手的套接字已包含旧进程的所有地址
+    if (!adopted) {
+        if (!listenAddress_.isUnix()) {
+            port_ = listenAddress_.getPort();
+        }
+        for (const auto& spec : extraAddresses_) {
+            SocketAddress address;
+            if (!parseSocketAddress(spec, port_, address)) {
+                LOG_ERROR("Invalid listen address: %s", spec.c_str());
+                stopLoops();
+                closeListenSockets();
+                return false;
+            }
+            if (!openAcceptSocket(address)) {
+                stopLoops();
+                closeListenSockets();
+                return false;
+            }
+        }
+    }
+    
+    running_ = true;
+    accepting_ = true;
+    if (!acceptSockets_.empty()) {
+        acceptWakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (acceptWakeFd_ < 0) {
+            LOG_ERROR("Failed to create accept wakeup fd: %s", strerror(errno));
+            running_ = false;
+            accepting_ = false;
+            stopLoops();
+            closeListenSockets();
+            return false;
+        }
+        acceptThread_ = std::thread(&TcpServer::acceptLoop, this);
+    }
+    
+    std::string addresses;
+    for (const auto& address : boundAddresses_) {
+        addresses += (addresses.empty() ? "" : ", ") + address.toString();
+    }
+    LOG_INFO("Server started at %s (io model: %s, io threads: %zu, acceptors: %zu, framing: %s)", addresses.c_str(),
+             ioModelName(ioModel_), ioModel_ == IoModel::REACTOR ? loops_.size() : 0,
+             listenSockets_.size() + (acceptSockets_.empty() ? 0 : 1), framingModeName(framingMode_));
+    return true;
+}
+
+int TcpServer::openListenSocket(SocketAddress& address, bool reusePort) {
+    // 接受线程用poll等待多个监听套接字，I/O线程用epoll，都需要非阻塞
+    int fd = socket(address.getFamily(), SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create server socket: %s", strerror(errno));
+        return -1;
+    }
+    
+    // 设置socket选项
+    int opt = 1;
+    if (!address.isUnix() && setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        LOG_ERROR("Failed to set SO_REUSEADDR: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if (reusePort && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        LOG_ERROR("Failed to set SO_REUSEPORT: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    // IPv6监听套接字只接受IPv6连接，才能和同端口的IPv4监听套接字共存
+    if (address.getFamily() == AF_INET6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &opt, sizeof(opt)) < 0) {
+        LOG_ERROR("Failed to set IPV6_V6ONLY: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    // 上次异常退出留下的套接字文件会导致bind失败，只删除套接字类型的文件
+    if (address.isUnix()) {
+        struct stat st;
+        std::string path = address.getPath();
+        if (stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+            unlink(path.c_str());
+        }
+    }
+    
+    // 绑定地址和端口
+    if (bind(fd, address.get(), address.length) < 0) {
+        LOG_ERROR("Failed to bind %s: %s", address.toString().c_str(), strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
     // 监听连接
-    if (listen(serverSocket_, SOMAXCONN) < 0) {
+    if (listen(fd, SOMAXCONN) < 0) {
         LOG_ERROR("Failed to listen: %s", strerror(errno));
-        close(serverSocket_);
+        close(fd);
+        return -1;
+    }
+    
+    // 端口为0时由系统分配，记录实际监听的端口，之后的监听套接字绑定到同一端口
+    if (!address.isUnix() && address.getPort() == 0) {
+        struct sockaddr_storage bound;
+        socklen_t boundLen = sizeof(bound);
+        if (getsockname(fd, (struct sockaddr*)&bound, &boundLen) == 0) {
+            address.setPort(socketAddressFrom(bound, boundLen).getPort());
+        }
+    }
+    return fd;
+}
+
+bool TcpServer::openAcceptSocket(SocketAddress& address) {
+    int fd = openListenSocket(address, false);
+    if (fd < 0) {
         return false;
     }
+    acceptSockets_.push_back(fd);
+    boundAddresses_.push_back(address);
+    return true;
+}
+
+bool TcpServer::startReusePortListeners() {
+    for (auto& loop : loops_) {
+        int fd = openListenSocket(listenAddress_, true);
+        if (fd < 0) {
+            closeListenSockets();
+            return false;
+        }
+        registerListenSocket(fd, loop.get());
+    }
+    boundAddresses_.push_back(listenAddress_);
+    return true;
+}
+
+void TcpServer::registerListenSocket(int fd, EventLoop* loop) {
+    listenSockets_.emplace_back(fd, loop);
     
-    running_ = true;
-    acceptThread_ = std::thread(&TcpServer::acceptLoop, this);
+    // 每个I/O线程只接受自己监听套接字上的连接，新连接也留在该线程中处理
+    loop->runInLoop([this, fd, loop] {
+        bool added = loop->addFd(fd, EPOLLIN, [this, fd, loop](uint32_t) {
+            handleAccept(fd, loop);
+        });
+        if (!added) {
+            LOG_ERROR("Failed to register listen socket %d with I/O thread", fd);
+        }
+    });
+}
+
+bool TcpServer::startAdoptedListeners() {
+    size_t nextLoop = 0;
+    bool portKnown = false;
+    for (int fd : adoptedSockets_) {
+        struct sockaddr_storage storage;
+        socklen_t length = sizeof(storage);
+        int acceptConn = 0;
+        socklen_t optLen = sizeof(acceptConn);
+        if (getsockname(fd, (struct sockaddr*)&storage, &length) < 0 ||
+            getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &acceptConn, &optLen) < 0 || !acceptConn) {
+            LOG_ERROR("Inherited fd %d is not a listening socket", fd);
+            // 已登记的套接字由closeListenSockets()关闭，这里关闭剩余的
+            for (auto it = std::find(adoptedSockets_.begin(), adoptedSockets_.end(), fd); it != adoptedSockets_.end(); ++it) {
+                close(*it);
+            }
+            adoptedSockets_.clear();
+            return false;
+        }
+        
+        // 交接前后是同一个打开的套接字，非阻塞标志随之保留，这里再设置一次以防旧进程不是本程序
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags >= 0) {
+            fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        }
+        
+        SocketAddress address = socketAddressFrom(storage, length);
+        int reuse = 0;
+        socklen_t reuseLen = sizeof(reuse);
+        bool reusePort = ioModel_ == IoModel::REACTOR && !address.isUnix() &&
+                         getsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &reuse, &reuseLen) == 0 && reuse;
+        if (reusePort) {
+            registerListenSocket(fd, loops_[nextLoop++ % loops_.size()].get());
+        } else {
+            acceptSockets_.push_back(fd);
+        }
+        
+        bool known = std::any_of(boundAddresses_.begin(), boundAddresses_.end(), [&address](const SocketAddress& bound) {
+            return bound.toString() == address.toString();
+        });
+        if (!known) {
+            boundAddresses_.push_back(address);
+        }
+        // 第一个IP地址的端口作为服务器端口
+        if (!address.isUnix() && !portKnown) {
+            port_ = address.getPort();
+            portKnown = true;
+        }
+    }
+    LOG_INFO("Took over %zu listen sockets, configured listen addresses are ignored", adoptedSockets_.size());
+    adoptedSockets_.clear();
+    return true;
+}
+
+std::vector<int> TcpServer::releaseListenSockets() {
+    std::vector<int> fds;
+    if (!running_ || !accepting_) {
+        return fds;
+    }
+    
+    // 停止接受线程，监听套接字保持打开，新连接留在内核队列中等待接手的进程
+    accepting_ = false;
+    wakeAcceptThread();
+    if (acceptThread_.joinable()) {
+        acceptThread_.join();
+    }
+    fds = acceptSockets_;
+    acceptSockets_.clear();
     
-    LOG_INFO("Server started at %s:%d", address_.c_str(), port_);
+    // 在各自的I/O线程中注销，返回之后不会再有线程在这些套接字上accept
+    for (const auto& pair : listenSockets_) {
+        int fd = pair.first;
+        EventLoop* loop = pair.second;
+        std::promise<void> removed;
+        auto done = removed.get_future();
+        loop->runInLoop([loop, fd, &removed] {
+            loop->removeFd(fd);
+            removed.set_value();
+        });
+        done.wait();
+        fds.push_back(fd);
+    }
+    listenSockets_.clear();
+    boundAddresses_.clear();
+    
+    LOG_INFO("Released %zu listen sockets, no longer accepting connections", fds.size());
+    return fds;
+}
+
+void TcpServer::closeListenSockets() {
+    for (const auto& pair : listenSockets_) {
+        close(pair.first);
+    }
+    listenSockets_.clear();
+    for (int fd : acceptSockets_) {
+        close(fd);
+    }
+    acceptSockets_.clear();
+    
+    // 删除自己创建的Unix域套接字文件
+    for (const auto& address : boundAddresses_) {
+        if (address.isUnix()) {
+            unlink(address.getPath().c_str());
+        }
+    }
+    boundAddresses_.clear();
+}
+
+bool TcpServer::startLoops() {
+    if (loops_.empty()) {
+        size_t threadCount = ioThreads_ > 0 ? ioThreads_ : std::thread::hardware_concurrency();
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+        for (size_t i = 0; i < threadCount; ++i) {
+            loops_.push_back(std::make_unique<EventLoop>());
+        }
+    }
+    
+    for (auto& loop : loops_) {
+        if (!loop->start()) {
+            LOG_ERROR("Failed to start I/O thread");
+            stopLoops();
+            return false;
+        }
+    }
+    startIdleWheels();
     return true;
 }
 
+void TcpServer::startIdleWheels() {
+    idleWheels_.clear();
+    if (idleTimeoutMs_ == 0 && heartbeatIntervalMs_ == 0) {
+        return;
+    }
+    
+    // 刻度取较短间隔的1/4，限制在10ms到1s之间；槽位数覆盖最长的间隔
+    uint32_t shortest = idleTimeoutMs_ == 0 ? heartbeatIntervalMs_
+                      : heartbeatIntervalMs_ == 0 ? idleTimeoutMs_
+                      : std::min(idleTimeoutMs_, heartbeatIntervalMs_);
+    idleTickMs_ = std::min(std::max(shortest / 4, 10u), 1000u);
+    size_t slotCount = std::max(idleTimeoutMs_, heartbeatIntervalMs_) / idleTickMs_ + 2;
+    
+    for (auto& loop : loops_) {
+        auto& slot = idleWheels_[loop.get()];
+        slot = std::make_unique<IdleWheel>(slotCount);
+        IdleWheel* wheel = slot.get();
+        EventLoop* ioLoop = loop.get();
+        ioLoop->runInLoop([this, wheel, ioLoop] {
+            ioLoop->runEvery(idleTickMs_, [this, wheel] {
+                uint64_t now = TimeUtil::steadyTimeMillis();
+                wheel->advance([this, wheel, now](std::weak_ptr<TcpConnection>& entry) {
+                    checkIdle(*wheel, entry, now);
+                });
+            });
+        });
+    }
+}
+
+void TcpServer::watchIdle(const TcpConnectionPtr& connection, EventLoop* loop) {
+    auto it = idleWheels_.find(loop);
+    if (it == idleWheels_.end()) {
+        return;
+    }
+    
+    IdleWheel* wheel = it->second.get();
+    std::weak_ptr<TcpConnection> entry = connection;
+    loop->runInLoop([this, wheel, entry]() mutable {
+        auto connection = entry.lock();
+        if (connection) {
+            uint64_t delay = nextIdleCheck(*connection) - connection->getLastReadTime();
+            wheel->schedule(std::move(entry), (delay + idleTickMs_ - 1) / idleTickMs_);
+        }
+    });
+}
+
+uint64_t TcpServer::nextIdleCheck(const TcpConnection& connection) const {
+    uint64_t next = UINT64_MAX;
+    if (idleTimeoutMs_ > 0) {
+        next = connection.getLastReadTime() + idleTimeoutMs_;
+    }
+    if (heartbeatIntervalMs_ > 0) {
+        // 收到数据后重新计时，持续空闲时每个间隔发送一次
+        uint64_t lastActivity = std::max(connection.getLastReadTime(), connection.getLastHeartbeatTime());
+        next = std::min(next, lastActivity + heartbeatIntervalMs_);
+    }
+    return next;
+}
+
+void TcpServer::checkIdle(IdleWheel& wheel, std::weak_ptr<TcpConnection>& entry, uint64_t now) {
+    // 已关闭的连接直接从时间轮中丢弃
+    auto connection = entry.lock();
+    if (!connection || !connection->isConnected()) {
+        return;
+    }
+    
+    uint64_t lastRead = connection->getLastReadTime();
+    if (idleTimeoutMs_ > 0 && now >= lastRead + idleTimeoutMs_) {
+        LOG_INFO("Closing idle client %llu (no data for %llu ms)", connection->getId(),
+                 static_cast<unsigned long long>(now - lastRead));
+        connection->disconnect();
+        return;
+    }
+    
+    if (heartbeatIntervalMs_ > 0 &&
+        now >= std::max(lastRead, connection->getLastHeartbeatTime()) + heartbeatIntervalMs_) {
+        LOG_DEBUG("Sending heartbeat to client %llu", connection->getId());
+        connection->send(connection->getProtocol() == WireProtocol::BINARY ? binaryHeartbeatMessage_
+                                                                           : heartbeatMessage_);
+        connection->setLastHeartbeatTime(now);
+    }
+    
+    // 期间收到过数据时只需按新的时间重新放回时间轮，读路径本身不操作时间轮
+    uint64_t next = nextIdleCheck(*connection);
+    uint64_t delay = next > now ? next - now : 0;
+    wheel.schedule(std::move(entry), (delay + idleTickMs_ - 1) / idleTickMs_);
+}
+
+void TcpServer::stopLoops() {
+    // 只停止线程，EventLoop对象保留到服务器析构，仍被外部引用的连接可以安全访问
+    for (auto& loop : loops_) {
+        loop->stop();
+    }
+}
+
 void TcpServer::stop() {
     if (!running_) {
         LOG_DEBUG("TcpServer already stopped");
@@ -84,20 +509,23 @@ void TcpServer::stop() {
     
     LOG_DEBUG("Stopping TcpServer");
     running_ = false;
+    accepting_ = false;
     
-    // 关闭服务器socket
-    if (serverSocket_ >= 0) {
-        LOG_DEBUG("Closing server socket");
-        close(serverSocket_);
-        serverSocket_ = -1;
-    }
-    
-    // 等待接受线程结束
+    // 唤醒在poll中等待的接受线程，等待接受线程结束后再关闭监听套接字
+    wakeAcceptThread();
     if (acceptThread_.joinable()) {
         LOG_DEBUG("Joining accept thread");
         acceptThread_.join();
         LOG_DEBUG("Accept thread joined");
     }
+    if (acceptWakeFd_ >= 0) {
+        close(acceptWakeFd_);
+        acceptWakeFd_ = -1;
+    }
+    
+    // 先停止I/O线程，之后连接只在当前线程中关闭
+    stopLoops();
+    closeListenSockets();
     
     // 关闭所有客户端连接，但不触发回调，因为服务器正在关闭
     LOG_DEBUG("Closing all client connections");
@@ -111,6 +539,11 @@ void TcpServer::stop() {
     LOG_INFO("Server stopped");
 }
 
+size_t TcpServer::getConnectionCount() {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    return connections_.size();
+}
+
 bool TcpServer::sendToClient(TcpConnection::ConnectionId clientId, const std::string& message) {
     std::lock_guard<std::mutex> lock(connectionsMutex_);
     auto it = connections_.find(clientId);
@@ -122,6 +555,19 @@ bool TcpServer::sendToClient(TcpConnection::ConnectionId clientId, const std::st
     return false;
 }
 
+bool TcpServer::sendToClient(TcpConnection::ConnectionId clientId, const std::string& message,
+                             const std::string& binaryMessage) {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    auto it = connections_.find(clientId);
+    if (it != connections_.end() && it->second->isConnected()) {
+        bool binary = it->second->getProtocol() == WireProtocol::BINARY;
+        LOG_DEBUG("Sending %s message to client %llu", binary ? "binary" : "JSON", clientId);
+        return it->second->send(binary ? binaryMessage : message);
+    }
+    LOG_DEBUG("Client %llu not found or not connected", clientId);
+    return false;
+}
+
 void TcpServer::broadcastMessage(const std::string& message) {
     LOG_DEBUG("Broadcasting message to all clients");
     std::lock_guard<std::mutex> lock(connectionsMutex_);
@@ -135,44 +581,118 @@ void TcpServer::broadcastMessage(const std::string& message) {
 
 void TcpServer::acceptLoop() {
     LOG_DEBUG("Accept loop started");
-    while (running_) {
-        struct sockaddr_in clientAddr;
-        socklen_t clientAddrLen = sizeof(clientAddr);
-        
+    std::vector<struct pollfd> fds;
+    for (int fd : acceptSockets_) {
+        fds.push_back({fd, POLLIN, 0});
+    }
+    fds.push_back({acceptWakeFd_, POLLIN, 0});
+    
+    while (accepting_) {
         LOG_DEBUG("Waiting for new connections");
-        int clientSocket = accept(serverSocket_, (struct sockaddr*)&clientAddr, &clientAddrLen);
-        if (clientSocket < 0) {
-            if (errno != EAGAIN && errno != EWOULDBLOCK && running_) {
-                LOG_ERROR("Failed to accept: %s", strerror(errno));
+        int ready = poll(fds.data(), fds.size(), -1);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                LOG_ERROR("Failed to poll listen sockets: %s", strerror(errno));
+                break;
             }
             continue;
         }
-        
-        char clientIP[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, sizeof(clientIP));
-        LOG_DEBUG("New connection from %s:%d", clientIP, ntohs(clientAddr.sin_port));
-        
-        handleNewConnection(clientSocket);
+        for (size_t i = 0; i + 1 < fds.size(); ++i) {
+            if (fds[i].revents != 0 && accepting_) {
+                handleAccept(fds[i].fd, nullptr);
+            }
+        }
     }
     LOG_DEBUG("Accept loop ended");
 }
 
-void TcpServer::handleNewConnection(int clientSocket) {
+void TcpServer::wakeAcceptThread() {
+    if (acceptWakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(acceptWakeFd_, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void TcpServer::handleAccept(int listenFd, EventLoop* loop) {
+    // 监听套接字为水平触发，每次接受到EAGAIN为止，剩余的连接在下一轮继续处理
+    // reactor模式下新连接直接以非阻塞方式创建，省去之后的fcntl
+    int flags = SOCK_CLOEXEC | (ioModel_ == IoModel::REACTOR ? SOCK_NONBLOCK : 0);
+    while (true) {
+        int clientSocket = accept4(listenFd, nullptr, nullptr, flags);
+        if (clientSocket < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("Failed to accept: %s", strerror(errno));
+            }
+            return;
+        }
+        handleNewConnection(clientSocket, loop);
+    }
+}
+
+void TcpServer::handleNewConnection(int clientSocket, EventLoop* loop) {
+    // 连接数达到上限时直接关闭，不分配ID也不通知上层；
+    // 检查通过时在同一次加锁内预留名额，多个接受线程并发时也不会超出上限
+    bool reserved = false;
+    if (maxConnections_ > 0) {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        if (connections_.size() + reservedConnections_ >= maxConnections_) {
+            ++rejectedConnections_;
+            LOG_DEBUG("Connection limit %zu reached, rejecting new connection", maxConnections_);
+            close(clientSocket);
+            return;
+        }
+        ++reservedConnections_;
+        reserved = true;
+    }
+    
     auto clientId = nextClientId_++;
     LOG_DEBUG("Handling new connection, assigned ID %llu", clientId);
     
-    auto connection = std::make_shared<TcpConnection>(clientSocket, clientId);
-    connection->setMessageCallback(
-        [this](TcpConnection::ConnectionId id, const std::string& msg) {
-            handleClientMessage(id, msg);
-        });
-    connection->setDisconnectCallback(
-        [this](TcpConnection::ConnectionId id) {
-            handleClientDisconnect(id);
-        });
+    // 未指定时按轮询顺序分配给I/O线程
+    if (!loop && !loops_.empty()) {
+        loop = loops_[nextLoop_++ % loops_.size()].get();
+    }
+    
+    TcpConnectionPtr connection;
+    try {
+        connection = std::make_shared<TcpConnection>(clientSocket, clientId, loop);
+        connection->setFraming(framingMode_, maxFrameSize_);
+        connection->setBinaryProtocol(binaryProtocol_);
+        connection->setSendHighWaterMark(sendHighWaterMark_, slowConsumerPolicy_);
+        connection->setIdleTimeout(idleTimeoutMs_);
+        if (rateLimit_) {
+            connection->setRateLimit(rateLimit_);
+        }
+        connection->setMessageCallback(
+            [this](TcpConnection::ConnectionId id, std::string_view msg) {
+                handleClientMessage(id, msg);
+            });
+        connection->setDisconnectCallback(
+            [this](TcpConnection::ConnectionId id) {
+                handleClientDisconnect(id);
+            });
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to set up client %llu: %s", clientId, e.what());
+        // 连接对象已创建时由析构关闭套接字
+        if (!connection) {
+            close(clientSocket);
+        }
+        if (reserved) {
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            --reservedConnections_;
+        }
+        return;
+    }
     
     {
         std::lock_guard<std::mutex> lock(connectionsMutex_);
+        if (reserved) {
+            --reservedConnections_;
+        }
         connections_[clientId] = connection;
         LOG_DEBUG("Added client %llu to connections map", clientId);
     }
@@ -190,9 +710,12 @@ void TcpServer::handleNewConnection(int clientSocket) {
     }
     
     connection->startReading();
+    if (loop) {
+        watchIdle(connection, loop);
+    }
 }
 
-void TcpServer::handleClientMessage(TcpConnection::ConnectionId clientId, const std::string& message) {
+void TcpServer::handleClientMessage(TcpConnection::ConnectionId clientId, std::string_view message) {
     TcpConnectionPtr connection;
     
     {
@@ -7,41 +7,167 @@
 #include <atomic>
 #include <vector>
 #include <unordered_map>
+#include <deque>
 #include <memory>
+#include "EventLoop.h"
+#include "../util/BinaryProtocol.h"
+#include "../util/FrameCodec.h"
+#include "../util/SocketAddress.h"
+#include "../util/TimingWheel.h"
+#include "../util/TokenBucket.h"
 
 namespace gmatch {
 
+// I/O模型
+enum class IoModel {
+    REACTOR,               // 固定数量的I/O线程，每个线程一个epoll循环（边缘触发），管理非阻塞套接字
+    THREAD_PER_CONNECTION  // 每个连接一个阻塞读线程
+};
+
+// 模型名称，用于配置和日志输出："reactor" / "thread"
+const char* ioModelName(IoModel model);
+bool parseIoModel(const std::string& name, IoModel& model);
+
+// 发送缓冲区超过高水位时的处理方式
+enum class SlowConsumerPolicy {
+    BACKPRESSURE,  // 暂停读取该连接的请求，待发送缓冲区降到高水位一半以下再恢复
+    DISCONNECT     // 直接断开连接
+};
+
+// 策略名称，用于配置："backpressure" / "disconnect"
+const char* slowConsumerPolicyName(SlowConsumerPolicy policy);
+bool parseSlowConsumerPolicy(const std::string& name, SlowConsumerPolicy& policy);
+
+// 每个连接的请求速率限制，由服务器创建后由所有连接共享
+struct RateLimit {
+    double requestsPerSecond = 0.0;
+    double burst = 0.0;
+    std::string rejectMessage;  // JSON拒绝响应，请求带id时插入id后发送
+    std::string rejectFrame;    // 已按分帧方式编码好的拒绝响应，请求不带id时直接发送
+    std::atomic<uint64_t> rejected{0};
+};
+
 // 用于表示连接的客户端
-class TcpConnection {
+class TcpConnection : public std::enable_shared_from_this<TcpConnection> {
 public:
     using ConnectionId = uint64_t;
-    using MessageCallback = std::function<void(ConnectionId, const std::string&)>;
+    // message指向连接的接收缓冲区，只在回调期间有效，需要保留时由回调方复制
+    using MessageCallback = std::function<void(ConnectionId, std::string_view)>;
     using DisconnectCallback = std::function<void(ConnectionId)>;
     
-    TcpConnection(int socketFd, ConnectionId id);
+    static constexpr size_t DEFAULT_SEND_HIGH_WATER_MARK = 1024 * 1024;
+    
+    // loop为空时使用独立的读线程，否则由loop所在的I/O线程读取
+    TcpConnection(int socketFd, ConnectionId id, EventLoop* loop = nullptr);
     ~TcpConnection();
     
     ConnectionId getId() const { return id_; }
     bool isConnected() const { return connected_; }
     
-    bool send(const std::string& message);
+    // 按连接的分帧方式编码后发送
+    // reactor模式下只追加到发送缓冲区，由所属I/O线程合并多条消息用一次writev写出，不阻塞调用线程
+    bool send(std::string_view message);
+    // 发送已按连接的分帧方式编码好的帧，用于预先构造的固定响应
+    bool sendEncoded(std::string frame);
     void disconnect();
     void disconnectWithoutCallback();  // 断开连接但不触发回调
     
     void setMessageCallback(MessageCallback callback) { messageCallback_ = callback; }
     void setDisconnectCallback(DisconnectCallback callback) { disconnectCallback_ = callback; }
     
+    // 设置分帧方式，需在startReading()之前调用
+    void setFraming(FramingMode mode, size_t maxFrameSize = FrameDecoder::DEFAULT_MAX_FRAME_SIZE) {
+        decoder_ = FrameDecoder(mode, maxFrameSize);
+        framingMode_ = mode;
+    }
+    // 协商为二进制协议后为FramingMode::BINARY
+    FramingMode getFramingMode() const {
+        return protocol_ == WireProtocol::BINARY ? FramingMode::BINARY : framingMode_;
+    }
+    
+    // 允许客户端以魔数开头协商二进制协议，需在startReading()之前调用
+    void setBinaryProtocol(bool enable) { binaryProtocol_ = enable; }
+    // 协商之前和未启用二进制协议时为JSON
+    WireProtocol getProtocol() const { return protocol_; }
+    
+    // 设置发送缓冲区高水位(字节)及超过时的处理方式，只对reactor模式生效
+    void setSendHighWaterMark(size_t bytes, SlowConsumerPolicy policy) {
+        highWaterMark_ = bytes;
+        slowConsumerPolicy_ = policy;
+    }
+    
+    // 尚未写入套接字的字节数
+    size_t getPendingOutputBytes() const { return outboundBytes_; }
+    
+    // 超过限速的请求不分发，直接回复limit中预先编码的拒绝响应；需在startReading()之前调用
+    void setRateLimit(const std::shared_ptr<RateLimit>& limit) {
+        rateLimit_ = limit;
+        requestBucket_ = TokenBucket(limit->requestsPerSecond, limit->burst);
+    }
+    
+    // 每连接一个读线程时，超过ms毫秒没有收到数据即断开，0表示不超时；需在startReading()之前调用
+    // reactor模式下的空闲检测由TcpServer的时间轮负责
+    void setIdleTimeout(uint32_t ms) { idleTimeoutMs_ = ms; }
+    
+    // 最近一次收到数据和发送心跳的时间(TimeUtil::steadyTimeMillis)，只在所属I/O线程中访问
+    uint64_t getLastReadTime() const { return lastReadTime_; }
+    uint64_t getLastHeartbeatTime() const { return lastHeartbeatTime_; }
+    void setLastHeartbeatTime(uint64_t ms) { lastHeartbeatTime_ = ms; }
+    
     void startReading();
     
 private:
     void readLoop();
     
+    // 以下方法只在所属EventLoop的线程中调用
+    void handleEvent(uint32_t events);
+    void handleRead();
+    void closeInLoop(bool notify);
+    void flushOutput();
+    void updateEvents(bool wantWrite);
+    // backpressure策略下发送缓冲区超过高水位，暂停处理该连接的请求
+    bool outputBlocked() const;
+    
+    // 按顺序分发接收缓冲区中的完整帧，帧超长时返回false
+    bool dispatchFrames();
+    // 根据连接开头的字节确定协议，数据不足以判断时返回false
+    bool negotiateProtocol();
+    
     int socketFd_;
     ConnectionId id_;
+    EventLoop* loop_;
     std::atomic<bool> connected_{true};
     std::thread readThread_;
     std::mutex writeMutex_;
     
+    // 发送缓冲区，由writeMutex_保护；outboundOffset_为队首消息已写出的字节数
+    std::deque<std::string> outbound_;
+    size_t outboundOffset_ = 0;
+    std::atomic<size_t> outboundBytes_{0};
+    bool flushScheduled_ = false;
+    bool writing_ = false;  // 已注册EPOLLOUT，等待套接字可写
+    size_t highWaterMark_ = DEFAULT_SEND_HIGH_WATER_MARK;
+    SlowConsumerPolicy slowConsumerPolicy_ = SlowConsumerPolicy::BACKPRESSURE;
+    // 因发送缓冲区过高暂停读取，只在所属I/O线程中访问
+    bool readPaused_ = false;
+    
+    // 请求限速，只由读线程或所属I/O线程访问
+    std::shared_ptr<RateLimit> rateLimit_;
+    TokenBucket requestBucket_;
+    
+    uint32_t idleTimeoutMs_ = 0;
+    uint64_t lastReadTime_ = 0;
+    uint64_t lastHeartbeatTime_ = 0;
+    
+    // 接收缓冲区，只由读线程或所属I/O线程访问
+    FrameDecoder decoder_;
+    FramingMode framingMode_ = FramingMode::LINE;
+    
+    // 协议协商：protocolNegotiated_只由读线程或所属I/O线程访问，协商结果可在任意线程读取
+    bool binaryProtocol_ = false;
+    bool protocolNegotiated_ = false;
+    std::atomic<WireProtocol> protocol_{WireProtocol::JSON};
+    
     MessageCallback messageCallback_;
     DisconnectCallback disconnectCallback_;
 };
@@ -52,7 +178,8 @@ using TcpConnectionPtr = std::shared_ptr<TcpConnection>;
 class TcpServer {
 public:
     using ConnectionCallback = std::function<void(const TcpConnectionPtr&)>;
-    using MessageCallback = std::function<void(const TcpConnectionPtr&, const std::string&)>;
+    // message指向连接的接收缓冲区，只在回调期间有效，需要保留时由回调方复制
+    using MessageCallback = std::function<void(const TcpConnectionPtr&, std::string_view)>;
     using CloseCallback = std::function<void(const TcpConnectionPtr&)>;
     
     TcpServer(const std::string& address = "0.0.0.0", uint16_t port = 8080);
@@ -63,27 +190,156 @@ public:
     
     bool isRunning() const { return running_; }
     
+    // 实际监听的端口，构造时端口为0则在start()后返回系统分配的端口
+    uint16_t getPort() const { return port_; }
+    
+    // 在构造时的地址之外同时监听的地址，需在start()之前调用；构造时的地址也可以是IPv6或Unix域套接字
+    // 格式见parseSocketAddress，如"[::]:8080"、"::1"或"unix:/run/gmatch.sock"，IP地址没有写端口时使用主地址的端口
+    void addListenAddress(const std::string& address) { extraAddresses_.push_back(address); }
+    // start()之后实际监听的所有地址
+    const std::vector<SocketAddress>& getListenAddresses() const { return boundAddresses_; }
+    
+    // 进程交接：releaseListenSockets()停止接受新连接并交出所有监听套接字，已有连接不受影响，
+    // 返回的套接字由调用方关闭，Unix域套接字文件保留给接手的进程；
+    // adoptListenSockets()在start()之前调用，之后start()直接使用这些套接字而不再绑定配置的地址。
+    // 设置了SO_REUSEPORT的套接字在reactor模式下依次分给各I/O线程，其余由接受线程接受
+    std::vector<int> releaseListenSockets();
+    void adoptListenSockets(std::vector<int> fds) { adoptedSockets_ = std::move(fds); }
+    
+    // 设置I/O模型和I/O线程数，需在start()之前调用；threadCount为0表示使用硬件并发数
+    void setIoModel(IoModel model) { ioModel_ = model; }
+    void setIoThreads(size_t threadCount) { ioThreads_ = threadCount; }
+    IoModel getIoModel() const { return ioModel_; }
+    size_t getIoThreads() const { return ioThreads_; }
+    
+    // reactor模式下为每个I/O线程打开一个SO_REUSEPORT监听套接字，由内核在各线程间分摊新连接；
+    // 关闭时由单独的接受线程接受所有连接。需在start()之前调用
+    void setReusePort(bool enable) { reusePort_ = enable; }
+    bool getReusePort() const { return reusePort_; }
+    
+    // 设置消息分帧方式和单帧最大字节数，需在start()之前调用
+    void setFramingMode(FramingMode mode) { framingMode_ = mode; }
+    void setMaxFrameSize(size_t maxFrameSize) { maxFrameSize_ = maxFrameSize; }
+    FramingMode getFramingMode() const { return framingMode_; }
+    
+    // 设置每个连接发送缓冲区的高水位(字节)及超过时的处理方式，需在start()之前调用
+    void setSendHighWaterMark(size_t bytes) { sendHighWaterMark_ = bytes; }
+    void setSlowConsumerPolicy(SlowConsumerPolicy policy) { slowConsumerPolicy_ = policy; }
+    
+    // 允许客户端在连接开头发送魔数协商二进制协议，需在start()之前调用
+    void setBinaryProtocol(bool enable) { binaryProtocol_ = enable; }
+    bool getBinaryProtocol() const { return binaryProtocol_; }
+    
+    // 同时保持的连接数上限，超过时新连接被直接关闭，0表示不限制；需在start()之前调用
+    void setMaxConnections(size_t maxConnections) { maxConnections_ = maxConnections; }
+    
+    // 每个连接每秒最多处理requestsPerSecond个请求，允许burst个突发，超过的请求回复rejectMessage；
+    // requestsPerSecond为0表示不限速，需在start()之前调用
+    void setRateLimit(double requestsPerSecond, double burst, const std::string& rejectMessage) {
+        requestRate_ = requestsPerSecond;
+        requestBurst_ = burst;
+        rateLimitMessage_ = rejectMessage;
+    }
+    
+    // 当前连接数和准入控制计数
+    size_t getConnectionCount();
+    uint64_t getRejectedConnections() const { return rejectedConnections_; }
+    uint64_t getRateLimitedRequests() const { return rateLimit_ ? rateLimit_->rejected.load() : 0; }
+    
+    // 超过ms毫秒没有收到任何数据的连接被断开，0表示不超时；需在start()之前调用
+    void setIdleTimeout(uint32_t ms) { idleTimeoutMs_ = ms; }
+    // reactor模式下连接空闲intervalMs毫秒后发送一次message作为心跳，之后每隔intervalMs重复，0表示不发送；
+    // 二进制协议的连接收到HEARTBEAT消息。需在start()之前调用
+    void setHeartbeat(uint32_t intervalMs, const std::string& message) {
+        heartbeatIntervalMs_ = intervalMs;
+        heartbeatMessage_ = message;
+    }
+    
     void setConnectionCallback(ConnectionCallback callback) { connectionCallback_ = callback; }
     void setMessageCallback(MessageCallback callback) { messageCallback_ = callback; }
     void setCloseCallback(CloseCallback callback) { closeCallback_ = callback; }
     
     // 向特定客户端发送消息
     bool sendToClient(TcpConnection::ConnectionId clientId, const std::string& message);
+    // 按客户端协商的协议发送message(JSON)或binaryMessage(二进制协议)
+    bool sendToClient(TcpConnection::ConnectionId clientId, const std::string& message, const std::string& binaryMessage);
     
     // 向所有客户端广播消息
     void broadcastMessage(const std::string& message);
     
 private:
     void acceptLoop();
-    void handleNewConnection(int clientSocket);
-    void handleClientMessage(TcpConnection::ConnectionId clientId, const std::string& message);
+    void wakeAcceptThread();
+    // 在I/O线程中接受listenFd上的所有待处理连接，新连接由该线程负责
+    void handleAccept(int listenFd, EventLoop* loop);
+    // loop为空时按轮询顺序分配I/O线程
+    void handleNewConnection(int clientSocket, EventLoop* loop = nullptr);
+    void handleClientMessage(TcpConnection::ConnectionId clientId, std::string_view message);
     void handleClientDisconnect(TcpConnection::ConnectionId clientId);
     
+    bool startLoops();
+    void stopLoops();
+    
+    // 创建、绑定并监听非阻塞套接字，失败时返回-1；端口为0时把系统分配的端口写回address
+    int openListenSocket(SocketAddress& address, bool reusePort);
+    // 打开由接受线程负责的监听套接字
+    bool openAcceptSocket(SocketAddress& address);
+    bool startReusePortListeners();
+    // 在loop中接受listenFd上的连接
+    void registerListenSocket(int fd, EventLoop* loop);
+    bool startAdoptedListeners();
+    void closeListenSockets();
+    
+    // 空闲检测：每个I/O线程一个时间轮，由该线程的定时器驱动
+    using IdleWheel = TimingWheel<std::weak_ptr<TcpConnection>>;
+    void startIdleWheels();
+    void watchIdle(const TcpConnectionPtr& connection, EventLoop* loop);
+    void checkIdle(IdleWheel& wheel, std::weak_ptr<TcpConnection>& entry, uint64_t now);
+    // 下一次需要检查连接的时间
+    uint64_t nextIdleCheck(const TcpConnection& connection) const;
+    
     std::string address_;
     uint16_t port_;
-    int serverSocket_ = -1;
+    SocketAddress listenAddress_;
+    std::vector<std::string> extraAddresses_;
+    std::vector<SocketAddress> boundAddresses_;
     std::atomic<bool> running_{false};
+    std::atomic<bool> accepting_{false};
     std::thread acceptThread_;
+    std::vector<int> acceptSockets_;  // 由接受线程poll的监听套接字
+    int acceptWakeFd_ = -1;           // 唤醒接受线程的eventfd
+    bool reusePort_ = false;
+    // SO_REUSEPORT模式下每个I/O线程一个，记录负责接受的I/O线程
+    std::vector<std::pair<int, EventLoop*>> listenSockets_;
+    std::vector<int> adoptedSockets_;
+    
+    IoModel ioModel_ = IoModel::REACTOR;
+    size_t ioThreads_ = 0;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    size_t nextLoop_ = 0;
+    
+    FramingMode framingMode_ = FramingMode::LINE;
+    size_t maxFrameSize_ = FrameDecoder::DEFAULT_MAX_FRAME_SIZE;
+    size_t sendHighWaterMark_ = TcpConnection::DEFAULT_SEND_HIGH_WATER_MARK;
+    SlowConsumerPolicy slowConsumerPolicy_ = SlowConsumerPolicy::BACKPRESSURE;
+    
+    bool binaryProtocol_ = false;
+    
+    size_t maxConnections_ = 0;
+    std::atomic<uint64_t> rejectedConnections_{0};
+    double requestRate_ = 0.0;
+    double requestBurst_ = 0.0;
+    std::string rateLimitMessage_;
+    // 在start()中按分帧方式编码拒绝响应后创建
+    std::shared_ptr<RateLimit> rateLimit_;
+    
+    uint32_t idleTimeoutMs_ = 0;
+    uint32_t heartbeatIntervalMs_ = 0;
+    std::string heartbeatMessage_;
+    std::string binaryHeartbeatMessage_;
+    uint32_t idleTickMs_ = 1000;
+    // 在startLoops()中创建，之后只读
+    std::unordered_map<EventLoop*, std::unique_ptr<IdleWheel>> idleWheels_;
     
     ConnectionCallback connectionCallback_;
     MessageCallback messageCallback_;
@@ -91,6 +347,8 @@ private:
     
     std::mutex connectionsMutex_;
     std::unordered_map<TcpConnection::ConnectionId, TcpConnectionPtr> connections_;
+    // 已通过连接数检查、尚未加入connections_的连接数，由connectionsMutex_保护
+    size_t reservedConnections_ = 0;
     std::atomic<TcpConnection::ConnectionId> nextClientId_{1};
 };
 
@@ -0,0 +1,169 @@
+#include "BinaryProtocol.h"
+#include <cstring>
+
+namespace gmatch {
+
+const char* wireProtocolName(WireProtocol protocol) {
+    switch (protocol) {
+        case WireProtocol::BINARY:
+            return "binary";
+        case WireProtocol::JSON:
+        default:
+            return "json";
+    }
+}
+
+bool parseWireProtocol(const std::string& name, WireProtocol& protocol) {
+    if (name == "json") {
+        protocol = WireProtocol::JSON;
+        return true;
+    }
+    if (name == "binary") {
+        protocol = WireProtocol::BINARY;
+        return true;
+    }
+    return false;
+}
+
+void BinaryWriter::header(BinaryOpcode opcode, BinaryStatus status, uint32_t requestId) {
+    u8(static_cast<uint8_t>(opcode));
+    u8(static_cast<uint8_t>(status));
+    u16(0);
+    u32(requestId);
+}
+
+void BinaryWriter::f64(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put(bits, 8);
+}
+
+void BinaryWriter::str(std::string_view value) {
+    size_t length = value.size() > UINT16_MAX ? UINT16_MAX : value.size();
+    u16(static_cast<uint16_t>(length));
+    out_.append(value.data(), length);
+}
+
+void BinaryWriter::put(uint64_t value, size_t bytes) {
+    char buffer[8];
+    for (size_t i = 0; i < bytes; ++i) {
+        buffer[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    out_.append(buffer, bytes);
+}
+
+bool BinaryReader::get(uint64_t& value, size_t bytes) {
+    if (in_.size() < bytes) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(in_[i])) << (8 * i);
+    }
+    in_.remove_prefix(bytes);
+    return true;
+}
+
+bool BinaryReader::header(BinaryHeader& header) {
+    uint8_t opcode, status;
+    uint16_t reserved;
+    if (!u8(opcode) || !u8(status) || !u16(reserved) || !u32(header.requestId)) {
+        return false;
+    }
+    header.opcode = static_cast<BinaryOpcode>(opcode);
+    header.status = static_cast<BinaryStatus>(status);
+    return true;
+}
+
+bool BinaryReader::u8(uint8_t& value) {
+    uint64_t raw;
+    if (!get(raw, 1)) {
+        return false;
+    }
+    value = static_cast<uint8_t>(raw);
+    return true;
+}
+
+bool BinaryReader::u16(uint16_t& value) {
+    uint64_t raw;
+    if (!get(raw, 2)) {
+        return false;
+    }
+    value = static_cast<uint16_t>(raw);
+    return true;
+}
+
+bool BinaryReader::i16(int16_t& value) {
+    uint16_t raw;
+    if (!u16(raw)) {
+        return false;
+    }
+    value = static_cast<int16_t>(raw);
+    return true;
+}
+
+bool BinaryReader::u32(uint32_t& value) {
+    uint64_t raw;
+    if (!get(raw, 4)) {
+        return false;
+    }
+    value = static_cast<uint32_t>(raw);
+    return true;
+}
+
+bool BinaryReader::i32(int32_t& value) {
+    uint32_t raw;
+    if (!u32(raw)) {
+        return false;
+    }
+    value = static_cast<int32_t>(raw);
+    return true;
+}
+
+bool BinaryReader::u64(uint64_t& value) {
+    return get(value, 8);
+}
+
+bool BinaryReader::f64(double& value) {
+    uint64_t bits;
+    if (!get(bits, 8)) {
+        return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+bool BinaryReader::str(std::string_view& value) {
+    uint16_t length;
+    if (!u16(length) || in_.size() < length) {
+        return false;
+    }
+    value = in_.substr(0, length);
+    in_.remove_prefix(length);
+    return true;
+}
+
+void appendBinaryError(std::string& out, BinaryOpcode opcode, uint32_t requestId, BinaryStatus status,
+                       std::string_view message) {
+    BinaryWriter writer(out);
+    writer.header(opcode, status, requestId);
+    writer.str(message);
+}
+
+std::string encodeBinaryError(BinaryOpcode opcode, uint32_t requestId, BinaryStatus status, std::string_view message) {
+    std::string out;
+    out.reserve(BINARY_HEADER_SIZE + 2 + message.size());
+    appendBinaryError(out, opcode, requestId, status, message);
+    return out;
+}
+
+std::string encodeBinaryError(std::string_view request, BinaryStatus status, std::string_view message) {
+    BinaryHeader header;
+    BinaryReader reader(request);
+    if (!reader.header(header)) {
+        header = BinaryHeader();
+    }
+    return encodeBinaryError(header.opcode, header.requestId, status, message);
+}
+
+} // namespace gmatch
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace gmatch {
+
+// 紧凑二进制协议，与JSON协议提供相同的命令，供网关等对带宽和解析开销敏感的客户端使用。
+//
+// 协商：客户端连接后先发送4字节魔数"GMB1"，服务器据此把该连接切换为二进制协议；
+// 以其他字节开头的连接仍按配置的分帧方式使用JSON。
+// 帧：4字节小端序长度(不含自身) + 8字节消息头 + 消息体，长度为0的帧只用于保活。
+// 消息头：u8 opcode | u8 status | u16 保留(0) | u32 request_id，
+// 响应的opcode和request_id与请求相同，服务器主动推送的消息request_id为0。
+// 消息体中的整数都是小端序，str为u16长度加UTF-8字节。status非0时消息体只有一个str错误描述。
+//
+// | opcode | 请求体 | 成功响应体 |
+// |--------|--------|------------|
+// | CREATE_PLAYER | i32 rating, str name | u64 player_id, i32 rating, str name |
+// | JOIN_MATCHMAKING / LEAVE_MATCHMAKING | u64 player_id | 空 |
+// | GET_ROOMS | 空 | u32 count, 每个房间: u64 room_id, u8 status, u16 player_count, u16 capacity, f64 avg_rating |
+// | GET_PLAYER_INFO | u64 player_id | u64 player_id, i32 rating, u8 in_queue, str name |
+// | GET_QUEUE_STATUS | 空 | u64 queue_size |
+// | MATCH_NOTIFY(推送) | - | u64 room_id, u16 teams, u16 count, 每个玩家: u64 player_id, i32 rating, i16 team, str name |
+// | STATUS_CHANGED(推送) | - | u64 player_id, u8 in_queue |
+// | HEARTBEAT(推送) | - | 空，客户端回复一个长度为0的帧 |
+
+// 连接使用的协议
+enum class WireProtocol {
+    JSON,
+    BINARY
+};
+
+// 协议名称，用于客户端配置："json" / "binary"
+const char* wireProtocolName(WireProtocol protocol);
+bool parseWireProtocol(const std::string& name, WireProtocol& protocol);
+
+constexpr std::string_view BINARY_PROTOCOL_MAGIC("GMB1", 4);
+constexpr size_t BINARY_HEADER_SIZE = 8;
+
+enum class BinaryOpcode : uint8_t {
+    NONE = 0,
+    CREATE_PLAYER = 1,
+    JOIN_MATCHMAKING = 2,
+    LEAVE_MATCHMAKING = 3,
+    GET_ROOMS = 4,
+    GET_PLAYER_INFO = 5,
+    GET_QUEUE_STATUS = 6,
+    MATCH_NOTIFY = 0x81,
+    STATUS_CHANGED = 0x82,
+    HEARTBEAT = 0x83
+};
+
+// 状态码与API文档中的状态码一致
+enum class BinaryStatus : uint8_t {
+    OK = 0,
+    ERROR = 1,
+    INVALID_COMMAND = 2,
+    INVALID_ARGUMENT = 3,
+    PLAYER_NOT_FOUND = 4,
+    INTERNAL_ERROR = 9,
+    SERVER_BUSY = 10,
+    RATE_LIMITED = 11
+};
+
+struct BinaryHeader {
+    BinaryOpcode opcode = BinaryOpcode::NONE;
+    BinaryStatus status = BinaryStatus::OK;
+    uint32_t requestId = 0;
+};
+
+// 按小端序向out追加字段
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& out) : out_(out) {}
+
+    void header(BinaryOpcode opcode, BinaryStatus status, uint32_t requestId);
+    void u8(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+    void u16(uint16_t value) { put(value, 2); }
+    void i16(int16_t value) { put(static_cast<uint16_t>(value), 2); }
+    void u32(uint32_t value) { put(value, 4); }
+    void i32(int32_t value) { put(static_cast<uint32_t>(value), 4); }
+    void u64(uint64_t value) { put(value, 8); }
+    void f64(double value);
+    // 超过65535字节的字符串被截断
+    void str(std::string_view value);
+
+private:
+    void put(uint64_t value, size_t bytes);
+
+    std::string& out_;
+};
+
+// 从消息中按顺序读取字段，数据不足时返回false
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view in) : in_(in) {}
+
+    bool header(BinaryHeader& header);
+    bool u8(uint8_t& value);
+    bool u16(uint16_t& value);
+    bool i16(int16_t& value);
+    bool u32(uint32_t& value);
+    bool i32(int32_t& value);
+    bool u64(uint64_t& value);
+    bool f64(double& value);
+    // value指向消息内部
+    bool str(std::string_view& value);
+
+    bool atEnd() const { return in_.empty(); }
+
+private:
+    bool get(uint64_t& value, size_t bytes);
+
+    std::string_view in_;
+};
+
+// 编码错误响应的消息(不含长度前缀)
+void appendBinaryError(std::string& out, BinaryOpcode opcode, uint32_t requestId, BinaryStatus status,
+                       std::string_view message);
+std::string encodeBinaryError(BinaryOpcode opcode, uint32_t requestId, BinaryStatus status, std::string_view message);
+// 按请求的消息头回复错误，请求头不完整时opcode和request_id为0
+std::string encodeBinaryError(std::string_view request, BinaryStatus status, std::string_view message);
+
+} // namespace gmatch
@@ -1,9 +1,30 @@
 #include "Config.h"
 #include <fstream>
 #include <sstream>
+#include <type_traits>
 
 namespace gmatch {
 
+namespace {
+
+// 整个值都是数字时才转换成功，数字后可以有空白(例如行尾注释前的空格)
+template<typename T>
+bool parseNumber(const std::string& value, T& result) {
+    try {
+        size_t pos = 0;
+        if constexpr (std::is_same_v<T, int>) {
+            result = std::stoi(value, &pos);
+        } else {
+            result = std::stod(value, &pos);
+        }
+        return pos == value.size() || value[pos] == ' ' || value[pos] == '\t';
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace
+
 Config& Config::getInstance() {
     static Config instance;
     return instance;
@@ -34,19 +55,20 @@ bool Config::loadFromFile(const std::string& filename) {
             value.erase(0, value.find_first_not_of(" \t"));
             value.erase(value.find_last_not_of(" \t") + 1);
             
-            // 尝试转换为数值类型
+            // 尝试转换为数值类型，只有数字后面没有其他内容时才算数值，
+            // 避免"0.0.0.0"、"127.0.0.1:8080"这样的地址被截断成数字
             if (value.find('.') != std::string::npos) {
-                try {
-                    double doubleVal = std::stod(value);
+                double doubleVal;
+                if (parseNumber(value, doubleVal)) {
                     set(key, doubleVal);
-                } catch (...) {
+                } else {
                     set(key, value);
                 }
             } else {
-                try {
-                    int intVal = std::stoi(value);
+                int intVal;
+                if (parseNumber(value, intVal)) {
                     set(key, intVal);
-                } catch (...) {
+                } else {
                     set(key, value);
                 }
             }
@@ -0,0 +1,163 @@
+#include "FrameCodec.h"
+#include <algorithm>
+#include <cstring>
+
+namespace gmatch {
+
+namespace {
+// 接收缓冲区的初始大小；空闲时超过上限的缓冲区会被收缩回初始大小
+constexpr size_t INITIAL_BUFFER_SIZE = 4096;
+constexpr size_t IDLE_BUFFER_LIMIT = 64 * 1024;
+}
+
+const char* framingModeName(FramingMode mode) {
+    switch (mode) {
+        case FramingMode::LENGTH_PREFIXED:
+            return "length";
+        case FramingMode::BINARY:
+            return "binary";
+        case FramingMode::LINE:
+        default:
+            return "line";
+    }
+}
+
+bool parseFramingMode(const std::string& name, FramingMode& mode) {
+    if (name == "line") {
+        mode = FramingMode::LINE;
+        return true;
+    }
+    if (name == "length") {
+        mode = FramingMode::LENGTH_PREFIXED;
+        return true;
+    }
+    return false;
+}
+
+void appendFrame(FramingMode mode, std::string_view payload, std::string& out) {
+    if (mode == FramingMode::LENGTH_PREFIXED) {
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        char header[FRAME_LENGTH_PREFIX_SIZE] = {
+            static_cast<char>((length >> 24) & 0xFF),
+            static_cast<char>((length >> 16) & 0xFF),
+            static_cast<char>((length >> 8) & 0xFF),
+            static_cast<char>(length & 0xFF)
+        };
+        out.append(header, sizeof(header));
+        out.append(payload.data(), payload.size());
+    } else if (mode == FramingMode::BINARY) {
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        char header[FRAME_LENGTH_PREFIX_SIZE] = {
+            static_cast<char>(length & 0xFF),
+            static_cast<char>((length >> 8) & 0xFF),
+            static_cast<char>((length >> 16) & 0xFF),
+            static_cast<char>((length >> 24) & 0xFF)
+        };
+        out.append(header, sizeof(header));
+        out.append(payload.data(), payload.size());
+    } else {
+        out.append(payload.data(), payload.size());
+        out.push_back('\n');
+    }
+}
+
+std::string encodeFrame(FramingMode mode, std::string_view payload) {
+    std::string out;
+    out.reserve(payload.size() + FRAME_LENGTH_PREFIX_SIZE);
+    appendFrame(mode, payload, out);
+    return out;
+}
+
+FrameDecoder::FrameDecoder(FramingMode mode, size_t maxFrameSize)
+    : mode_(mode), maxFrameSize_(maxFrameSize) {
+}
+
+char* FrameDecoder::beginWrite(size_t length) {
+    if (readPos_ == writePos_) {
+        // 缓冲区已取空，从头开始写；之前因大帧扩张的缓冲区收缩回初始大小
+        readPos_ = writePos_ = scanPos_ = 0;
+        if (buffer_.size() > IDLE_BUFFER_LIMIT) {
+            std::vector<char>(INITIAL_BUFFER_SIZE).swap(buffer_);
+        }
+    }
+
+    if (buffer_.size() - writePos_ < length) {
+        size_t pending = writePos_ - readPos_;
+        if (readPos_ > 0 && buffer_.size() - pending >= length) {
+            // 把未取出的数据移到开头即可腾出空间
+            std::memmove(buffer_.data(), buffer_.data() + readPos_, pending);
+            scanPos_ = scanPos_ > readPos_ ? scanPos_ - readPos_ : 0;
+            readPos_ = 0;
+            writePos_ = pending;
+        } else {
+            buffer_.resize(std::max({writePos_ + length, buffer_.size() * 2, INITIAL_BUFFER_SIZE}));
+        }
+    }
+    return buffer_.data() + writePos_;
+}
+
+void FrameDecoder::commitWrite(size_t length) {
+    writePos_ += length;
+}
+
+void FrameDecoder::append(const char* data, size_t length) {
+    std::memcpy(beginWrite(length), data, length);
+    commitWrite(length);
+}
+
+bool FrameDecoder::nextFrame(std::string_view& frame) {
+    while (!error_ && readPos_ < writePos_) {
+        const char* base = buffer_.data();
+
+        if (mode_ != FramingMode::LINE) {
+            if (writePos_ - readPos_ < FRAME_LENGTH_PREFIX_SIZE) {
+                return false;
+            }
+            const unsigned char* header = reinterpret_cast<const unsigned char*>(base + readPos_);
+            size_t length = mode_ == FramingMode::BINARY
+                ? (static_cast<size_t>(header[3]) << 24) | (static_cast<size_t>(header[2]) << 16) |
+                  (static_cast<size_t>(header[1]) << 8) | static_cast<size_t>(header[0])
+                : (static_cast<size_t>(header[0]) << 24) | (static_cast<size_t>(header[1]) << 16) |
+                  (static_cast<size_t>(header[2]) << 8) | static_cast<size_t>(header[3]);
+            if (length > maxFrameSize_) {
+                error_ = true;
+                return false;
+            }
+            if (writePos_ - readPos_ - FRAME_LENGTH_PREFIX_SIZE < length) {
+                return false;
+            }
+            frame = std::string_view(base + readPos_ + FRAME_LENGTH_PREFIX_SIZE, length);
+            readPos_ += FRAME_LENGTH_PREFIX_SIZE + length;
+            return true;
+        }
+
+        size_t scanFrom = std::max(scanPos_, readPos_);
+        const void* newline = std::memchr(base + scanFrom, '\n', writePos_ - scanFrom);
+        if (!newline) {
+            scanPos_ = writePos_;
+            if (writePos_ - readPos_ > maxFrameSize_) {
+                error_ = true;
+            }
+            return false;
+        }
+
+        size_t end = static_cast<const char*>(newline) - base;
+        size_t begin = readPos_;
+        readPos_ = end + 1;
+        if (end > begin && base[end - 1] == '\r') {
+            --end;
+        }
+        if (end - begin > maxFrameSize_) {
+            error_ = true;
+            return false;
+        }
+        if (end > begin) {
+            frame = std::string_view(base + begin, end - begin);
+            return true;
+        }
+        // 空行直接跳过
+    }
+    return false;
+}
+
+} // namespace gmatch
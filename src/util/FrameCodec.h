@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gmatch {
+
+// 消息分帧方式
+enum class FramingMode {
+    LINE,             // 每条消息以'\n'结尾，忽略行尾的'\r'和空行
+    LENGTH_PREFIXED,  // 每条消息前有4字节大端序的消息长度
+    BINARY            // 二进制协议：每条消息前有4字节小端序的消息长度，由连接协商启用，不能配置
+};
+
+// 分帧方式名称，用于配置："line" / "length"；"binary"只用于输出
+const char* framingModeName(FramingMode mode);
+bool parseFramingMode(const std::string& name, FramingMode& mode);
+
+// 长度前缀的字节数
+constexpr size_t FRAME_LENGTH_PREFIX_SIZE = 4;
+
+// 将payload编码为一帧追加到out
+void appendFrame(FramingMode mode, std::string_view payload, std::string& out);
+std::string encodeFrame(FramingMode mode, std::string_view payload);
+
+// 接收缓冲区与分帧器：收到的字节写入缓冲区，每次可取出零到多个完整的帧，
+// 不完整的帧留在缓冲区中等待后续数据
+class FrameDecoder {
+public:
+    static constexpr size_t DEFAULT_MAX_FRAME_SIZE = 1024 * 1024;
+
+    explicit FrameDecoder(FramingMode mode = FramingMode::LINE, size_t maxFrameSize = DEFAULT_MAX_FRAME_SIZE);
+
+    FramingMode getMode() const { return mode_; }
+    // 切换分帧方式，缓冲区中尚未取出的数据按新的方式分帧
+    // 其他分帧方式不维护scanPos_，切换后从未取出的数据开头重新扫描
+    void setMode(FramingMode mode) {
+        mode_ = mode;
+        scanPos_ = readPos_;
+    }
+    size_t getMaxFrameSize() const { return maxFrameSize_; }
+
+    // 返回至少length字节的可写空间，写入后调用commitWrite提交实际写入的字节数
+    // 调用后之前由nextFrame返回的帧失效
+    char* beginWrite(size_t length);
+    void commitWrite(size_t length);
+    size_t writableBytes() const { return buffer_.size() - writePos_; }
+
+    void append(const char* data, size_t length);
+
+    // 取出下一个完整的帧，帧内容在下一次beginWrite/append之前有效
+    // 没有完整的帧或出现协议错误时返回false
+    bool nextFrame(std::string_view& frame);
+
+    // 单帧超过maxFrameSize时置位，之后不再返回任何帧
+    bool hasError() const { return error_; }
+
+    // 缓冲区中尚未取出的字节数
+    size_t readableBytes() const { return writePos_ - readPos_; }
+    
+    // 查看和丢弃尚未取出的数据，用于在分帧之前读取连接开头的协议协商字节
+    std::string_view peek() const { return std::string_view(buffer_.data() + readPos_, writePos_ - readPos_); }
+    void consume(size_t length) {
+        readPos_ += std::min(length, writePos_ - readPos_);
+        scanPos_ = std::max(scanPos_, readPos_);
+    }
+
+private:
+    FramingMode mode_;
+    size_t maxFrameSize_;
+    std::vector<char> buffer_;
+    size_t readPos_ = 0;
+    size_t writePos_ = 0;
+    // 按行分帧时已确认不含'\n'的位置，避免重复扫描
+    size_t scanPos_ = 0;
+    bool error_ = false;
+};
+
+} // namespace gmatch
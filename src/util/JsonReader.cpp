@@ -0,0 +1,466 @@
+#include "JsonReader.h"
+#include <cstdint>
+
+namespace gmatch {
+
+namespace {
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// 读取\u之后的4位十六进制数
+bool readHex4(std::string_view text, size_t pos, uint32_t& code) {
+    if (pos + 4 > text.size()) {
+        return false;
+    }
+    code = 0;
+    for (size_t i = pos; i < pos + 4; ++i) {
+        int digit = hexValue(text[i]);
+        if (digit < 0) {
+            return false;
+        }
+        code = (code << 4) | static_cast<uint32_t>(digit);
+    }
+    return true;
+}
+
+void appendUtf8(uint32_t code, std::string& out) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+// 递归下降读取器，pos_始终指向下一个未读字符
+class JsonScanner {
+public:
+    explicit JsonScanner(std::string_view text, size_t pos = 0) : text_(text), pos_(pos) {}
+
+    void skipSpace() {
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+            ++pos_;
+        }
+    }
+
+    bool atEnd() const { return pos_ == text_.size(); }
+    bool peek(char c) const { return pos_ < text_.size() && text_[pos_] == c; }
+    size_t position() const { return pos_; }
+
+    bool consume(char c) {
+        if (!peek(c)) {
+            return false;
+        }
+        ++pos_;
+        return true;
+    }
+
+    // 读取一个对象，直接成员记录到members；名为nestedKey的对象成员记录到nested
+    bool parseObject(JsonValue& value, int depth, JsonFields* members,
+                     std::string_view nestedKey = {}, JsonFields* nested = nullptr) {
+        if (depth > MAX_JSON_DEPTH || !peek('{')) {
+            return false;
+        }
+        size_t start = pos_++;
+        skipSpace();
+        if (peek('}')) {
+            ++pos_;
+            value = {JsonValue::Type::OBJECT, slice(start, pos_), false};
+            return true;
+        }
+
+        while (true) {
+            JsonValue key;
+            skipSpace();
+            if (!parseString(key)) {
+                return false;
+            }
+            skipSpace();
+            if (!peek(':')) {
+                return false;
+            }
+            ++pos_;
+            skipSpace();
+
+            JsonValue member;
+            bool recordNested = nested && !key.escaped && key.text == nestedKey && peek('{');
+            bool parsed = recordNested ? parseObject(member, depth + 1, nested) : parseValue(member, depth + 1);
+            if (!parsed || (members && !members->add(key.text, member))) {
+                return false;
+            }
+            if (recordNested) {
+                // 重复的同名字段只记录第一个，与JsonFields::find一致
+                nested = nullptr;
+            }
+
+            skipSpace();
+            if (peek(',')) {
+                ++pos_;
+                continue;
+            }
+            if (peek('}')) {
+                ++pos_;
+                value = {JsonValue::Type::OBJECT, slice(start, pos_), false};
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        if (pos_ >= text_.size()) {
+            return false;
+        }
+        switch (text_[pos_]) {
+            case '{':
+                return parseObject(value, depth, nullptr);
+            case '[':
+                return parseArray(value, depth);
+            case '"':
+                return parseString(value);
+            case 't':
+                return parseLiteral("true", JsonValue::Type::BOOLEAN, value);
+            case 'f':
+                return parseLiteral("false", JsonValue::Type::BOOLEAN, value);
+            case 'n':
+                return parseLiteral("null", JsonValue::Type::NULL_VALUE, value);
+            default:
+                return parseNumber(value);
+        }
+    }
+
+private:
+    bool parseArray(JsonValue& value, int depth) {
+        if (depth > MAX_JSON_DEPTH) {
+            return false;
+        }
+        size_t start = pos_++;
+        skipSpace();
+        if (!peek(']')) {
+            while (true) {
+                JsonValue element;
+                skipSpace();
+                if (!parseValue(element, depth + 1)) {
+                    return false;
+                }
+                skipSpace();
+                if (peek(',')) {
+                    ++pos_;
+                    continue;
+                }
+                if (!peek(']')) {
+                    return false;
+                }
+                break;
+            }
+        }
+        ++pos_;
+        value = {JsonValue::Type::ARRAY, slice(start, pos_), false};
+        return true;
+    }
+
+    // 只检查转义是否合法，不解码
+    bool parseString(JsonValue& value) {
+        if (!peek('"')) {
+            return false;
+        }
+        size_t start = ++pos_;
+        bool escaped = false;
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c == '"') {
+                value = {JsonValue::Type::STRING, slice(start, pos_), escaped};
+                ++pos_;
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c == '\\') {
+                escaped = true;
+                if (++pos_ >= text_.size()) {
+                    return false;
+                }
+                uint32_t code;
+                switch (text_[pos_]) {
+                    case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                        break;
+                    case 'u':
+                        if (!readHex4(text_, pos_ + 1, code)) {
+                            return false;
+                        }
+                        pos_ += 4;
+                        break;
+                    default:
+                        return false;
+                }
+            }
+            ++pos_;
+        }
+        return false;
+    }
+
+    bool parseLiteral(std::string_view literal, JsonValue::Type type, JsonValue& value) {
+        if (text_.substr(pos_, literal.size()) != literal) {
+            return false;
+        }
+        value = {type, text_.substr(pos_, literal.size()), false};
+        pos_ += literal.size();
+        return true;
+    }
+
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool parseNumber(JsonValue& value) {
+        size_t start = pos_;
+        if (peek('-')) {
+            ++pos_;
+        }
+        if (peek('0')) {
+            ++pos_;
+        } else if (pos_ < text_.size() && isDigit(text_[pos_])) {
+            skipDigits();
+        } else {
+            return false;
+        }
+        if (peek('.')) {
+            ++pos_;
+            if (!skipDigits()) {
+                return false;
+            }
+        }
+        if (peek('e') || peek('E')) {
+            ++pos_;
+            if (peek('+') || peek('-')) {
+                ++pos_;
+            }
+            if (!skipDigits()) {
+                return false;
+            }
+        }
+        value = {JsonValue::Type::NUMBER, slice(start, pos_), false};
+        return true;
+    }
+
+    // 跳过至少一位数字
+    bool skipDigits() {
+        size_t start = pos_;
+        while (pos_ < text_.size() && isDigit(text_[pos_])) {
+            ++pos_;
+        }
+        return pos_ > start;
+    }
+
+    // [start, end)已经在范围内，不需要substr的边界检查
+    std::string_view slice(size_t start, size_t end) const {
+        return std::string_view(text_.data() + start, end - start);
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+bool JsonValue::getString(std::string& out) const {
+    if (type != Type::STRING) {
+        return false;
+    }
+    out.clear();
+    if (!escaped) {
+        out.assign(text.data(), text.size());
+        return true;
+    }
+    return unescapeJsonString(text, out);
+}
+
+bool JsonFields::add(std::string_view key, const JsonValue& value) {
+    if (size_ >= CAPACITY) {
+        return false;
+    }
+    new (&storage_.fields[size_++]) Field{key, value};
+    return true;
+}
+
+const JsonValue* JsonFields::find(std::string_view key) const {
+    for (size_t i = 0; i < size_; ++i) {
+        if (storage_.fields[i].key == key) {
+            return &storage_.fields[i].value;
+        }
+    }
+    return nullptr;
+}
+
+bool parseJsonObject(std::string_view text, JsonFields& fields, std::string_view nestedKey, JsonFields* nested) {
+    fields.clear();
+    if (nested) {
+        nested->clear();
+    }
+
+    JsonScanner scanner(text);
+    JsonValue object;
+    scanner.skipSpace();
+    if (!scanner.parseObject(object, 1, &fields, nestedKey, nested)) {
+        return false;
+    }
+    scanner.skipSpace();
+    return scanner.atEnd();
+}
+
+bool JsonArrayReader::next(JsonValue& element, JsonFields* fields) {
+    if (done_) {
+        return false;
+    }
+    JsonScanner scanner(text_, pos_);
+    scanner.skipSpace();
+    if (!started_) {
+        started_ = true;
+        if (!scanner.consume('[')) {
+            return fail();
+        }
+        scanner.skipSpace();
+        if (scanner.consume(']')) {
+            done_ = true;
+            return false;
+        }
+    } else if (scanner.consume(']')) {
+        done_ = true;
+        return false;
+    } else if (!scanner.consume(',')) {
+        return fail();
+    }
+    scanner.skipSpace();
+    
+    // 数组本身算一层
+    bool parsed;
+    if (fields) {
+        fields->clear();
+        parsed = scanner.peek('{') ? scanner.parseObject(element, 2, fields) : scanner.parseValue(element, 2);
+    } else {
+        parsed = scanner.parseValue(element, 2);
+    }
+    if (!parsed) {
+        return fail();
+    }
+    pos_ = scanner.position();
+    return true;
+}
+
+bool JsonArrayReader::fail() {
+    done_ = true;
+    failed_ = true;
+    return false;
+}
+
+bool unescapeJsonString(std::string_view text, std::string& out) {
+    out.reserve(out.size() + text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (++i >= text.size()) {
+            return false;
+        }
+        switch (text[i]) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                uint32_t code;
+                if (!readHex4(text, i + 1, code)) {
+                    return false;
+                }
+                i += 4;
+                // UTF-16代理对组合为一个码点，单独出现的代理项无效
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    uint32_t low;
+                    if (i + 2 >= text.size() || text[i + 1] != '\\' || text[i + 2] != 'u' ||
+                        !readHex4(text, i + 3, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                    return false;
+                }
+                appendUtf8(code, out);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+void escapeJsonString(std::string_view text, std::string& out) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    // 不需要转义的连续字符整段追加；不按text的长度reserve，否则向同一缓冲区追加多个字符串时
+    // 每次都按精确大小重新分配，失去std::string的倍增扩容
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20) {
+            continue;
+        }
+        out.append(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\b': out.append("\\b"); break;
+            case '\f': out.append("\\f"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                out.append("\\u00");
+                out.push_back(HEX_DIGITS[(c >> 4) & 0x0F]);
+                out.push_back(HEX_DIGITS[c & 0x0F]);
+        }
+    }
+    out.append(text.data() + runStart, text.size() - runStart);
+}
+
+std::string escapeJsonString(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    escapeJsonString(text, out);
+    return out;
+}
+
+} // namespace gmatch
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <string_view>
+
+namespace gmatch {
+
+// 单遍JSON读取：对象只扫描一次，字段记录为指向原文的string_view，不分配内存。
+// 只有需要取出含转义字符的字符串时才解码到调用方提供的std::string
+
+// 解析得到的JSON值，text指向原文
+struct JsonValue {
+    enum class Type { STRING, NUMBER, BOOLEAN, NULL_VALUE, OBJECT, ARRAY };
+
+    Type type = Type::NULL_VALUE;
+    // 字符串为引号内的原文(未解码)，对象和数组包含括号，其余为字面量本身
+    std::string_view text;
+    // 字符串中是否有反斜杠转义
+    bool escaped = false;
+
+    bool isString() const { return type == Type::STRING; }
+    bool isNumber() const { return type == Type::NUMBER; }
+    bool isObject() const { return type == Type::OBJECT; }
+
+    // 取出解码后的字符串，不是字符串时返回false；没有转义时out直接复制原文
+    bool getString(std::string& out) const;
+
+    // 没有转义的字符串直接返回原文视图，否则返回false
+    bool getStringView(std::string_view& out) const {
+        if (type != Type::STRING || escaped) {
+            return false;
+        }
+        out = text;
+        return true;
+    }
+
+    // 取出整数，不是数字、带小数/指数或超出T的范围时返回false且不修改out
+    template <typename T>
+    bool getInteger(T& out) const {
+        if (type != Type::NUMBER) {
+            return false;
+        }
+        T value;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc() || ptr != text.data() + text.size()) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    bool getBool(bool& out) const {
+        if (type != Type::BOOLEAN) {
+            return false;
+        }
+        out = text == "true";
+        return true;
+    }
+};
+
+// 固定容量的字段表，键为引号内的原文
+class JsonFields {
+public:
+    static constexpr size_t CAPACITY = 16;
+
+    // 表满时返回false
+    bool add(std::string_view key, const JsonValue& value);
+    // 同名字段以第一个为准，找不到时返回nullptr
+    const JsonValue* find(std::string_view key) const;
+
+    size_t size() const { return size_; }
+    void clear() { size_ = 0; }
+
+private:
+    struct Field {
+        std::string_view key;
+        JsonValue value;
+    };
+
+    // 字段按需就地构造，避免每次解析都初始化整张表；Field可平凡析构，不需要析构函数
+    union Storage {
+        Storage() {}
+        Field fields[CAPACITY];
+    };
+
+    Storage storage_;
+    size_t size_ = 0;
+};
+
+// 解析text中的一个JSON对象，对象前后只允许空白；顶层字段记录到fields。
+// nested不为空时，名为nestedKey且值为对象的顶层字段的成员在同一遍扫描中记录到nested。
+// 更深层的对象和数组只做语法检查。格式错误、嵌套超过MAX_JSON_DEPTH或字段超过容量时返回false
+constexpr int MAX_JSON_DEPTH = 32;
+bool parseJsonObject(std::string_view text, JsonFields& fields,
+                     std::string_view nestedKey = {}, JsonFields* nested = nullptr);
+
+// 逐个读取数组原文(含括号，如JsonValue::text)中的元素，不分配内存。
+// 用于parseJsonObject只做了语法检查的数组字段
+class JsonArrayReader {
+public:
+    explicit JsonArrayReader(std::string_view text) : text_(text) {}
+    
+    // 读取下一个元素，元素为对象且fields不为空时其顶层字段记录到fields(否则fields为空)。
+    // 数组结束或格式错误时返回false，之后可以用failed()区分
+    bool next(JsonValue& element, JsonFields* fields = nullptr);
+    bool failed() const { return failed_; }
+
+private:
+    bool fail();
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    bool started_ = false;
+    bool done_ = false;
+    bool failed_ = false;
+};
+
+// 把字符串原文(引号内、可含转义)解码后追加到out，转义无效时返回false
+bool unescapeJsonString(std::string_view text, std::string& out);
+
+// unescapeJsonString的逆过程：转义引号、反斜杠和控制字符后追加到out(不加引号)
+void escapeJsonString(std::string_view text, std::string& out);
+std::string escapeJsonString(std::string_view text);
+
+} // namespace gmatch
@@ -0,0 +1,129 @@
+#include "JsonWriter.h"
+#include <cmath>
+
+namespace gmatch {
+
+void JsonWriter::separator() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (depth_ == 0 || depth_ > MAX_DEPTH) {
+        return;
+    }
+    uint64_t bit = uint64_t(1) << (depth_ - 1);
+    if (hasElement_ & bit) {
+        out_.push_back(',');
+    }
+    hasElement_ |= bit;
+}
+
+JsonWriter& JsonWriter::open(char bracket) {
+    separator();
+    out_.push_back(bracket);
+    ++depth_;
+    if (depth_ <= MAX_DEPTH) {
+        hasElement_ &= ~(uint64_t(1) << (depth_ - 1));
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::close(char bracket) {
+    out_.push_back(bracket);
+    if (depth_ > 0) {
+        --depth_;
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separator();
+    out_.push_back('"');
+    out_.append(name.data(), name.size());
+    out_.append("\":", 2);
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string(std::string_view value) {
+    separator();
+    out_.push_back('"');
+    escapeJsonString(value, out_);
+    out_.push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::escapedString(std::string_view value) {
+    separator();
+    out_.push_back('"');
+    out_.append(value.data(), value.size());
+    out_.push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool value) {
+    separator();
+    if (value) {
+        out_.append("true", 4);
+    } else {
+        out_.append("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(double value) {
+    separator();
+    if (!std::isfinite(value)) {
+        out_.append("null", 4);
+        return *this;
+    }
+    // 最短的可以精确还原的表示
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, result.ptr - buffer);
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separator();
+    out_.append(json.data(), json.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const JsonValue& value) {
+    if (value.isString()) {
+        return escapedString(value.text);
+    }
+    return raw(value.text);
+}
+
+void appendJsonWithId(std::string_view response, const JsonValue& id, std::string& out) {
+    if (response.empty() || response.front() != '{') {
+        out.append(response.data(), response.size());
+        return;
+    }
+    JsonWriter writer(out);
+    writer.beginObject().key("id").value(id);
+    // 原对象为空时不需要逗号
+    std::string_view rest = response.substr(1);
+    size_t next = rest.find_first_not_of(" \t\r\n");
+    if (next != std::string_view::npos && rest[next] != '}') {
+        out.push_back(',');
+    }
+    out.append(rest.data(), rest.size());
+}
+
+bool appendJsonWithRequestId(std::string_view request, std::string_view response, std::string& out) {
+    JsonFields fields;
+    if (!parseJsonObject(request, fields)) {
+        return false;
+    }
+    const JsonValue* id = fields.find("id");
+    if (!id || !isValidRequestId(*id)) {
+        return false;
+    }
+    appendJsonWithId(response, *id, out);
+    return true;
+}
+
+} // namespace gmatch
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "JsonReader.h"
+
+namespace gmatch {
+
+// JSON生成器，直接追加到调用方提供的缓冲区，自动在数组元素和对象字段之间插入逗号。
+// 数字用std::to_chars格式化，字符串按escapeJsonString转义，不经过ostringstream和临时字符串；
+// 缓冲区容量足够时生成过程不分配内存。
+//
+//   JsonWriter writer(out);
+//   writer.beginObject().key("player_id").integer(id).key("name").string(name).endObject();
+class JsonWriter {
+public:
+    // 嵌套层数上限，超过后更深的层不再自动插入逗号
+    static constexpr int MAX_DEPTH = 64;
+
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    JsonWriter& beginObject() { return open('{'); }
+    JsonWriter& endObject() { return close('}'); }
+    JsonWriter& beginArray() { return open('['); }
+    JsonWriter& endArray() { return close(']'); }
+
+    // 字段名按原样写出，调用方保证不需要转义
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& string(std::string_view value);
+    // 已经是JSON转义形式的字符串内容(如JsonReader取出的原文)，只加引号
+    JsonWriter& escapedString(std::string_view value);
+    JsonWriter& boolean(bool value);
+    // 非有限值(NaN、无穷)写为null
+    JsonWriter& number(double value);
+    // 已编码好的JSON值，按原样写出
+    JsonWriter& raw(std::string_view json);
+    // JsonReader读出的值，按原文写出，字符串保持原来的转义形式
+    JsonWriter& value(const JsonValue& value);
+
+    template <typename T>
+    JsonWriter& integer(T value) {
+        static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "integer() takes integral values");
+        separator();
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, result.ptr - buffer);
+        return *this;
+    }
+
+    std::string& buffer() { return out_; }
+
+private:
+    JsonWriter& open(char bracket);
+    JsonWriter& close(char bracket);
+    // 写值或字段名之前调用：容器中已有元素时先写逗号
+    void separator();
+
+    std::string& out_;
+    // 每一层容器是否已经写过元素，第0位是最外层
+    uint64_t hasElement_ = 0;
+    int depth_ = 0;
+    bool afterKey_ = false;
+};
+
+// 请求的"id"是否可以带回响应：只接受数字和字符串
+inline bool isValidRequestId(const JsonValue& id) {
+    return id.isString() || id.isNumber();
+}
+
+// 把id作为第一个字段插入已生成的响应对象，结果追加到out：{"id":<id>,<response的其余字段>}。
+// response不是以'{'开头的对象时原样追加
+void appendJsonWithId(std::string_view response, const JsonValue& id, std::string& out);
+
+// 不经过请求处理器直接回复的响应(如服务器繁忙、超过限速)带回请求中的id：
+// request带有合法的id时把插入id后的response追加到out并返回true，否则返回false且out不变
+bool appendJsonWithRequestId(std::string_view request, std::string_view response, std::string& out);
+
+} // namespace gmatch
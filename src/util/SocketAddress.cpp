@@ -0,0 +1,141 @@
+#include "SocketAddress.h"
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstring>
+
+namespace gmatch {
+
+namespace {
+
+bool parsePort(const std::string& text, uint16_t& port) {
+    if (text.empty() || text.size() > 5 || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    unsigned long value = std::stoul(text);
+    if (value > 65535) {
+        return false;
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+bool fillInet6(const std::string& host, uint16_t port, SocketAddress& address) {
+    auto* addr = reinterpret_cast<struct sockaddr_in6*>(&address.storage);
+    std::memset(addr, 0, sizeof(*addr));
+    addr->sin6_family = AF_INET6;
+    addr->sin6_port = htons(port);
+    if (inet_pton(AF_INET6, host.c_str(), &addr->sin6_addr) != 1) {
+        return false;
+    }
+    address.length = sizeof(struct sockaddr_in6);
+    return true;
+}
+
+bool fillInet4(const std::string& host, uint16_t port, SocketAddress& address) {
+    auto* addr = reinterpret_cast<struct sockaddr_in*>(&address.storage);
+    std::memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr->sin_addr) != 1) {
+        return false;
+    }
+    address.length = sizeof(struct sockaddr_in);
+    return true;
+}
+
+} // namespace
+
+uint16_t SocketAddress::getPort() const {
+    switch (storage.ss_family) {
+        case AF_INET:
+            return ntohs(reinterpret_cast<const struct sockaddr_in*>(&storage)->sin_port);
+        case AF_INET6:
+            return ntohs(reinterpret_cast<const struct sockaddr_in6*>(&storage)->sin6_port);
+        default:
+            return 0;
+    }
+}
+
+void SocketAddress::setPort(uint16_t port) {
+    if (storage.ss_family == AF_INET) {
+        reinterpret_cast<struct sockaddr_in*>(&storage)->sin_port = htons(port);
+    } else if (storage.ss_family == AF_INET6) {
+        reinterpret_cast<struct sockaddr_in6*>(&storage)->sin6_port = htons(port);
+    }
+}
+
+std::string SocketAddress::getPath() const {
+    if (!isUnix() || length <= offsetof(struct sockaddr_un, sun_path)) {
+        return std::string();
+    }
+    const auto* addr = reinterpret_cast<const struct sockaddr_un*>(&storage);
+    return std::string(addr->sun_path, strnlen(addr->sun_path, length - offsetof(struct sockaddr_un, sun_path)));
+}
+
+std::string SocketAddress::toString() const {
+    char buffer[INET6_ADDRSTRLEN];
+    switch (storage.ss_family) {
+        case AF_INET:
+            inet_ntop(AF_INET, &reinterpret_cast<const struct sockaddr_in*>(&storage)->sin_addr, buffer, sizeof(buffer));
+            return std::string(buffer) + ":" + std::to_string(getPort());
+        case AF_INET6:
+            inet_ntop(AF_INET6, &reinterpret_cast<const struct sockaddr_in6*>(&storage)->sin6_addr, buffer, sizeof(buffer));
+            return "[" + std::string(buffer) + "]:" + std::to_string(getPort());
+        case AF_UNIX:
+            return UNIX_ADDRESS_PREFIX + getPath();
+        default:
+            return "unknown";
+    }
+}
+
+bool parseSocketAddress(const std::string& spec, uint16_t defaultPort, SocketAddress& address) {
+    address = SocketAddress();
+    
+    if (spec.compare(0, std::strlen(UNIX_ADDRESS_PREFIX), UNIX_ADDRESS_PREFIX) == 0) {
+        std::string path = spec.substr(std::strlen(UNIX_ADDRESS_PREFIX));
+        auto* addr = reinterpret_cast<struct sockaddr_un*>(&address.storage);
+        if (path.empty() || path.size() >= sizeof(addr->sun_path)) {
+            return false;
+        }
+        addr->sun_family = AF_UNIX;
+        std::memcpy(addr->sun_path, path.data(), path.size());
+        address.length = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + path.size() + 1);
+        return true;
+    }
+    
+    // "[IPv6]"或"[IPv6]:port"
+    if (!spec.empty() && spec[0] == '[') {
+        size_t close = spec.find(']');
+        if (close == std::string::npos) {
+            return false;
+        }
+        uint16_t port = defaultPort;
+        if (close + 1 < spec.size() && (spec[close + 1] != ':' || !parsePort(spec.substr(close + 2), port))) {
+            return false;
+        }
+        return fillInet6(spec.substr(1, close - 1), port, address);
+    }
+    
+    // 多于一个冒号的是不带端口的IPv6地址
+    size_t colon = spec.find(':');
+    if (colon != std::string::npos && spec.find(':', colon + 1) != std::string::npos) {
+        return fillInet6(spec, defaultPort, address);
+    }
+    
+    uint16_t port = defaultPort;
+    if (colon != std::string::npos && !parsePort(spec.substr(colon + 1), port)) {
+        return false;
+    }
+    return fillInet4(spec.substr(0, colon), port, address);
+}
+
+SocketAddress socketAddressFrom(const struct sockaddr_storage& storage, socklen_t length) {
+    SocketAddress address;
+    address.storage = storage;
+    address.length = length;
+    return address;
+}
+
+} // namespace gmatch
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <cstdint>
+#include <string>
+
+namespace gmatch {
+
+// Unix域套接字地址的前缀，如"unix:/run/gmatch.sock"
+constexpr const char* UNIX_ADDRESS_PREFIX = "unix:";
+
+// 监听或连接使用的套接字地址：IPv4、IPv6或Unix域套接字路径
+struct SocketAddress {
+    struct sockaddr_storage storage = {};
+    socklen_t length = 0;
+
+    int getFamily() const { return storage.ss_family; }
+    bool isUnix() const { return storage.ss_family == AF_UNIX; }
+    const struct sockaddr* get() const { return reinterpret_cast<const struct sockaddr*>(&storage); }
+    struct sockaddr* get() { return reinterpret_cast<struct sockaddr*>(&storage); }
+
+    // IP地址的端口，Unix域套接字返回0
+    uint16_t getPort() const;
+    void setPort(uint16_t port);
+    // Unix域套接字的路径，其他地址返回空串
+    std::string getPath() const;
+
+    // "1.2.3.4:8080"、"[::1]:8080"或"unix:/path"
+    std::string toString() const;
+};
+
+// 解析地址，支持"unix:/path"、"[IPv6]:port"、"[IPv6]"、"IPv6"、"IPv4:port"和"IPv4"，只接受数字形式的IP
+// 没有写端口时使用defaultPort，格式错误时返回false
+bool parseSocketAddress(const std::string& spec, uint16_t defaultPort, SocketAddress& address);
+
+// 用accept()或getsockname()得到的地址填充，length为实际长度
+SocketAddress socketAddressFrom(const struct sockaddr_storage& storage, socklen_t length);
+
+} // namespace gmatch
@@ -11,6 +11,12 @@ uint64_t TimeUtil::currentTimeMillis() {
         now.time_since_epoch()).count();
 }
 
+uint64_t TimeUtil::steadyTimeMillis() {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count();
+}
+
 uint64_t TimeUtil::currentTimeSeconds() {
     auto now = std::chrono::system_clock::now();
     return std::chrono::duration_cast<std::chrono::seconds>(
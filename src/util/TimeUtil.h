@@ -11,6 +11,9 @@ public:
     // 获取当前时间戳（毫秒）
     static uint64_t currentTimeMillis();
     
+    // 单调时钟的毫秒数，不受系统时间调整影响，只用于计算时间间隔
+    static uint64_t steadyTimeMillis();
+    
     // 获取当前时间戳（秒）
     static uint64_t currentTimeSeconds();
     
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace gmatch {
+
+// 哈希时间轮：slotCount个槽位组成环，每次advance()前进一个刻度并取出当前槽位中到期的条目
+// 插入和到期都是O(1)。条目不支持取消，调用方在到期回调中判断是否仍然有效，
+// 需要延后时在回调中重新schedule()，因此频繁更新的时间戳不需要每次都移动条目。
+// 不是线程安全的，由单个线程（如I/O线程）驱动
+template <typename T>
+class TimingWheel {
+public:
+    explicit TimingWheel(size_t slotCount) : slots_(std::max<size_t>(slotCount, 2)) {}
+
+    size_t getSlotCount() const { return slots_.size(); }
+    size_t size() const { return size_; }
+
+    // 在ticks个刻度后到期，ticks超出[1, slotCount - 1]时取最近的边界
+    void schedule(T entry, size_t ticks) {
+        ticks = std::min(std::max<size_t>(ticks, 1), slots_.size() - 1);
+        slots_[(current_ + ticks) % slots_.size()].push_back(std::move(entry));
+        ++size_;
+    }
+
+    // 前进一个刻度，对到期的每个条目调用onExpire(T&)，回调中可以再次schedule()
+    template <typename Callback>
+    void advance(Callback&& onExpire) {
+        current_ = (current_ + 1) % slots_.size();
+        std::vector<T> expired;
+        expired.swap(slots_[current_]);
+        size_ -= expired.size();
+        for (auto& entry : expired) {
+            onExpire(entry);
+        }
+        // 回调不会把条目放回当前槽位，复用已分配的空间
+        expired.clear();
+        if (slots_[current_].empty()) {
+            slots_[current_].swap(expired);
+        }
+    }
+
+private:
+    std::vector<std::vector<T>> slots_;
+    size_t current_ = 0;
+    size_t size_ = 0;
+};
+
+} // namespace gmatch
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace gmatch {
+
+// 令牌桶限速器：以ratePerSecond的速度补充令牌，最多积累burst个，每次请求消耗一个
+// 不是线程安全的，由持有者所在的线程使用
+class TokenBucket {
+public:
+    TokenBucket(double ratePerSecond = 0.0, double burst = 0.0)
+        : ratePerMs_(ratePerSecond / 1000.0), burst_(std::max(burst, 1.0)), tokens_(burst_) {}
+
+    // nowMs为单调时钟毫秒数，令牌不足时返回false
+    bool tryConsume(uint64_t nowMs) {
+        if (lastRefillMs_ == 0) {
+            lastRefillMs_ = nowMs;
+        } else if (nowMs > lastRefillMs_) {
+            tokens_ = std::min(burst_, tokens_ + (nowMs - lastRefillMs_) * ratePerMs_);
+            lastRefillMs_ = nowMs;
+        }
+        if (tokens_ < 1.0) {
+            return false;
+        }
+        tokens_ -= 1.0;
+        return true;
+    }
+
+    double getTokens() const { return tokens_; }
+
+private:
+    double ratePerMs_;
+    double burst_;
+    double tokens_;
+    uint64_t lastRefillMs_ = 0;
+};
+
+} // namespace gmatch
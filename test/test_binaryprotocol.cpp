@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include "../src/util/BinaryProtocol.h"
+
+using namespace gmatch;
+
+TEST(BinaryProtocolTest, WriterAndReaderRoundTrip) {
+    std::string message;
+    BinaryWriter writer(message);
+    writer.header(BinaryOpcode::GET_PLAYER_INFO, BinaryStatus::PLAYER_NOT_FOUND, 0x01020304);
+    writer.u8(0xAB);
+    writer.u16(0xBEEF);
+    writer.i16(-2);
+    writer.u32(0xDEADBEEF);
+    writer.i32(-1500);
+    writer.u64(0x0102030405060708ULL);
+    writer.f64(1523.25);
+    writer.str("名字");
+    // 消息头8字节，整数小端序
+    ASSERT_EQ(message.size(), BINARY_HEADER_SIZE + 1 + 2 + 2 + 4 + 4 + 8 + 8 + 2 + 6);
+    EXPECT_EQ(message.substr(0, 8), std::string("\x05\x04\0\0\x04\x03\x02\x01", 8));
+
+    BinaryReader reader(message);
+    BinaryHeader header;
+    uint8_t u8;
+    uint16_t u16;
+    int16_t i16;
+    uint32_t u32;
+    int32_t i32;
+    uint64_t u64;
+    double f64;
+    std::string_view str;
+    ASSERT_TRUE(reader.header(header));
+    EXPECT_EQ(header.opcode, BinaryOpcode::GET_PLAYER_INFO);
+    EXPECT_EQ(header.status, BinaryStatus::PLAYER_NOT_FOUND);
+    EXPECT_EQ(header.requestId, 0x01020304u);
+    ASSERT_TRUE(reader.u8(u8) && reader.u16(u16) && reader.i16(i16) && reader.u32(u32) && reader.i32(i32) &&
+                reader.u64(u64) && reader.f64(f64) && reader.str(str));
+    EXPECT_EQ(u8, 0xAB);
+    EXPECT_EQ(u16, 0xBEEF);
+    EXPECT_EQ(i16, -2);
+    EXPECT_EQ(u32, 0xDEADBEEFu);
+    EXPECT_EQ(i32, -1500);
+    EXPECT_EQ(u64, 0x0102030405060708ULL);
+    EXPECT_EQ(f64, 1523.25);
+    EXPECT_EQ(str, "名字");
+    EXPECT_TRUE(reader.atEnd());
+    EXPECT_FALSE(reader.u8(u8));
+}
+
+TEST(BinaryProtocolTest, TruncatedMessagesFailToRead) {
+    std::string message;
+    BinaryWriter writer(message);
+    writer.header(BinaryOpcode::CREATE_PLAYER, BinaryStatus::OK, 7);
+    writer.i32(1600);
+    writer.str("Alice");
+
+    // 任何截断都不能读出完整的请求
+    for (size_t length = 0; length < message.size(); ++length) {
+        BinaryReader reader(std::string_view(message).substr(0, length));
+        BinaryHeader header;
+        int32_t rating;
+        std::string_view name;
+        EXPECT_FALSE(reader.header(header) && reader.i32(rating) && reader.str(name)) << length;
+    }
+
+    // 超长字符串被截断到u16能表示的长度
+    std::string longMessage;
+    BinaryWriter(longMessage).str(std::string(70000, 'x'));
+    BinaryReader reader(longMessage);
+    std::string_view str;
+    ASSERT_TRUE(reader.str(str));
+    EXPECT_EQ(str.size(), 65535u);
+    EXPECT_TRUE(reader.atEnd());
+}
+
+TEST(BinaryProtocolTest, ErrorResponseEchoesRequestHeader) {
+    std::string request;
+    BinaryWriter(request).header(BinaryOpcode::JOIN_MATCHMAKING, BinaryStatus::OK, 42);
+    std::string response = encodeBinaryError(request, BinaryStatus::RATE_LIMITED, "Rate limit exceeded");
+
+    BinaryReader reader(response);
+    BinaryHeader header;
+    std::string_view message;
+    ASSERT_TRUE(reader.header(header) && reader.str(message));
+    EXPECT_EQ(header.opcode, BinaryOpcode::JOIN_MATCHMAKING);
+    EXPECT_EQ(header.status, BinaryStatus::RATE_LIMITED);
+    EXPECT_EQ(header.requestId, 42u);
+    EXPECT_EQ(message, "Rate limit exceeded");
+
+    // 请求头不完整时opcode和request_id为0
+    std::string partialResponse = encodeBinaryError("abc", BinaryStatus::INVALID_COMMAND, "bad");
+    BinaryReader partial(partialResponse);
+    ASSERT_TRUE(partial.header(header));
+    EXPECT_EQ(header.opcode, BinaryOpcode::NONE);
+    EXPECT_EQ(header.requestId, 0u);
+}
+
+TEST(BinaryProtocolTest, ParseWireProtocol) {
+    WireProtocol protocol = WireProtocol::JSON;
+    EXPECT_TRUE(parseWireProtocol("binary", protocol));
+    EXPECT_EQ(protocol, WireProtocol::BINARY);
+    EXPECT_STREQ(wireProtocolName(protocol), "binary");
+    EXPECT_TRUE(parseWireProtocol("json", protocol));
+    EXPECT_EQ(protocol, WireProtocol::JSON);
+    EXPECT_FALSE(parseWireProtocol("line", protocol));
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../src/util/FrameCodec.h"
+
+using namespace gmatch;
+
+namespace {
+
+std::vector<std::string> drain(FrameDecoder& decoder) {
+    std::vector<std::string> frames;
+    std::string_view frame;
+    while (decoder.nextFrame(frame)) {
+        frames.emplace_back(frame);
+    }
+    return frames;
+}
+
+} // namespace
+
+TEST(FrameCodecTest, LineFramesAcrossReads) {
+    FrameDecoder decoder(FramingMode::LINE);
+
+    // 一次读取包含多帧，最后一帧不完整
+    std::string data = "{\"cmd\":\"a\"}\n{\"cmd\":\"b\"}\r\n\n{\"cmd\"";
+    decoder.append(data.data(), data.size());
+    EXPECT_EQ(drain(decoder), (std::vector<std::string>{"{\"cmd\":\"a\"}", "{\"cmd\":\"b\"}"}));
+    EXPECT_EQ(decoder.readableBytes(), 6u);
+
+    std::string rest = ":\"c\"}\n";
+    decoder.append(rest.data(), rest.size());
+    EXPECT_EQ(drain(decoder), (std::vector<std::string>{"{\"cmd\":\"c\"}"}));
+    EXPECT_EQ(decoder.readableBytes(), 0u);
+}
+
+TEST(FrameCodecTest, LengthPrefixedFrames) {
+    FrameDecoder decoder(FramingMode::LENGTH_PREFIXED);
+    std::string payload(70000, 'z');
+    std::string data = encodeFrame(FramingMode::LENGTH_PREFIXED, "hello") +
+                       encodeFrame(FramingMode::LENGTH_PREFIXED, payload) +
+                       encodeFrame(FramingMode::LENGTH_PREFIXED, "");
+    ASSERT_EQ(data.substr(0, 4), std::string("\0\0\0\5", 4));
+
+    // 逐字节写入，帧只在完整后才能取出
+    std::vector<std::string> frames;
+    for (char c : data) {
+        decoder.append(&c, 1);
+        for (auto& frame : drain(decoder)) {
+            frames.push_back(frame);
+        }
+    }
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(frames[0], "hello");
+    EXPECT_EQ(frames[1], payload);
+    EXPECT_EQ(frames[2], "");
+}
+
+TEST(FrameCodecTest, OversizedFrameIsError) {
+    FrameDecoder lineDecoder(FramingMode::LINE, 8);
+    std::string line = "0123456789";
+    lineDecoder.append(line.data(), line.size());
+    std::string_view frame;
+    EXPECT_FALSE(lineDecoder.nextFrame(frame));
+    EXPECT_TRUE(lineDecoder.hasError());
+
+    FrameDecoder lengthDecoder(FramingMode::LENGTH_PREFIXED, 8);
+    std::string header = encodeFrame(FramingMode::LENGTH_PREFIXED, line).substr(0, 4);
+    lengthDecoder.append(header.data(), header.size());
+    EXPECT_FALSE(lengthDecoder.nextFrame(frame));
+    EXPECT_TRUE(lengthDecoder.hasError());
+}
+
+TEST(FrameCodecTest, ParseFramingMode) {
+    FramingMode mode = FramingMode::LINE;
+    EXPECT_TRUE(parseFramingMode("length", mode));
+    EXPECT_EQ(mode, FramingMode::LENGTH_PREFIXED);
+    EXPECT_STREQ(framingModeName(mode), "length");
+    EXPECT_FALSE(parseFramingMode("json", mode));
+}
+
+TEST(FrameCodecTest, BinaryFramesUseLittleEndianLength) {
+    std::string data = encodeFrame(FramingMode::BINARY, "hello") + encodeFrame(FramingMode::BINARY, "");
+    ASSERT_EQ(data.substr(0, 4), std::string("\5\0\0\0", 4));
+
+    FrameDecoder decoder(FramingMode::BINARY);
+    decoder.append(data.data(), data.size());
+    EXPECT_EQ(drain(decoder), (std::vector<std::string>{"hello", ""}));
+    EXPECT_STREQ(framingModeName(FramingMode::BINARY), "binary");
+    // binary只能通过协商启用，不能作为分帧配置
+    FramingMode mode = FramingMode::LINE;
+    EXPECT_FALSE(parseFramingMode("binary", mode));
+}
+
+TEST(FrameCodecTest, SwitchModeAfterConsumingPrefix) {
+    // 连接开头的协商字节之后按新的分帧方式解析
+    FrameDecoder decoder(FramingMode::LINE);
+    std::string data = "MAGIC" + encodeFrame(FramingMode::BINARY, "a\nb");
+    decoder.append(data.data(), data.size());
+    EXPECT_EQ(decoder.peek().substr(0, 5), "MAGIC");
+    decoder.consume(5);
+    decoder.setMode(FramingMode::BINARY);
+    EXPECT_EQ(drain(decoder), (std::vector<std::string>{"a\nb"}));
+    EXPECT_TRUE(decoder.peek().empty());
+    // 超过剩余字节数的consume不越界
+    decoder.consume(10);
+    EXPECT_EQ(decoder.readableBytes(), 0u);
+}
+
+TEST(FrameCodecTest, CompactAfterReadingPastScanPosition) {
+    // 按行扫描过的位置落后于readPos_时，压缩缓冲区不能让扫描位置回绕
+    FrameDecoder decoder(FramingMode::LINE);
+    decoder.append("abc", 3);
+    EXPECT_TRUE(drain(decoder).empty());
+    decoder.append("defgh", 5);
+    decoder.consume(6);
+
+    // 剩余空间不足、需要把未取出的"gh"移到开头
+    std::string chunk = "ij\n" + std::string(4087, 'x') + "\n";
+    decoder.append(chunk.data(), chunk.size());
+    EXPECT_EQ(drain(decoder), (std::vector<std::string>{"ghij", std::string(4087, 'x')}));
+
+    // 其他分帧方式推进readPos_后切回按行分帧
+    decoder.append("partial", 7);
+    EXPECT_TRUE(drain(decoder).empty());
+    decoder.consume(7);
+    decoder.setMode(FramingMode::LENGTH_PREFIXED);
+    std::string data = encodeFrame(FramingMode::LENGTH_PREFIXED, "framed") + "ta";
+    decoder.append(data.data(), data.size());
+    EXPECT_EQ(drain(decoder), (std::vector<std::string>{"framed"}));
+    decoder.setMode(FramingMode::LINE);
+    chunk = "\n" + std::string(4088, 'y') + "\n";
+    decoder.append(chunk.data(), chunk.size());
+    EXPECT_EQ(drain(decoder), (std::vector<std::string>{"ta", std::string(4088, 'y')}));
+}
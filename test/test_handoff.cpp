@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/server/Handoff.h"
+
+using namespace gmatch;
+
+namespace {
+
+int openListener(uint16_t& port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        close(fd);
+        return -1;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(fd, (struct sockaddr*)&addr, &length);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+uint16_t localPort(int fd) {
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    getsockname(fd, (struct sockaddr*)&addr, &length);
+    return ntohs(addr.sin_port);
+}
+
+} // namespace
+
+TEST(HandoffTest, StateRoundTrip) {
+    HandoffState state;
+    state.nextPlayerId = 42;
+    state.players.push_back({7, "alice", 1500, true, 1700000000123ULL});
+    state.players.push_back({9, std::string("b\0b", 3), 1800, false, 5});
+    state.players.push_back({11, "", -20, true, 0});
+
+    HandoffState decoded;
+    ASSERT_TRUE(decodeHandoffState(encodeHandoffState(state), decoded));
+    EXPECT_EQ(decoded.nextPlayerId, 42u);
+    ASSERT_EQ(decoded.players.size(), 3u);
+    for (size_t i = 0; i < state.players.size(); ++i) {
+        EXPECT_EQ(decoded.players[i].id, state.players[i].id);
+        EXPECT_EQ(decoded.players[i].name, state.players[i].name);
+        EXPECT_EQ(decoded.players[i].rating, state.players[i].rating);
+        EXPECT_EQ(decoded.players[i].inQueue, state.players[i].inQueue);
+        EXPECT_EQ(decoded.players[i].lastActivityTime, state.players[i].lastActivityTime);
+    }
+}
+
+TEST(HandoffTest, TruncatedStateIsRejected) {
+    HandoffState state;
+    state.players.push_back({1, "player", 1500, true, 10});
+    std::string data = encodeHandoffState(state);
+
+    HandoffState decoded;
+    for (size_t length = 0; length < data.size(); ++length) {
+        EXPECT_FALSE(decodeHandoffState(std::string_view(data).substr(0, length), decoded)) << length;
+    }
+    EXPECT_FALSE(decodeHandoffState(data + "x", decoded));
+    EXPECT_TRUE(decodeHandoffState(data, decoded));
+}
+
+TEST(HandoffTest, PassesListenSocketsAndState) {
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    uint16_t port = 0;
+    int listener = openListener(port);
+    ASSERT_GE(listener, 0);
+
+    // 大于套接字缓冲区的状态需要分多次发送
+    std::string payload(1 << 20, 'p');
+    std::thread sender([&] {
+        EXPECT_TRUE(sendHandoff(pair[0], {listener}, payload));
+        EXPECT_TRUE(waitHandoffAck(pair[0], 5000));
+    });
+
+    std::vector<int> fds;
+    std::string received;
+    ASSERT_TRUE(receiveHandoff(pair[1], fds, received, 5000));
+    EXPECT_EQ(received, payload);
+    ASSERT_EQ(fds.size(), 1u);
+    EXPECT_NE(fds[0], listener);
+    EXPECT_EQ(localPort(fds[0]), port);
+    EXPECT_TRUE(sendHandoffAck(pair[1]));
+    sender.join();
+
+    // 原描述符关闭后，收到的描述符仍然在同一端口上接受连接
+    close(listener);
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    ASSERT_EQ(connect(client, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    int accepted = accept(fds[0], nullptr, nullptr);
+    EXPECT_GE(accepted, 0);
+
+    close(accepted);
+    close(client);
+    close(fds[0]);
+    close(pair[0]);
+    close(pair[1]);
+}
+
+TEST(HandoffTest, ReceiveTimesOutWithoutSender) {
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    std::vector<int> fds;
+    std::string payload;
+    EXPECT_FALSE(receiveHandoff(pair[1], fds, payload, 50));
+    EXPECT_FALSE(waitHandoffAck(pair[0], 50));
+    close(pair[0]);
+    close(pair[1]);
+}
+
+TEST(HandoffTest, ConnectsThroughHandoffPath) {
+    std::string path = "/tmp/gmatch_handoff_test_" + std::to_string(getpid()) + ".sock";
+    // 没有进程等待时连接失败
+    EXPECT_LT(connectHandoff(path), 0);
+
+    int listenFd = listenHandoff(path);
+    ASSERT_GE(listenFd, 0);
+    int oldSide = connectHandoff(path);
+    ASSERT_GE(oldSide, 0);
+    int newSide = acceptHandoff(listenFd, 1000);
+    ASSERT_GE(newSide, 0);
+
+    EXPECT_TRUE(sendHandoff(oldSide, {}, "state"));
+    std::vector<int> fds;
+    std::string payload;
+    EXPECT_TRUE(receiveHandoff(newSide, fds, payload, 1000));
+    EXPECT_TRUE(fds.empty());
+    EXPECT_EQ(payload, "state");
+
+    close(oldSide);
+    close(newSide);
+    close(listenFd);
+    unlink(path.c_str());
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../src/util/JsonReader.h"
+
+using namespace gmatch;
+
+namespace {
+
+struct CorpusEntry {
+    bool valid;
+    std::string text;
+    int line;
+};
+
+std::vector<CorpusEntry> loadCorpus() {
+    std::vector<CorpusEntry> entries;
+    std::ifstream in(std::string(GMATCH_TEST_CORPUS_DIR) + "/json_requests.txt");
+    std::string line;
+    int number = 0;
+    while (std::getline(in, line)) {
+        ++number;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line.compare(0, 3, "OK ") == 0) {
+            entries.push_back({true, line.substr(3), number});
+        } else if (line.compare(0, 4, "ERR ") == 0) {
+            entries.push_back({false, line.substr(4), number});
+        } else {
+            ADD_FAILURE() << "Malformed corpus line " << number << ": " << line;
+        }
+    }
+    return entries;
+}
+
+bool within(std::string_view view, std::string_view text) {
+    return view.empty() || (view.data() >= text.data() && view.data() + view.size() <= text.data() + text.size());
+}
+
+} // namespace
+
+TEST(JsonReaderTest, RegressionCorpus) {
+    auto entries = loadCorpus();
+    ASSERT_GT(entries.size(), 20u);
+    for (const auto& entry : entries) {
+        JsonFields fields, data;
+        EXPECT_EQ(parseJsonObject(entry.text, fields, "data", &data), entry.valid)
+            << "line " << entry.line << ": " << entry.text;
+    }
+}
+
+TEST(JsonReaderTest, RecordsTopLevelAndNestedFields) {
+    std::string text = " {\"cmd\" : \"create_player\", \"data\": {\"name\": \"a,b}\", \"rating\": 1720, "
+                       "\"tags\": [1, {\"x\": 2}], \"ok\": true}, \"extra\": null} ";
+    JsonFields top, data;
+    ASSERT_TRUE(parseJsonObject(text, top, "data", &data));
+    EXPECT_EQ(top.size(), 3u);
+    EXPECT_EQ(data.size(), 4u);
+
+    std::string_view cmd;
+    ASSERT_TRUE(top.find("cmd")->getStringView(cmd));
+    EXPECT_EQ(cmd, "create_player");
+    EXPECT_EQ(top.find("data")->text.front(), '{');
+    EXPECT_EQ(top.find("data")->text.back(), '}');
+    EXPECT_EQ(top.find("extra")->type, JsonValue::Type::NULL_VALUE);
+    EXPECT_EQ(top.find("missing"), nullptr);
+
+    std::string name;
+    ASSERT_TRUE(data.find("name")->getString(name));
+    EXPECT_EQ(name, "a,b}");
+    int rating = 0;
+    ASSERT_TRUE(data.find("rating")->getInteger(rating));
+    EXPECT_EQ(rating, 1720);
+    EXPECT_EQ(data.find("tags")->type, JsonValue::Type::ARRAY);
+    EXPECT_EQ(data.find("tags")->text, "[1, {\"x\": 2}]");
+    bool ok = false;
+    ASSERT_TRUE(data.find("ok")->getBool(ok));
+    EXPECT_TRUE(ok);
+    // 更深层对象的成员不记录
+    EXPECT_EQ(data.find("x"), nullptr);
+}
+
+TEST(JsonReaderTest, OnlyFirstNestedObjectIsRecorded) {
+    JsonFields top, data;
+    ASSERT_TRUE(parseJsonObject("{\"data\":{\"a\":1},\"data\":{\"b\":2}}", top, "data", &data));
+    EXPECT_NE(data.find("a"), nullptr);
+    EXPECT_EQ(data.find("b"), nullptr);
+    EXPECT_EQ(top.find("data")->text, "{\"a\":1}");
+}
+
+TEST(JsonReaderTest, ArrayReaderIteratesElements) {
+    JsonArrayReader reader(" [ {\"name\": \"a\", \"rating\": 1}, 42 ,\"x\", [1,2], {} ] ");
+    JsonValue element;
+    JsonFields fields;
+    ASSERT_TRUE(reader.next(element, &fields));
+    EXPECT_TRUE(element.isObject());
+    EXPECT_EQ(fields.size(), 2u);
+    int rating = 0;
+    ASSERT_TRUE(fields.find("rating")->getInteger(rating));
+    EXPECT_EQ(rating, 1);
+
+    // 不是对象的元素不记录字段
+    ASSERT_TRUE(reader.next(element, &fields));
+    EXPECT_EQ(element.text, "42");
+    EXPECT_EQ(fields.size(), 0u);
+    ASSERT_TRUE(reader.next(element));
+    EXPECT_EQ(element.text, "x");
+    ASSERT_TRUE(reader.next(element));
+    EXPECT_EQ(element.text, "[1,2]");
+    ASSERT_TRUE(reader.next(element, &fields));
+    EXPECT_EQ(fields.size(), 0u);
+    EXPECT_FALSE(reader.next(element));
+    EXPECT_FALSE(reader.failed());
+    EXPECT_FALSE(reader.next(element));
+
+    JsonArrayReader empty("[ ]");
+    EXPECT_FALSE(empty.next(element));
+    EXPECT_FALSE(empty.failed());
+
+    for (const char* text : {"", "{}", "[1,]", "[1 2]", "[1"}) {
+        JsonArrayReader bad(text);
+        while (bad.next(element)) {
+        }
+        EXPECT_TRUE(bad.failed()) << text;
+    }
+}
+
+TEST(JsonReaderTest, IntegerConversion) {
+    JsonFields fields;
+    ASSERT_TRUE(parseJsonObject("{\"a\":-12,\"b\":1.5,\"c\":1e3,\"d\":\"7\",\"e\":99999999999,\"f\":18446744073709551615}",
+                                fields));
+    int value = 0;
+    EXPECT_TRUE(fields.find("a")->getInteger(value));
+    EXPECT_EQ(value, -12);
+    EXPECT_FALSE(fields.find("b")->getInteger(value));
+    EXPECT_FALSE(fields.find("c")->getInteger(value));
+    EXPECT_FALSE(fields.find("d")->getInteger(value));
+    EXPECT_FALSE(fields.find("e")->getInteger(value));
+    uint64_t large = 0;
+    EXPECT_TRUE(fields.find("f")->getInteger(large));
+    EXPECT_EQ(large, UINT64_MAX);
+    EXPECT_FALSE(fields.find("a")->getInteger(large));
+}
+
+TEST(JsonReaderTest, UnescapesStrings) {
+    std::string out;
+    ASSERT_TRUE(unescapeJsonString("a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t", out));
+    EXPECT_EQ(out, "a\"b\\c/d\b\f\n\r\t");
+
+    out.clear();
+    ASSERT_TRUE(unescapeJsonString("\\u0041\\u00e9\\u4e2d\\ud83d\\ude00", out));
+    EXPECT_EQ(out, "A\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80");
+
+    // 单独出现或顺序颠倒的代理项无效
+    const char* invalid[] = {"\\ud83d", "\\ud83dx", "\\ud83d\\u0041", "\\ude00", "\\u12", "\\q", "\\"};
+    for (const char* text : invalid) {
+        out.clear();
+        EXPECT_FALSE(unescapeJsonString(text, out)) << text;
+    }
+
+    // 语法合法但代理项不成对的字符串在取值时失败
+    JsonFields fields;
+    ASSERT_TRUE(parseJsonObject("{\"name\":\"\\udc00\"}", fields));
+    EXPECT_FALSE(fields.find("name")->getString(out));
+}
+
+TEST(JsonReaderTest, EscapeRoundTrip) {
+    std::string original = std::string("quote\" slash\\ ctrl\x01\x1f\n\t end", 26);
+    std::string escaped = escapeJsonString(original);
+    EXPECT_EQ(escaped.find_first_of(std::string("\x01\x1f\n\t", 4)), std::string::npos);
+
+    std::string text = "{\"v\":\"" + escaped + "\"}";
+    JsonFields fields;
+    ASSERT_TRUE(parseJsonObject(text, fields));
+    std::string decoded;
+    ASSERT_TRUE(fields.find("v")->getString(decoded));
+    EXPECT_EQ(decoded, original);
+}
+
+TEST(JsonReaderTest, FieldCapacityAndDepthLimits) {
+    std::string text = "{";
+    for (size_t i = 0; i < JsonFields::CAPACITY; ++i) {
+        text += (i ? ",\"k" : "\"k") + std::to_string(i) + "\":" + std::to_string(i);
+    }
+    JsonFields fields;
+    EXPECT_TRUE(parseJsonObject(text + "}", fields));
+    EXPECT_EQ(fields.size(), JsonFields::CAPACITY);
+    EXPECT_FALSE(parseJsonObject(text + ",\"overflow\":1}", fields));
+
+    auto nested = [](int depth) {
+        return "{\"a\":" + std::string(depth - 1, '[') + std::string(depth - 1, ']') + "}";
+    };
+    EXPECT_TRUE(parseJsonObject(nested(MAX_JSON_DEPTH), fields));
+    EXPECT_FALSE(parseJsonObject(nested(MAX_JSON_DEPTH + 1), fields));
+    // 很深的嵌套不会耗尽栈
+    EXPECT_FALSE(parseJsonObject(std::string(1 << 20, '['), fields));
+    EXPECT_FALSE(parseJsonObject("{\"a\":" + std::string(1 << 20, '{'), fields));
+}
+
+// 对语料做确定性的随机变异(替换、插入、删除、截断)，解析不能崩溃，
+// 接受的输入中记录下来的视图必须都落在输入之内。配合ASAN构建可以发现越界读取
+TEST(JsonReaderTest, MutationFuzz) {
+    auto entries = loadCorpus();
+    ASSERT_FALSE(entries.empty());
+    const char alphabet[] = "{}[]\":,\\-+.eE0123456789 \tabcdefnlrstu\x01\x7f\xc3";
+
+    std::mt19937 rng(20260521);
+    size_t accepted = 0;
+    for (int iteration = 0; iteration < 200000; ++iteration) {
+        std::string text = entries[rng() % entries.size()].text;
+        int mutations = 1 + rng() % 4;
+        for (int m = 0; m < mutations; ++m) {
+            size_t pos = text.empty() ? 0 : rng() % (text.size() + 1);
+            char c = alphabet[rng() % (sizeof(alphabet) - 1)];
+            switch (rng() % 4) {
+                case 0:
+                    if (pos < text.size()) {
+                        text[pos] = c;
+                    }
+                    break;
+                case 1:
+                    text.insert(pos, 1, c);
+                    break;
+                case 2:
+                    if (pos < text.size()) {
+                        text.erase(pos, 1);
+                    }
+                    break;
+                default:
+                    text.resize(pos);
+                    break;
+            }
+        }
+
+        // 复制到精确大小的缓冲区，越界读取能被ASAN发现
+        std::vector<char> buffer(text.begin(), text.end());
+        std::string_view input(buffer.data(), buffer.size());
+        JsonFields top, data;
+        if (!parseJsonObject(input, top, "data", &data)) {
+            continue;
+        }
+        ++accepted;
+        for (const JsonFields* fields : {&top, &data}) {
+            for (std::string_view key : {"cmd", "data", "name", "rating", "player_id", "a", "b"}) {
+                const JsonValue* value = fields->find(key);
+                if (!value) {
+                    continue;
+                }
+                ASSERT_TRUE(within(value->text, input)) << text;
+                std::string decoded;
+                int number;
+                value->getString(decoded);
+                value->getInteger(number);
+            }
+        }
+    }
+    // 变异后仍有一部分输入合法，说明变异覆盖了解析成功的路径
+    EXPECT_GT(accepted, 0u);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include "../src/util/JsonReader.h"
+#include "../src/util/JsonWriter.h"
+
+using namespace gmatch;
+
+TEST(JsonWriterTest, InsertsSeparatorsInNestedContainers) {
+    std::string out;
+    JsonWriter writer(out);
+    writer.beginObject()
+        .key("a").integer(1)
+        .key("list").beginArray()
+            .integer(1)
+            .beginObject().key("x").boolean(true).key("y").boolean(false).endObject()
+            .beginArray().endArray()
+            .string("s")
+        .endArray()
+        .key("empty").beginObject().endObject()
+        .key("raw").raw("{\"k\":[1,2]}")
+        .endObject();
+    EXPECT_EQ(out, "{\"a\":1,\"list\":[1,{\"x\":true,\"y\":false},[],\"s\"],\"empty\":{},\"raw\":{\"k\":[1,2]}}");
+
+    // 生成的结果可以被JsonReader读回
+    JsonFields fields;
+    ASSERT_TRUE(parseJsonObject(out, fields));
+    int a = 0;
+    ASSERT_NE(fields.find("a"), nullptr);
+    EXPECT_TRUE(fields.find("a")->getInteger(a));
+    EXPECT_EQ(a, 1);
+}
+
+TEST(JsonWriterTest, FormatsNumbers) {
+    std::string out;
+    JsonWriter writer(out);
+    writer.beginArray()
+        .integer(std::numeric_limits<int64_t>::min())
+        .integer(std::numeric_limits<uint64_t>::max())
+        .integer(static_cast<int16_t>(-1))
+        .number(1523.25)
+        .number(0.1)
+        .number(-2.0)
+        .number(std::nan(""))
+        .number(std::numeric_limits<double>::infinity())
+        .endArray();
+    EXPECT_EQ(out, "[-9223372036854775808,18446744073709551615,-1,1523.25,0.1,-2,null,null]");
+}
+
+TEST(JsonWriterTest, EscapesStrings) {
+    std::string out;
+    JsonWriter writer(out);
+    writer.beginObject()
+        .key("name").string("A, \"B\"}\\\n\x01 \xc3\xa9")
+        .key("cmd").escapedString("already\\\"escaped")
+        .endObject();
+    EXPECT_EQ(out, "{\"name\":\"A, \\\"B\\\"}\\\\\\n\\u0001 \xc3\xa9\",\"cmd\":\"already\\\"escaped\"}");
+
+    JsonFields fields;
+    ASSERT_TRUE(parseJsonObject(out, fields));
+    std::string name;
+    ASSERT_TRUE(fields.find("name")->getString(name));
+    EXPECT_EQ(name, "A, \"B\"}\\\n\x01 \xc3\xa9");
+}
+
+TEST(JsonWriterTest, AppendsWithoutReallocatingReservedBuffer) {
+    std::string out = "prefix:";
+    out.reserve(256);
+    const char* data = out.data();
+    JsonWriter writer(out);
+    writer.beginObject().key("player_id").integer(uint64_t(123456789)).key("name").string("Alice").endObject();
+    EXPECT_EQ(out, "prefix:{\"player_id\":123456789,\"name\":\"Alice\"}");
+    EXPECT_EQ(out.data(), data);
+}
+
+TEST(JsonWriterTest, InsertsRequestIdIntoResponse) {
+    JsonFields fields;
+    ASSERT_TRUE(parseJsonObject("{\"id\":\"r-1\",\"n\":12}", fields));
+    std::string out;
+    appendJsonWithId("{\"cmd\":\"x\"}", *fields.find("id"), out);
+    EXPECT_EQ(out, "{\"id\":\"r-1\",\"cmd\":\"x\"}");
+    out.clear();
+    appendJsonWithId("{ }", *fields.find("n"), out);
+    EXPECT_EQ(out, "{\"id\":12 }");
+    // 不是对象时原样追加
+    out = "a";
+    appendJsonWithId("pong", *fields.find("n"), out);
+    EXPECT_EQ(out, "apong");
+
+    const std::string busy = "{\"cmd\":\"error\",\"success\":false}";
+    out.clear();
+    EXPECT_TRUE(appendJsonWithRequestId("{\"id\":5,\"cmd\":\"get_rooms\"}", busy, out));
+    EXPECT_EQ(out, "{\"id\":5,\"cmd\":\"error\",\"success\":false}");
+    // 没有id、id不是数字或字符串、请求不是合法JSON时out不变
+    out.clear();
+    EXPECT_FALSE(appendJsonWithRequestId("{\"cmd\":\"get_rooms\"}", busy, out));
+    EXPECT_FALSE(appendJsonWithRequestId("{\"id\":[1]}", busy, out));
+    EXPECT_FALSE(appendJsonWithRequestId("{\"id\":5", busy, out));
+    EXPECT_TRUE(out.empty());
+}
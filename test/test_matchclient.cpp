@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "../src/client/MatchClient.h"
+#include "../src/server/BinaryRequestHandler.h"
+#include "../src/server/RequestExecutor.h"
+#include "../src/server/RequestHandler.h"
+
+using namespace gmatch;
+
+namespace {
+
+// 测试用的一次性门闩
+class Gate {
+public:
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        condition_.notify_all();
+    }
+
+    bool wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return condition_.wait_for(lock, std::chrono::seconds(5), [this] { return open_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool open_ = false;
+};
+
+bool ready(const std::future<ClientResponse>& future, int ms = 5000) {
+    return future.wait_for(std::chrono::milliseconds(ms)) == std::future_status::ready;
+}
+
+} // namespace
+
+// 与MatchServer相同的请求分发：按连接协议选择处理器，在执行器中处理，带id的请求从连接的串行队列中分离
+class MatchClientTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto& manager = MatchManager::getInstance();
+        manager.shutdown();
+        manager.init(10);
+
+        executor = std::make_unique<RequestExecutor>(2);
+        executor->start();
+        handler.setRequestIdCallback([this] { executor->detachCurrentTask(); });
+
+        server = std::make_unique<TcpServer>("127.0.0.1", 0);
+        server->setIoThreads(1);
+        server->setBinaryProtocol(true);
+        server->setMessageCallback([this](const TcpConnectionPtr& conn, std::string_view message) {
+            RequestHandler* requestHandler = conn->getProtocol() == WireProtocol::BINARY
+                ? static_cast<RequestHandler*>(&binaryHandler) : &handler;
+            executor->submit(conn->getId(), [requestHandler, conn, request = std::string(message)] {
+                conn->send(requestHandler->handleRequest(request, conn->getId()));
+            });
+        });
+        ASSERT_TRUE(server->start());
+    }
+
+    void TearDown() override {
+        server->stop();
+        executor->stop();
+        MatchManager::getInstance().shutdown();
+    }
+
+    JsonRequestHandler handler;
+    BinaryRequestHandler binaryHandler;
+    std::unique_ptr<RequestExecutor> executor;
+    std::unique_ptr<TcpServer> server;
+};
+
+TEST_F(MatchClientTest, FuturesResolveByRequestId) {
+    MatchClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", server->getPort()));
+
+    auto created = client.createPlayerAsync("Alice \"A\"", 1720);
+    ASSERT_TRUE(ready(created));
+    ClientResponse response = created.get();
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.message, "Player created successfully");
+    // 回调执行前已经记录了玩家ID
+    ASSERT_NE(client.getPlayerId(), 0u);
+    EXPECT_EQ(response.data, "{\"player_id\":" + std::to_string(client.getPlayerId()) +
+                             ",\"name\":\"Alice \\\"A\\\"\",\"rating\":1720}");
+
+    // 多个请求同时在途
+    auto joined = client.joinMatchmakingAsync();
+    ASSERT_TRUE(ready(joined));
+    auto info = client.getPlayerInfoAsync();
+    auto queue = client.getQueueStatusAsync();
+    ASSERT_TRUE(ready(info));
+    ASSERT_TRUE(ready(queue));
+    EXPECT_TRUE(joined.get().success);
+    EXPECT_NE(info.get().data.find("\"in_queue\":true"), std::string::npos);
+    EXPECT_EQ(queue.get().data, "{\"queue_size\":1}");
+
+    // 回调形式，失败的响应也按id完成
+    std::promise<ClientResponse> joinedAgain;
+    ASSERT_TRUE(client.joinMatchmaking([&joinedAgain](const ClientResponse& r) { joinedAgain.set_value(r); }));
+    auto joinedAgainFuture = joinedAgain.get_future();
+    ASSERT_TRUE(ready(joinedAgainFuture));
+    EXPECT_FALSE(joinedAgainFuture.get().success);
+
+    client.disconnect();
+    // 未连接时请求不会发出
+    auto notSent = client.getRoomsAsync();
+    ASSERT_TRUE(ready(notSent, 0));
+    EXPECT_FALSE(notSent.get().success);
+}
+
+TEST_F(MatchClientTest, SlowRequestCompletesOutOfOrder) {
+    // 让get_rooms阻塞，同一连接随后的请求先完成
+    Gate release;
+    handler.registerCommandHandler("get_rooms", [&release](const JsonRequest&, TcpConnection::ConnectionId) {
+        release.wait();
+        return std::string("{\"cmd\":\"get_rooms\",\"success\":true,\"message\":\"slow\",\"data\":[]}");
+    });
+
+    MatchClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", server->getPort()));
+    auto rooms = client.getRoomsAsync();
+    auto queue = client.getQueueStatusAsync();
+    ASSERT_TRUE(ready(queue));
+    EXPECT_TRUE(queue.get().success);
+    EXPECT_FALSE(ready(rooms, 50));
+
+    release.open();
+    ASSERT_TRUE(ready(rooms));
+    ClientResponse response = rooms.get();
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.message, "slow");
+    EXPECT_EQ(response.data, "[]");
+    client.disconnect();
+}
+
+TEST_F(MatchClientTest, PendingRequestsFailOnDisconnect) {
+    Gate release;
+    handler.registerCommandHandler("get_rooms", [&release](const JsonRequest&, TcpConnection::ConnectionId) {
+        release.wait();
+        return std::string("{}");
+    });
+
+    MatchClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", server->getPort()));
+    auto rooms = client.getRoomsAsync();
+    EXPECT_FALSE(ready(rooms, 20));
+
+    // 服务器关闭连接后等待中的请求以失败完成
+    server->stop();
+    ASSERT_TRUE(ready(rooms));
+    ClientResponse response = rooms.get();
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.message, "Disconnected from server");
+    release.open();
+}
+
+TEST_F(MatchClientTest, BinaryFuturesUseHeaderRequestId) {
+    MatchClient client;
+    client.setProtocol(WireProtocol::BINARY);
+    ASSERT_TRUE(client.connect("127.0.0.1", server->getPort()));
+
+    auto created = client.createPlayerAsync("Bob", 1500);
+    ASSERT_TRUE(ready(created));
+    EXPECT_TRUE(created.get().success);
+    ASSERT_NE(client.getPlayerId(), 0u);
+
+    // 二进制响应转换为与JSON协议相同的data
+    auto info = client.getPlayerInfoAsync();
+    auto rooms = client.getRoomsAsync();
+    ASSERT_TRUE(ready(info));
+    ASSERT_TRUE(ready(rooms));
+    EXPECT_EQ(info.get().data, "{\"player_id\":" + std::to_string(client.getPlayerId()) +
+                               ",\"name\":\"Bob\",\"rating\":1500,\"in_queue\":false}");
+    ClientResponse roomsResponse = rooms.get();
+    EXPECT_EQ(roomsResponse.message, "Rooms retrieved successfully");
+    EXPECT_EQ(roomsResponse.data, "[]");
+
+    auto left = client.leaveMatchmakingAsync();
+    ASSERT_TRUE(ready(left));
+    ClientResponse leftResponse = left.get();
+    EXPECT_FALSE(leftResponse.success);
+    EXPECT_FALSE(leftResponse.message.empty());
+    client.disconnect();
+}
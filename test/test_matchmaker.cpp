@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <chrono>
+#include <future>
 #include "../src/core/MatchMaker.h"
 
 using namespace gmatch;
@@ -131,4 +132,150 @@ TEST_F(MatchMakerTest, RatingBasedMatching) {
     
     EXPECT_TRUE(foundPlayer1);
     EXPECT_TRUE(foundPlayer3);
-} 
\ No newline at end of file
+} 
+TEST_F(MatchMakerTest, MatchTickFormsAllRooms) {
+    auto strategy = std::make_shared<RatingBasedStrategy>(300);
+    matchMaker->setMatchStrategy(strategy);
+    
+    int notified = 0;
+    matchMaker->setMatchNotifyCallback([&notified](const RoomPtr&) {
+        ++notified;
+    });
+    
+    // 不启动匹配线程，直接执行一轮匹配
+    matchMaker->addPlayer(std::make_shared<Player>(1, "Player1", 1500));
+    matchMaker->addPlayer(std::make_shared<Player>(2, "Player2", 2500));
+    matchMaker->addPlayer(std::make_shared<Player>(3, "Player3", 1600));
+    matchMaker->addPlayer(std::make_shared<Player>(4, "Player4", 2400));
+    matchMaker->addPlayer(std::make_shared<Player>(5, "Player5", 1000));
+    matchMaker->addPlayer(std::make_shared<Player>(6, "Player6", 1250));
+    matchMaker->addPlayer(std::make_shared<Player>(7, "Player7", 3500));
+    
+    auto rooms = matchMaker->matchTick();
+    
+    // 一轮内组出全部3个房间，仅剩无法匹配的Player7
+    EXPECT_EQ(rooms.size(), 3);
+    EXPECT_EQ(notified, 3);
+    EXPECT_EQ(matchMaker->getQueueSize(), 1);
+    EXPECT_EQ(matchMaker->getRooms().size(), 3);
+    
+    EXPECT_TRUE(matchMaker->matchTick().empty());
+}
+
+TEST_F(MatchMakerTest, EventDrivenMatchesWithoutWaitingForInterval) {
+    matchMaker->setEventDriven(true);
+    matchMaker->setMatchInterval(1000);
+    
+    std::promise<std::chrono::steady_clock::time_point> matched;
+    auto matchedAt = matched.get_future();
+    matchMaker->setMatchNotifyCallback([&matched](const RoomPtr&) {
+        matched.set_value(std::chrono::steady_clock::now());
+    });
+    
+    // 等匹配线程进入等待后再入队
+    matchMaker->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    
+    matchMaker->addPlayer(std::make_shared<Player>(1, "Player1", 1500));
+    matchMaker->addPlayer(std::make_shared<Player>(2, "Player2", 1600));
+    auto joinedAt = std::chrono::steady_clock::now();
+    
+    // 队列变化唤醒匹配线程，房间在合并窗口后即组成，远早于轮询间隔
+    ASSERT_EQ(matchedAt.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_LT(matchedAt.get() - joinedAt, std::chrono::milliseconds(500));
+    EXPECT_EQ(matchMaker->getQueueSize(), 0);
+}
+
+TEST(ShardedMatchMakerTest, MatchesAcrossShardBoundaries) {
+    // 4个分片，评分段边界为1000、2000、3000
+    MatchMaker matchMaker(2, 4);
+    matchMaker.setShardRatingRange(0, 4000);
+    matchMaker.setMatchStrategy(std::make_shared<RatingBasedStrategy>(100));
+    EXPECT_EQ(matchMaker.getWorkerCount(), 4);
+    
+    // 各自分片内可以匹配的玩家
+    matchMaker.addPlayer(std::make_shared<Player>(1, "Player1", 500));
+    matchMaker.addPlayer(std::make_shared<Player>(2, "Player2", 550));
+    // 横跨1000边界的一对
+    matchMaker.addPlayer(std::make_shared<Player>(3, "Player3", 950));
+    matchMaker.addPlayer(std::make_shared<Player>(4, "Player4", 1040));
+    // 横跨3000边界但评分差超限的一对
+    matchMaker.addPlayer(std::make_shared<Player>(5, "Player5", 2940));
+    matchMaker.addPlayer(std::make_shared<Player>(6, "Player6", 3060));
+    EXPECT_EQ(matchMaker.getQueueSize(), 6);
+    
+    auto rooms = matchMaker.matchTick();
+    EXPECT_EQ(rooms.size(), 2);
+    EXPECT_EQ(matchMaker.getQueueSize(), 2);
+    
+    // 出队路由到玩家所在的分片
+    matchMaker.removePlayer(5);
+    matchMaker.removePlayer(6);
+    EXPECT_EQ(matchMaker.getQueueSize(), 0);
+}
+
+TEST(ShardedMatchMakerTest, MatchesAcrossShardsNarrowerThanMaxDiff) {
+    // 16个分片，评分段宽187，比最大评分差窄：1100与1400之间隔着一个分片
+    MatchMaker matchMaker(2, 16);
+    matchMaker.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+    matchMaker.addPlayer(std::make_shared<Player>(1, "Player1", 1100));
+    matchMaker.addPlayer(std::make_shared<Player>(2, "Player2", 1400));
+    
+    auto rooms = matchMaker.matchTick();
+    EXPECT_EQ(rooms.size(), 1);
+    EXPECT_EQ(matchMaker.getQueueSize(), 0);
+    
+    // 工作线程同样能匹配
+    matchMaker.start();
+    matchMaker.addPlayer(std::make_shared<Player>(3, "Player3", 1100));
+    matchMaker.addPlayer(std::make_shared<Player>(4, "Player4", 1400));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(matchMaker.getQueueSize(), 0);
+    EXPECT_EQ(matchMaker.getRooms().size(), 2);
+    matchMaker.stop();
+}
+
+TEST(ShardedMatchMakerTest, ForceMatchesAcrossShardsOnTimeout) {
+    // 两名玩家分别落在首尾分片，各分片人数都不足一个房间，超时后跨分片强制成组
+    for (size_t workers : {2, 4}) {
+        MatchMaker matchMaker(2, workers);
+        matchMaker.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+        matchMaker.setForceMatchOnTimeout(true);
+        matchMaker.setMatchTimeoutThreshold(200);
+        matchMaker.start();
+        
+        uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        auto low = std::make_shared<Player>(1, "Low", 200);
+        auto high = std::make_shared<Player>(2, "High", 2800);
+        low->updateActivity(now);
+        high->updateActivity(now);
+        matchMaker.addPlayer(low);
+        matchMaker.addPlayer(high);
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        EXPECT_EQ(matchMaker.getQueueSize(), 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        EXPECT_EQ(matchMaker.getQueueSize(), 0) << workers << " workers";
+        EXPECT_EQ(matchMaker.getRooms().size(), 1) << workers << " workers";
+        matchMaker.stop();
+    }
+}
+
+TEST(ShardedMatchMakerTest, WorkersMatchConcurrently) {
+    MatchMaker matchMaker(2, 3);
+    matchMaker.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+    matchMaker.start();
+    // 等待各线程完成启动时的一轮匹配，之后的入队按评分从低到高唤醒各分片
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    
+    // 评分间隔50的60名玩家横跨3个分片，边界1000、2000两侧的玩家需要跨分片配对
+    for (Player::PlayerId id = 1; id <= 60; ++id) {
+        matchMaker.addPlayer(std::make_shared<Player>(id, "Player", static_cast<int>(id) * 50));
+    }
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    EXPECT_EQ(matchMaker.getQueueSize(), 0);
+    EXPECT_EQ(matchMaker.getRooms().size(), 30);
+    matchMaker.stop();
+}
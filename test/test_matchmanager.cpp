@@ -14,7 +14,11 @@ protected:
     }
     
     void TearDown() override {
-        MatchManager::getInstance().shutdown();
+        auto& manager = MatchManager::getInstance();
+        manager.shutdown();
+        // 回调可能引用测试用例的局部变量，不能留给后面的用例
+        manager.setMatchNotifyCallback(nullptr);
+        manager.setPlayerStatusCallback(nullptr);
     }
 };
 
@@ -99,6 +103,47 @@ TEST_F(MatchManagerTest, LeaveMatchmaking) {
     EXPECT_EQ(manager.getQueueSize(), 1);
 }
 
+TEST_F(MatchManagerTest, BatchJoinAndLeave) {
+    auto& manager = MatchManager::getInstance();
+    
+    std::vector<Player::PlayerId> notified;
+    manager.setPlayerStatusCallback([&notified](Player::PlayerId playerId, bool) {
+        notified.push_back(playerId);
+    });
+    
+    // 评分差距足够大，不会被匹配
+    auto players = manager.createPlayers({{"A", 100}, {"B", 1500}, {"C", 2900}});
+    ASSERT_EQ(players.size(), 3u);
+    EXPECT_EQ(players[0]->getName(), "A");
+    EXPECT_EQ(players[2]->getRating(), 2900);
+    EXPECT_EQ(players[1]->getId(), players[0]->getId() + 1);
+    EXPECT_EQ(manager.getPlayerCount(), 3u);
+    
+    auto a = players[0]->getId();
+    auto b = players[1]->getId();
+    auto c = players[2]->getId();
+    ASSERT_TRUE(manager.joinMatchmaking(c));
+    notified.clear();
+    
+    auto results = manager.joinMatchmakingBatch({a, b, a, c, 999999});
+    std::vector<MatchmakingResult> expected = {
+        MatchmakingResult::OK, MatchmakingResult::OK, MatchmakingResult::ALREADY_IN_QUEUE,
+        MatchmakingResult::ALREADY_IN_QUEUE, MatchmakingResult::PLAYER_NOT_FOUND};
+    EXPECT_EQ(results, expected);
+    EXPECT_EQ(notified, (std::vector<Player::PlayerId>{a, b}));
+    EXPECT_TRUE(players[0]->isInQueue());
+    EXPECT_EQ(manager.getQueueSize(), 3u);
+    
+    notified.clear();
+    results = manager.leaveMatchmakingBatch({c, a, c, 999999});
+    expected = {MatchmakingResult::OK, MatchmakingResult::OK, MatchmakingResult::NOT_IN_QUEUE,
+                MatchmakingResult::PLAYER_NOT_FOUND};
+    EXPECT_EQ(results, expected);
+    EXPECT_EQ(notified, (std::vector<Player::PlayerId>{c, a}));
+    EXPECT_FALSE(players[2]->isInQueue());
+    EXPECT_EQ(manager.getQueueSize(), 1u);
+}
+
 TEST_F(MatchManagerTest, RoomManagement) {
     auto& manager = MatchManager::getInstance();
     
@@ -192,4 +237,59 @@ TEST_F(MatchManagerTest, PlayerStatusCallback) {
     EXPECT_TRUE(callbackCalled);
     EXPECT_EQ(notifiedPlayerId, player->getId());
     EXPECT_FALSE(notifiedStatus);
-} 
\ No newline at end of file
+} 
+
+TEST_F(MatchManagerTest, ExportAndImportPlayers) {
+    auto& manager = MatchManager::getInstance();
+    auto queued = manager.createPlayer("Queued", 1500);
+    auto idle = manager.createPlayer("Idle", 1600);
+    ASSERT_TRUE(manager.joinMatchmaking(queued->getId()));
+    uint64_t enqueueTime = queued->getLastActivityTime();
+    
+    // 停止匹配后导出，玩家和队列状态保持不变
+    manager.stopMatching();
+    Player::PlayerId nextPlayerId = 0;
+    auto players = manager.exportPlayers(nextPlayerId);
+    ASSERT_EQ(players.size(), 2u);
+    EXPECT_GT(nextPlayerId, std::max(queued->getId(), idle->getId()));
+    
+    // 模拟新进程：全新的匹配管理器导入快照
+    manager.shutdown();
+    manager.init(2);
+    manager.importPlayers(players, nextPlayerId);
+    EXPECT_EQ(manager.getPlayerCount(), 2u);
+    auto restored = manager.getPlayer(queued->getId());
+    ASSERT_NE(restored, nullptr);
+    EXPECT_EQ(restored->getName(), "Queued");
+    EXPECT_TRUE(restored->isInQueue());
+    EXPECT_EQ(restored->getLastActivityTime(), enqueueTime);
+    EXPECT_FALSE(manager.getPlayer(idle->getId())->isInQueue());
+    
+    // 新玩家ID不与导入的玩家冲突，两名玩家在新进程中继续匹配
+    auto next = manager.createPlayer("Next", 1500);
+    EXPECT_GE(next->getId(), nextPlayerId);
+    ASSERT_TRUE(manager.joinMatchmaking(next->getId()));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.getRoomCount() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(manager.getRoomCount(), 1u);
+}
+
+TEST_F(MatchManagerTest, ResumeMatchingAfterStop) {
+    auto& manager = MatchManager::getInstance();
+    auto first = manager.createPlayer("First", 1500);
+    auto second = manager.createPlayer("Second", 1500);
+    ASSERT_TRUE(manager.joinMatchmaking(first->getId()));
+    manager.stopMatching();
+    
+    // 停止期间加入的玩家在恢复后只入队一次
+    ASSERT_TRUE(manager.joinMatchmaking(second->getId()));
+    manager.resumeMatching();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.getRoomCount() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(manager.getRoomCount(), 1u);
+    EXPECT_EQ(manager.getQueueSize(), 0u);
+}
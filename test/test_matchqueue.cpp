@@ -0,0 +1,479 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <thread>
+#include "../src/core/MatchQueue.h"
+
+using namespace gmatch;
+
+// 不限制评分区间的策略，用于验证全量扫描路径
+class AlwaysMatchStrategy : public MatchStrategy {
+public:
+    bool isMatch(const PlayerPtr&, const PlayerPtr&) const override {
+        return true;
+    }
+};
+
+TEST(MatchQueueTest, AddRemovePlayer) {
+    MatchQueue queue;
+    queue.addPlayer(std::make_shared<Player>(1, "Player1", 1500));
+    queue.addPlayer(std::make_shared<Player>(2, "Player2", 1800));
+    queue.addPlayer(std::make_shared<Player>(3, "Player3", 1210));
+    EXPECT_EQ(queue.size(), 3);
+
+    // 重复加入的玩家会被忽略
+    queue.addPlayer(std::make_shared<Player>(2, "Player2", 1800));
+    EXPECT_EQ(queue.size(), 3);
+
+    queue.removePlayer(2);
+    EXPECT_EQ(queue.size(), 2);
+
+    // 移除不存在的玩家不影响队列
+    queue.removePlayer(42);
+    EXPECT_EQ(queue.size(), 2);
+
+    queue.clear();
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(MatchQueueTest, OldestPlayerAnchorsMatch) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+
+    auto p1 = std::make_shared<Player>(1, "Player1", 1500);
+    auto p2 = std::make_shared<Player>(2, "Player2", 2000);
+    auto p3 = std::make_shared<Player>(3, "Player3", 1750);
+    auto p4 = std::make_shared<Player>(4, "Player4", 1400);
+    auto p5 = std::make_shared<Player>(5, "Player5", 1300);
+    for (const auto& p : {p1, p2, p3, p4, p5}) {
+        queue.addPlayer(p);
+    }
+
+    // 锚点为最早入队的p1，窗口内按入队顺序选择p3而不是评分更接近的p4
+    std::vector<PlayerPtr> matched;
+    ASSERT_TRUE(queue.tryMatchPlayers(matched, 2));
+    ASSERT_EQ(matched.size(), 2);
+    EXPECT_EQ(matched[0]->getId(), 1);
+    EXPECT_EQ(matched[1]->getId(), 3);
+    EXPECT_EQ(queue.size(), 3);
+
+    // 剩余玩家中p2最早，但窗口内没有可匹配的玩家
+    EXPECT_FALSE(queue.tryMatchPlayers(matched, 2));
+    EXPECT_TRUE(matched.empty());
+
+    queue.removePlayer(2);
+    ASSERT_TRUE(queue.tryMatchPlayers(matched, 2));
+    EXPECT_EQ(matched[0]->getId(), 4);
+    EXPECT_EQ(matched[1]->getId(), 5);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(MatchQueueTest, AllPickedPlayersMustMatch) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+
+    // p2在锚点窗口内，但与p3评分差超过300，p3应被跳过
+    queue.addPlayer(std::make_shared<Player>(1, "Player1", 1500));
+    queue.addPlayer(std::make_shared<Player>(2, "Player2", 1250));
+    queue.addPlayer(std::make_shared<Player>(3, "Player3", 1790));
+    queue.addPlayer(std::make_shared<Player>(4, "Player4", 1510));
+
+    std::vector<PlayerPtr> matched;
+    ASSERT_TRUE(queue.tryMatchPlayers(matched, 3));
+    EXPECT_EQ(matched[0]->getId(), 1);
+    EXPECT_EQ(matched[1]->getId(), 2);
+    EXPECT_EQ(matched[2]->getId(), 4);
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(MatchQueueTest, NegativeRatingsShareBuckets) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(50));
+
+    queue.addPlayer(std::make_shared<Player>(1, "Player1", -30));
+    queue.addPlayer(std::make_shared<Player>(2, "Player2", 10));
+
+    std::vector<PlayerPtr> matched;
+    EXPECT_TRUE(queue.tryMatchPlayers(matched, 2));
+}
+
+TEST(MatchQueueTest, UnboundedStrategyScansInFifoOrder) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<AlwaysMatchStrategy>());
+
+    queue.addPlayer(std::make_shared<Player>(1, "Player1", 100));
+    queue.addPlayer(std::make_shared<Player>(2, "Player2", 3000));
+    queue.addPlayer(std::make_shared<Player>(3, "Player3", 110));
+
+    std::vector<PlayerPtr> matched;
+    ASSERT_TRUE(queue.tryMatchPlayers(matched, 2));
+    EXPECT_EQ(matched[1]->getId(), 2);
+}
+
+TEST(MatchQueueTest, ForceMatchOnTimeout) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(100));
+
+    auto p1 = std::make_shared<Player>(1, "Player1", 1000);
+    auto p2 = std::make_shared<Player>(2, "Player2", 2000);
+    p1->updateActivity(1);
+    p2->updateActivity(1);
+    queue.addPlayer(p1);
+    queue.addPlayer(p2);
+
+    std::vector<PlayerPtr> matched;
+    EXPECT_FALSE(queue.tryMatchPlayers(matched, 2));
+    ASSERT_TRUE(queue.tryMatchPlayers(matched, 2, true, 1000));
+    EXPECT_EQ(matched[0]->getId(), 1);
+    EXPECT_EQ(matched[1]->getId(), 2);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(MatchQueueTest, ManyRemovalsKeepOrder) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(0));
+
+    // 大量中间移除会触发FIFO序列压缩
+    for (Player::PlayerId id = 1; id <= 1000; ++id) {
+        queue.addPlayer(std::make_shared<Player>(id, "Player", 1000 + static_cast<int>(id % 7)));
+    }
+    for (Player::PlayerId id = 2; id <= 1000; ++id) {
+        if (id % 7 != 1) {
+            queue.removePlayer(id);
+        }
+    }
+
+    std::vector<PlayerPtr> matched;
+    ASSERT_TRUE(queue.tryMatchPlayers(matched, 2));
+    EXPECT_EQ(matched[0]->getId(), 1);
+    EXPECT_EQ(matched[1]->getId(), 8);
+}
+
+TEST(MatchQueueTest, MatchAllDrainsQueue) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(100));
+
+    // 最早的玩家无法匹配时，后面的玩家仍然可以在同一轮中成组
+    queue.addPlayer(std::make_shared<Player>(1, "Player1", 3000));
+    for (Player::PlayerId id = 2; id <= 9; ++id) {
+        queue.addPlayer(std::make_shared<Player>(id, "Player", 1000 + static_cast<int>(id) * 10));
+    }
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 2), 4);
+    ASSERT_EQ(rooms.size(), 4);
+    EXPECT_EQ(rooms[0][0]->getId(), 2);
+    EXPECT_EQ(rooms[0][1]->getId(), 3);
+    EXPECT_EQ(queue.size(), 1);
+
+    // 未超时的玩家不会被强制成组
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    MatchQueue freshQueue;
+    auto fresh1 = std::make_shared<Player>(10, "Player10", 100);
+    auto fresh2 = std::make_shared<Player>(11, "Player11", 5000);
+    fresh1->updateActivity(now);
+    fresh2->updateActivity(now);
+    freshQueue.addPlayer(fresh1);
+    freshQueue.addPlayer(fresh2);
+    rooms.clear();
+    EXPECT_EQ(freshQueue.matchAll(rooms, 2, true, 60000), 0);
+
+    // 超时的剩余玩家按入队顺序强制成组
+    queue.addPlayer(fresh1);
+    EXPECT_EQ(queue.matchAll(rooms, 2, true, 60000), 1);
+    ASSERT_EQ(rooms.size(), 1);
+    EXPECT_EQ(rooms[0][0]->getId(), 1);
+    EXPECT_EQ(rooms[0][1]->getId(), 10);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(MatchQueueTest, MatchAcrossOrdersByEnqueueTime) {
+    MatchQueue lower;
+    MatchQueue upper;
+
+    // 批量入队或交接导入时，队列内的入队顺序可能与活动时间不一致
+    auto late = std::make_shared<Player>(1, "Late", 1000);
+    auto early = std::make_shared<Player>(2, "Early", 1000);
+    auto middle = std::make_shared<Player>(3, "Middle", 1010);
+    late->updateActivity(3000);
+    early->updateActivity(1000);
+    middle->updateActivity(2000);
+    lower.addPlayer(late);
+    lower.addPlayer(early);
+    upper.addPlayer(middle);
+
+    // 等待最久的玩家作为锚点，与其后最早入队的玩家组成房间
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(MatchQueue::matchAcross({&lower, &upper}, 0, 2000, rooms, 2), 1);
+    ASSERT_EQ(rooms.size(), 1);
+    EXPECT_EQ(rooms[0][0]->getId(), 2);
+    EXPECT_EQ(rooms[0][1]->getId(), 3);
+    EXPECT_EQ(lower.size(), 1);
+    EXPECT_EQ(upper.size(), 0);
+}
+
+TEST(MatchQueueTest, ExtremeRatingsDoNotOverflowWindow) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+
+    // 评分窗口在int范围两端截断，不会回绕成空区间
+    queue.addPlayer(std::make_shared<Player>(1, "Max", std::numeric_limits<int>::max() - 10));
+    queue.addPlayer(std::make_shared<Player>(2, "Player2", 1500));
+    queue.addPlayer(std::make_shared<Player>(3, "Player3", 1600));
+    queue.addPlayer(std::make_shared<Player>(4, "Min", std::numeric_limits<int>::min() + 10));
+    queue.addPlayer(std::make_shared<Player>(5, "Max2", std::numeric_limits<int>::max()));
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 2), 2);
+    ASSERT_EQ(rooms.size(), 2);
+    EXPECT_EQ(rooms[0][0]->getId(), 1);
+    EXPECT_EQ(rooms[0][1]->getId(), 5);
+    EXPECT_EQ(rooms[1][0]->getId(), 2);
+    EXPECT_EQ(rooms[1][1]->getId(), 3);
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(MatchQueueTest, EmptyBucketsPrunedAfterPass) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+
+    // 三个评分桶，匹配后前两个桶变空
+    queue.addPlayer(std::make_shared<Player>(1, "Player1", 1000));
+    queue.addPlayer(std::make_shared<Player>(2, "Player2", 1150));
+    queue.addPlayer(std::make_shared<Player>(3, "Player3", 3000));
+    EXPECT_EQ(queue.size(), 3);
+    EXPECT_EQ(queue.bucketCount(), 3);
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 2), 1);
+    EXPECT_EQ(queue.bucketCount(), 1);
+
+    // 跨队列匹配后各队列的空桶同样被清理
+    MatchQueue other;
+    queue.addPlayer(std::make_shared<Player>(4, "Player4", 3050));
+    other.addPlayer(std::make_shared<Player>(5, "Player5", 3210));
+    other.addPlayer(std::make_shared<Player>(6, "Player6", 5000));
+    EXPECT_EQ(other.size(), 2);
+    rooms.clear();
+    EXPECT_EQ(MatchQueue::matchAcross({&queue, &other}, 3000, 3300, rooms, 3), 1);
+    EXPECT_EQ(queue.bucketCount(), 0);
+    EXPECT_EQ(other.bucketCount(), 1);
+}
+
+TEST(MatchQueueTest, SortedWindowAvoidsStranding) {
+    auto makeQueue = [](MatchAlgorithm algorithm) {
+        auto queue = std::make_unique<MatchQueue>();
+        queue->setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+        queue->setMatchAlgorithm(algorithm);
+        queue->addPlayer(std::make_shared<Player>(1, "Player1", 1000));
+        queue->addPlayer(std::make_shared<Player>(2, "Player2", 1200));
+        queue->addPlayer(std::make_shared<Player>(3, "Player3", 1400));
+        queue->addPlayer(std::make_shared<Player>(4, "Player4", 900));
+        return queue;
+    };
+
+    // 贪心以Player1为锚点取走Player2，剩下的Player3与Player4评分差超限
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(makeQueue(MatchAlgorithm::ANCHOR_GREEDY)->matchAll(rooms, 2), 1);
+
+    rooms.clear();
+    auto queue = makeQueue(MatchAlgorithm::SORTED_WINDOW);
+    EXPECT_EQ(queue->matchAll(rooms, 2), 2);
+    ASSERT_EQ(rooms.size(), 2);
+    EXPECT_EQ(rooms[0][0]->getId(), 4);
+    EXPECT_EQ(rooms[0][1]->getId(), 1);
+    EXPECT_EQ(rooms[1][0]->getId(), 2);
+    EXPECT_EQ(rooms[1][1]->getId(), 3);
+    EXPECT_EQ(queue->size(), 0);
+}
+
+TEST(MatchQueueTest, SortedWindowMinimizesSpread) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(300));
+    queue.setMatchAlgorithm(MatchAlgorithm::SORTED_WINDOW);
+
+    // 7人组3人房最多2间，选择评分跨度总和最小的划分，1500被留下
+    for (int rating : {1000, 1010, 1020, 1200, 1210, 1220, 1500}) {
+        queue.addPlayer(std::make_shared<Player>(static_cast<Player::PlayerId>(rating), "Player", rating));
+    }
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 3), 2);
+    ASSERT_EQ(rooms.size(), 2);
+    EXPECT_EQ(rooms[0].front()->getRating(), 1000);
+    EXPECT_EQ(rooms[0].back()->getRating(), 1020);
+    EXPECT_EQ(rooms[1].front()->getRating(), 1200);
+    EXPECT_EQ(rooms[1].back()->getRating(), 1220);
+    EXPECT_EQ(queue.size(), 1);
+
+    // 不按评分区间判断的策略同样适用
+    MatchQueue unbounded;
+    unbounded.setMatchStrategy(std::make_shared<AlwaysMatchStrategy>());
+    unbounded.setMatchAlgorithm(MatchAlgorithm::SORTED_WINDOW);
+    for (Player::PlayerId id = 1; id <= 5; ++id) {
+        unbounded.addPlayer(std::make_shared<Player>(id, "Player", static_cast<int>(id) * 1000));
+    }
+    rooms.clear();
+    EXPECT_EQ(unbounded.matchAll(rooms, 2), 2);
+}
+
+TEST(MatchQueueTest, IngressPreservesSubmitOrder) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<RatingBasedStrategy>(100));
+    auto player1 = std::make_shared<Player>(1, "Player1", 1000);
+    auto player2 = std::make_shared<Player>(2, "Player2", 1050);
+
+    // 离开后重新加入，按提交顺序应用后玩家仍在队列中，且入队顺序排在玩家2之后
+    queue.addPlayer(player1);
+    queue.addPlayer(player2);
+    queue.removePlayer(1);
+    queue.addPlayer(player1);
+    EXPECT_EQ(queue.size(), 2);
+
+    // 加入后立即离开，不会留在队列中
+    queue.addPlayer(std::make_shared<Player>(3, "Player3", 1020));
+    queue.removePlayer(3);
+
+    std::vector<PlayerPtr> matched;
+    ASSERT_TRUE(queue.tryMatchPlayers(matched, 2));
+    EXPECT_EQ(matched[0]->getId(), 2);
+    EXPECT_EQ(matched[1]->getId(), 1);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(MatchQueueTest, IngressFullFallsBackToLock) {
+    // 容量为2的缓冲区写满后直接加锁修改，顺序不变
+    MatchQueue queue(2);
+    for (Player::PlayerId id = 1; id <= 10; ++id) {
+        queue.addPlayer(std::make_shared<Player>(id, "Player", 1000));
+    }
+    for (Player::PlayerId id = 1; id <= 10; id += 2) {
+        queue.removePlayer(id);
+    }
+    EXPECT_EQ(queue.size(), 5);
+
+    uint64_t version = queue.getVersion();
+    queue.addPlayer(std::make_shared<Player>(11, "Player11", 1000));
+    EXPECT_NE(queue.getVersion(), version);
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 2), 3);
+    EXPECT_EQ(rooms[0][0]->getId(), 2);
+    EXPECT_EQ(rooms[0][1]->getId(), 4);
+}
+
+TEST(MatchQueueTest, BatchSubmitKeepsOrderAndPublishesOnce) {
+    // 容量为4的缓冲区放不下整批，剩余部分加锁直接应用
+    MatchQueue queue(4);
+    std::vector<PlayerPtr> players;
+    for (Player::PlayerId id = 1; id <= 10; ++id) {
+        players.push_back(std::make_shared<Player>(id, "Player", 1000));
+    }
+    uint64_t version = queue.getVersion();
+    queue.addPlayers(players);
+    EXPECT_EQ(queue.getVersion(), version + 1);
+    EXPECT_EQ(queue.size(), 10);
+
+    queue.removePlayers({1, 3, 5, 7, 9, 42});
+    EXPECT_EQ(queue.getVersion(), version + 2);
+    EXPECT_EQ(queue.size(), 5);
+
+    // 空批次不发布变化
+    queue.addPlayers({});
+    queue.removePlayers({});
+    EXPECT_EQ(queue.getVersion(), version + 2);
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 2), 2);
+    EXPECT_EQ(rooms[0][0]->getId(), 2);
+    EXPECT_EQ(rooms[0][1]->getId(), 4);
+}
+
+TEST(MatchQueueTest, ConcurrentProducersDuringMatching) {
+    MatchQueue queue(64);
+    queue.setMatchStrategy(std::make_shared<AlwaysMatchStrategy>());
+
+    const int producers = 4;
+    const int perProducer = 2000;
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < producers; ++t) {
+        threads.emplace_back([&queue, &finished, t, perProducer] {
+            // 每个玩家先提交一次离开再加入，加入不会被之前的离开抵消
+            for (int i = 0; i < perProducer; ++i) {
+                auto player = std::make_shared<Player>(static_cast<Player::PlayerId>(t * perProducer + i + 1),
+                                                       "Player", 1000 + i);
+                queue.removePlayer(player->getId());
+                queue.addPlayer(player);
+            }
+            ++finished;
+        });
+    }
+
+    size_t matchedPlayers = 0;
+    std::vector<std::vector<PlayerPtr>> rooms;
+    while (finished < producers) {
+        rooms.clear();
+        queue.matchAll(rooms, 2);
+        matchedPlayers += rooms.size() * 2;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    rooms.clear();
+    queue.matchAll(rooms, 2);
+    matchedPlayers += rooms.size() * 2;
+
+    EXPECT_EQ(matchedPlayers + queue.size(), static_cast<size_t>(producers * perProducer));
+    EXPECT_LE(queue.size(), 1u);
+}
+
+TEST(MatchQueueTest, WaitForChangeWakesOnAddPlayer) {
+    MatchQueue queue;
+    uint64_t version = queue.getVersion();
+
+    std::thread producer([&queue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.addPlayer(std::make_shared<Player>(1, "Player1", 1500));
+    });
+
+    // 入队线程发布变化后立即返回，不等到deadline
+    auto start = std::chrono::steady_clock::now();
+    uint64_t current = queue.waitForChange(version, start + std::chrono::seconds(10));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    producer.join();
+
+    EXPECT_NE(current, version);
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(MatchQueueTest, WaitForChangeReturnsAtDeadline) {
+    MatchQueue queue;
+    uint64_t version = queue.getVersion();
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t current = queue.waitForChange(version, start + std::chrono::milliseconds(50));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(current, version);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+}
+
+TEST(MatchQueueTest, InterruptWakesUntimedWaiter) {
+    MatchQueue queue;
+    uint64_t version = queue.getVersion();
+
+    auto waiter = std::async(std::launch::async, [&queue, version] {
+        return queue.waitForChange(version);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.interrupt();
+
+    ASSERT_EQ(waiter.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_NE(waiter.get(), version);
+}
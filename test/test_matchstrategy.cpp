@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include "../src/core/MatchStrategy.h"
+#include "../src/core/MatchQueue.h"
+#include "../src/util/TimeUtil.h"
+
+using namespace gmatch;
+
+namespace {
+
+PlayerPtr makePlayer(Player::PlayerId id, int rating, uint64_t waitedMs) {
+    auto player = std::make_shared<Player>(id, "Player", rating);
+    player->updateActivity(TimeUtil::currentTimeMillis() - waitedMs);
+    return player;
+}
+
+// 只实现isMatch的策略，用于验证默认的批量适配
+class EvenSumStrategy : public MatchStrategy {
+public:
+    bool isMatch(const PlayerPtr& player1, const PlayerPtr& player2) const override {
+        return (player1->getRating() + player2->getRating()) % 2 == 0;
+    }
+};
+
+// 用matchBatch逐位展开的结果与逐对isMatch比较
+void expectBatchMatchesPairwise(const MatchStrategy& strategy, const PlayerPtr& anchor,
+                                const std::vector<PlayerPtr>& players) {
+    std::vector<int> ratings;
+    std::vector<uint64_t> enqueueTimes;
+    for (const auto& player : players) {
+        ratings.push_back(player->getRating());
+        enqueueTimes.push_back(player->getLastActivityTime());
+    }
+    MatchCandidates batch;
+    batch.ratings = ratings.data();
+    batch.enqueueTimes = enqueueTimes.data();
+    batch.players = players.data();
+    batch.count = players.size();
+
+    // 预先写入脏数据，确认实现会清零
+    std::vector<uint64_t> mask(MatchStrategy::maskWords(players.size()), ~uint64_t(0));
+    strategy.matchBatch(anchor, anchor->getRating(), anchor->getLastActivityTime(), batch, mask.data());
+    for (size_t i = 0; i < players.size(); ++i) {
+        bool bit = (mask[i / 64] >> (i % 64)) & 1;
+        EXPECT_EQ(bit, strategy.isMatch(anchor, players[i])) << "candidate " << i;
+    }
+}
+
+} // namespace
+
+TEST(MatchStrategyTest, RatingBasedWindow) {
+    RatingBasedStrategy strategy(300);
+    auto p1 = makePlayer(1, 1500, 0);
+    auto p2 = makePlayer(2, 1800, 0);
+    auto p3 = makePlayer(3, 1801, 0);
+
+    EXPECT_TRUE(strategy.isMatch(p1, p2));
+    EXPECT_FALSE(strategy.isMatch(p1, p3));
+
+    int minRating = 0, maxRating = 0;
+    ASSERT_TRUE(strategy.getRatingWindow(p1, p1->getRating(), minRating, maxRating));
+    EXPECT_EQ(minRating, 1200);
+    EXPECT_EQ(maxRating, 1800);
+    
+    // 窗口以队列记录的入队评分为中心，不读取玩家当前的评分
+    p1->setRating(2000);
+    ASSERT_TRUE(strategy.getRatingWindow(p1, 1500, minRating, maxRating));
+    EXPECT_EQ(minRating, 1200);
+    EXPECT_EQ(maxRating, 1800);
+    EXPECT_EQ(strategy.getMaxRatingDiff(), 300);
+}
+
+TEST(MatchStrategyTest, WaitTimeExpandsAllowedDiff) {
+    WaitTimeExpandingStrategy strategy(100, 50, 400);
+    uint64_t now = TimeUtil::currentTimeMillis();
+
+    EXPECT_EQ(strategy.getAllowedRatingDiff(makePlayer(1, 1500, 0), now), 100);
+    EXPECT_EQ(strategy.getAllowedRatingDiff(makePlayer(2, 1500, 4000), now), 300);
+    // 不超过上限
+    EXPECT_EQ(strategy.getAllowedRatingDiff(makePlayer(3, 1500, 60000), now), 400);
+    EXPECT_EQ(strategy.getMaxRatingDiff(), 400);
+}
+
+TEST(MatchStrategyTest, LongerWaitingPlayerDecides) {
+    WaitTimeExpandingStrategy strategy(100, 50, 1000);
+    auto fresh = makePlayer(1, 1500, 0);
+    auto waited = makePlayer(2, 1750, 4000);
+    auto freshFar = makePlayer(3, 1750, 0);
+
+    EXPECT_TRUE(strategy.isMatch(fresh, waited));
+    EXPECT_TRUE(strategy.isMatch(waited, fresh));
+    EXPECT_FALSE(strategy.isMatch(fresh, freshFar));
+}
+
+TEST(MatchStrategyTest, ExpandingWindowInQueue) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<WaitTimeExpandingStrategy>(100, 50, 1000));
+
+    // 最早入队的玩家已等待10秒，容忍度扩大到600
+    queue.addPlayer(makePlayer(1, 1500, 10000));
+    queue.addPlayer(makePlayer(2, 2050, 0));
+    queue.addPlayer(makePlayer(3, 2150, 0));
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 2), 1);
+    ASSERT_EQ(rooms.size(), 1);
+    EXPECT_EQ(rooms[0][0]->getId(), 1);
+    EXPECT_EQ(rooms[0][1]->getId(), 2);
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(MatchStrategyTest, ExpandingWindowCoversOlderCandidates) {
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<WaitTimeExpandingStrategy>(100, 50, 1000));
+
+    // 等待10秒的玩家1先作为锚点时贪心选中玩家2，之后找不到第三名与两人都能匹配的玩家；
+    // 轮到容忍度只有100的玩家3时，玩家1凭自己的容忍度仍是它的候选
+    queue.addPlayer(makePlayer(1, 1000, 10000));
+    queue.addPlayer(makePlayer(2, 400, 0));
+    queue.addPlayer(makePlayer(3, 1500, 0));
+    queue.addPlayer(makePlayer(4, 1450, 0));
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 3), 1);
+    ASSERT_EQ(rooms.size(), 1);
+    EXPECT_EQ(rooms[0][0]->getId(), 3);
+    EXPECT_EQ(rooms[0][1]->getId(), 1);
+    EXPECT_EQ(rooms[0][2]->getId(), 4);
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(MatchStrategyTest, ExpandingWindowClampsExtremeRatings) {
+    WaitTimeExpandingStrategy strategy(100, 50, 1000);
+    int minRating = 0;
+    int maxRating = 0;
+
+    ASSERT_TRUE(strategy.getRatingWindow(nullptr, std::numeric_limits<int>::max() - 10, minRating, maxRating));
+    EXPECT_EQ(minRating, std::numeric_limits<int>::max() - 1010);
+    EXPECT_EQ(maxRating, std::numeric_limits<int>::max());
+    ASSERT_TRUE(strategy.getRatingWindow(nullptr, std::numeric_limits<int>::min() + 10, minRating, maxRating));
+    EXPECT_EQ(minRating, std::numeric_limits<int>::min());
+    EXPECT_EQ(maxRating, std::numeric_limits<int>::min() + 1010);
+
+    MatchQueue queue;
+    queue.setMatchStrategy(std::make_shared<WaitTimeExpandingStrategy>(100, 50, 1000));
+    queue.addPlayer(makePlayer(1, std::numeric_limits<int>::max() - 10, 0));
+    queue.addPlayer(makePlayer(2, 1500, 0));
+    queue.addPlayer(makePlayer(3, 1550, 0));
+
+    std::vector<std::vector<PlayerPtr>> rooms;
+    EXPECT_EQ(queue.matchAll(rooms, 2), 1);
+    ASSERT_EQ(rooms.size(), 1);
+    EXPECT_EQ(rooms[0][0]->getId(), 2);
+    EXPECT_EQ(rooms[0][1]->getId(), 3);
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(MatchStrategyTest, ExpandingBatchUsesQueuedEnqueueTime) {
+    WaitTimeExpandingStrategy strategy(100, 50, 1000);
+    uint64_t now = TimeUtil::currentTimeMillis();
+    auto anchor = makePlayer(0, 1500, 0);
+    int ratings[] = {2000};
+    uint64_t enqueueTimes[] = {now};
+    MatchCandidates batch;
+    batch.ratings = ratings;
+    batch.enqueueTimes = enqueueTimes;
+    batch.count = 1;
+
+    // 玩家在队列中的活动时间被刷新后，锚点容忍度仍按入队时记录的时间计算
+    uint64_t mask = 0;
+    strategy.matchBatch(anchor, 1500, now - 10000, batch, &mask);
+    EXPECT_EQ(mask, 1u);
+    strategy.matchBatch(anchor, 1500, now, batch, &mask);
+    EXPECT_EQ(mask, 0u);
+}
+
+TEST(MatchStrategyTest, RatingBatchMatchesPairwise) {
+    RatingBasedStrategy strategy(300);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> rating(900, 2100);
+    auto anchor = makePlayer(0, 1500, 0);
+
+    // 覆盖空批次、不足一个向量宽度、跨越多个mask字以及正好落在边界上的评分
+    for (size_t count : {0, 1, 3, 7, 8, 63, 64, 65, 130}) {
+        std::vector<PlayerPtr> players;
+        for (size_t i = 0; i < count; ++i) {
+            int r = i % 5 == 0 ? (i % 2 ? 1800 : 1200) : rating(rng);
+            players.push_back(makePlayer(static_cast<Player::PlayerId>(i + 1), r, 0));
+        }
+        expectBatchMatchesPairwise(strategy, anchor, players);
+    }
+}
+
+TEST(MatchStrategyTest, DefaultBatchUsesIsMatch) {
+    EvenSumStrategy strategy;
+    auto anchor = makePlayer(0, 1000, 0);
+    std::vector<PlayerPtr> players;
+    for (int i = 0; i < 70; ++i) {
+        players.push_back(makePlayer(i + 1, 1000 + i, 0));
+    }
+    expectBatchMatchesPairwise(strategy, anchor, players);
+}
+
+TEST(MatchStrategyTest, ExpandingBatchMatchesPairwise) {
+    WaitTimeExpandingStrategy strategy(100, 50, 1000);
+    auto anchor = makePlayer(0, 1500, 2000);
+    std::vector<PlayerPtr> players;
+    for (int i = 0; i < 20; ++i) {
+        players.push_back(makePlayer(i + 1, 1200 + i * 30, static_cast<uint64_t>(i) * 1000));
+    }
+    expectBatchMatchesPairwise(strategy, anchor, players);
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/server/RequestExecutor.h"
+
+using namespace gmatch;
+
+namespace {
+
+// 测试用的一次性门闩
+class Gate {
+public:
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        condition_.notify_all();
+    }
+
+    bool wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return condition_.wait_for(lock, std::chrono::seconds(5), [this] { return open_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool open_ = false;
+};
+
+template <typename Predicate>
+bool waitFor(Predicate predicate) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(RequestExecutorTest, PreservesOrderPerKey) {
+    RequestExecutor executor(4);
+    executor.start();
+
+    const int keyCount = 8;
+    const int tasksPerKey = 1000;
+    std::vector<std::vector<int>> results(keyCount);
+    std::vector<std::thread> producers;
+    for (int key = 0; key < keyCount; ++key) {
+        producers.emplace_back([&, key] {
+            for (int i = 0; i < tasksPerKey; ++i) {
+                // 同一key的任务串行执行，不需要额外加锁
+                ASSERT_TRUE(executor.submit(key, [&results, key, i] { results[key].push_back(i); }));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_TRUE(waitFor([&] { return executor.getStats().completed == keyCount * tasksPerKey; }));
+    executor.stop();
+
+    for (int key = 0; key < keyCount; ++key) {
+        ASSERT_EQ(results[key].size(), static_cast<size_t>(tasksPerKey));
+        for (int i = 0; i < tasksPerKey; ++i) {
+            EXPECT_EQ(results[key][i], i);
+        }
+    }
+}
+
+TEST(RequestExecutorTest, SlowKeyDoesNotBlockOthers) {
+    RequestExecutor executor(2);
+    executor.start();
+
+    Gate release;
+    std::atomic<bool> otherDone{false};
+    std::atomic<bool> slowFollowUpDone{false};
+    executor.submit(1, [&release] { release.wait(); });
+    executor.submit(1, [&slowFollowUpDone] { slowFollowUpDone = true; });
+    executor.submit(2, [&otherDone] { otherDone = true; });
+
+    EXPECT_TRUE(waitFor([&] { return otherDone.load(); }));
+    // 慢请求后面同一连接的请求要等它完成
+    EXPECT_FALSE(slowFollowUpDone);
+    release.open();
+    EXPECT_TRUE(waitFor([&] { return slowFollowUpDone.load(); }));
+    executor.stop();
+}
+
+TEST(RequestExecutorTest, DetachedTaskDoesNotBlockLaterTasks) {
+    RequestExecutor executor(2);
+    executor.start();
+
+    Gate release;
+    std::atomic<bool> detached{false};
+    std::atomic<bool> followUpDone{false};
+    std::atomic<bool> slowDone{false};
+    executor.submit(1, [&] {
+        detached = executor.detachCurrentTask();
+        release.wait();
+        slowDone = true;
+    });
+    executor.submit(1, [&followUpDone] { followUpDone = true; });
+
+    // 分离后同一key的后续任务由另一个工作线程执行，先于慢任务完成
+    EXPECT_TRUE(waitFor([&] { return followUpDone.load(); }));
+    EXPECT_TRUE(detached);
+    EXPECT_FALSE(slowDone);
+    release.open();
+    EXPECT_TRUE(waitFor([&] { return slowDone.load(); }));
+    // 不在任务中调用时无效
+    EXPECT_FALSE(executor.detachCurrentTask());
+    executor.stop();
+}
+
+TEST(RequestExecutorTest, BarrierWaitsForDetachedTasks) {
+    RequestExecutor executor(2);
+    executor.start();
+
+    Gate release;
+    std::atomic<bool> slowDone{false};
+    std::atomic<bool> barrierSawSlowDone{false};
+    std::atomic<bool> barrierDone{false};
+    std::atomic<bool> afterBarrierDone{false};
+    executor.submit(1, [&] {
+        executor.detachCurrentTask();
+        release.wait();
+        slowDone = true;
+    });
+    EXPECT_TRUE(executor.submitBarrier(1, [&] {
+        barrierSawSlowDone = slowDone.load();
+        barrierDone = true;
+    }));
+    executor.submit(1, [&afterBarrierDone] { afterBarrierDone = true; });
+
+    // 屏障任务及其后的任务都要等已分离的任务完成
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(barrierDone);
+    EXPECT_FALSE(afterBarrierDone);
+    release.open();
+    EXPECT_TRUE(waitFor([&] { return afterBarrierDone.load(); }));
+    EXPECT_TRUE(barrierSawSlowDone);
+    executor.stop();
+}
+
+TEST(RequestExecutorTest, IdleWorkerStealsReadyKeys) {
+    RequestExecutor executor(2);
+    executor.start();
+
+    // 偶数key默认排在同一个工作线程上，该线程被阻塞时其余key只能由另一个线程窃取执行
+    Gate release;
+    std::atomic<int> done{0};
+    executor.submit(0, [&release] { release.wait(); });
+    for (RequestExecutor::Key key = 2; key <= 20; key += 2) {
+        executor.submit(key, [&done] { ++done; });
+    }
+
+    EXPECT_TRUE(waitFor([&] { return done == 10; }));
+    EXPECT_GT(executor.getStats().stolen, 0u);
+    release.open();
+    executor.stop();
+}
+
+TEST(RequestExecutorTest, RejectsWhenFull) {
+    RequestExecutor executor(1, 2);
+    executor.start();
+
+    Gate release;
+    std::atomic<int> done{0};
+    EXPECT_TRUE(executor.submit(1, [&release, &done] { release.wait(); ++done; }));
+    EXPECT_TRUE(executor.submit(2, [&done] { ++done; }));
+    EXPECT_FALSE(executor.submit(3, [&done] { ++done; }));
+    // 清理任务不受上限限制
+    EXPECT_TRUE(executor.submit(3, [&done] { ++done; }, true));
+
+    auto stats = executor.getStats();
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.queueDepth, 3u);
+    EXPECT_EQ(stats.peakQueueDepth, 3u);
+
+    release.open();
+    EXPECT_TRUE(waitFor([&] { return done == 3; }));
+    executor.stop();
+    EXPECT_FALSE(executor.submit(1, [] {}));
+}
+
+TEST(RequestExecutorTest, RecordsHandlerLatency) {
+    RequestExecutor executor(2);
+    executor.start();
+
+    for (int i = 0; i < 20; ++i) {
+        executor.submit(i, [] { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+    }
+    EXPECT_TRUE(waitFor([&] { return executor.getStats().completed == 20; }));
+
+    auto stats = executor.getStats();
+    EXPECT_EQ(stats.submitted, 20u);
+    EXPECT_EQ(stats.queueDepth, 0u);
+    EXPECT_GE(stats.avgHandlerUs, 2000.0);
+    EXPECT_GE(stats.maxHandlerUs, 2000u);
+    EXPECT_GE(stats.p50HandlerUs, 2000u);
+    EXPECT_GE(stats.p99HandlerUs, stats.p50HandlerUs);
+    executor.stop();
+}
@@ -0,0 +1,316 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include "../src/server/RequestHandler.h"
+#include "../src/server/BinaryRequestHandler.h"
+
+using namespace gmatch;
+
+class RequestHandlerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto& manager = MatchManager::getInstance();
+        manager.shutdown();
+        manager.init(2);
+    }
+
+    void TearDown() override {
+        MatchManager::getInstance().shutdown();
+    }
+
+    JsonRequestHandler handler;
+    BinaryRequestHandler binaryHandler;
+};
+
+namespace {
+
+std::string binaryRequest(BinaryOpcode opcode, uint32_t requestId, const std::string& body = "") {
+    std::string message;
+    BinaryWriter(message).header(opcode, BinaryStatus::OK, requestId);
+    return message + body;
+}
+
+std::string playerIdBody(Player::PlayerId playerId) {
+    std::string body;
+    BinaryWriter(body).u64(playerId);
+    return body;
+}
+
+} // namespace
+
+TEST_F(RequestHandlerTest, CommandHandlerReceivesDataView) {
+    std::string request = "{\"cmd\": \"echo\", \"data\": {\"value\": 42}}";
+    std::string_view received;
+    int value = 0;
+    handler.registerCommandHandler("echo", [&](const JsonRequest& parsed, TcpConnection::ConnectionId) {
+        received = parsed.data;
+        const JsonValue* field = parsed.fields.find("value");
+        EXPECT_TRUE(field && field->getInteger(value));
+        return std::string("ok");
+    });
+
+    EXPECT_EQ(handler.handleRequest(request, 1), "ok");
+    EXPECT_EQ(received, "{\"value\": 42}");
+    EXPECT_EQ(value, 42);
+    // data指向请求本身而不是副本
+    EXPECT_GE(received.data(), request.data());
+    EXPECT_LE(received.data() + received.size(), request.data() + request.size());
+}
+
+TEST_F(RequestHandlerTest, RejectsInvalidAndUnknownRequests) {
+    EXPECT_EQ(handler.handleRequest("not json", 1),
+              "{\"cmd\":\"error\",\"success\":false,\"message\":\"Invalid JSON format\"}");
+    EXPECT_EQ(handler.handleRequest("{\"cmd\":\"nope\",\"data\":{}}", 1),
+              "{\"cmd\":\"nope\",\"success\":false,\"message\":\"Unknown command\"}");
+    // cmd必须是字符串，data必须是对象，对象之后不能有多余内容
+    const char* invalid[] = {
+        "{\"cmd\":1,\"data\":{}}",
+        "{\"data\":{}}",
+        "{\"cmd\":\"get_rooms\",\"data\":[]}",
+        "{\"cmd\":\"get_rooms\",\"data\":{}}}",
+        "{\"cmd\":\"get_rooms\",\"data\":{\"a\":}}",
+    };
+    for (const char* request : invalid) {
+        EXPECT_NE(handler.handleRequest(request, 1).find("Invalid JSON format"), std::string::npos) << request;
+    }
+}
+
+TEST_F(RequestHandlerTest, CreatePlayerDecodesEscapedName) {
+    Player::PlayerId created = 0;
+    handler.setPlayerCreatedCallback([&created](TcpConnection::ConnectionId, Player::PlayerId playerId) {
+        created = playerId;
+    });
+
+    // 名称中的逗号、右括号和转义字符不再截断后面的字段
+    std::string response = handler.handleRequest(
+        "{\"cmd\":\"create_player\",\"data\":{\"name\":\"A, \\\"B\\\"} \\u00e9\",\"rating\":1600}}", 7);
+    ASSERT_NE(created, 0u);
+    auto player = MatchManager::getInstance().getPlayer(created);
+    ASSERT_NE(player, nullptr);
+    EXPECT_EQ(player->getName(), "A, \"B\"} \xc3\xa9");
+    EXPECT_EQ(player->getRating(), 1600);
+    // 响应中的名称重新转义
+    EXPECT_NE(response.find("\"name\":\"A, \\\"B\\\"} \xc3\xa9\""), std::string::npos);
+
+    // 非整数评分使用默认值
+    created = 0;
+    handler.handleRequest("{\"cmd\":\"create_player\",\"data\":{\"name\":\"C\",\"rating\":1600.5}}", 7);
+    player = MatchManager::getInstance().getPlayer(created);
+    ASSERT_NE(player, nullptr);
+    EXPECT_EQ(player->getRating(), 1500);
+}
+
+TEST_F(RequestHandlerTest, CreatePlayerParsesNameAndRating) {
+    Player::PlayerId created = 0;
+    handler.setPlayerCreatedCallback([&created](TcpConnection::ConnectionId, Player::PlayerId playerId) {
+        created = playerId;
+    });
+
+    std::string response = handler.handleRequest("{\"cmd\":\"create_player\",\"data\":{\"name\": \"Alice\", \"rating\": 1720}}", 7);
+    ASSERT_NE(created, 0u);
+    auto player = MatchManager::getInstance().getPlayer(created);
+    ASSERT_NE(player, nullptr);
+    EXPECT_EQ(player->getName(), "Alice");
+    EXPECT_EQ(player->getRating(), 1720);
+    EXPECT_NE(response.find("\"success\":true"), std::string::npos);
+}
+
+TEST_F(RequestHandlerTest, PlayerIdValidation) {
+    EXPECT_NE(handler.handleRequest("{\"cmd\":\"join_matchmaking\",\"data\":{}}", 1).find("Player ID is required"),
+              std::string::npos);
+    EXPECT_NE(handler.handleRequest("{\"cmd\":\"join_matchmaking\",\"data\":{\"player_id\":\"x\"}}", 1).find("Invalid player ID"),
+              std::string::npos);
+
+    auto player = MatchManager::getInstance().createPlayer("Bob", 1500);
+    std::string request = "{\"cmd\":\"get_player_info\",\"data\":{\"player_id\": " + std::to_string(player->getId()) + "}}";
+    std::string response = handler.handleRequest(request, 1);
+    EXPECT_NE(response.find("\"name\":\"Bob\""), std::string::npos);
+}
+
+TEST_F(RequestHandlerTest, ResponsesAppendToReusedBuffer) {
+    auto player = MatchManager::getInstance().createPlayer("Carol \"C\"", 1610);
+    std::string request = "{\"cmd\":\"get_player_info\",\"data\":{\"player_id\":" + std::to_string(player->getId()) + "}}";
+    std::string expected = "{\"cmd\":\"get_player_info\",\"success\":true,\"message\":\"Player info retrieved successfully\","
+                           "\"data\":{\"player_id\":" + std::to_string(player->getId()) +
+                           ",\"name\":\"Carol \\\"C\\\"\",\"rating\":1610,\"in_queue\":false}}";
+
+    // 服务器的工作线程每次清空后复用同一个缓冲区，容量足够后不再重新分配
+    std::string buffer;
+    handler.handleRequest(request, 1, buffer);
+    EXPECT_EQ(buffer, expected);
+    const char* data = buffer.data();
+    for (int i = 0; i < 10; ++i) {
+        buffer.clear();
+        handler.handleRequest(request, 1, buffer);
+        EXPECT_EQ(buffer, expected);
+        EXPECT_EQ(buffer.data(), data);
+    }
+
+    // 不带data的响应和带data的响应格式
+    buffer.clear();
+    handler.handleRequest("{\"cmd\":\"get_queue_status\"}", 1, buffer);
+    EXPECT_EQ(buffer, "{\"cmd\":\"get_queue_status\",\"success\":true,"
+                      "\"message\":\"Queue status retrieved successfully\",\"data\":{\"queue_size\":0}}");
+    buffer.clear();
+    handler.handleRequest("{\"cmd\":\"get_rooms\"}", 1, buffer);
+    EXPECT_EQ(buffer, "{\"cmd\":\"get_rooms\",\"success\":true,\"message\":\"Rooms retrieved successfully\",\"data\":[]}");
+    // 自定义命令处理器的响应同样追加到缓冲区
+    handler.registerCommandHandler("ping", [](const JsonRequest&, TcpConnection::ConnectionId) {
+        return std::string("pong");
+    });
+    buffer = "x";
+    handler.handleRequest("{\"cmd\":\"ping\"}", 1, buffer);
+    EXPECT_EQ(buffer, "xpong");
+}
+
+TEST_F(RequestHandlerTest, EchoesRequestId) {
+    int idRequests = 0;
+    handler.setRequestIdCallback([&idRequests] { ++idRequests; });
+
+    // 数字和字符串id都原样带回，作为响应的第一个字段
+    EXPECT_EQ(handler.handleRequest("{\"id\":42,\"cmd\":\"get_rooms\"}", 1),
+              "{\"id\":42,\"cmd\":\"get_rooms\",\"success\":true,\"message\":\"Rooms retrieved successfully\",\"data\":[]}");
+    EXPECT_EQ(handler.handleRequest("{\"cmd\":\"join_matchmaking\",\"data\":{},\"id\":\"a\\\"b\"}", 1),
+              "{\"id\":\"a\\\"b\",\"cmd\":\"join_matchmaking\",\"success\":false,\"message\":\"Player ID is required\"}");
+    EXPECT_EQ(handler.handleRequest("{\"id\":7,\"cmd\":\"unknown\"}", 1),
+              "{\"id\":7,\"cmd\":\"unknown\",\"success\":false,\"message\":\"Unknown command\"}");
+    EXPECT_EQ(idRequests, 3);
+
+    // 缺少命令时的错误响应也带回id；不带id的请求不触发回调
+    EXPECT_EQ(handler.handleRequest("{\"id\":8,\"data\":{}}", 1),
+              "{\"id\":8,\"cmd\":\"error\",\"success\":false,\"message\":\"Invalid JSON format\"}");
+    handler.handleRequest("{\"cmd\":\"get_rooms\"}", 1);
+    EXPECT_EQ(idRequests, 3);
+
+    // id只能是数字或字符串
+    EXPECT_EQ(handler.handleRequest("{\"id\":{\"x\":1},\"cmd\":\"get_rooms\"}", 1),
+              "{\"cmd\":\"get_rooms\",\"success\":false,\"message\":\"Invalid request id\"}");
+    EXPECT_EQ(idRequests, 3);
+
+    // 自定义命令的响应中插入id
+    handler.registerCommandHandler("ping", [](const JsonRequest&, TcpConnection::ConnectionId) {
+        return std::string("{\"cmd\":\"ping\",\"success\":true}");
+    });
+    EXPECT_EQ(handler.handleRequest("{\"id\":9,\"cmd\":\"ping\"}", 1),
+              "{\"id\":9,\"cmd\":\"ping\",\"success\":true}");
+    EXPECT_EQ(handler.handleRequest("{\"cmd\":\"ping\"}", 1), "{\"cmd\":\"ping\",\"success\":true}");
+}
+
+TEST_F(RequestHandlerTest, BatchCommandsReturnPerItemResults) {
+    std::vector<Player::PlayerId> created;
+    handler.setPlayerCreatedCallback([&created](TcpConnection::ConnectionId clientId, Player::PlayerId playerId) {
+        EXPECT_EQ(clientId, 5u);
+        created.push_back(playerId);
+    });
+
+    std::string response = handler.handleRequest(
+        "{\"id\":1,\"cmd\":\"create_players\",\"data\":{\"players\":"
+        "[{\"name\":\"A\",\"rating\":100},7,{\"name\":\"B\\u0021\",\"rating\":2900}]}}", 5);
+    ASSERT_EQ(created.size(), 2u);
+    std::string a = std::to_string(created[0]);
+    std::string b = std::to_string(created[1]);
+    EXPECT_EQ(response, "{\"id\":1,\"cmd\":\"create_players\",\"success\":true,\"message\":\"Players created\","
+                        "\"data\":{\"succeeded\":2,\"failed\":1,\"results\":["
+                        "{\"success\":true,\"player_id\":" + a + ",\"name\":\"A\",\"rating\":100},"
+                        "{\"success\":false,\"message\":\"Invalid player\"},"
+                        "{\"success\":true,\"player_id\":" + b + ",\"name\":\"B!\",\"rating\":2900}]}}");
+
+    response = handler.handleRequest("{\"cmd\":\"join_matchmaking_batch\",\"data\":{\"player_ids\":"
+                                     "[" + a + ", " + b + ", \"x\", " + a + ", 999999]}}", 5);
+    EXPECT_EQ(response, "{\"cmd\":\"join_matchmaking_batch\",\"success\":true,\"message\":\"Batch join processed\","
+                        "\"data\":{\"succeeded\":2,\"failed\":3,\"results\":["
+                        "{\"success\":true,\"player_id\":" + a + "},"
+                        "{\"success\":true,\"player_id\":" + b + "},"
+                        "{\"success\":false,\"player_id\":\"x\",\"message\":\"Invalid player ID\"},"
+                        "{\"success\":false,\"player_id\":" + a + ",\"message\":\"Player already in queue\"},"
+                        "{\"success\":false,\"player_id\":999999,\"message\":\"Player not found\"}]}}");
+    EXPECT_EQ(MatchManager::getInstance().getQueueSize(), 2u);
+
+    response = handler.handleRequest("{\"cmd\":\"leave_matchmaking_batch\",\"data\":{\"player_ids\":[" + b + "," + b + "]}}", 5);
+    EXPECT_NE(response.find("\"succeeded\":1,\"failed\":1"), std::string::npos);
+    EXPECT_NE(response.find("Player not in queue"), std::string::npos);
+    EXPECT_EQ(MatchManager::getInstance().getQueueSize(), 1u);
+
+    // 列表缺失、类型错误或超过上限时整个请求失败
+    EXPECT_NE(handler.handleRequest("{\"cmd\":\"create_players\",\"data\":{}}", 5).find("Player list is required"),
+              std::string::npos);
+    EXPECT_NE(handler.handleRequest("{\"cmd\":\"join_matchmaking_batch\",\"data\":{\"player_ids\":1}}", 5)
+                  .find("Invalid player ID list"), std::string::npos);
+    std::string tooMany = "[1";
+    for (size_t i = 0; i < JsonRequestHandler::MAX_BATCH_SIZE; ++i) {
+        tooMany += ",1";
+    }
+    tooMany += "]";
+    EXPECT_NE(handler.handleRequest("{\"cmd\":\"leave_matchmaking_batch\",\"data\":{\"player_ids\":" + tooMany + "}}", 5)
+                  .find("Too many players in batch"), std::string::npos);
+    EXPECT_EQ(created.size(), 2u);
+}
+
+TEST_F(RequestHandlerTest, BinaryCreatePlayerAndJoin) {
+    Player::PlayerId created = 0;
+    binaryHandler.setPlayerCreatedCallback([&created](TcpConnection::ConnectionId, Player::PlayerId playerId) {
+        created = playerId;
+    });
+
+    std::string body;
+    BinaryWriter writer(body);
+    writer.i32(1720);
+    writer.str("A, \"B\"");
+    std::string response = binaryHandler.handleRequest(binaryRequest(BinaryOpcode::CREATE_PLAYER, 9, body), 7);
+
+    BinaryReader reader(response);
+    BinaryHeader header;
+    uint64_t playerId;
+    int32_t rating;
+    std::string_view name;
+    ASSERT_TRUE(reader.header(header) && reader.u64(playerId) && reader.i32(rating) && reader.str(name));
+    EXPECT_TRUE(reader.atEnd());
+    EXPECT_EQ(header.opcode, BinaryOpcode::CREATE_PLAYER);
+    EXPECT_EQ(header.status, BinaryStatus::OK);
+    EXPECT_EQ(header.requestId, 9u);
+    EXPECT_EQ(playerId, created);
+    EXPECT_EQ(rating, 1720);
+    // 二进制协议的字符串不需要转义
+    EXPECT_EQ(name, "A, \"B\"");
+
+    response = binaryHandler.handleRequest(binaryRequest(BinaryOpcode::JOIN_MATCHMAKING, 10, playerIdBody(created)), 7);
+    EXPECT_EQ(response, binaryRequest(BinaryOpcode::JOIN_MATCHMAKING, 10));
+    EXPECT_TRUE(MatchManager::getInstance().getPlayer(created)->isInQueue());
+
+    response = binaryHandler.handleRequest(binaryRequest(BinaryOpcode::GET_PLAYER_INFO, 11, playerIdBody(created)), 7);
+    reader = BinaryReader(response);
+    uint8_t inQueue;
+    ASSERT_TRUE(reader.header(header) && reader.u64(playerId) && reader.i32(rating) && reader.u8(inQueue) &&
+                reader.str(name));
+    EXPECT_EQ(header.status, BinaryStatus::OK);
+    EXPECT_EQ(inQueue, 1);
+    EXPECT_EQ(name, "A, \"B\"");
+
+    response = binaryHandler.handleRequest(binaryRequest(BinaryOpcode::GET_QUEUE_STATUS, 12), 7);
+    reader = BinaryReader(response);
+    uint64_t queueSize;
+    ASSERT_TRUE(reader.header(header) && reader.u64(queueSize));
+    EXPECT_EQ(queueSize, 1u);
+}
+
+TEST_F(RequestHandlerTest, BinaryRejectsInvalidRequests) {
+    auto expectStatus = [this](const std::string& request, BinaryStatus status) {
+        std::string response = binaryHandler.handleRequest(request, 1);
+        BinaryReader reader(response);
+        BinaryHeader header;
+        std::string_view message;
+        ASSERT_TRUE(reader.header(header) && reader.str(message));
+        EXPECT_EQ(header.status, status);
+        EXPECT_FALSE(message.empty());
+    };
+
+    expectStatus("abc", BinaryStatus::INVALID_COMMAND);
+    expectStatus(binaryRequest(static_cast<BinaryOpcode>(0x7F), 1), BinaryStatus::INVALID_COMMAND);
+    // 请求体缺少字段或有多余字节
+    expectStatus(binaryRequest(BinaryOpcode::JOIN_MATCHMAKING, 1, "1234"), BinaryStatus::INVALID_ARGUMENT);
+    expectStatus(binaryRequest(BinaryOpcode::JOIN_MATCHMAKING, 1, playerIdBody(1) + "x"), BinaryStatus::INVALID_ARGUMENT);
+    // 名称长度为5但只有2字节
+    expectStatus(binaryRequest(BinaryOpcode::CREATE_PLAYER, 1, std::string("\x01\0\0\0\x05\0ab", 8)),
+                 BinaryStatus::INVALID_ARGUMENT);
+    expectStatus(binaryRequest(BinaryOpcode::GET_PLAYER_INFO, 1, playerIdBody(999999)), BinaryStatus::PLAYER_NOT_FOUND);
+}
@@ -120,4 +120,27 @@ TEST(RoomTest, GetPlayers) {
     
     EXPECT_TRUE(foundPlayer1);
     EXPECT_TRUE(foundPlayer2);
-} 
\ No newline at end of file
+} 
+TEST(RoomTest, TeamAssignment) {
+    Room room(1, 3);
+    auto player1 = std::make_shared<Player>(1, "Player1", 1500);
+    auto player2 = std::make_shared<Player>(2, "Player2", 1600);
+    room.addPlayer(player1);
+    room.addPlayer(player2);
+
+    EXPECT_EQ(room.getTeamCount(), 0);
+    EXPECT_EQ(room.getTeam(1), -1);
+
+    EXPECT_TRUE(room.setTeam(1, 0));
+    EXPECT_TRUE(room.setTeam(2, 1));
+    // 不在房间中的玩家不能分配队伍
+    EXPECT_FALSE(room.setTeam(3, 0));
+    EXPECT_EQ(room.getTeamCount(), 2);
+    EXPECT_EQ(room.getTeam(2), 1);
+    ASSERT_EQ(room.getTeamPlayers(1).size(), 1);
+    EXPECT_EQ(room.getTeamPlayers(1)[0]->getId(), 2);
+
+    room.removePlayer(2);
+    EXPECT_EQ(room.getTeam(2), -1);
+    EXPECT_TRUE(room.getTeamPlayers(1).empty());
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include "../src/util/SocketAddress.h"
+
+using namespace gmatch;
+
+TEST(SocketAddressTest, ParsesIpv4WithAndWithoutPort) {
+    SocketAddress address;
+    ASSERT_TRUE(parseSocketAddress("127.0.0.1", 8080, address));
+    EXPECT_EQ(address.getFamily(), AF_INET);
+    EXPECT_EQ(address.getPort(), 8080);
+    EXPECT_EQ(address.toString(), "127.0.0.1:8080");
+
+    ASSERT_TRUE(parseSocketAddress("0.0.0.0:9000", 8080, address));
+    EXPECT_EQ(address.getPort(), 9000);
+    EXPECT_EQ(address.toString(), "0.0.0.0:9000");
+}
+
+TEST(SocketAddressTest, ParsesIpv6Forms) {
+    SocketAddress address;
+    ASSERT_TRUE(parseSocketAddress("::1", 8080, address));
+    EXPECT_EQ(address.getFamily(), AF_INET6);
+    EXPECT_EQ(address.toString(), "[::1]:8080");
+
+    ASSERT_TRUE(parseSocketAddress("[::]:9000", 8080, address));
+    EXPECT_EQ(address.toString(), "[::]:9000");
+
+    ASSERT_TRUE(parseSocketAddress("[fe80::1]", 8080, address));
+    EXPECT_EQ(address.getPort(), 8080);
+}
+
+TEST(SocketAddressTest, ParsesUnixPath) {
+    SocketAddress address;
+    ASSERT_TRUE(parseSocketAddress("unix:/tmp/gmatch.sock", 8080, address));
+    EXPECT_TRUE(address.isUnix());
+    EXPECT_EQ(address.getPath(), "/tmp/gmatch.sock");
+    EXPECT_EQ(address.getPort(), 0);
+    EXPECT_EQ(address.toString(), "unix:/tmp/gmatch.sock");
+}
+
+TEST(SocketAddressTest, RejectsMalformedAddresses) {
+    SocketAddress address;
+    EXPECT_FALSE(parseSocketAddress("localhost", 8080, address));
+    EXPECT_FALSE(parseSocketAddress("1.2.3.4:", 8080, address));
+    EXPECT_FALSE(parseSocketAddress("1.2.3.4:70000", 8080, address));
+    EXPECT_FALSE(parseSocketAddress("[::1", 8080, address));
+    EXPECT_FALSE(parseSocketAddress("[::1]x", 8080, address));
+    EXPECT_FALSE(parseSocketAddress("unix:", 8080, address));
+    EXPECT_FALSE(parseSocketAddress("unix:/" + std::string(200, 'x'), 8080, address));
+}
+
+TEST(SocketAddressTest, SetPortKeepsAddress) {
+    SocketAddress address;
+    ASSERT_TRUE(parseSocketAddress("::1", 0, address));
+    address.setPort(1234);
+    EXPECT_EQ(address.toString(), "[::1]:1234");
+}
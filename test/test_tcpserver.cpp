@@ -0,0 +1,656 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/server/TcpServer.h"
+
+using namespace gmatch;
+
+namespace {
+
+// 阻塞式测试客户端
+int connectTo(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+// 连接parseSocketAddress格式的地址
+int connectToAddress(const std::string& spec, uint16_t port) {
+    SocketAddress address;
+    if (!parseSocketAddress(spec, port, address)) {
+        return -1;
+    }
+    int fd = socket(address.getFamily(), SOCK_STREAM, 0);
+    if (connect(fd, address.get(), address.length) < 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+// 读取恰好length字节，超时或连接关闭时返回已读取的部分
+std::string readExactly(int fd, size_t length) {
+    std::string data;
+    char buffer[4096];
+    while (data.size() < length) {
+        ssize_t n = recv(fd, buffer, std::min(sizeof(buffer), length - data.size()), 0);
+        if (n <= 0) {
+            break;
+        }
+        data.append(buffer, n);
+    }
+    return data;
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void expectEchoServer(IoModel model, bool reusePort = false) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoModel(model);
+    server.setIoThreads(2);
+    server.setReusePort(reusePort);
+
+    std::atomic<int> connected{0};
+    std::atomic<int> closed{0};
+    server.setConnectionCallback([&connected](const TcpConnectionPtr&) { ++connected; });
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view message) {
+        conn->send(message);
+    });
+    server.setCloseCallback([&closed](const TcpConnectionPtr&) { ++closed; });
+    ASSERT_TRUE(server.start());
+    ASSERT_NE(server.getPort(), 0);
+
+    const int clientCount = 8;
+    std::vector<int> clients;
+    for (int i = 0; i < clientCount; ++i) {
+        int fd = connectTo(server.getPort());
+        ASSERT_GE(fd, 0);
+        clients.push_back(fd);
+    }
+    EXPECT_TRUE(waitFor([&] { return connected == clientCount; }));
+
+    // 大于单次读取缓冲区的消息也能完整回显
+    std::string payload = std::string(10000, 'x') + "\n";
+    for (int fd : clients) {
+        ASSERT_EQ(send(fd, payload.data(), payload.size(), 0), static_cast<ssize_t>(payload.size()));
+    }
+    for (int fd : clients) {
+        EXPECT_EQ(readExactly(fd, payload.size()), payload);
+    }
+
+    // 客户端主动关闭触发关闭回调
+    close(clients[0]);
+    EXPECT_TRUE(waitFor([&] { return closed == 1; }));
+
+    server.stop();
+    for (size_t i = 1; i < clients.size(); ++i) {
+        close(clients[i]);
+    }
+    // 服务器停止时关闭连接不触发回调
+    EXPECT_EQ(closed, 1);
+}
+
+void expectEchoOnAllListeners(IoModel model) {
+    std::string unixPath = "/tmp/gmatch_test_" + std::to_string(getpid()) + ".sock";
+    TcpServer server("127.0.0.1", 0);
+    server.setIoModel(model);
+    server.setIoThreads(2);
+    server.addListenAddress("::1");
+    server.addListenAddress("unix:" + unixPath);
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view message) {
+        conn->send(message);
+    });
+    std::atomic<int> closed{0};
+    server.setCloseCallback([&closed](const TcpConnectionPtr&) { ++closed; });
+    ASSERT_TRUE(server.start());
+    ASSERT_EQ(server.getListenAddresses().size(), 3u);
+    // IPv6地址没有写端口时使用主地址的端口
+    EXPECT_EQ(server.getListenAddresses()[1].getPort(), server.getPort());
+
+    for (const std::string& spec : std::vector<std::string>{"127.0.0.1", "::1", "unix:" + unixPath}) {
+        int fd = connectToAddress(spec, server.getPort());
+        ASSERT_GE(fd, 0) << spec;
+        ASSERT_EQ(send(fd, "hello\n", 6, 0), 6);
+        EXPECT_EQ(readExactly(fd, 6), "hello\n") << spec;
+        close(fd);
+    }
+    EXPECT_TRUE(waitFor([&] { return closed == 3; }));
+
+    // 停止后删除Unix域套接字文件
+    server.stop();
+    EXPECT_NE(access(unixPath.c_str(), F_OK), 0);
+}
+
+} // namespace
+
+TEST(TcpServerTest, ReactorEchoesAndClosesConnections) {
+    expectEchoServer(IoModel::REACTOR);
+}
+
+TEST(TcpServerTest, ThreadPerConnectionFallback) {
+    expectEchoServer(IoModel::THREAD_PER_CONNECTION);
+}
+
+TEST(TcpServerTest, ReusePortListenersPerIoThread) {
+    expectEchoServer(IoModel::REACTOR, true);
+}
+
+TEST(TcpServerTest, ReusePortIgnoredForThreadPerConnection) {
+    expectEchoServer(IoModel::THREAD_PER_CONNECTION, true);
+}
+
+TEST(TcpServerTest, ParseIoModel) {
+    IoModel model = IoModel::REACTOR;
+    EXPECT_TRUE(parseIoModel("thread", model));
+    EXPECT_EQ(model, IoModel::THREAD_PER_CONNECTION);
+    EXPECT_STREQ(ioModelName(model), "thread");
+    EXPECT_TRUE(parseIoModel("reactor", model));
+    EXPECT_EQ(model, IoModel::REACTOR);
+    EXPECT_FALSE(parseIoModel("epoll", model));
+}
+
+TEST(TcpServerTest, PipelinedFramesDispatchInOrder) {
+    for (auto framing : {FramingMode::LINE, FramingMode::LENGTH_PREFIXED}) {
+        TcpServer server("127.0.0.1", 0);
+        server.setIoThreads(1);
+        server.setFramingMode(framing);
+
+        std::mutex mutex;
+        std::vector<std::string> received;
+        server.setMessageCallback([&](const TcpConnectionPtr&, std::string_view message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.emplace_back(message);
+        });
+        ASSERT_TRUE(server.start());
+
+        int fd = connectTo(server.getPort());
+        ASSERT_GE(fd, 0);
+
+        // 三条请求合并在一次发送中，第四条拆成两次发送
+        std::string batch = encodeFrame(framing, "first") + encodeFrame(framing, "second") +
+                            encodeFrame(framing, "third");
+        std::string split = encodeFrame(framing, "fourth");
+        batch += split.substr(0, 3);
+        ASSERT_EQ(send(fd, batch.data(), batch.size(), 0), static_cast<ssize_t>(batch.size()));
+        EXPECT_TRUE(waitFor([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return received.size() == 3;
+        }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ASSERT_EQ(send(fd, split.data() + 3, split.size() - 3, 0), static_cast<ssize_t>(split.size() - 3));
+        EXPECT_TRUE(waitFor([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return received.size() == 4;
+        }));
+
+        server.stop();
+        close(fd);
+        EXPECT_EQ(received, (std::vector<std::string>{"first", "second", "third", "fourth"}));
+    }
+}
+
+TEST(TcpServerTest, OversizedFrameClosesConnection) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setMaxFrameSize(16);
+    std::atomic<int> closed{0};
+    server.setCloseCallback([&closed](const TcpConnectionPtr&) { ++closed; });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    std::string line(64, 'y');
+    ASSERT_EQ(send(fd, line.data(), line.size(), 0), static_cast<ssize_t>(line.size()));
+    EXPECT_TRUE(waitFor([&] { return closed == 1; }));
+    EXPECT_EQ(readExactly(fd, 1), "");
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, QueuedSendsArriveInOrder) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    const int messageCount = 2000;
+    // 一次回调中产生的大量响应由I/O线程合并写出，顺序不变
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view) {
+        for (int i = 0; i < messageCount; ++i) {
+            conn->send("message " + std::to_string(i));
+        }
+    });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(send(fd, "go\n", 3, 0), 3);
+
+    std::string expected;
+    for (int i = 0; i < messageCount; ++i) {
+        expected += "message " + std::to_string(i) + "\n";
+    }
+    EXPECT_EQ(readExactly(fd, expected.size()), expected);
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, SlowConsumerDisconnected) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setSendHighWaterMark(4096);
+    server.setSlowConsumerPolicy(SlowConsumerPolicy::DISCONNECT);
+    std::atomic<int> closed{0};
+    std::atomic<int> rejected{0};
+    server.setMessageCallback([&rejected](const TcpConnectionPtr& conn, std::string_view) {
+        std::string payload(1024, 'z');
+        for (int i = 0; i < 16; ++i) {
+            if (!conn->send(payload)) {
+                ++rejected;
+                break;
+            }
+        }
+    });
+    server.setCloseCallback([&closed](const TcpConnectionPtr&) { ++closed; });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(send(fd, "go\n", 3, 0), 3);
+    EXPECT_TRUE(waitFor([&] { return closed == 1; }));
+    EXPECT_EQ(rejected, 1);
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, BackpressurePausesReads) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setSendHighWaterMark(4096);
+    server.setSlowConsumerPolicy(SlowConsumerPolicy::BACKPRESSURE);
+    const size_t responseSize = 256 * 1024;
+    std::atomic<int> handled{0};
+    server.setMessageCallback([&handled](const TcpConnectionPtr& conn, std::string_view) {
+        ++handled;
+        conn->send(std::string(responseSize, 'r'));
+    });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    const int requestCount = 200;
+    std::string requests;
+    for (int i = 0; i < requestCount; ++i) {
+        requests += "req\n";
+    }
+    ASSERT_EQ(send(fd, requests.data(), requests.size(), 0), static_cast<ssize_t>(requests.size()));
+
+    // 客户端不读取时服务器停止处理新请求
+    EXPECT_TRUE(waitFor([&] { return handled > 0; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_LT(handled, requestCount);
+
+    // 客户端开始读取后恢复处理，所有响应完整送达
+    size_t expectedBytes = (responseSize + 1) * requestCount;
+    EXPECT_EQ(readExactly(fd, expectedBytes).size(), expectedBytes);
+    EXPECT_EQ(handled, requestCount);
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, ParseSlowConsumerPolicy) {
+    SlowConsumerPolicy policy = SlowConsumerPolicy::BACKPRESSURE;
+    EXPECT_TRUE(parseSlowConsumerPolicy("disconnect", policy));
+    EXPECT_EQ(policy, SlowConsumerPolicy::DISCONNECT);
+    EXPECT_STREQ(slowConsumerPolicyName(policy), "disconnect");
+    EXPECT_TRUE(parseSlowConsumerPolicy("backpressure", policy));
+    EXPECT_EQ(policy, SlowConsumerPolicy::BACKPRESSURE);
+    EXPECT_FALSE(parseSlowConsumerPolicy("drop", policy));
+}
+
+TEST(TcpServerTest, IdleConnectionsAreClosed) {
+    for (auto model : {IoModel::REACTOR, IoModel::THREAD_PER_CONNECTION}) {
+        TcpServer server("127.0.0.1", 0);
+        server.setIoModel(model);
+        server.setIoThreads(1);
+        server.setIdleTimeout(200);
+        std::atomic<int> closed{0};
+        server.setCloseCallback([&closed](const TcpConnectionPtr&) { ++closed; });
+        ASSERT_TRUE(server.start());
+
+        int idle = connectTo(server.getPort());
+        int active = connectTo(server.getPort());
+        ASSERT_GE(idle, 0);
+        ASSERT_GE(active, 0);
+
+        // 持续发送数据的连接不会被断开
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500)) {
+            ASSERT_EQ(send(active, "\n", 1, 0), 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        EXPECT_EQ(closed, 1);
+        EXPECT_EQ(readExactly(idle, 1), "");
+
+        server.stop();
+        close(idle);
+        close(active);
+    }
+}
+
+TEST(TcpServerTest, HeartbeatSentToIdleConnections) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setHeartbeat(50, "ping");
+    std::atomic<int> messages{0};
+    server.setMessageCallback([&messages](const TcpConnectionPtr&, std::string_view) { ++messages; });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(readExactly(fd, 5), "ping\n");
+    // 空闲期间重复发送
+    EXPECT_EQ(readExactly(fd, 5), "ping\n");
+
+    // 回复的空帧计为活动但不分发
+    ASSERT_EQ(send(fd, "\n", 1, 0), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(messages, 0);
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, ConnectionsOverLimitAreClosed) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setMaxConnections(2);
+    std::atomic<int> connected{0};
+    server.setConnectionCallback([&connected](const TcpConnectionPtr&) { ++connected; });
+    ASSERT_TRUE(server.start());
+
+    int first = connectTo(server.getPort());
+    int second = connectTo(server.getPort());
+    ASSERT_GE(first, 0);
+    ASSERT_GE(second, 0);
+    EXPECT_TRUE(waitFor([&] { return connected == 2; }));
+
+    // 超过上限的连接被服务器直接关闭
+    int third = connectTo(server.getPort());
+    ASSERT_GE(third, 0);
+    char byte;
+    EXPECT_EQ(recv(third, &byte, 1, 0), 0);
+    EXPECT_EQ(server.getRejectedConnections(), 1u);
+    EXPECT_EQ(connected, 2);
+    close(third);
+
+    // 有连接断开后可以再接受新连接
+    close(first);
+    EXPECT_TRUE(waitFor([&] { return server.getConnectionCount() == 1; }));
+    int fourth = connectTo(server.getPort());
+    ASSERT_GE(fourth, 0);
+    EXPECT_TRUE(waitFor([&] { return connected == 3; }));
+
+    server.stop();
+    close(second);
+    close(fourth);
+}
+
+TEST(TcpServerTest, ConcurrentAcceptorsRespectLimit) {
+    // 每个I/O线程各自接受连接，并发接受时同样不超过上限
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(4);
+    server.setReusePort(true);
+    server.setMaxConnections(3);
+    std::atomic<int> connected{0};
+    server.setConnectionCallback([&connected](const TcpConnectionPtr&) { ++connected; });
+    ASSERT_TRUE(server.start());
+
+    std::vector<int> fds;
+    for (int i = 0; i < 12; ++i) {
+        int fd = connectTo(server.getPort());
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+    }
+    EXPECT_TRUE(waitFor([&] { return connected + server.getRejectedConnections() == 12; }));
+    EXPECT_EQ(connected, 3);
+    EXPECT_EQ(server.getRejectedConnections(), 9u);
+    EXPECT_EQ(server.getConnectionCount(), 3u);
+
+    server.stop();
+    for (int fd : fds) {
+        close(fd);
+    }
+}
+
+TEST(TcpServerTest, RequestsOverRateLimitGetRejectFrame) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    // 每秒1个请求，允许突发3个，测试期间几乎不补充令牌
+    server.setRateLimit(1, 3, "busy");
+    std::atomic<int> handled{0};
+    server.setMessageCallback([&handled](const TcpConnectionPtr& conn, std::string_view message) {
+        ++handled;
+        conn->send(message);
+    });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    std::string requests = "a\nb\nc\nd\ne\n";
+    ASSERT_EQ(send(fd, requests.data(), requests.size(), 0), static_cast<ssize_t>(requests.size()));
+    EXPECT_EQ(readExactly(fd, 16), "a\nb\nc\nbusy\nbusy\n");
+    EXPECT_EQ(handled, 3);
+    EXPECT_EQ(server.getRateLimitedRequests(), 2u);
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, RateLimitRejectionEchoesRequestId) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setRateLimit(1, 1, "{\"cmd\":\"error\"}");
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view message) {
+        conn->send(message);
+    });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    // 带id的请求被拒绝时响应带回id，不带id的使用预先编码的拒绝响应
+    std::string requests = "{\"id\":1}\n{\"id\":2}\n{}\n";
+    ASSERT_EQ(send(fd, requests.data(), requests.size(), 0), static_cast<ssize_t>(requests.size()));
+    std::string expected = "{\"id\":1}\n{\"id\":2,\"cmd\":\"error\"}\n{\"cmd\":\"error\"}\n";
+    EXPECT_EQ(readExactly(fd, expected.size()), expected);
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, BinaryProtocolNegotiatedPerConnection) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setBinaryProtocol(true);
+    // 回显消息并在前面标记连接协商的协议
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view message) {
+        conn->send(std::string(wireProtocolName(conn->getProtocol())) + ":" + std::string(message));
+    });
+    ASSERT_TRUE(server.start());
+
+    // 魔数可以分多次到达，之后的数据按4字节小端序长度分帧
+    int binaryFd = connectTo(server.getPort());
+    ASSERT_GE(binaryFd, 0);
+    ASSERT_EQ(send(binaryFd, "GM", 2, 0), 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::string data = "B1" + encodeFrame(FramingMode::BINARY, "a\nb") + encodeFrame(FramingMode::BINARY, "");
+    ASSERT_EQ(send(binaryFd, data.data(), data.size(), 0), static_cast<ssize_t>(data.size()));
+    std::string expected = encodeFrame(FramingMode::BINARY, "binary:a\nb");
+    EXPECT_EQ(readExactly(binaryFd, expected.size()), expected);
+
+    // 同一服务器上的其他连接仍使用JSON，包括以魔数前缀开头的
+    int jsonFd = connectTo(server.getPort());
+    ASSERT_GE(jsonFd, 0);
+    ASSERT_EQ(send(jsonFd, "GMX\n", 4, 0), 4);
+    EXPECT_EQ(readExactly(jsonFd, 9), "json:GMX\n");
+
+    server.stop();
+    close(binaryFd);
+    close(jsonFd);
+}
+
+TEST(TcpServerTest, BinaryProtocolDisabledByDefault) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(1);
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view message) {
+        conn->send(std::string(wireProtocolName(conn->getProtocol())) + ":" + std::string(message));
+    });
+    ASSERT_TRUE(server.start());
+
+    int fd = connectTo(server.getPort());
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(send(fd, "GMB1\n", 5, 0), 5);
+    EXPECT_EQ(readExactly(fd, 10), "json:GMB1\n");
+
+    server.stop();
+    close(fd);
+}
+
+TEST(TcpServerTest, ListensOnIpv6AndUnixSocketAlongsideTcp) {
+    expectEchoOnAllListeners(IoModel::REACTOR);
+}
+
+TEST(TcpServerTest, ExtraListenersWithThreadPerConnection) {
+    expectEchoOnAllListeners(IoModel::THREAD_PER_CONNECTION);
+}
+
+TEST(TcpServerTest, ReusePortWithExtraListeners) {
+    TcpServer server("127.0.0.1", 0);
+    server.setIoThreads(2);
+    server.setReusePort(true);
+    server.addListenAddress("::1");
+    server.setMessageCallback([](const TcpConnectionPtr& conn, std::string_view message) {
+        conn->send(message);
+    });
+    ASSERT_TRUE(server.start());
+
+    // 主地址由I/O线程接受，附加地址由接受线程接受
+    for (const char* spec : {"127.0.0.1", "::1"}) {
+        int fd = connectToAddress(spec, server.getPort());
+        ASSERT_GE(fd, 0) << spec;
+        ASSERT_EQ(send(fd, "ping\n", 5, 0), 5);
+        EXPECT_EQ(readExactly(fd, 5), "ping\n") << spec;
+        close(fd);
+    }
+    server.stop();
+}
+
+TEST(TcpServerTest, InvalidListenAddressFailsStart) {
+    TcpServer server("127.0.0.1", 0);
+    server.addListenAddress("not-an-address");
+    EXPECT_FALSE(server.start());
+    EXPECT_FALSE(server.isRunning());
+}
+
+TEST(TcpServerTest, ReleasedListenSocketsAreAdoptedByAnotherServer) {
+    std::string unixPath = "/tmp/gmatch_adopt_test_" + std::to_string(getpid()) + ".sock";
+    auto taggedEcho = [](const std::string& tag) {
+        return [tag](const TcpConnectionPtr& conn, std::string_view message) {
+            conn->send(tag + std::string(message));
+        };
+    };
+
+    TcpServer oldServer("127.0.0.1", 0);
+    oldServer.setIoThreads(2);
+    oldServer.setReusePort(true);
+    oldServer.addListenAddress("unix:" + unixPath);
+    oldServer.setMessageCallback(taggedEcho("old:"));
+    ASSERT_TRUE(oldServer.start());
+    uint16_t port = oldServer.getPort();
+
+    int existing = connectTo(port);
+    ASSERT_GE(existing, 0);
+    ASSERT_EQ(send(existing, "a\n", 2, 0), 2);
+    EXPECT_EQ(readExactly(existing, 6), "old:a\n");
+
+    // 每个I/O线程一个SO_REUSEPORT套接字加一个Unix域套接字
+    std::vector<int> fds = oldServer.releaseListenSockets();
+    ASSERT_EQ(fds.size(), 3u);
+    EXPECT_TRUE(oldServer.releaseListenSockets().empty());
+
+    // 没有进程接受时连接仍然成功，留在监听队列中
+    int waitingTcp = connectTo(port);
+    ASSERT_GE(waitingTcp, 0);
+    int waitingUnix = connectToAddress("unix:" + unixPath, 0);
+    ASSERT_GE(waitingUnix, 0);
+
+    TcpServer newServer("127.0.0.1", 1);
+    newServer.setIoThreads(2);
+    newServer.setMessageCallback(taggedEcho("new:"));
+    newServer.adoptListenSockets(fds);
+    ASSERT_TRUE(newServer.start());
+    EXPECT_EQ(newServer.getPort(), port);
+    EXPECT_EQ(newServer.getListenAddresses().size(), 2u);
+
+    for (int fd : {waitingTcp, waitingUnix}) {
+        ASSERT_EQ(send(fd, "b\n", 2, 0), 2);
+        EXPECT_EQ(readExactly(fd, 6), "new:b\n");
+    }
+    // 已有连接继续由原来的服务器处理
+    ASSERT_EQ(send(existing, "c\n", 2, 0), 2);
+    EXPECT_EQ(readExactly(existing, 6), "old:c\n");
+
+    // 交出后原服务器停止时不删除Unix域套接字文件，由接手的服务器删除
+    oldServer.stop();
+    EXPECT_EQ(access(unixPath.c_str(), F_OK), 0);
+    int fresh = connectTo(port);
+    ASSERT_GE(fresh, 0);
+    ASSERT_EQ(send(fresh, "d\n", 2, 0), 2);
+    EXPECT_EQ(readExactly(fresh, 6), "new:d\n");
+    newServer.stop();
+    EXPECT_NE(access(unixPath.c_str(), F_OK), 0);
+
+    for (int fd : {existing, waitingTcp, waitingUnix, fresh}) {
+        close(fd);
+    }
+}
+
+TEST(TcpServerTest, AdoptingNonListeningSocketFailsStart) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    TcpServer server("127.0.0.1", 0);
+    server.adoptListenSockets({fd});
+    EXPECT_FALSE(server.start());
+    EXPECT_FALSE(server.isRunning());
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "../src/core/TeamBalancer.h"
+#include "../src/core/MatchMaker.h"
+
+using namespace gmatch;
+
+namespace {
+
+std::vector<int> teamSizes(const std::vector<int>& teams, int teamCount) {
+    std::vector<int> sizes(teamCount, 0);
+    for (int team : teams) {
+        ++sizes[team];
+    }
+    return sizes;
+}
+
+} // namespace
+
+TEST(TeamBalancerTest, BalancesFiveVersusFive) {
+    TeamBalancer balancer(2, 1000);
+    // 按入队顺序对半分时两队平均分相差悬殊
+    std::vector<int> ratings = {2400, 2300, 2200, 2100, 2000, 1400, 1300, 1200, 1100, 1000};
+    std::vector<int> fifoSplit = {0, 0, 0, 0, 0, 1, 1, 1, 1, 1};
+
+    auto teams = balancer.assignTeams(ratings);
+    ASSERT_EQ(teams.size(), ratings.size());
+    EXPECT_EQ(teamSizes(teams, 2), std::vector<int>({5, 5}));
+    EXPECT_LT(TeamBalancer::ratingSpread(ratings, teams, 2), 1.0);
+    EXPECT_GT(TeamBalancer::ratingSpread(ratings, fifoSplit, 2), 900.0);
+}
+
+TEST(TeamBalancerTest, LocalSwapImprovesGreedy) {
+    // 贪心分配得到 {19,11,4} / {18,13,1}，交换11与13后两队总分相同
+    std::vector<int> ratings = {1019, 1018, 1013, 1011, 1004, 1001};
+    auto greedy = TeamBalancer(2, 0).assignTeams(ratings);
+    auto swapped = TeamBalancer(2, 1000).assignTeams(ratings);
+
+    EXPECT_GT(TeamBalancer::ratingSpread(ratings, greedy, 2), 0.0);
+    EXPECT_DOUBLE_EQ(TeamBalancer::ratingSpread(ratings, swapped, 2), 0.0);
+    EXPECT_EQ(teamSizes(swapped, 2), std::vector<int>({3, 3}));
+}
+
+TEST(TeamBalancerTest, UnevenAndMultipleTeams) {
+    TeamBalancer balancer(3, 1000);
+    std::vector<int> ratings = {1500, 1600, 1700, 1800, 1900, 2000, 2100};
+
+    auto teams = balancer.assignTeams(ratings);
+    auto sizes = teamSizes(teams, 3);
+    std::sort(sizes.begin(), sizes.end());
+    EXPECT_EQ(sizes, std::vector<int>({2, 2, 3}));
+
+    // 不分队或人数不足时全部在0号队伍
+    EXPECT_EQ(TeamBalancer(1).assignTeams(ratings), std::vector<int>(7, 0));
+    EXPECT_EQ(TeamBalancer(3).assignTeams(std::vector<int>({1500, 1600})), std::vector<int>(2, 0));
+}
+
+TEST(TeamBalancerTest, MatchMakerAssignsRoomTeams) {
+    MatchMaker matchMaker(4, 1);
+    matchMaker.setTeamBalanceBudget(1000);
+
+    std::vector<PlayerPtr> players = {
+        std::make_shared<Player>(1, "Player1", 1900),
+        std::make_shared<Player>(2, "Player2", 1800),
+        std::make_shared<Player>(3, "Player3", 1200),
+        std::make_shared<Player>(4, "Player4", 1100),
+    };
+    auto room = matchMaker.createRoom(players);
+
+    EXPECT_EQ(room->getTeamCount(), 2);
+    // 最高分与最低分同队
+    EXPECT_EQ(room->getTeam(1), room->getTeam(4));
+    EXPECT_EQ(room->getTeam(2), room->getTeam(3));
+    EXPECT_NE(room->getTeam(1), room->getTeam(2));
+    EXPECT_EQ(room->getTeamPlayers(0).size(), 2);
+
+    matchMaker.setTeamCount(1);
+    auto unbalanced = matchMaker.createRoom(players);
+    EXPECT_EQ(unbalanced->getTeamCount(), 0);
+    EXPECT_EQ(unbalanced->getTeam(1), -1);
+}
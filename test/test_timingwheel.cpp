@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../src/util/TimingWheel.h"
+
+using namespace gmatch;
+
+TEST(TimingWheelTest, ExpiresAfterScheduledTicks) {
+    TimingWheel<int> wheel(8);
+    wheel.schedule(1, 1);
+    wheel.schedule(3, 3);
+    wheel.schedule(33, 3);
+    EXPECT_EQ(wheel.size(), 3u);
+
+    std::vector<std::vector<int>> expiredPerTick;
+    for (int tick = 0; tick < 4; ++tick) {
+        std::vector<int> expired;
+        wheel.advance([&expired](int& value) { expired.push_back(value); });
+        expiredPerTick.push_back(expired);
+    }
+    EXPECT_EQ(expiredPerTick, (std::vector<std::vector<int>>{{1}, {}, {3, 33}, {}}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimingWheelTest, ClampsTicksToWheelSize) {
+    TimingWheel<int> wheel(4);
+    wheel.schedule(0, 0);    // 至少一个刻度
+    wheel.schedule(100, 100);  // 最多slotCount - 1个刻度
+
+    std::vector<int> ticks;
+    for (int tick = 1; tick <= 4; ++tick) {
+        wheel.advance([&ticks, tick](int&) { ticks.push_back(tick); });
+    }
+    EXPECT_EQ(ticks, (std::vector<int>{1, 3}));
+}
+
+TEST(TimingWheelTest, RescheduleFromCallback) {
+    // 模拟空闲检测：条目到期时若截止时间未到则按剩余时间重新放回
+    TimingWheel<int> wheel(4);
+    int deadline = 10;
+    wheel.schedule(0, 3);
+
+    int now = 0;
+    int fired = -1;
+    while (fired < 0 && now < 20) {
+        ++now;
+        wheel.advance([&](int& entry) {
+            if (now >= deadline) {
+                fired = now;
+            } else {
+                wheel.schedule(entry, deadline - now);
+            }
+        });
+    }
+    EXPECT_EQ(fired, deadline);
+    EXPECT_EQ(wheel.size(), 0u);
+}
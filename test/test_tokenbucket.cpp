@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include "../src/util/TokenBucket.h"
+
+using namespace gmatch;
+
+TEST(TokenBucketTest, AllowsBurstThenRefillsAtRate) {
+    TokenBucket bucket(10, 3);  // 每100ms补充一个令牌
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(bucket.tryConsume(1000));
+    }
+    EXPECT_FALSE(bucket.tryConsume(1000));
+    EXPECT_FALSE(bucket.tryConsume(1050));
+    EXPECT_TRUE(bucket.tryConsume(1110));
+    EXPECT_FALSE(bucket.tryConsume(1110));
+}
+
+TEST(TokenBucketTest, RefillIsCappedAtBurst) {
+    TokenBucket bucket(10, 2);
+    EXPECT_TRUE(bucket.tryConsume(1000));
+    // 空闲很久也最多积累burst个令牌
+    int allowed = 0;
+    while (bucket.tryConsume(100000)) {
+        ++allowed;
+    }
+    EXPECT_EQ(allowed, 2);
+}
+
+TEST(TokenBucketTest, ClockGoingBackwardsDoesNotRefill) {
+    TokenBucket bucket(1000, 1);
+    EXPECT_TRUE(bucket.tryConsume(5000));
+    EXPECT_FALSE(bucket.tryConsume(4000));
+}